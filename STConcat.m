@@ -16,7 +16,22 @@ function [stCatTrain] = STConcat(stTrain1, stTrain2, strLevel)
 %
 % STConcat can also accept a cell array of spike trains to concatenate.  In
 % this mode, the trains will be concatenated from index 1 to the end of the
-% array.
+% array.  The trains are concatenated all at once by STConcatChunks: the size
+% of the result and the time offset of each train are found first, and the
+% spikes are then copied into chunks of at most 'SpikeChunkLength' spikes
+% (see STOptions) in a single pass, over several threads.  Concatenating many
+% short trains therefore takes time proportional to the number of spikes.
+%
+% Mapped trains are rescaled to the temporal resolution of the first train,
+% and each is offset by a whole number of ticks, as STShift would offset it.
+% Ticks are rescaled by the exact ratio between the two resolutions, and
+% rounded down, whether two trains or many are concatenated.
+%
+% If any mapped train is held in a native spike store (see STMaterialise),
+% STConcatChunks returns the concatenated mapping in a new store.  The caller
+% owns this store, and must free it with STMaterialise(stTrain, true) when it is done
+% with the train.  Zero-duration trains are skipped, and if only one train is
+% left it is returned as it is, still sharing its own store.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 2nd April, 2004
@@ -51,6 +66,16 @@ end
 % -- Handle a cell array of spike trains
 
 if (iscell(stTrain1))
+   % - Concatenate every train at once, if STConcatChunks is available
+   if ((numel(stTrain1) > 1) && (exist('STConcatChunks', 'file') == 3))
+      if (exist('strLevel', 'var') == 1)
+         stCatTrain = STConcatTrains(stTrain1, strLevel);
+      else
+         stCatTrain = STConcatTrains(stTrain1);
+      end
+      return;
+   end
+
    % - Initialise first train
    stCatTrain = stTrain1{1};
    
@@ -69,6 +94,17 @@ end
 
 % -- Non-cell array mode
 
+% - Concatenate the pair with STConcatChunks, if it is available, so that
+%   the second train is rescaled exactly
+if (exist('STConcatChunks', 'file') == 3)
+   if (exist('strLevel', 'var') == 1)
+      stCatTrain = STConcatTrains({stTrain1, stTrain2}, strLevel);
+   else
+      stCatTrain = STConcatTrains({stTrain1, stTrain2});
+   end
+   return;
+end
+
 % - Handle zero-duration spike trains
 if (STIsZeroDuration(stTrain1))
    disp('--- STConcat: Warning: Zero-duration spike train');
@@ -148,26 +184,17 @@ nodeCat.bChunkedMode = true;  % It's easier this way
 nodeCat.tDuration = node1.tDuration + node2.tDuration;
 
 % - Make sure the nodes share a common temporal resolution
-fTempResFactor = node1.fTemporalResolution / node2.fTemporalResolution;
 nodeCat.fTemporalResolution = node1.fTemporalResolution;
 
 % -- Extract spike lists
-if (node1.bChunkedMode)
-   spikeList1 = node1.spikeList;
-else
-   spikeList1 = {node1.spikeList};
-end
-
-if (node2.bChunkedMode)
-   spikeList2 = node2.spikeList;
-else
-   spikeList2 = {node2.spikeList};
-end
+spikeList1 = NodeChunks(node1);
+spikeList2 = NodeChunks(node2);
 
 % -- Fix the temporal resolution for spike list 2
 if (bFixTempRes)
    for (nChunkIndex = 1:length(spikeList2))
-      spikeList2{nChunkIndex}(:, 1) = floor(spikeList2{nChunkIndex}(:, 1) .* fTempResFactor);
+      spikeList2{nChunkIndex}(:, 1) = STRescaleTicks(spikeList2{nChunkIndex}(:, 1), ...
+                                                     node2.fTemporalResolution, node1.fTemporalResolution);
    end
 end
    
@@ -179,7 +206,7 @@ if (bFixTempRes)
    for (nChunkIndex = 1:length(spikeList2))
       % - For mappings, spike time signatures are in temporal resolution
       % counts, therefore we need to adjust for this
-      spikeList2{nChunkIndex}(:, 1) = spikeList2{nChunkIndex}(:, 1) + (node1.tDuration / node1.fTemporalResolution);
+      spikeList2{nChunkIndex}(:, 1) = spikeList2{nChunkIndex}(:, 1) + round(node1.tDuration / node1.fTemporalResolution);
    end
 else
    for (nChunkIndex = 1:length(spikeList2))
@@ -191,4 +218,163 @@ end
 nodeCat.spikeList = {spikeList1{:} spikeList2{:}};
 return;
 
+% --- END of STConcatNodes FUNCTION ---
+
+
+% --- STConcatTrains - FUNCTION
+function [stCatTrain] = STConcatTrains(cTrains, strLevel)
+% Concatenate a cell array of spike trains with STConcatChunks
+
+cTrains = reshape(cTrains, 1, []);
+
+% - Skip zero-duration spike trains, as concatenating in pairs would
+vbZeroDuration = CellForEach(@STIsZeroDuration, cTrains);
+
+for (nTrainIndex = find(vbZeroDuration))
+   disp('--- STConcat: Warning: Zero-duration spike train');
+end
+
+if (all(vbZeroDuration))
+   stCatTrain = cTrains{end};
+   return;
+end
+
+cTrains = cTrains(~vbZeroDuration);
+
+if (numel(cTrains) == 1)
+   stCatTrain = cTrains{1};
+   return;
+end
+
+% -- Which spike train level should we try to concatenate?
+
+if (exist('strLevel', 'var') == 1)
+   % - The user supplied a spike train level, so verify it
+   [strLevel, bNotExisting, bInvalidLevel] = STFindMatchingLevel(strLevel, cTrains);
+   
+   if (bInvalidLevel || strcmp(strLevel, 'definition'))
+      % - The user supplied an invalid spike train level
+      SameLinePrintf('*** STConcat: Invalid spike train level [%s].\n', strLevel);
+      disp('       strLevel must be one of {instance, mapping}');
+      return;
+   end
+
+   if (bNotExisting)
+      % - The supplied level doesn't exist in every spike train
+      SameLinePrintf('*** STConcat: To concatenate [%s], [%s] must exist in each spike train.\n', strLevel, strLevel);
+      return;
+   end
+
+else  % - Determine a spike train level we can use
+   [strLevel, bNoMatching] = STFindMatchingLevel(cTrains);
+   
+   if (bNoMatching)
+      % - There is no consistent spike train level
+      disp('*** STConcat: To concatenate trains, either a mapping or an instance');
+      disp('       must exist in every spike train');
+      return;
+   end
+end
+
+% - Extract the nodes to concatenate
+sRef.type = '.';
+sRef.subs = strLevel;
+stNodes = CellForEachCell(@subsref, cTrains, sRef);
+bMapping = strcmp(strLevel, 'mapping');
+
+if (bMapping)
+   % - Do all spike trains share a common addressing specification?
+   sRef.subs = 'stasSpecification';
+   stasSpecs = CellForEachCell(@subsref, stNodes, sRef);
+
+   if (~STAddrSpecCompare(stasSpecs{:}))
+      disp('*** STConcat: Only mapped spike trains sharing a common addressing');
+      disp('       specification can be concatenated');
+      return;
+   end
+end
+
+% -- Find the offset of each train, and the chunks to concatenate
+
+% -- Get options
+stOptions = STOptions;
+
+sRef.subs = 'tDuration';
+vtDuration = CellForEach(@subsref, stNodes, sRef);
+sRef.subs = 'fTemporalResolution';
+vfTemporalResolution = CellForEach(@subsref, stNodes, sRef);
+
+% - Each train starts where the previous trains end; mapped trains are offset
+%   by whole ticks
+vtEnd = cumsum(vtDuration);
+vtOffset = [0 vtEnd(1:end-1)];
+
+nodeCat = [];
+nodeCat.tDuration = vtEnd(end);
+nodeCat.fTemporalResolution = vfTemporalResolution(1);
+
+if (bMapping)
+   vtOffset = round(vtOffset ./ nodeCat.fTemporalResolution);
+end
+
+cNodeChunks = CellForEachCell(@NodeChunks, stNodes);
+vnNumChunks = CellForEach(@numel, cNodeChunks);
+cChunks = [cNodeChunks{:}];
+
+vnFirstChunk = cumsum([1 vnNumChunks]);
+vnSegment = zeros(1, numel(cChunks));
+
+for (nTrainIndex = 1:numel(stNodes))
+   vnSegment(vnFirstChunk(nTrainIndex):vnFirstChunk(nTrainIndex+1)-1) = nTrainIndex;
+end
+
+% - Copy every train into place, in chunks of at most SpikeChunkLength spikes
+spikeList = STConcatChunks(cChunks, vnSegment, vtOffset, vfTemporalResolution, nodeCat.fTemporalResolution, ...
+                           stOptions.SpikeChunkLength, bMapping);
+
+if (numel(spikeList) > 1)
+   nodeCat.bChunkedMode = true;
+   nodeCat.nNumChunks = numel(spikeList);
+   nodeCat.spikeList = spikeList;
+elseif (numel(spikeList) == 1)
+   nodeCat.bChunkedMode = false;
+   nodeCat.spikeList = spikeList{1};
+else
+   nodeCat.bChunkedMode = false;
+   nodeCat.spikeList = [];
+end
+
+if (bMapping)
+   nodeCat.stasSpecification = stNodes{1}.stasSpecification;
+
+   % - Keep the result in a native spike store, if any train used one
+   if (any(CellForEach(@isfield, stNodes, 'hSpikeStore')) && ~isempty(spikeList))
+      bCompress = FieldExists(stOptions, 'CompressSpikeStores') && stOptions.CompressSpikeStores;
+      nodeCat = STSpikeStoreNode(nodeCat, STSpikeStore('create', spikeList, bCompress));
+   end
+
+   stCatTrain.mapping = nodeCat;
+else
+   stCatTrain.instance = nodeCat;
+end
+
+% --- END of STConcatTrains FUNCTION ---
+
+
+% --- NodeChunks - FUNCTION
+function [cChunks] = NodeChunks(node)
+% Return the spike list of a node as a 1xC cell array of chunks
+
+if (isfield(node, 'hSpikeStore'))
+   cChunks = STSpikeStore('spikelist', node.hSpikeStore);
+elseif (node.bChunkedMode)
+   cChunks = node.spikeList;
+else
+   cChunks = {node.spikeList};
+end
+
+cChunks = reshape(cChunks, 1, []);
+
+% --- END of NodeChunks FUNCTION ---
+
 % --- END of STConcat.m ---
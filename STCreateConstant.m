@@ -36,6 +36,7 @@ for (nTrainIndex = 1:nNumTrains)
     cstTrain{nTrainIndex}.definition.strType = 'constant';
     cstTrain{nTrainIndex}.definition.fFreq = fFreq(nTrainIndex);
     cstTrain{nTrainIndex}.definition.fhInstFreq = @STInstantaneousFrequencyConstant;
+    cstTrain{nTrainIndex}.definition.fhMaxFreq = @STMaxFrequencyConstant;
     cstTrain{nTrainIndex}.definition.fhPlotFunction = @STPlotDefConstant;
 end
 
@@ -19,6 +19,13 @@ function [stTrain] = STCreateFastPoisson(fFreq,tDuration,varargin)
 % If the optional set of additional arguments are provided, the train 
 % will be mapped and 'stTrain' will contain a field 'mapping' containing 
 % the mapped spike train.  See STMap for details of these arguments.
+%
+% Inter-spike intervals are drawn from an exponential distribution, rounded
+% to a resolution of 25 usec, and intervals shorter than three bins are
+% discarded.  If the STGenerateRenewal MEX function has been compiled (see
+% STWelcome), the equivalent shifted exponential distribution is sampled
+% spike-by-spike instead, so no random numbers are drawn for the whole
+% duration.
 
 % Author: Giacomo Indiveri <giacomo@ini.phys.ethz.ch>
 % Created: 27th June, 2007
@@ -41,15 +48,25 @@ end
 duration=tDuration*1000; % spike train duration in ms
 delta_t = 0.025; % resolution of spike train in ms
 
-t = 0:delta_t:duration;
-idur=length(t);
-Vrandth = gamrnd(1,1,1,idur);
-itonextspike =round(Vrandth/(fFreq/1000*delta_t));
-itonextspike = itonextspike(itonextspike > 2); % refractory period = 0.002 ms
-ispikes = cumsum(itonextspike);
-ispikes = ispikes(ispikes < (duration/delta_t));
-nspikes = length(ispikes);
-spikes=(t(ispikes)/1000);
+if (exist('STGenerateRenewal', 'file') == 3)
+    % - Rounded exponential ISIs of more than two bins are distributed as
+    %   exponential ISIs shifted by 2.5 bins, so draw those directly.  Spike
+    %   times start one bin early, as t(ispikes) below
+    stOptions = STOptions;
+    dt = delta_t/1000;
+    vnSeed = floor(feval(stOptions.RandomGenerator, 1, 2) * 2^32);
+    spikes = STGenerateRenewal('exponential', 2.5*dt + 1/fFreq, 1/fFreq^2, -dt, tDuration - dt, dt, vnSeed, true);
+else
+    t = 0:delta_t:duration;
+    idur=length(t);
+    Vrandth = gamrnd(1,1,1,idur);
+    itonextspike =round(Vrandth/(fFreq/1000*delta_t));
+    itonextspike = itonextspike(itonextspike > 2); % refractory period = 0.002 ms
+    ispikes = cumsum(itonextspike);
+    ispikes = ispikes(ispikes < (duration/delta_t));
+    nspikes = length(ispikes);
+    spikes=(t(ispikes)/1000);
+end
 
 if (~isempty(spikes))
     [stTrain]=STCreateFromVector(spikes);
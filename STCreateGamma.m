@@ -1,10 +1,10 @@
-function [cstTrain] = STCreateGamma(fMeanISI, fVarISI)
+function [cstTrain] = STCreateGamma(fMeanISI, fVarISI, strISIDistribution)
 
 % STCreateGamma - FUNCTION Define a spike train using a gamma function for the ISI distribution
 % $Id: STCreateGamma.m 3987 2006-05-09 13:38:38Z dylan $
 %
-% Usage: [stTrain] = STCreateGamma(fMeanISI, fVarISI)
-%        [cstTrain] = STCreateGamma(vfMeanISI, vfVarISI)
+% Usage: [stTrain] = STCreateGamma(fMeanISI, fVarISI <, strISIDistribution>)
+%        [cstTrain] = STCreateGamma(vfMeanISI, vfVarISI <, strISIDistribution>)
 %
 % STCreateGamma will create a spike train definition, in which the inter-spike
 % intervals are drawn from a gamma distribution.  'fMeanFreq' and 'fVarFreq'
@@ -17,6 +17,22 @@ function [cstTrain] = STCreateGamma(fMeanISI, fVarISI)
 % trains, the parameters for each definition taken element-wise from the
 % array arguments.  If one argument is a scalar, that value will be
 % duplicated for all spike train definitions.
+%
+% The optional argument 'strISIDistribution' selects a different distribution
+% for the inter-spike intervals, with the same mean and variance.  It must be
+% one of:
+%
+%    'gamma'        - Gamma distribution (the default)
+%    'exponential'  - Exponential distribution shifted by a refractory dead
+%                     time.  The standard deviation of the ISIs is the mean of
+%                     the exponential part, and the dead time makes up the
+%                     rest of 'fMeanISI'.  'fVarISI' must be <= 'fMeanISI'^2.
+%    'lognormal'    - Log-normal distribution
+%    'invgauss'     - Inverse gaussian distribution
+%
+% If the STGenerateRenewal MEX function has been compiled (see STWelcome),
+% STInstantiate generates these trains spike-by-spike, so the cost depends on
+% the number of spikes rather than the duration of the train.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 28th February, 2005
@@ -24,12 +40,23 @@ function [cstTrain] = STCreateGamma(fMeanISI, fVarISI)
 
 % -- Check arguments
 
-if (nargin < 1)
+if (nargin < 2)
     disp ('*** STCreateGamma: Incorrect number of arguments');
     help STCreateGamma;
     return;
 end
 
+if (nargin < 3)
+   strISIDistribution = 'gamma';
+end
+
+strISIDistribution = lower(strISIDistribution);
+if (~any(strcmp(strISIDistribution, {'gamma', 'exponential', 'lognormal', 'invgauss'})))
+   disp('*** STCreateGamma: Unknown ISI distribution.  Should be one of');
+   disp('       {''gamma'', ''exponential'', ''lognormal'', ''invgauss''}');
+   return;
+end
+
 
 % -- Check number of elements in array arguments
 
@@ -74,7 +101,12 @@ fAlpha = fMeanISI.^2 ./ fVarISI;
 % fBeta = fAlpha ./ fMeanISI;
 
 % - Check suitability of alpha and beta
-if (any(fAlpha < 1))
+if (strcmp(strISIDistribution, 'exponential') && any(fAlpha < 1))
+   disp('*** STCreateGamma: An exponential ISI distribution with a dead time');
+   disp('       requires ''fVarISI'' <= ''fMeanISI''^2.');
+   return;
+   
+elseif (strcmp(strISIDistribution, 'gamma') && any(fAlpha < 1))
    disp('--- STCreateGamma: Warning: This type of spike train definition doesn''t');
    disp('       work well unless ''fVarISI'' <= ''fMeanISI''^2.  You may get no');
    disp('       spikes when you instantiate this train.');
@@ -89,6 +121,7 @@ for (nTrainIndex = 1:nNumTrains);
     cstTrain{nTrainIndex}.definition.strType = 'gamma';
     cstTrain{nTrainIndex}.definition.fMeanISI = fMeanISI(nTrainIndex);
     cstTrain{nTrainIndex}.definition.fVarISI = fVarISI(nTrainIndex);
+    cstTrain{nTrainIndex}.definition.strISIDistribution = strISIDistribution;
     cstTrain{nTrainIndex}.definition.fhInstFreq = @STInstantaneousFrequencyGamma;
     cstTrain{nTrainIndex}.definition.fhPlotFunction = @STPlotDefGamma;
 end
@@ -78,6 +78,7 @@ for (nTrainIndex = 1:nNumTrains)
     cstTrain{nTrainIndex}.definition.fStartFreq = fStartFreq(nTrainIndex);
     cstTrain{nTrainIndex}.definition.fEndFreq = fEndFreq(nTrainIndex);
     cstTrain{nTrainIndex}.definition.fhInstFreq = @STInstantaneousFrequencyLinear;
+    cstTrain{nTrainIndex}.definition.fhMaxFreq = @STMaxFrequencyLinear;
     cstTrain{nTrainIndex}.definition.fhPlotFunction = @STPlotDefLinear;
 end
 
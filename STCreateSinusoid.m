@@ -91,6 +91,7 @@ for (nTrainIndex = 1:nNumTrains)
     cstTrain{nTrainIndex}.definition.fMaxFreq = fFreqs(2);
     cstTrain{nTrainIndex}.definition.tPeriod = tPeriod(nNumTrains);
     cstTrain{nTrainIndex}.definition.fhInstFreq = @STInstantaneousFrequencySinusoid;
+    cstTrain{nTrainIndex}.definition.fhMaxFreq = @STMaxFrequencySinusoid;
     cstTrain{nTrainIndex}.definition.fhPlotFunction = @STPlotDefSinusoid;
 end
 
@@ -13,6 +13,16 @@ function [stCroppedTrain] = STCrop(stTrain, tMinTime, tMaxTime)
 % Note: STCrop will not shift the cropped spike train to zero -- see the
 % STNormalise function for help with this.  However, STCrop will correct the
 % duration of the spike train to end at tMaxTime.
+%
+% If the mapping of 'stTrain' has been indexed with STIndexAddresses, the
+% index is cropped along with the spikes, and returned with the mapping of
+% 'stCroppedTrain'.
+%
+% If the mapping of 'stTrain' is held in a native spike store (see
+% STMaterialise), the cropped spikes are returned in a new store.  The caller
+% owns this store, and should free it with STMaterialise(stCroppedTrain, true)
+% once 'stCroppedTrain' is no longer needed.  The store of 'stTrain' is left
+% as it is.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Date: 14th May, 2004
@@ -83,6 +93,13 @@ if (bUseMapping)
    nodeNew.tDuration = tMaxTime .* nodeNew.fTemporalResolution;
 end
 
+% - Crop a native spike store directly
+if (bUseMapping && isfield(nodeOld, 'hSpikeStore'))
+   hStore = STSpikeStore('crop', nodeOld.hSpikeStore, tMinTime, tMaxTime);
+   stCroppedTrain.mapping = STSpikeStoreNode(nodeNew, hStore);
+   return;
+end
+
 % - Extract spike train
 if (nodeOld.bChunkedMode)
    spikeList = nodeOld.spikeList;
@@ -93,9 +110,11 @@ else
 end
 
 % - Crop spikes in chunks
+cvbKeptSpikes = cell(nNumChunks, 1);
 for (nChunkIndex = 1:nNumChunks)
    vbMatchingSpikes = (spikeList{nChunkIndex}(:, 1) >= tMinTime) & (spikeList{nChunkIndex}(:, 1) <= tMaxTime);
    spikeList{nChunkIndex} = spikeList{nChunkIndex}(vbMatchingSpikes, :);
+   cvbKeptSpikes{nChunkIndex} = vbMatchingSpikes;
 end
 
 % - Remove empty chunks
@@ -118,6 +137,11 @@ else
    nodeNew.spikeList = spikeList{1};
 end
 
+% - Keep the address index of the mapping up to date
+if (bUseMapping && STAddrIndexValid(nodeOld))
+   nodeNew.stAddrIndex = CropIndex(nodeOld.stAddrIndex, vertcat(cvbKeptSpikes{:}), spikeList);
+end
+
 % - Assign node
 if (bUseMapping)
    stCroppedTrain.mapping = nodeNew;
@@ -125,4 +149,32 @@ else
    stCroppedTrain.instance = nodeNew;
 end
 
+% --- END of STCrop FUNCTION ---
+
+
+% --- FUNCTION CropIndex
+
+function [stIndex] = CropIndex(stIndex, vbKeptSpikes, spikeList)
+
+% - Renumber the kept spikes, and drop the others from the postings
+vnNewSpike = cumsum(vbKeptSpikes(:));
+vbKeptPostings = vbKeptSpikes(stIndex.vnPostings);
+vbKeptPostings = vbKeptPostings(:);
+vnKeptBefore = [0; cumsum(vbKeptPostings)];
+
+stIndex.vnOffsets = vnKeptBefore(stIndex.vnOffsets + 1);
+stIndex.vnPostings = vnNewSpike(stIndex.vnPostings(vbKeptPostings));
+stIndex.vnPostings = stIndex.vnPostings(:);
+
+% - Drop addresses with no spikes left
+vbKeptKeys = diff(stIndex.vnOffsets) > 0;
+stIndex.vAddrKey = stIndex.vAddrKey(vbKeptKeys);
+stIndex.vnOffsets = [stIndex.vnOffsets(vbKeptKeys); stIndex.vnOffsets(end)];
+
+% - Number the remaining chunks
+vnChunkLengths = reshape(CellForEach(@size, spikeList, 1), [], 1);
+stIndex.vnChunkStarts = [0; cumsum(vnChunkLengths)];
+
+% --- END of CropIndex FUNCTION ---
+
 % --- END of STCrop.m ---
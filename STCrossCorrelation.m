@@ -1,10 +1,10 @@
-function [vCorrSmoothed, vCorrRaw, vtCorrTime] = STCrossCorrelation(stTrain1, stTrain2, tWindow, strKernel, tSmoothing)
+function [vCorrSmoothed, vCorrRaw, vtCorrTime] = STCrossCorrelation(stTrain1, stTrain2, tWindow, strKernel, tSmoothing, strMethod)
 
 % STCrossCorrelation - FUNCTION Calcualte cross-correlation for instantiated spike trains
 % $Id: STCrossCorrelation.m 3987 2006-05-09 13:38:38Z dylan $
 %
 % Usage: [vCorrSmoothed, vCorrRaw, vtCorrTime] = STCrossCorrelation(stTrain1, stTrain2
-%                                                   <, tWindow, strKernel, tSmoothing>)
+%                                                   <, tWindow, strKernel, tSmoothing, strMethod>)
 %
 % STCrossCorrelation calculates the cross-correlation of two spike trains.
 % Any mapping information is ignored; this function is designed to work with
@@ -30,6 +30,17 @@ function [vCorrSmoothed, vCorrRaw, vtCorrTime] = STCrossCorrelation(stTrain1, st
 % output arguments are supplied, the (smoothed) correlation will be plotted in
 % the current figure.
 %
+% The raw correlation counts every pair of a spike from 'stTrain1' and a
+% spike from 'stTrain2' whose separation falls inside the window.
+% 'strMethod' optionally chooses how the pairs are counted.  'sweep' sweeps
+% the two sorted trains together, so only the pairs inside the window are
+% visited; this suits sparse trains and short windows.  'fft' bins both trains
+% at the sampling rate and correlates them by FFT, a zero-padded block at a
+% time, so the cost depends on the length of the recording rather than on the
+% number of pairs; this suits dense trains and wide windows.  'auto' (the
+% default) counts the pairs inside the window, and uses whichever method is
+% cheaper.  Both methods give exactly the same counts.
+%
 % To perform an autocorrelation, just supply the same spike train twice.  In
 % this case, the zero point will be ignored for smoothing and will be replaced
 % by a NaN.
@@ -45,7 +56,7 @@ stOptions = STOptions;
 
 % -- Check arguments
 
-if (nargin > 5)
+if (nargin > 6)
    disp('--- STCrossCorrelation: Extra arguments ignored');
 end
 
@@ -64,6 +75,20 @@ if (nargin < 4)
    strKernel = stOptions.DefaultCorrSmoothingKernel;
 end
 
+if (nargin < 6)
+   % - Choose the correlation method automatically
+   strMethod = 'auto';
+end
+
+% - Check if the supplied method is valid
+if (  ~strcmp(strMethod, 'auto') && ...
+      ~strcmp(strMethod, 'sweep') && ...
+      ~strcmp(strMethod, 'fft'))
+   disp('*** STCrossCorrelation: Invalid correlation method specified.  ''strMethod''');
+   disp('       must be one of {''auto'', ''sweep'', ''fft''}.');
+   return;
+end
+
 % - Check if the supplied kernel is valid
 if (  ~strcmp(strKernel, 'gaussian') && ...
       ~strcmp(strKernel, 'square') && ...
@@ -130,39 +155,15 @@ nWindowSize = round(tWindow * fSampRate);
 nSmoothingSize = round(tSmoothing * fSampRate);
 
 
-% -- Prepare cross-correlation algorithm
-
-% - Make a matrix of both spike trains concatenated, and tagged with the
-% source
-mSpikes = [ [vSpikeIndex1 zeros(length(vSpikeIndex1), 1)] ; [vSpikeIndex2 ones(length(vSpikeIndex2), 1)] ];
-
-% - Sort the matrix by spike time
-mSpikes = sortrows(mSpikes, 1);
-
-vCorrRaw = zeros(1, nWindowSize * 2 + 1);
-
-
 % -- Calculate cross-correlation
 
-for (nBinDifference = 2:length(mSpikes))
-   % - Get ISIs and index differences for the given separation
-   mDiffSpikes = mSpikes(nBinDifference:end, :) - mSpikes(1:end+1-nBinDifference, :);
-   
-   % - Only keep ISIs where we've shifted from one train to the other
-   vFilteredSpikes = [mDiffSpikes(mDiffSpikes(:, 2) == 1, 1); -mDiffSpikes(mDiffSpikes(:, 2) == -1, 1)];
-   
-   % - Only keep ISIs inside the time window
-   vFilteredSpikes = vFilteredSpikes(abs(vFilteredSpikes) <= nWindowSize);
-
-   % - Should we break?
-   if ((size(vFilteredSpikes, 1) == 0) && (rem(nBinDifference, 2) == 0))
-      break;
-   end
-   
-   % - Accumulate correlations
-   for (nCorrIndex = vFilteredSpikes' + nWindowSize + 1)
-      vCorrRaw(nCorrIndex) = vCorrRaw(nCorrIndex) + 1;
-   end
+if (exist('STCorrelogram', 'file') == 3)
+   % - Sweep the sorted trains together, or correlate them by FFT, natively
+   vCorrRaw = STCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize, strMethod);
+elseif (strcmp(strMethod, 'fft'))
+   vCorrRaw = FFTCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize);
+else
+   vCorrRaw = CrossCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize);
 end
 
 % - For autocorrelation, replace zero point with a NaN
@@ -199,7 +200,11 @@ if (bSmoothing)
    vCorrSmoothed(isnan(vCorrSmoothed)) = 0;
    
    % - Perform smoothing with convolution
-   vCorrSmoothed = conv2(vCorrSmoothed, vKern, 'same');
+   if (exist('STConv', 'file') == 3)
+      vCorrSmoothed = STConv(vCorrSmoothed, vKern, 'same');
+   else
+      vCorrSmoothed = conv2(vCorrSmoothed, vKern, 'same');
+   end
    
    % - Tidy up the display
    STProgress('\b\b\b\b\b\b\b\b\b\b\b\b            \b\b\b\b\b\b\b\b\b\b\b\b');
@@ -244,4 +249,74 @@ if (nargout == 0)
    clear vCorrSmoothed vCorrRaw;
 end
 
+% --- END of STCrossCorrelation FUNCTION ---
+
+
+% --- FUNCTION CrossCorrelogram
+
+function [vCorrRaw] = CrossCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize)
+
+% NOTE: This is only used if STCorrelogram has not been compiled
+
+% - Make a matrix of both spike trains concatenated, and tagged with the
+% source
+mSpikes = [ [vSpikeIndex1 zeros(length(vSpikeIndex1), 1)] ; [vSpikeIndex2 ones(length(vSpikeIndex2), 1)] ];
+
+% - Sort the matrix by spike time
+mSpikes = sortrows(mSpikes, 1);
+
+vCorrRaw = zeros(1, nWindowSize * 2 + 1);
+
+for (nBinDifference = 2:length(mSpikes))
+   % - Get ISIs and index differences for the given separation
+   mDiffSpikes = mSpikes(nBinDifference:end, :) - mSpikes(1:end+1-nBinDifference, :);
+   
+   % - Only keep ISIs where we've shifted from one train to the other
+   vFilteredSpikes = [mDiffSpikes(mDiffSpikes(:, 2) == 1, 1); -mDiffSpikes(mDiffSpikes(:, 2) == -1, 1)];
+   
+   % - Only keep ISIs inside the time window
+   vFilteredSpikes = vFilteredSpikes(abs(vFilteredSpikes) <= nWindowSize);
+
+   % - Spike separations only grow with the rank difference, so stop once
+   %   every pair is outside the window
+   if (all(mDiffSpikes(:, 1) > nWindowSize))
+      break;
+   end
+   
+   % - Accumulate correlations
+   for (nCorrIndex = vFilteredSpikes' + nWindowSize + 1)
+      vCorrRaw(nCorrIndex) = vCorrRaw(nCorrIndex) + 1;
+   end
+end
+
+% --- END of CrossCorrelogram FUNCTION ---
+
+
+% --- FUNCTION FFTCorrelogram
+
+function [vCorrRaw] = FFTCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize)
+
+% NOTE: This is only used if STCorrelogram has not been compiled
+
+vCorrRaw = zeros(1, nWindowSize * 2 + 1);
+
+if (isempty(vSpikeIndex1) || isempty(vSpikeIndex2))
+   return;
+end
+
+% - Bin both trains over their common span, one sample per bin
+nOrigin = min([vSpikeIndex1(:); vSpikeIndex2(:)]);
+nSpan = max([vSpikeIndex1(:); vSpikeIndex2(:)]) - nOrigin + 1;
+vBins1 = accumarray(vSpikeIndex1(:) - nOrigin + 1, 1, [nSpan 1]);
+vBins2 = accumarray(vSpikeIndex2(:) - nOrigin + 1, 1, [nSpan 1]);
+
+% - Zero-pad so that lags inside the window don't wrap around
+nFFTSize = 2^nextpow2(nSpan + nWindowSize);
+vCorr = real(ifft(conj(fft(vBins1, nFFTSize)) .* fft(vBins2, nFFTSize)));
+
+% - Negative lags wrap to the end of the correlation; counts are whole numbers
+vCorrRaw = round(vCorr([nFFTSize-nWindowSize+1:nFFTSize 1:nWindowSize+1]))';
+
+% --- END of FFTCorrelogram FUNCTION ---
+
 % --- END of STCrossCorrelation.m ---
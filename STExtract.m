@@ -34,6 +34,15 @@ function [stExtTrain] = STExtract(stTrain, varargin)
 %
 % Note that the addressing specification will be taken from 'stTrain' and can
 % not be overridden.
+%
+% If the mapping of 'stTrain' has been indexed with STIndexAddresses, the
+% matching spikes are looked up in the index rather than found by searching
+% the whole spike list.  This makes extracting each address of a large
+% multiplexed mapping in turn much faster.
+%
+% When the mapping of 'stTrain' is held in a native spike store (see
+% STMaterialise), the extracted spikes are kept in a new store.  The caller
+% owns it, and frees it with STMaterialise(stExtTrain, true).
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 9th May, 2004
@@ -103,6 +112,13 @@ if (~any(vbArrayAddresses))
    mapping.addrSynapse = addrLogMin;
 end
 
+% - Extract from a native spike store directly
+if (isfield(stTrain.mapping, 'hSpikeStore'))
+   hStore = STSpikeStore('extract', stTrain.mapping.hSpikeStore, addrLogMin, addrLogMax);
+   stExtTrain.mapping = STSpikeStoreNode(mapping, hStore);
+   return;
+end
+
 % - Extract the spike list
 if (mapping.bChunkedMode)
    spikeList = stTrain.mapping.spikeList;
@@ -112,11 +128,17 @@ else
    nNumChunks = 1;
 end
 
-% - Filter the spike list
-for (nChunkIndex = 1:nNumChunks)
-   rawSpikeList = spikeList{nChunkIndex};
-   vbMatchingSpikes = (rawSpikeList(:, 2) >= addrLogMin) & (rawSpikeList(:, 2) <= addrLogMax);
-   spikeList{nChunkIndex} = rawSpikeList(vbMatchingSpikes, :);
+if (STAddrIndexValid(stTrain.mapping))
+   % - Look up the matching spikes in the address index
+   spikeList = ExtractIndexed(spikeList, stTrain.mapping.stAddrIndex, addrLogMin, addrLogMax);
+
+else
+   % - Filter the spike list
+   for (nChunkIndex = 1:nNumChunks)
+      rawSpikeList = spikeList{nChunkIndex};
+      vbMatchingSpikes = (rawSpikeList(:, 2) >= addrLogMin) & (rawSpikeList(:, 2) <= addrLogMax);
+      spikeList{nChunkIndex} = rawSpikeList(vbMatchingSpikes, :);
+   end
 end
 
 % - Reassign the spike list
@@ -129,4 +151,45 @@ end
 % - Assign the mapping to a new spike train
 stExtTrain.mapping = mapping;
 
+% --- END of STExtract FUNCTION ---
+
+
+% --- FUNCTION ExtractIndexed
+
+function [spikeList] = ExtractIndexed(spikeList, stIndex, addrLogMin, addrLogMax)
+
+% - The spikes of a range of sorted addresses are a single range of postings
+vnKeys = find((stIndex.vAddrKey >= addrLogMin) & (stIndex.vAddrKey <= addrLogMax));
+
+if (isempty(vnKeys))
+   vnSpikes = zeros(0, 1);
+else
+   vnSpikes = stIndex.vnPostings(stIndex.vnOffsets(vnKeys(1))+1:stIndex.vnOffsets(vnKeys(end)+1));
+   vnSpikes = reshape(vnSpikes, [], 1);
+
+   % - Merge the spikes of several addresses back into order
+   if (numel(vnKeys) > 1)
+      vnSpikes = sort(vnSpikes);
+   end
+end
+
+% - Split the spikes by chunk; chunk 'c' holds the spikes numbered
+%   vnChunkStarts(c)+1 to vnChunkStarts(c+1)
+vnChunkStarts = reshape(stIndex.vnChunkStarts, [], 1);
+
+if (isempty(vnSpikes))
+   vnChunkCounts = zeros(numel(spikeList), 1);
+else
+   vnChunkCounts = histc(vnSpikes, vnChunkStarts + 0.5);
+   vnChunkCounts = reshape(vnChunkCounts(1:end-1), [], 1);
+end
+
+cvnChunkSpikes = mat2cell(vnSpikes, vnChunkCounts, 1);
+
+for (nChunkIndex = 1:numel(spikeList))
+   spikeList{nChunkIndex} = spikeList{nChunkIndex}(cvnChunkSpikes{nChunkIndex} - vnChunkStarts(nChunkIndex), :);
+end
+
+% --- END of ExtractIndexed FUNCTION ---
+
 % --- END of STExtract.m ---
@@ -19,6 +19,11 @@ function [stPairs] = STFindSynchronousPairs(stTrain1, stTrain2, tWindowSize, str
 % 'strLevel' can optionally be provided to specify a spike train level to
 % match, and should be one of {'instance', 'mapping'}.
 %
+% Spikes are matched by STSynchronousChunks, which compares each chunk of
+% 'stTrain1' only with the chunks of 'stTrain2' that overlap it in time, in a
+% single sweep over both, so matching takes time proportional to the number
+% of spikes.  Chunks are matched in parallel.
+%
 % STFindSynchronousPairs can accept a cell array of spike trains.  In this
 % case, the matching result from the first two trains will be repeatedly
 % matched through the remaining trains.  For example, the first two trains
@@ -154,74 +159,102 @@ end
 function [stPairs] = STFindSynchronousPairsNodes(node1, node2, tWindowSize, bIsMapping)
 
 nodeMatch = [];
-nodeMatch.bChunkedMode = node1.bChunkedMode;
-nodeMatch.nNumChunks = node1.nNumChunks;
 nodeMatch.tDuration = node1.tDuration;
 
 % - Make sure the nodes share a common temporal resolution
 nodeMatch.fTemporalResolution = node1.fTemporalResolution;
 
-% -- Extract the spikelists
-if (node1.bChunkedMode)
-   spikeList1 = node1.spikeList;
+% - Convert each spike list to chunks of spike times once, rather than for
+%   every pair of chunks
+spikeList1 = NodeTimes(node1, bIsMapping);
+spikeList2 = NodeTimes(node2, bIsMapping);
+
+
+% -- Match the spikelists
+
+if (exist('STSynchronousChunks', 'file') == 3)
+   % - Sweep each pair of overlapping chunks once, natively
+   cMatches = STSynchronousChunks(spikeList1, spikeList2, tWindowSize);
+
 else
-   spikeList1 = {node1.spikeList};
+   cMatches = cell(1, length(spikeList1));
+
+   for (nChunkIndex1 = 1:length(spikeList1))
+      spikeTime1 = spikeList1{nChunkIndex1};
+
+      chunkMatches = [];
+
+      for (nChunkIndex2 = 1:length(spikeList2))
+         % - Get list of spike times from spike list 2
+         spikeTime2 = spikeList2{nChunkIndex2};
+
+         % - Make sure both spike lists are the same length
+         % - Pad the shorter list with NaNs
+         spikeTime2 = [spikeTime2; nan * ones(length(spikeTime1) - length(spikeTime2), 1)];
+         spikeTime1 = [spikeTime1; nan * ones(length(spikeTime2) - length(spikeTime1), 1)];
+
+         % - Get the min and max time windows
+         minTime = spikeTime1 - (tWindowSize/2);
+         maxTime = spikeTime1 + (tWindowSize/2);
+
+         for (nListIndex2 = 1:length(spikeTime2))
+            % - Get a shifted version of the spike times from spike train 2
+            spikeSearch2 = [spikeTime2(nListIndex2:length(spikeTime2));...
+                            spikeTime2(1:nListIndex2-1)];
+
+            % - Match the times with spike train 1
+            chunkMatches = [chunkMatches;...
+                            spikeTime1((spikeSearch2 >= minTime) & (spikeSearch2 <= maxTime))];
+         end
+      end
+
+      % - Only keep unique matches
+      cMatches{nChunkIndex1} = unique(chunkMatches);
+   end
 end
 
-if (node2.bChunkedMode)
-   spikeList2 = node2.spikeList;
+% - Keep the chunks of train 1
+if (length(cMatches) > 1)
+   nodeMatch.bChunkedMode = true;
+   nodeMatch.nNumChunks = length(cMatches);
+   nodeMatch.spikeList = cMatches;
 else
-   spikeList2 = {node2.spikeList};
+   nodeMatch.bChunkedMode = false;
+   nodeMatch.spikeList = cMatches{1};
 end
 
 
-% -- Match the spikelists
+% - Assign the instance
+stPairs.instance = nodeMatch;
+
+% --- END of STFindSynchronousPairsNodes FUNCTION ---
+
 
-for (nChunkIndex1 = 1:length(spikeList1))
-   spikeTime1 = spikeList1{nChunkIndex1}(:, 1);
+% --- FUNCTION NodeTimes
+
+function [spikeList] = NodeTimes(node, bIsMapping)
+
+% - Native spike stores convert their ticks to times themselves
+if (isfield(node, 'hSpikeStore'))
+   spikeList = STSpikeStore('times', node.hSpikeStore, node.fTemporalResolution);
+   return;
+end
+
+if (node.bChunkedMode)
+   spikeList = node.spikeList;
+else
+   spikeList = {node.spikeList};
+end
+
+for (nChunkIndex = reshape(find(~CellForEach(@isempty, spikeList)), 1, []))
+   spikeList{nChunkIndex} = spikeList{nChunkIndex}(:, 1);
    
    if (bIsMapping)
       % - Convert to time signature format
-      spikeTime1 = spikeTime1 .* node1.fTemporalResolution;
-   end
-   
-   chunkMatches = [];
-   
-   for (nChunkIndex2 = 1:length(spikeList2))
-      % - Get list of spike times from spike list 2
-      spikeTime2 = spikeList2{nChunkIndex2}(:, 1);
-      
-      if (bIsMapping)
-         % - Convert to time signature format
-         spikeTime2 = spikeTime2 .* node2.fTemporalResolution;
-      end
-      
-      % - Make sure both spike lists are the same length
-      % - Pad the shorter list with NaNs
-      spikeTime2 = [spikeTime2; nan * ones(length(spikeTime1) - length(spikeTime2), 1)];
-      spikeTime1 = [spikeTime1; nan * ones(length(spikeTime2) - length(spikeTime1), 1)];
-
-      % - Get the min and max time windows
-      minTime = spikeTime1 - (tWindowSize/2);
-      maxTime = spikeTime1 + (tWindowSize/2);
-      
-      for (nListIndex2 = 1:length(spikeTime2))
-         % - Get a shifted version of the spike times from spike train 2
-         spikeSearch2 = [spikeTime2(nListIndex2:length(spikeTime2));...
-                         spikeTime2(1:nListIndex2-1)];
-         
-         % - Match the times with spike train 1
-         chunkMatches = [chunkMatches;...
-                         spikeTime1((spikeSearch2 >= minTime) & (spikeSearch2 <= maxTime))];
-      end
+      spikeList{nChunkIndex} = spikeList{nChunkIndex} .* node.fTemporalResolution;
    end
-   
-   % - Only keep unique matches
-   nodeMatch.spikeList{nChunkIndex1} = unique(chunkMatches);
 end
 
-
-% - Assign the instance
-stPairs.instance = nodeMatch;
+% --- END of NodeTimes FUNCTION ---
 
 % --- END of STFindSynchronousPairs.m ---
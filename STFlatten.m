@@ -48,23 +48,35 @@ end
 
 % -- Flatten the spike train
 
-% - Extract the spike list
-if (stTrain.mapping.bChunkedMode)
-   spikeList = stTrain.mapping.spikeList;
-   nNumChunks = stTrain.mapping.nNumChunks;
+if (isfield(stTrain.mapping, 'hSpikeStore'))
+   % - Convert the ticks of the native spike store to spike times in one pass
+   spikeList = STSpikeStore('times', stTrain.mapping.hSpikeStore, stTrain.mapping.fTemporalResolution);
+   bChunkedMode = (length(spikeList) > 1);
+   
+   if (isempty(spikeList))
+      spikeList = {[]};
+   end
+   
 else
-   spikeList = {stTrain.mapping.spikeList};
-   nNumChunks = 1;
-end
-
-% - Flatten the train
-for (nChunkIndex = 1:nNumChunks)
-   spikeList{nChunkIndex} = spikeList{nChunkIndex}(:, 1) .* stTrain.mapping.fTemporalResolution;
+   % - Extract the spike list
+   if (stTrain.mapping.bChunkedMode)
+      spikeList = stTrain.mapping.spikeList;
+      nNumChunks = stTrain.mapping.nNumChunks;
+   else
+      spikeList = {stTrain.mapping.spikeList};
+      nNumChunks = 1;
+   end
+   bChunkedMode = stTrain.mapping.bChunkedMode;
+   
+   % - Flatten the train
+   for (nChunkIndex = 1:nNumChunks)
+      spikeList{nChunkIndex} = spikeList{nChunkIndex}(:, 1) .* stTrain.mapping.fTemporalResolution;
+   end
 end
 
 % - Make a new instance
 instance.tDuration = stTrain.mapping.tDuration;
-instance.bChunkedMode = stTrain.mapping.bChunkedMode;
+instance.bChunkedMode = bChunkedMode;
 instance.fTemporalResolution = stTrain.mapping.fTemporalResolution;
 
 % - Assign the flattened spike train
@@ -27,6 +27,9 @@ function [mISIHist, tTimeBins] = STISIHist(stTrain, bUseLog, nNumBins)
 %
 % If no output arguments are supplied, STISIHist will construct a plot of the
 % ISI histogram.
+%
+% See STISIHistAddresses for histogramming the ISIs of each address of a
+% multiplexed mapping separately.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 4th March, 2005
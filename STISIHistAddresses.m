@@ -0,0 +1,185 @@
+function [mISIHist, tTimeBins, vKey, vtMeanISI, vfCV, vtMinISI] = STISIHistAddresses(stMappedTrain, bUseLog, nNumBins)
+
+% STISIHistAddresses - FUNCTION Construct an ISI histogram for each address of a mapped spike train
+% $Id: STISIHistAddresses.m $
+%
+% Usage: [mISIHist, tTimeBins, vKey, vtMeanISI, vfCV, vtMinISI] = ...
+%              STISIHistAddresses(stMappedTrain <, bUseLog, nNumBins>)
+%        [mISIHist, tTimeBins, vKey, vtMeanISI, vfCV, vtMinISI] = ...
+%              STISIHistAddresses(stMappedTrain <, bUseLog, tTimeBins>)
+%
+% 'stMappedTrain' is a spike train containing a mapping, usually multiplexed
+% from the trains of many neurons.  STISIHistAddresses will calculate an
+% inter-spike interval histogram for the spikes of each address in the
+% mapping separately, without extracting each address with STExtract.
+% 'mISIHist' will be a matrix, with the histogram for each address along the
+% rows of the matrix, for the bin centres specified in 'tTimeBins'.  Each row
+% in 'vKey' gives the address corresponding to one of the rows of
+% 'mISIHist'.  'vKey' is sorted, and contains every address with a spike in
+% 'stMappedTrain'.
+%
+% 'vtMeanISI' will give the mean ISI for each address, 'vfCV' the coefficient
+% of variation of the ISIs (their standard deviation divided by their mean)
+% and 'vtMinISI' the shortest ISI.  These will be NaN for addresses with too
+% few spikes.
+%
+% The optional arguments 'bUseLog' and 'nNumBins' are as for STISIHist: a log
+% time scale can be used for the histogram bins, and 50 bins are used by
+% default.  The bins are generated to span the shortest and longest ISI over
+% all addresses, so the identical time bins are used for each histogram.  If a
+% vector is supplied for 'tTimeBins', the specified bin centres will be used
+% instead.
+%
+% The mapping is read in a single pass (or two, when the bins must be
+% generated), keeping only the last spike of each address, by a compiled
+% kernel if one is available.
+%
+% See STISIHist for histogramming spike train instances, or the flattened
+% spikes of a mapping.
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026 (from STISIHist by Dylan Muir)
+% Copyright (c) 2026 agent
+
+% -- Constants
+
+% - Default number of histogram bins
+nDefaultNumBins = 50;
+
+
+% -- Check arguments
+
+if (nargin > 3)
+   disp('--- STISIHistAddresses: Extra arguments ignored');
+end
+
+if (nargin < 1)
+   disp('*** STISIHistAddresses: Incorrect usage');
+   help STISIHistAddresses;
+   return;
+end
+
+if ((nargin < 2) || isempty(bUseLog))
+   % - Default to linear scale
+   bUseLog = false;
+end
+
+if ((nargin < 3) || isempty(nNumBins))
+   % - Use default number of time bins
+   nNumBins = nDefaultNumBins;
+end
+
+% - Test that a mapping exists in the spike train
+if (~FieldExists(stMappedTrain, 'mapping'))
+   disp('*** STISIHistAddresses: The spike train doesn''t contain a mapping');
+   return;
+end
+
+% - Check if a vector of time bins was supplied
+bGenerateBins = numel(nNumBins) == 1;
+
+
+% -- Extract spike lists
+
+mapping = stMappedTrain.mapping;
+
+if (isfield(mapping, 'hSpikeStore'))
+   spikeList = STSpikeStore('spikelist', mapping.hSpikeStore);
+elseif (mapping.bChunkedMode)
+   spikeList = mapping.spikeList;
+else
+   spikeList = {mapping.spikeList};
+end
+
+% - Use the compiled kernel, if it exists
+bNative = (exist('STISIAddresses', 'file') == 3);
+
+if (~bNative)
+   % - Collect the ISIs of each address
+   [cISIs, vKey] = AddressISIs(spikeList, mapping.fTemporalResolution);
+end
+
+
+% -- Create binning structure
+
+if (bGenerateBins)
+   % - Find the range of ISIs over all addresses
+   if (bNative)
+      [mISIHist, vKey, vtMeanISI, vfCV, vtMinISI, vtMaxISI] = STISIAddresses(spikeList, mapping.fTemporalResolution, []);
+      fMinISI = min(vtMinISI);
+      fMaxISI = max(vtMaxISI);
+   else
+      fMinISI = min(vertcat(cISIs{:}));
+      fMaxISI = max(vertcat(cISIs{:}));
+   end
+
+   if (bUseLog)
+      tTimeBins = logspace(log10(fMinISI), log10(fMaxISI), nNumBins);
+   else
+      fDeltaBin = (fMaxISI - fMinISI) / (nNumBins-1);
+      tTimeBins = fMinISI:fDeltaBin:fMaxISI;
+   end
+else
+    tTimeBins = nNumBins;
+end
+
+
+% -- Calculate histogram and statistics
+
+if (bNative)
+   [mISIHist, vKey, vtMeanISI, vfCV, vtMinISI] = STISIAddresses(spikeList, mapping.fTemporalResolution, tTimeBins);
+
+else
+   nNumKeys = numel(vKey);
+   mISIHist = zeros(nNumKeys, numel(tTimeBins));
+   [vtMeanISI, vfCV, vtMinISI] = deal(nan(nNumKeys, 1));
+
+   for (nKeyIndex = 1:nNumKeys)
+      vtISIs = cISIs{nKeyIndex};
+
+      if (isempty(vtISIs))
+         continue;
+      end
+
+      mISIHist(nKeyIndex, :) = reshape(hist(vtISIs, tTimeBins), 1, []);
+      vtMeanISI(nKeyIndex) = mean(vtISIs);
+      vtMinISI(nKeyIndex) = min(vtISIs);
+
+      if (numel(vtISIs) > 1)
+         vfCV(nKeyIndex) = std(vtISIs) / vtMeanISI(nKeyIndex);
+      end
+   end
+end
+
+% --- END of STISIHistAddresses FUNCTION ---
+
+
+% --- FUNCTION AddressISIs
+
+function [cISIs, vKey] = AddressISIs(spikeList, fTemporalResolution)
+
+% NOTE: This is only used if STISIAddresses has not been compiled
+
+% - Collect the spikes in time order
+mSpikes = vertcat(spikeList{:});
+
+if (isempty(mSpikes))
+   cISIs = {};
+   vKey = zeros(0, 1);
+   return;
+end
+
+[vnTicks, vnOrder] = sort(mSpikes(:, 1));
+vAddrs = mSpikes(vnOrder, 2);
+
+% - Group the spike times by address; the sort is stable, so each group
+%   stays in time order
+[vKey, vnFirst, vnKeyIndex] = unique(vAddrs);
+[vnSortedIndex, vnGroupOrder] = sort(vnKeyIndex(:));
+vtSpikeTimes = vnTicks(vnGroupOrder) .* fTemporalResolution;
+
+cISIs = CellForEachCell(@diff, mat2cell(vtSpikeTimes, accumarray(vnSortedIndex, 1), 1));
+
+% --- END of AddressISIs FUNCTION ---
+
+% --- END of STISIHistAddresses.m ---
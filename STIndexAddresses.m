@@ -0,0 +1,108 @@
+function [stTrain] = STIndexAddresses(stTrain)
+
+% STIndexAddresses - FUNCTION Index the spikes of a mapped spike train by address
+% $Id: STIndexAddresses.m $
+%
+% Usage: [stTrain] = STIndexAddresses(stTrain)
+%
+% 'stTrain' is a spike train containing a mapping, usually multiplexed from
+% the trains of many neurons.  STIndexAddresses builds an index of the spikes
+% of each address in the mapping, and stores it with the mapping.  STExtract
+% then finds the spikes of any address or address range from the index,
+% instead of searching the whole spike list, so extracting many addresses
+% from one mapping costs little more than copying the extracted spikes.
+%
+% The index is built in a single pass over the spike list, by a compiled
+% kernel if one is available.  STCrop updates the index of the mapping it
+% returns, and STShift and STNormalise keep it, so a train can be indexed once
+% and then cropped to each window of interest.  Every other toolbox function
+% returns its mappings without an index.  If the spike list of an indexed
+% mapping is changed by hand, STIndexAddresses must be called again.  The
+% index is only checked against the length of each chunk, so STExtract would
+% otherwise return the wrong spikes.
+%
+% Mappings held in a native spike store (see STMaterialise) are returned
+% unchanged, since STExtract already extracts from these natively.  If a cell
+% array of spike trains is supplied, each train will be indexed.
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin > 1)
+   disp('--- STIndexAddresses: Extra arguments ignored');
+end
+
+if (nargin < 1)
+   disp('*** STIndexAddresses: Incorrect usage');
+   help STIndexAddresses;
+   return;
+end
+
+% - Handle cell arrays of spike trains
+if (iscell(stTrain))
+   stTrain = CellForEachCell(@STIndexAddresses, stTrain);
+   return;
+end
+
+% - Test that a mapping exists in the spike train
+if (~FieldExists(stTrain, 'mapping'))
+   disp('*** STIndexAddresses: The spike train doesn''t contain a mapping');
+   return;
+end
+
+if (isfield(stTrain.mapping, 'hSpikeStore'))
+   disp('--- STIndexAddresses: Spike store mappings are not indexed');
+   return;
+end
+
+
+% -- Build the index
+
+if (stTrain.mapping.bChunkedMode)
+   spikeList = stTrain.mapping.spikeList;
+else
+   spikeList = {stTrain.mapping.spikeList};
+end
+
+if (exist('STIndexChunks', 'file') == 3)
+   [stIndex.vAddrKey, stIndex.vnOffsets, stIndex.vnPostings, stIndex.vnChunkStarts] = STIndexChunks(spikeList);
+else
+   stIndex = IndexChunks(spikeList);
+end
+
+stTrain.mapping.stAddrIndex = stIndex;
+
+% --- END of STIndexAddresses FUNCTION ---
+
+
+% --- FUNCTION IndexChunks
+
+function [stIndex] = IndexChunks(spikeList)
+
+% NOTE: This is only used if STIndexChunks has not been compiled
+
+% - Number the spikes of every chunk in order
+vnChunkLengths = reshape(CellForEach(@size, spikeList, 1), [], 1);
+stIndex.vnChunkStarts = [0; cumsum(vnChunkLengths)];
+
+mSpikes = vertcat(spikeList{:});
+
+if (isempty(mSpikes))
+   vAddrs = zeros(0, 1);
+else
+   vAddrs = mSpikes(:, 2);
+end
+
+% - Group the spikes by address; the sort is stable, so each group stays in
+%   order
+[stIndex.vAddrKey, vnFirst, vnKeyIndex] = unique(vAddrs);
+stIndex.vAddrKey = reshape(stIndex.vAddrKey, [], 1);
+[vnSortedIndex, stIndex.vnPostings] = sort(vnKeyIndex(:));
+stIndex.vnOffsets = [0; cumsum(accumarray(vnSortedIndex, 1, [numel(stIndex.vAddrKey) 1]))];
+
+% --- END of IndexChunks FUNCTION ---
+
+% --- END of STIndexAddresses.m ---
@@ -13,9 +13,35 @@ function [stTrain] = STInstantiate(stOldTrain, strTemporalType, tDuration, mCorr
 % a probability based on the train frequency.  'stTrain' (output) will have a
 % 'instance' field added, containing the instantiated train.
 %
-% Note: Changing frequencies and regular spike trains don't play well
-% together.  Perhaps a better algorithm for creating regular trains is
-% required.
+% Note: Regular trains integrate the instantaneous frequency of the
+% definition, and place a spike each time the integral passes a whole
+% number.  Changing frequencies are therefore followed correctly, and the
+% integral is carried from one chunk to the next.  If STInstantiateNative has
+% been compiled, constant, linear and sinusoidal regular trains are
+% integrated in closed form, spike by spike, so their cost depends on the
+% number of spikes rather than on 'tDuration'.
+%
+% Note: If the STGeneratePoisson MEX function has been compiled (see
+% STWelcome), uncorrelated, ergodic 'poisson' trains are generated by
+% thinning rather than by testing every time bin.  Candidate spikes are
+% drawn spike-by-spike at a bounding frequency supplied by the definition,
+% and each is kept with probability given by the definition's frequency at
+% that time.  The resulting trains have the same distribution, but the cost
+% depends on the number of spikes rather than on 'tDuration'.
+%
+% Note: If the STInstantiateNative MEX function has been compiled, trains with
+% constant, linear or sinusoidal definitions are generated natively, with the
+% work for each train and chunk spread over one thread per processor core.
+% Each piece of work is seeded from the toolbox random generator and its
+% train and chunk, so the results do not depend on the number of threads.
+% Other definitions are instantiated as before.
+%
+% Note: If the STGenerateRenewal MEX function has been compiled, uncorrelated,
+% ergodic gamma trains are generated spike-by-spike from their ISI
+% distribution over the whole duration, and then split into chunks.  The
+% renewal spikes are used directly for both 'regular' and 'poisson' trains;
+% previously each renewal spike was only kept with the spike probability of a
+% bin at the full temporal resolution.
 %
 % --- ARRAY ARGUMENTS
 %
@@ -60,12 +86,31 @@ function [stTrain] = STInstantiate(stOldTrain, strTemporalType, tDuration, mCorr
 % spike trains; the correlation coefficient between trains 'i' and 'j' (with
 % 'i' <= 'j') is given by 'mCorr(i, j)'.
 %
+% The correlation matrix is decomposed once per call.  If STInstantiateNative
+% has been compiled, the correlated random sequences are generated in small
+% blocks, so their cost in memory does not depend on the duration of the
+% trains.  The cost in time still grows with the square of the number of
+% trains, and with the number of time bins.
+%
+% For large numbers of trains, set the toolbox option 'CorrelationMethod' to
+% 'mixture' (see STOptions).  Correlated trains are then generated from a
+% shared "mother" spike train, of which each train copies a random subset of
+% spikes.  The cost depends only on the number of spikes generated.  This
+% requires STInstantiateNative, and does not support non-ergodic trains.  A
+% single positive correlation is used for all pairs of trains, taken as the
+% mean of the off-diagonal elements of 'mCorrelation'.  Trains with equal
+% frequencies will have this spike count correlation; trains with different
+% frequencies will be less strongly correlated.
+%
 % --- NON-ERGODIC SPIKE TRAINS
 %
 % The optional argument 'fMemTau' can be used to generate spike trains from a
 % non-ergodic process (ie a random process with memory).  'fMemTau' will be
 % the time constant for an exponential smoothing function.  'fMemTau' will be
-% the time for the memory effect to reduce to approximately 35%.
+% the time for the memory effect to reduce to approximately 35%.  The memory
+% carries across the chunks in which long trains are generated, and the
+% filtering takes the same time whatever the value of 'fMemTau'.  Non-ergodic
+% trains have the same mean frequency as ergodic trains.
 %
 % When both 'mCorrelation' and 'fMemTau' are supplied, correlated random
 % sequences will be generated before being made non-ergodic.
@@ -83,6 +128,12 @@ stOptions = STOptions;
 InstanceTemporalResolution = stOptions.InstanceTemporalResolution;
 SpikeChunkLength = stOptions.SpikeChunkLength;
 
+if (FieldExists(stOptions, 'CorrelationMethod'))
+   CorrelationMethod = lower(stOptions.CorrelationMethod);
+else
+   CorrelationMethod = 'norta';
+end
+
 
 % -- Perform argument number and basic checks
 
@@ -242,6 +293,7 @@ if (~all(CellForEach(@isfield, stTrain, 'definition')))
 end
 
 % - Find which sort of instances we're creating
+vbPoisson = false(1, nNumTrains);
 for (nTrainIndex = 1:nNumTrains)
    switch lower(strTemporalType{nTrainIndex})
       case {'regular', 'r'}
@@ -249,6 +301,7 @@ for (nTrainIndex = 1:nNumTrains)
         
       case {'poisson', 'p'}
          fhTestSpike{nTrainIndex} = @STTestSpikePoisson;
+         vbPoisson(nTrainIndex) = true;
         
       otherwise
          % - Invalid temporal type specified, so bail
@@ -325,9 +378,193 @@ sRef.type = '.';
 sRef.subs = 'fhInstFreq';
 vfhInstFreq = CellForEachCell(@subsref, cDefinitions, sRef);
 
+% - Poisson trains whose definitions supply a frequency bound can be
+%   generated by thinning, if STGeneratePoisson has been compiled.
+%   Correlated and non-ergodic trains need the full random sequence, so must
+%   use STTestSpikePoisson
+vbThinning = false(1, nNumTrains);
+if (~bCorrelate && ~bMemory && (exist('STGeneratePoisson', 'file') == 3))
+   vbThinning = vbPoisson & reshape(CellForEach(@isfield, cDefinitions, 'fhMaxFreq'), 1, nNumTrains);
+end
+
+% - Trains with constant, linear or sinusoidal definitions can be generated
+%   natively over a pool of threads, if STInstantiateNative has been
+%   compiled.  Correlated trains share their random sequences, so either all
+%   are generated natively or none are
+vbNative = false(1, nNumTrains);
+mTrainParams = zeros(nNumTrains, 5);
+if (exist('STInstantiateNative', 'file') == 3)
+   for (nTrainIndex = 1:nNumTrains)
+      stDef = cDefinitions{nTrainIndex};
+      switch (stDef.strType)
+         case 'constant'
+            mTrainParams(nTrainIndex, :) = [0 vbPoisson(nTrainIndex) stDef.fFreq 0 0];
+            
+         case 'linear'
+            mTrainParams(nTrainIndex, :) = [1 vbPoisson(nTrainIndex) stDef.fStartFreq stDef.fEndFreq 0];
+            
+         case 'sinusoid'
+            mTrainParams(nTrainIndex, :) = [2 vbPoisson(nTrainIndex) stDef.fMinFreq stDef.fMaxFreq stDef.tPeriod];
+            
+         otherwise
+            continue;
+      end
+      vbNative(nTrainIndex) = true;
+   end
+   
+   if (bCorrelate && ~all(vbNative))
+      vbNative(:) = false;
+   end
+end
+
+% - The mixture correlation method needs every train to be generated natively
+bMixture = bCorrelate && strcmp(CorrelationMethod, 'mixture');
+if (bMixture)
+   if (bMemory)
+      disp('*** STInstantiate: The ''mixture'' correlation method can''t generate');
+      disp('       non-ergodic spike trains.  Set the ''CorrelationMethod'' option to');
+      disp('       ''norta'' to use ''fMemTau''.');
+      return;
+   end
+   
+   if (~all(vbNative))
+      disp('--- STInstantiate: Warning: The ''mixture'' correlation method requires');
+      disp('       STInstantiateNative, and constant, linear or sinusoidal definitions.');
+      disp('       The ''norta'' method will be used instead.');
+      bMixture = false;
+   end
+end
+
+if (bMixture)
+   % - Use a single correlation for all pairs of trains
+   vfPairCorr = mCorrelation(triu(true(nNumTrains), 1));
+   if (isempty(vfPairCorr))
+      fMixtureCorr = 1;
+   else
+      fMixtureCorr = mean(vfPairCorr);
+   end
+   
+   if (any(abs(vfPairCorr - fMixtureCorr) > 1e-12))
+      fprintf(1, '--- STInstantiate: Warning: The ''mixture'' correlation method uses a single\n');
+      fprintf(1, '       correlation for all pairs of trains.  [%.3f] will be used.\n', fMixtureCorr);
+   end
+   
+   if ((fMixtureCorr <= 0) || (fMixtureCorr > 1))
+      disp('*** STInstantiate: The ''mixture'' correlation method requires a correlation');
+      disp('       greater than zero and no greater than one.');
+      return;
+   end
+else
+   fMixtureCorr = [];
+end
+
+% - Decompose the correlation matrix once, as CorrUniRand
+if (bCorrelate && ~bMixture)
+   [mCorrDecomp, nNotPosDef] = chol(2 * sin((pi * (eye(nNumTrains) + triu(mCorrelation, 1))) / 6));
+   
+   if (nNotPosDef > 0)
+      disp('*** STInstantiate: ''mCorrelation'' is not positive definite.  I can''t continue');
+      disp('       under this condition.  Sorry!');
+      return;
+   end
+else
+   mCorrDecomp = [];
+end
+
+vbThinning = vbThinning & ~vbNative;
+
+% - Gamma trains can be generated spike-by-spike, if STGenerateRenewal has
+%   been compiled.  Correlated and non-ergodic trains need the full random
+%   sequence, so must use the frequency profile function
+vbRenewal = false(1, nNumTrains);
+if (~bCorrelate && ~bMemory && (exist('STGenerateRenewal', 'file') == 3))
+   for (nTrainIndex = 1:nNumTrains)
+      vbRenewal(nTrainIndex) = strcmp(cDefinitions{nTrainIndex}.strType, 'gamma');
+   end
+end
+vnMatlabTrains = find(~vbNative & ~vbRenewal);
+
 % - Get total number of chunks
 nNumChunks = max(vnNumChunks);
 
+% - Find the time range of each chunk
+if (any(vbNative | vbRenewal))
+   vtChunkStart = zeros(1, nNumChunks);
+   vnChunkBins = zeros(1, nNumChunks);
+   for (nChunkIndex = 1:nNumChunks)
+      [tTimeStart, tTimeEnd] = STChunkTimes(nChunkIndex, nNumChunks, tDuration(1), InstanceTemporalResolution, SpikeChunkLength);
+      vtChunkStart(nChunkIndex) = tTimeStart;
+      vnChunkBins(nChunkIndex) = floor((tTimeEnd - tTimeStart) / InstanceTemporalResolution) + 1;
+   end
+end
+
+% - Generate renewal trains over the whole duration, and split into chunks
+for (nTrainIndex = find(vbRenewal))
+   stDef = cDefinitions{nTrainIndex};
+   if (isfield(stDef, 'strISIDistribution'))
+      strISIDistribution = stDef.strISIDistribution;
+   else
+      strISIDistribution = 'gamma';
+   end
+   
+   vnSeed = floor(feval(stOptions.RandomGenerator, 1, 2) * 2^32);
+   spikeList = STGenerateRenewal(strISIDistribution, stDef.fMeanISI, stDef.fVarISI, ...
+                                 0, tDuration(1), InstanceTemporalResolution, vnSeed)';
+   
+   if (vbChunkedMode(nTrainIndex))
+      % - Assign spikes to chunks by their bin indices, to avoid rounding
+      [nul, vnChunk] = histc(round(spikeList ./ InstanceTemporalResolution), ...
+                             [round(vtChunkStart ./ InstanceTemporalResolution) inf]);
+      for (nChunkIndex = 1:nNumChunks)
+         instance{nTrainIndex}.spikeList{nChunkIndex} = spikeList(vnChunk == nChunkIndex);
+      end
+   else
+      instance{nTrainIndex}.spikeList = spikeList;
+   end
+end
+
+% - Generate native trains for all chunks at once
+if (any(vbNative))
+   % - Check that we're not under-sampling
+   fMaxFreq = 0;
+   for (nTrainIndex = find(vbNative))
+      fMaxFreq = max(fMaxFreq, feval(cDefinitions{nTrainIndex}.fhMaxFreq, cDefinitions{nTrainIndex}, 0, tDuration(1)));
+   end
+   
+   if ((fMaxFreq * InstanceTemporalResolution) > 1.0001)
+      disp('--- STInstantiate: Spike frequency is greater than the temporal resolution.');
+      disp(sprintf('       Frequency [%.2f]MHz is clipped to [%.2f]MHz', ...
+                   fMaxFreq / 1e3, (1/InstanceTemporalResolution) / 1e3));
+   end
+
+   if (bMemory)
+      vfMemTau = fMemTau(vbNative);
+   else
+      vfMemTau = [];
+   end
+   
+   % - Seed the native generators from the toolbox random generator
+   vnSeed = floor(feval(stOptions.RandomGenerator, 1, 2) * 2^32);
+   
+   cSpikeLists = STInstantiateNative(mTrainParams(vbNative, :), vtChunkStart, vnChunkBins, ...
+                                     InstanceTemporalResolution, vnSeed, mCorrDecomp, vfMemTau, fMixtureCorr);
+   
+   % - Assign the spike lists
+   vnNativeTrains = find(vbNative);
+   for (nNativeIndex = 1:numel(vnNativeTrains))
+      nTrainIndex = vnNativeTrains(nNativeIndex);
+      if (vbChunkedMode(nTrainIndex))
+         instance{nTrainIndex}.spikeList = cSpikeLists(nNativeIndex, :);
+      else
+         instance{nTrainIndex}.spikeList = cSpikeLists{nNativeIndex, 1};
+      end
+   end
+end
+
+% - Non-ergodic trains carry their filter state, and regular trains their
+%   phase, from chunk to chunk
+cTrainState = cell(1, nNumTrains);
+
 % - Display some progress
 if (any(vbChunkedMode))
    STProgress('Instantiating: Chunk [%02d/%02d]', 0, nNumChunks);
@@ -340,24 +577,30 @@ for (nChunkIndex = 1:nNumChunks)
    end
    
    % - Get start and end times for the current chunk
-   tTimeStart = (nChunkIndex-1) * InstanceTemporalResolution * SpikeChunkLength;
-   if (nChunkIndex == nNumChunks)
-      tTimeEnd = tDuration(1);      % For now, assume identical durations
+   [tTimeStart, tTimeEnd] = STChunkTimes(nChunkIndex, nNumChunks, tDuration(1), InstanceTemporalResolution, SpikeChunkLength);
+   
+   % - Create time step vector, only if some train needs it
+   if (all(vbThinning | vbNative | vbRenewal))
+      tTimeCurr = [];
+      nNumBins = floor((tTimeEnd - tTimeStart) / InstanceTemporalResolution) + 1;
    else
-      tTimeEnd = (nChunkIndex) * InstanceTemporalResolution * (SpikeChunkLength-1);
+      tTimeCurr = tTimeStart:InstanceTemporalResolution:tTimeEnd;
+      nNumBins = length(tTimeCurr);
    end
    
-   % - Create time step vector
-   tTimeCurr = tTimeStart:InstanceTemporalResolution:tTimeEnd;
-   
    % - Get instantaneous frequency vector
    fInstFreq = cell(1, nNumTrains);
-   for (nTrainIndex = 1:nNumTrains)
-      fInstFreq{nTrainIndex} = feval(vfhInstFreq{nTrainIndex}, cDefinitions{nTrainIndex}, tTimeCurr);
+   for (nTrainIndex = vnMatlabTrains)
+      if (vbThinning(nTrainIndex))
+         % - Thinned trains only need a bound on the frequency over the chunk
+         fInstFreq{nTrainIndex} = feval(cDefinitions{nTrainIndex}.fhMaxFreq, cDefinitions{nTrainIndex}, tTimeStart, tTimeEnd);
+      else
+         fInstFreq{nTrainIndex} = feval(vfhInstFreq{nTrainIndex}, cDefinitions{nTrainIndex}, tTimeCurr);
+      end
    end
 
    % - Check that we're not under-sampling
-   fMaxFreq = max(CellForEach(@max, fInstFreq));
+   fMaxFreq = max([0 CellForEach(@max, fInstFreq(vnMatlabTrains))]);
    if ((fMaxFreq * InstanceTemporalResolution) > 1.0001)
       disp('--- STInstantiate: Spike frequency is greater than the temporal resolution.');
       disp(sprintf('       Frequency [%.2f]MHz is clipped to [%.2f]MHz', ...
@@ -366,14 +609,14 @@ for (nChunkIndex = 1:nNumChunks)
 
    % - If we're making correlated trains, generate some correlated random
    %   sequences
-   if (bCorrelate)
+   if (bCorrelate && ~isempty(vnMatlabTrains))
       STProgress(' Generating correlated sequence...');
-      mSeq = CorrUniRand(mCorrelation, length(tTimeCurr));
+      mSeq = CorrUniRand(mCorrelation, length(tTimeCurr), mCorrDecomp);
       STProgress('\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b                                  \b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b');
    end
 
    % - Generate spikes
-   for (nTrainIndex = 1:nNumTrains)
+   for (nTrainIndex = vnMatlabTrains)
       if (bCorrelate)
          % - Use the pre-generated correlated random sequence
          vfCorrSeq = mSeq(:, nTrainIndex)';
@@ -391,8 +634,17 @@ for (nChunkIndex = 1:nNumChunks)
       end
       
       % - Generate the spike train
-      nSpikeIndices = feval(fhTestSpike{nTrainIndex}, tTimeCurr, fInstFreq{nTrainIndex}, vfCorrSeq, fMemTauItem);
-      spikeList = tTimeCurr(nSpikeIndices);
+      if (vbThinning(nTrainIndex))
+         spikeList = STThinPoisson(cDefinitions{nTrainIndex}, fInstFreq{nTrainIndex}, ...
+                                   tTimeStart, nNumBins, InstanceTemporalResolution, stOptions.RandomGenerator);
+      elseif (~vbPoisson(nTrainIndex) || bMemory)
+         [nSpikeIndices, cTrainState{nTrainIndex}] = feval(fhTestSpike{nTrainIndex}, tTimeCurr, fInstFreq{nTrainIndex}, ...
+                                                           vfCorrSeq, fMemTauItem, cTrainState{nTrainIndex});
+         spikeList = tTimeCurr(nSpikeIndices);
+      else
+         nSpikeIndices = feval(fhTestSpike{nTrainIndex}, tTimeCurr, fInstFreq{nTrainIndex}, vfCorrSeq, fMemTauItem);
+         spikeList = tTimeCurr(nSpikeIndices);
+      end
 
       % - Assign the spike list
       if (vbChunkedMode(nTrainIndex))
@@ -420,4 +672,59 @@ if (~bArrayOutput)
    stTrain = stTrain{1};
 end
 
+% --- END of STInstantiate FUNCTION ---
+
+
+% --- FUNCTION STChunkTimes
+function [tTimeStart, tTimeEnd] = STChunkTimes(nChunkIndex, nNumChunks, tDuration, fTemporalResolution, nSpikeChunkLength)
+% Get start and end times for a chunk
+
+tTimeStart = (nChunkIndex-1) * fTemporalResolution * nSpikeChunkLength;
+if (nChunkIndex == nNumChunks)
+   tTimeEnd = tDuration;      % For now, assume identical durations
+else
+   tTimeEnd = (nChunkIndex) * fTemporalResolution * (nSpikeChunkLength-1);
+end
+
+% --- END of STChunkTimes FUNCTION ---
+
+
+% --- FUNCTION STThinPoisson
+function [vtSpikeTimes] = STThinPoisson(stDefinition, fMaxFreq, tTimeStart, nNumBins, fTemporalResolution, fhRandomGenerator)
+% Generate a poisson spike train chunk by Lewis-Shedler thinning.  Candidate
+% spikes are generated at the bounding frequency 'fMaxFreq', and each is kept
+% with probability P(f(t)) / P(fMaxFreq), where P is the per-bin spike
+% probability used by STTestSpikePoisson.  This gives exactly the
+% distribution of testing every bin with P(f(t)).
+
+% - Time of the last bin in the chunk, which defines the chunk's time range
+tTimeEnd = tTimeStart + (nNumBins-1) * fTemporalResolution;
+
+% - P(f) = f*dT * exp(-f*dT) is maximal at f*dT = 1, so clip the bound there
+fMaxFreq = min(fMaxFreq, 1 / fTemporalResolution);
+
+% - Generate candidate spikes at the bounding frequency
+vtSpikeTimes = STGeneratePoisson(tTimeStart, nNumBins, fTemporalResolution, fMaxFreq, fhRandomGenerator);
+
+if (isempty(vtSpikeTimes))
+   return;
+end
+
+% - Evaluate the definition's frequency at the candidate spikes only
+vfCandFreq = feval(stDefinition.fhInstFreq, stDefinition, vtSpikeTimes, [tTimeStart tTimeEnd]);
+
+% - Find spike probabilities for the candidates and for the bound
+vfCandSpikeAvgNum = vfCandFreq .* fTemporalResolution;
+vfCandSpikeProb = exp(-vfCandSpikeAvgNum) .* vfCandSpikeAvgNum;
+fMaxSpikeAvgNum = fMaxFreq * fTemporalResolution;
+fMaxSpikeProb = exp(-fMaxSpikeAvgNum) * fMaxSpikeAvgNum;
+
+% - Thin the candidates, unless every candidate must be accepted
+if (any(vfCandSpikeProb < fMaxSpikeProb))
+   vfRand = feval(fhRandomGenerator, 1, length(vtSpikeTimes));
+   vtSpikeTimes = vtSpikeTimes((vfRand .* fMaxSpikeProb) <= vfCandSpikeProb);
+end
+
+% --- END of STThinPoisson FUNCTION ---
+
 % --- END of STInstantiate.m ---
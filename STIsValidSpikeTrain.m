@@ -45,7 +45,7 @@ if (FieldExists(stTrain, 'mapping'))
    if (~FieldExists(mapping, 'tDuration') || ...
        ~FieldExists(mapping, 'fTemporalResolution') || ...
        ~FieldExists(mapping, 'bChunkedMode') || ...
-       ~isfield(mapping, 'spikeList'))
+       ~(isfield(mapping, 'spikeList') || isfield(mapping, 'hSpikeStore')))
       disp('--- STIsValidSpikeTrain: Invalid spike train mapping structure');
       return;
    end
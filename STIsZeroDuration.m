@@ -51,7 +51,12 @@ else
 end
 
 % - Test the train
-bZero = (node.tDuration == 0) | (isempty(node.spikeList));
+if (isfield(node, 'hSpikeStore'))
+   % - Spike stores are never kept empty
+   bZero = (node.tDuration == 0);
+else
+   bZero = (node.tDuration == 0) | (isempty(node.spikeList));
+end
 
 
 % --- END of STIsZeroDuration.m ---
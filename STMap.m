@@ -16,6 +16,11 @@ function [stTrain] = STMap(stTrain, varargin)
 % simultaneously, or map a single spike train to multiple addresses.  The
 % address arguments should be in matrix form.  All arrays supplied as
 % arguments must be of the same size.
+%
+% When the 'MappingSpikeStore' option is set, each mapping is kept in a new
+% native spike store (see STMaterialise).  The caller owns these stores, and
+% should free each with STMaterialise(stTrain, true) once the train is no
+% longer needed.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 29th March, 2004
@@ -153,6 +158,15 @@ if (STIsZeroDuration(stTrain))
    return;
 end
 
+% - Keep the mapped spike list in a native spike store, if requested
+if (FieldExists(stOptions, 'MappingSpikeStore') && stOptions.MappingSpikeStore && ...
+    (exist('STSpikeStore', 'file') == 3))
+   bCompress = FieldExists(stOptions, 'CompressSpikeStores') && stOptions.CompressSpikeStores;
+   hStore = STSpikeStore('map', stTrain.instance.spikeList, MappingTemporalResolution, mapping.addrSynapse, bCompress);
+   stTrain.mapping = STSpikeStoreNode(mapping, hStore);
+   return;
+end
+
 % - Are we using chunked mode?
 if (stTrain.instance.bChunkedMode)
    % - Extract the spike list from the instance
@@ -0,0 +1,93 @@
+function [stTrain] = STMaterialise(stTrain, bFreeStore)
+
+% STMaterialise - FUNCTION Convert a spike store mapping to a spike list mapping
+% $Id: STMaterialise.m $
+%
+% Usage: [stTrain] = STMaterialise(stTrain)
+%        [stTrain] = STMaterialise(stTrain, bFreeStore)
+%
+% When the 'MappingSpikeStore' toolbox option is set, STMap keeps mapped
+% spike lists in native memory rather than in the 'spikeList' field of the
+% mapping, and STTrainOpen returns such a mapping backed by a spike train
+% file.  STCrop, STShift, STMultiplex, STExtract, STProfileCount and
+% STPciaerExport work on these mappings directly.  STMaterialise copies the
+% spikes of such a mapping back into an ordinary spike list, for use with
+% other toolbox functions.  The 'CompressSpikeStores' option compresses these
+% stores, to about a fifth of the memory of a plain store, or a seventh of
+% that of a spike list.
+% Spike trains without a native spike store are returned unchanged.
+%
+% The native memory used by a spike store is not freed when a spike train
+% is cleared, since copies of the train share the same store.  If
+% 'bFreeStore' is true, STMaterialise frees the store once its spikes have
+% been copied, and any other copies of 'stTrain' become invalid.  Every spike
+% store is freed by the command "clear mex".
+%
+% STMap, STCrop, STShift, STMultiplex, STExtract, STConcat and STPipelineRun
+% return each spike store they build to the caller, who owns it and must free
+% it in this way.  Toolbox functions which use these functions internally
+% free the intermediate stores they make.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin > 2)
+   disp('--- STMaterialise: Extra arguments ignored');
+end
+
+if (nargin < 1)
+   disp('*** STMaterialise: Incorrect usage');
+   help STMaterialise;
+   return;
+end
+
+if (nargin < 2)
+   bFreeStore = false;
+end
+
+% - Handle cell arrays of spike trains
+if (iscell(stTrain))
+   stTrain = CellForEachCell(@STMaterialise, stTrain, bFreeStore);
+   return;
+end
+
+% - Is there a spike store to convert?
+if (~FieldExists(stTrain, 'mapping') || ~isfield(stTrain.mapping, 'hSpikeStore'))
+   return;
+end
+
+
+% -- Copy the spike list from the store
+
+mapping = stTrain.mapping;
+spikeList = STSpikeStore('spikelist', mapping.hSpikeStore);
+
+if (bFreeStore)
+   STSpikeStore('destroy', mapping.hSpikeStore);
+end
+
+mapping = rmfield(mapping, 'hSpikeStore');
+
+% - An address index never describes the copied spike list
+if (isfield(mapping, 'stAddrIndex'))
+   mapping = rmfield(mapping, 'stAddrIndex');
+end
+
+if (length(spikeList) > 1)
+   mapping.bChunkedMode = true;
+   mapping.nNumChunks = length(spikeList);
+   mapping.spikeList = spikeList;
+elseif (length(spikeList) == 1)
+   mapping.bChunkedMode = false;
+   mapping.spikeList = spikeList{1};
+else
+   mapping.bChunkedMode = false;
+   mapping.spikeList = [];
+end
+
+stTrain.mapping = mapping;
+
+% --- END of STMaterialise.m ---
@@ -19,9 +19,15 @@ function [stMuxTrain] = STMultiplex(varargin)
 % trains in the cell array will be multiplexed together and returned as a
 % single train.
 %
-% NOTE: STMultiplex currently assumes that concatenating two chunks will never
-% give a chunk bigger than can fit in a single matrix.  Fixing this makes
-% the algorithm more complex, and a pain.
+% The sorted spike lists of the source trains are merged by STMergeChunks,
+% which splits large merges over several threads.  If the multiplexed train
+% holds more than 'SpikeChunkLength' spikes (see STOptions), it is returned in
+% chunked mode, without ever building a spike list longer than one chunk.
+%
+% If any of the mappings is held in a native spike store (see STMaterialise),
+% the multiplexed mapping is returned in a new store.  STMultiplex frees the
+% temporary stores it makes along the way, but the new store is the caller's
+% to free, with STMaterialise(stMuxTrain, true).
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 1st April, 2004 (no, really)
@@ -134,7 +140,12 @@ switch (strLevel)
          return;
       end
       
-      stMuxTrain.mapping = STMultiplexNodes(true, stNodes);
+      % - Multiplex in native spike stores, if any mapping uses one
+      if (any(CellForEach(@isfield, stNodes, 'hSpikeStore')))
+         stMuxTrain.mapping = STMultiplexStores(stNodes);
+      else
+         stMuxTrain.mapping = STMultiplexNodes(true, stNodes);
+      end
       
       % - Add extra fields to the mapping
       stMuxTrain.mapping.stasSpecification = stNodes{1}.stasSpecification;
@@ -174,189 +185,165 @@ nodeMux.fTemporalResolution = nodeCellArray{1}.fTemporalResolution;
 sRef.subs = 'fTemporalResolution';
 vfTempResolutions = CellForEach(@subsref, nodeCellArray, sRef);
 
-vfTempResFactor = nodeMux.fTemporalResolution ./ vfTempResolutions;
+% - Extract the spike lists of each node as cell arrays of chunks, and find
+%   the temporal resolution of each chunk.  Only mapping ticks are rescaled;
+%   instance spike times are in seconds
+spikeList = {};
+vfChunkResolution = [];
 
-% - Fix the temporal resolution for each spike train node
 for (nNodeIndex = 1:numel(nodeCellArray))
    if (nodeCellArray{nNodeIndex}.bChunkedMode)
-      % - Fix the temporal resolution for each chunk of a chunked mode
-      %   spike list
-      for (nChunkIndex = 1:length(nodeCellArray{nNodeIndex}.spikeList))
-         nodeCellArray{nNodeIndex}.spikeList{nChunkIndex}(:, 1) = nodeCellArray{nNodeIndex}.spikeList{nChunkIndex}(:, 1) * vfTempResFactor(nNodeIndex);
-      end
-      
+      nodeChunks = nodeCellArray{nNodeIndex}.spikeList;
    else
-      % - Fix the temporal resolution for a non chunked mode spike list
-      nodeCellArray{nNodeIndex}.spikeList(:, 1) = nodeCellArray{nNodeIndex}.spikeList(:, 1) * vfTempResFactor(nNodeIndex);
+      nodeChunks = {nodeCellArray{nNodeIndex}.spikeList};
    end
+   
+   spikeList = [spikeList reshape(nodeChunks, 1, [])];
+   vfChunkResolution = [vfChunkResolution repmat(vfTempResolutions(nNodeIndex), 1, numel(nodeChunks))];
 end
 
-
-% -- If all the spikes will fit into a single chunk, then we can use a
-% simplistic sorting algorithm.  Otherwise things will be more difficult...
-
-% - Extract the spike lists
-sRef.subs = 'spikeList';
-spikeList = CellFlatten(CellForEachCell(@subsref, nodeCellArray, sRef));
-
 % - How many spikes do we have in total?
 nTotalSpikes = 0;
 for (nChunkIndex = 1:length(spikeList))
    nTotalSpikes = nTotalSpikes + size(spikeList{nChunkIndex}, 1);
 end
 
+
+% -- If all the spikes will fit into a single chunk, then merge them into one
+% chunk.  Otherwise merge the chunks into new chunks.
+
 if (nTotalSpikes <= SpikeChunkLength)
-   % - We can do a simple cat'n'sort
-   spikeList = vertcat(spikeList{:});
-   spikeList = sortrows(spikeList, 1);
+   if (exist('STMergeChunks', 'file') == 3)
+      % - Merge the sorted chunks natively, in parallel, into a single chunk
+      spikeList = STMergeChunks(spikeList, vfChunkResolution, nodeMux.fTemporalResolution, ...
+                                max(nTotalSpikes, 1), bFixTempRes);
+      
+      if (isempty(spikeList))
+         spikeList = [];
+      else
+         spikeList = spikeList{1};
+      end
+      
+   else
+      % - We can do a simple cat'n'sort
+      spikeList = RescaleChunks(spikeList, vfChunkResolution, nodeMux.fTemporalResolution, bFixTempRes);
+      spikeList = vertcat(spikeList{:});
+      spikeList = sortrows(spikeList, 1);
+   end
+   
    nodeMux.bChunkedMode = false;
    nodeMux.spikeList = spikeList;
    return;
    
-else
-   % - We have to do a more complex sort
-   nodeMux.bChunkedMode = true;
-   
-   % spikeList = SortCrossChunk(spikeList)
+elseif (exist('STMergeChunks', 'file') == 3)
+   % - Merge the sorted chunks natively, one output chunk at a time
+   spikeList = STMergeChunks(spikeList, vfChunkResolution, nodeMux.fTemporalResolution, ...
+                             SpikeChunkLength, bFixTempRes);
    
-   disp('*** STMultiplex: Cross-chunk sorting is not yet implemented.  Sorry!');
-   return;
+else
+   spikeList = RescaleChunks(spikeList, vfChunkResolution, nodeMux.fTemporalResolution, bFixTempRes);
+   spikeList = SortCrossChunk(spikeList, SpikeChunkLength);
 end
 
+nodeMux.bChunkedMode = true;
+nodeMux.nNumChunks = length(spikeList);
+nodeMux.spikeList = spikeList;
+
 % --- END of STMultiplexNodes FUNCTION ---
 
 
-% --- FUNCTION SortCrossChunk
-function SortCrossChunk(spikeList)
+% --- FUNCTION STMultiplexStores
 
-% -- Sort (pick'n'place)
-% NOTE: Spike list chunks are assumed to be already sorted
-%       Spike list chunks should ALWAYS be maintained in sorted order!
+function [nodeMux] = STMultiplexStores(nodeCellArray)
 
-nChunkLength = 0;
-nCurrentChunk = 1;
-sortedSpikeList = [];
-nTotalInputChunks = length(spikeList);
+% All nodes are mapping nodes, some with native spike stores
 
-while true
-   % - Find the minimum chunk
-   for (nChunkIndex = 1:nTotalInputChunks)
-   end
-   
-   
-end
+% -- Get options
+stOptions = STOptions;
 
-% --- OLD sorting code
+% - Create output node
+nodeMux = [];
 
-if (node1.bChunkedMode)
-   spikeList1 = node1.spikeList;
-else
-   spikeList1 = {node1.spikeList};
-end
-      
-if (node2.bChunkedMode)      
-   spikeList2 = node2.spikeList;
-else
-   spikeList2 = {node2.spikeList};
-end
+% - The duration will be that of the longest spiketrain
+sRef.type = '.';
+sRef.subs = 'tDuration';
+vDurations = CellForEach(@subsref, nodeCellArray, sRef);
+nodeMux.tDuration = max(vDurations);
 
+% -- Rescale to the temporal resolution of the first node
+nodeMux.fTemporalResolution = nodeCellArray{1}.fTemporalResolution;
+sRef.subs = 'fTemporalResolution';
+vfTempResolutions = CellForEach(@subsref, nodeCellArray, sRef);
 
-% -- Determine the total number of chunks
-if (nodeMux.bChunkedMode)
-   nodeMux.nNumChunks = max([length(spikeList1) length(spikeList2)]);
-   nNumChunks = nodeMux.nNumChunks;
-else
-   nNumChunks = 1;
-end
+% - Make temporary stores for nodes that hold spike lists
+vhStores = zeros(1, numel(nodeCellArray), 'uint32');
+vbTemporary = false(1, numel(nodeCellArray));
 
+bCompress = FieldExists(stOptions, 'CompressSpikeStores') && stOptions.CompressSpikeStores;
 
-% -- Fix the temporal resolution for spike list 2
-if (bFixTempRes)
-   for (nChunkIndex = 1:length(spikeList2))
-      spikeList2{nChunkIndex}(:, 1) = floor(spikeList2{nChunkIndex}(:, 1) .* fTempResFactor);
+try
+   for (nNodeIndex = 1:numel(nodeCellArray))
+      if (isfield(nodeCellArray{nNodeIndex}, 'hSpikeStore'))
+         vhStores(nNodeIndex) = nodeCellArray{nNodeIndex}.hSpikeStore;
+      else
+         vhStores(nNodeIndex) = STSpikeStore('create', nodeCellArray{nNodeIndex}.spikeList);
+         vbTemporary(nNodeIndex) = true;
+      end
    end
+
+   % - Interleave the stores, in chunks of at most SpikeChunkLength spikes
+   hMux = STSpikeStore('multiplex', vhStores, vfTempResolutions, nodeMux.fTemporalResolution, ...
+                       stOptions.SpikeChunkLength, bCompress);
+catch
+   STSpikeStore('destroy', vhStores(vbTemporary));
+   rethrow(lasterror);
 end
 
+STSpikeStore('destroy', vhStores(vbTemporary));
 
-% -- Iterate through the spike lists and make sure each chunk is the same
-% duration (but only if we're using chunked mode)
+nodeMux = STSpikeStoreNode(nodeMux, hMux);
 
-if (nodeMux.bChunkedMode)
-   % - Arbitrarily assign the shorter and longer spike lists
-   shortList = spikeList1;
-   longList = spikeList2;
+% --- END of STMultiplexStores FUNCTION ---
 
-   for (nChunkIndex = 1:min([length(spikeList1) length(spikeList2)]))   % Iterate to the end of the shorter list
-      % - Find which spike list chunk finishes later
-    bMismatchedChunks = false;
-      if (max(longList{nChunkIndex}(:, 1)) > max(shortList{nChunkIndex}(:, 1)))
-         bMismatchedChunks = true;
-      
-      elseif (max(shortList{nChunkIndex}(:, 1)) > max(longList{nChunkIndex}(:, 1)))
-         % - The end of spike list 2 is after the end of spike list 1
-         %   We need to make sure that we only take up to the same time for both
-         %   chunks
-         tempList = longList;
-         longList = shortList;
-         shortList = tempList;
-         bMismatchedChunks = true;
-      end
-      
-      if (bMismatchedChunks)
-         % - Find the point in the longer chunk that we should shift to the next
-         % chunk
-         [nul, nIndices] = find(longList{nChunkIndex}(:, 1) > max(shortList{nChunkIndex}(:, 1)));
-      
-         if (length(longList) == nChunkIndex)   % Does the next chunk exist?
-            % - No, so make a new chunk
-            longList{nChunkIndex+1} = [];
-         end
-      
-         % - Concatenate the longer portion of the longer list with the next chunk 
-         % of the longer list
-         longList{nChunkIndex+1} = cat(1, longList{nChunkIndex}(nIndices(1), :), longList{nChunkIndex+1});
-         
-         if (nChunkIndex == nNumChunks)      % Did we go beyond the end of the chunks we had allowed for?
-            % - Yes, so update the total number of chunks required
-            nNumChunks = nNumChunks + 1;
-            nodeMux.nNumChunks = nNumChunks;
-         end
-      end
-   end
 
-   % - Arbitrarily reassign the spike lists
-   spikeList1 = shortList;
-   spikeList2 = longList;
+% --- FUNCTION RescaleChunks
+
+function [spikeList] = RescaleChunks(spikeList, vfChunkResolution, fTemporalResolution, bMapping)
+
+% - Instance spike times are in seconds, and aren't rescaled
+if (~bMapping)
+   return;
 end
-   
-% -- Now iterate through the spike lists and multiplex them      
-for (nChunkIndex = 1:nNumChunks)
-   % - Have we gone beyond the end of the shorter list?
-   if (length(spikeList1) < nChunkIndex)
-      % - Just assign the rest of spikeList2
-      spikeListMux{nChunkIndex:nNumChunks} = spikeList2{nChunkIndex:nNumChunks};
-      break;
-      
-   elseif (length(spikeList2) < nChunkIndex)
-      % - Just assign the rest of spike list 1
-      spikeListMux{nChunkIndex:nNumChunks} = spikeList1{nChunkIndex:nNumChunks};
-      break;
-      
-   else
-      % - We need to multiplex
-      spikeListMux{nChunkIndex} = sortrows(cat(1, spikeList1{nChunkIndex}, spikeList2{nChunkIndex}));
+
+% NOTE: STMergeChunks rescales ticks exactly; this floating-point version
+%       can differ by a tick when the ratio of resolutions isn't exact
+for (nChunkIndex = 1:length(spikeList))
+   if (vfChunkResolution(nChunkIndex) ~= fTemporalResolution)
+      spikeList{nChunkIndex}(:, 1) = floor(spikeList{nChunkIndex}(:, 1) * ...
+                                           (vfChunkResolution(nChunkIndex) / fTemporalResolution));
    end
 end
 
+% --- END of RescaleChunks FUNCTION ---
 
-% -- Assign the spike list
-if (nodeMux.bChunkedMode)
-   nodeMux.spikeList = spikeListMux;
-else
-   nodeMux.spikeList = spikeListMux{1};
-end
 
-return;
+% --- FUNCTION SortCrossChunk
+
+function [sortedSpikeList] = SortCrossChunk(spikeList, nChunkLength)
+
+% -- Sort the spike lists in one matrix, then split them into chunks
+% NOTE: This is only used if STMergeChunks has not been compiled, and needs
+%       enough memory for the whole multiplexed spike list
+
+spikeList = sortrows(vertcat(spikeList{:}), 1);
+
+nNumChunks = ceil(size(spikeList, 1) / nChunkLength);
+sortedSpikeList = cell(1, nNumChunks);
+
+for (nChunkIndex = 1:nNumChunks)
+   nFirst = (nChunkIndex-1) * nChunkLength + 1;
+   sortedSpikeList{nChunkIndex} = spikeList(nFirst:min(nFirst + nChunkLength - 1, end), :);
+end
 
 % --- END of SortCrossChunk FUNCTION ---
 
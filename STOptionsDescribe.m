@@ -47,6 +47,23 @@ fprintf(1, '      Instances [%.2f] usec\n', stOptions.InstanceTemporalResolution
 fprintf(1, '      Mappings [%.2f] usec\n', stOptions.MappingTemporalResolution / 1e-6);
 fprintf(1, '   Toolbox random number generator [%s]\n', func2str(stOptions.RandomGenerator));
 fprintf(1, '   Maximum spike chunk length [%d] spikes\n', stOptions.SpikeChunkLength);
+if (FieldExists(stOptions, 'MappingSpikeStore'))
+   if (stOptions.MappingSpikeStore)
+      fprintf(1, '   Mapped spike lists kept in native spike stores [on]\n');
+   else
+      fprintf(1, '   Mapped spike lists kept in native spike stores [off]\n');
+   end
+end
+if (FieldExists(stOptions, 'CompressSpikeStores'))
+   if (stOptions.CompressSpikeStores)
+      fprintf(1, '   Native spike stores compressed [on]\n');
+   else
+      fprintf(1, '   Native spike stores compressed [off]\n');
+   end
+end
+if (FieldExists(stOptions, 'CorrelationMethod'))
+   fprintf(1, '   Correlated spike train generation method [%s]\n', stOptions.CorrelationMethod);
+end
 fprintf(1, '   Default spike synchrony matching window [%.2f] msec\n', stOptions.DefaultSynchWindowSize / 1e-3);
 fprintf(1, '   Default window size for cross-correlation analysis [%.2f] msec\n', stOptions.DefaultCorrWindow / 1e-3);
 fprintf(1, '   Default smoothing kernel for cross-correlation analysis [%s]\n', stOptions.DefaultCorrSmoothingKernel);
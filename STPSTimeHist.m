@@ -1,9 +1,9 @@
-function [vPSTHist, tBinCentres, vStdErr] = STPSTimeHist(stTrain, vtStimOnset, vtWindow, nNumBins)
+function [vPSTHist, tBinCentres, vStdErr, mCounts] = STPSTimeHist(stTrain, vtStimOnset, vtWindow, nNumBins)
 
 % STPSTimeHist - FUNCTION Construct an ISI histogram for a spike train
 % $Id: STPSTimeHist.m 3987 2006-05-09 13:38:38Z dylan $
 %
-% Usage: <[vPSTHist, tBinCentres, vStdErr]> = ..
+% Usage: <[vPSTHist, tBinCentres, vStdErr, mCounts]> = ..
 %              STPSTimeHist(stTrain, vtStimOnset <, vtWindow, nNumBins>)
 %
 % STPSTimeHist will calculate a peri-stimulus time histogram for the spike
@@ -25,7 +25,15 @@ function [vPSTHist, tBinCentres, vStdErr] = STPSTimeHist(stTrain, vtStimOnset, v
 % 'vPSTHist' and 'vStdErr' will be vectors containing the binned spike
 % counts (and standard error) over the analysis time window. The centre
 % points of each time bin in the histogram are given in the vector
-% 'tBinCentres', in seconds.
+% 'tBinCentres', in seconds.  'mCounts' optionally returns the binned spike
+% counts for each stimulus presentation separately, as a matrix with one row
+% per stimulus onset and one column per bin (for example, for bootstrap
+% statistics).
+%
+% The spike times of 'stTrain' are searched once for each stimulus onset, so
+% each presentation visits only its own spikes, and the presentations are
+% counted in parallel by a compiled kernel if one is available.  A spike on
+% the boundary between two bins is counted in both, as STProfileCount does.
 %
 % If no output arguments are specified, a plot of the PSTH will be created.
 
@@ -113,46 +121,69 @@ tRegPoint = -vtWindow(1);
 
 % -- Calculate histogram for each stimulus
 
-% - Turn of 'zero duration' warning for STCount
-stateWarn = warning('off', 'SpikeToolbox:ZeroDuration');
+% - Warn if we're trying to crop before zero
+if (any(vtStimOnset(:) + vtWindow(1) < 0))
+   disp('--- STPSTimeHist: Warning: Stimulus-aligned time window begins before');
+   disp('       the start of the spike train');
+end
 
-% - Preallocate spike bins
 nNumStimulations = numel(vtStimOnset);
-mCounts = zeros(nNumStimulations, nNumBins);
 
-for (nStimIndex = 1:nNumStimulations)
-   % - Determine absolute time window for this stimulus onset
-   tWindow = vtStimOnset(nStimIndex) + vtWindow;
+if (exist('STPSTHCounts', 'file') == 3)
+   % - Count every stimulus presentation natively, searching the spike times
+   %   for each window.  Prefer a mapping, as STProfileCount does
+   if (isfield(stTrain, 'mapping'))
+      vtSpikeTimes = STGetSpikeTimes(stTrain, 'mapping');
+   else
+      vtSpikeTimes = STGetSpikeTimes(stTrain, 'instance');
+   end
    
-   % - Warn if we're trying to crop before zero
-   if (min(tWindow) < 0)
-      disp('--- STPSTimeHist: Warning: Stimulus-aligned time window begins before');
-      disp('       the start of the spike train');
+   if (nargout > 3)
+      [vPSTHist, vMeanHist, vStdErr, mCounts] = STPSTHCounts(vtSpikeTimes, vtStimOnset, vtWindow, nNumBins);
+   else
+      [vPSTHist, vMeanHist, vStdErr] = STPSTHCounts(vtSpikeTimes, vtStimOnset, vtWindow, nNumBins);
    end
+
+else
+   % - Turn of 'zero duration' warning for STCount
+   stateWarn = warning('off', 'SpikeToolbox:ZeroDuration');
+   
+   % - Preallocate spike bins
+   mCounts = zeros(nNumStimulations, nNumBins);
    
-   % - Crop train to the current window
-   stWindowTrain = STCrop(stTrain, tWindow(1), tWindow(2));
+   for (nStimIndex = 1:nNumStimulations)
+      % - Determine absolute time window for this stimulus onset
+      tWindow = vtStimOnset(nStimIndex) + vtWindow;
+      
+      % - Crop train to the current window
+      stCropTrain = STCrop(stTrain, tWindow(1), tWindow(2));
+      
+      % - Shift spike train to the registration point
+      stWindowTrain = STShift(stCropTrain, tRegPoint - vtStimOnset(nStimIndex));
+      
+      % - Bin spike frequencies
+      mStimCounts = STProfileCount(stWindowTrain, tBinDuration);
+      
+      % - Free the spike stores made for this window
+      STFreeTemporaryStore(stCropTrain, stTrain, stWindowTrain);
+      STFreeTemporaryStore(stWindowTrain, stTrain);
+      
+      nLastBin = min([nNumBins  size(mStimCounts, 1)]);               % Determine last bin to take
+      mCounts(nStimIndex, 1:nLastBin) = mStimCounts(1:nLastBin, 2);
+   end
    
-   % - Shift spike train to the registration point
-   stWindowTrain = STShift(stWindowTrain, tRegPoint - vtStimOnset(nStimIndex));
+   % - Calculate mean and standard error of counts
+   vPSTHist = sum(mCounts);
+   vMeanHist = mean(mCounts);
+   vStdErr = std(mCounts) ./ sqrt(nNumStimulations);
    
-   % - Bin spike frequencies
-   mStimCounts = STProfileCount(stWindowTrain, tBinDuration);
-   nLastBin = min([nNumBins  size(mStimCounts, 1)]);               % Determine last bin to take
-   mCounts(nStimIndex, 1:nLastBin) = mStimCounts(1:nLastBin, 2);
+   % - Restore warning state
+   warning(stateWarn);
 end
 
 % - Calcualte the time of each bin centre
 tBinCentres = (0:nNumBins-1) .* tBinDuration + (tBinDuration / 2) + vtWindow(1);
 
-% - Calculate mean and standard error of counts
-vPSTHist = sum(mCounts);
-vMeanHist = mean(mCounts);
-vStdErr = std(mCounts) ./ sqrt(nNumStimulations);
-
-% - Restore warning state
-warning(stateWarn);
-
 
 % -- Plot, if no output arguments;
 
@@ -62,10 +62,17 @@ end
 % -- Export the spike train
 
 % - Extract spike list and convert to delay format
-if (stMappedTrain.mapping.bChunkedMode)
+if (isfield(stMappedTrain.mapping, 'hSpikeStore'))
+   % - A native spike store computes the intervals itself
+   [mDeltaAddr, vnChunkCounts] = STSpikeStore('export', stMappedTrain.mapping.hSpikeStore);
+   spikeList = mat2cell(mDeltaAddr, vnChunkCounts, 2);
+   bDeltaFormat = true;
+elseif (stMappedTrain.mapping.bChunkedMode)
    spikeList = stMappedTrain.mapping.spikeList;
+   bDeltaFormat = false;
 else
    spikeList = {stMappedTrain.mapping.spikeList};
+   bDeltaFormat = false;
 end
 
 % - Preallocate export matrix
@@ -76,20 +83,18 @@ for (nChunkIndex = 1:length(spikeList))
    % - Extract raw spike list
    rawSpikeList = spikeList{nChunkIndex};
    
-   % - Determine the time of the last spike
-   if (nChunkIndex == 1)
-   	% - The first spike should be delayed by whenever the timestamp says
-		tLastSpike = 0;
-   else
-      tLastSpike = max(spikeList{nChunkIndex-1}(:, 1));
-   end
-   
-   % - Handle a singleton spike
-   if  (size(rawSpikeList, 1) == 1)
-      rawSpikeList = [tLastSpike - rawSpikeList(1), rawSpikeList(2)];
-   else
-      % - Calculate the inter-spike intervals
-      rawSpikeList(:, 1) = rawSpikeList(:, 1) - [tLastSpike; rawSpikeList(1:length(rawSpikeList)-1, 1)];
+   if (~bDeltaFormat)
+      % - Determine the time of the last spike
+      if (nChunkIndex == 1)
+         % - The first spike should be delayed by whenever the timestamp says
+         tLastSpike = 0;
+      else
+         tLastSpike = max(spikeList{nChunkIndex-1}(:, 1));
+      end
+
+      % - Calculate the inter-spike intervals, for singleton chunks as well,
+      %   as STSpikeStore('export') does
+      rawSpikeList(:, 1) = rawSpikeList(:, 1) - [tLastSpike; rawSpikeList(1:size(rawSpikeList, 1)-1, 1)];
    end
    
    % - Get addressing specification
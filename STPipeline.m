@@ -0,0 +1,218 @@
+function [stPlan] = STPipeline(varargin)
+
+% STPipeline - FUNCTION Build a lazy pipeline of spike train operations
+% $Id: STPipeline.m $
+%
+% Usage: [stPlan] = STPipeline(stTrain1, stTrain2, ...)
+%        [stPlan] = STPipeline(stTrainCell)
+%        [stPlan] = STPipeline(stPlan, 'crop', tMinTime, tMaxTime)
+%        [stPlan] = STPipeline(stPlan, 'shift', tOffset)
+%        [stPlan] = STPipeline(stPlan, 'map', nAddr1, nAddr2, ...)
+%        [stPlan] = STPipeline(stPlan, 'map', stasAddressingSpecification, nAddr1, nAddr2, ...)
+%        [stPlan] = STPipeline(stPlan, 'multiplex')
+%
+% STPipeline builds a plan of operations on a set of spike trains, without
+% applying any of them.  The plan is run by STPipelineRun, which passes the
+% spikes through every operation a small buffer at a time and builds only
+% the final result: a mapped spike train, an exported [delta addr] matrix or
+% a spike train file.  A chain such as STCrop -> STShift -> STMap ->
+% STMultiplex -> STPciaerExport then needs memory for its input trains and
+% its result, instead of for a full copy of the trains at every step.
+%
+% The first form starts a plan from the spike trains 'stTrain1', 'stTrain2',
+% etc., or from the cell array 'stTrainCell'.  Each train must have a mapping
+% or an instance; if it has both, the mapping is used.  Each following form
+% adds a stage to 'stPlan', and returns the new plan:
+%
+%    'crop'      - as STCrop(stTrain, tMinTime, tMaxTime)
+%    'shift'     - as STShift(stTrain, tOffset)
+%    'map'       - as STMap(stTrain, ...).  Every train must still be an
+%                  instance, or a mapped train which is also instantiated
+%                  and has no stages yet.  An address argument may be an
+%                  array with one address for each train
+%    'multiplex' - as STMultiplex, for all the trains of the plan
+%
+% Stages before 'multiplex' apply to each train, and stages after it apply
+% to the multiplexed train.  A plan can only be run once its trains are
+% mapped, and once there is a single train left to run: either the plan
+% started from one train, or it has a 'multiplex' stage.
+%
+% Spike train definitions are not instantiated by a pipeline, since
+% STInstantiate needs its own arguments.  Instantiate the trains first, then
+% start a plan from them.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin < 1)
+   disp('*** STPipeline: Incorrect usage');
+   help STPipeline;
+   return;
+end
+
+
+% -- Start a new plan from a set of spike trains
+
+if (~FieldExists(varargin{1}, 'cStages'))
+   cTrains = CellFlatten(varargin);
+
+   for (nTrainIndex = 1:numel(cTrains))
+      if (~FieldExists(cTrains{nTrainIndex}, 'mapping') && ~FieldExists(cTrains{nTrainIndex}, 'instance'))
+         disp('*** STPipeline: Each spike train must be instantiated or mapped');
+         return;
+      end
+   end
+
+   stPlan.cTrains = reshape(cTrains, 1, []);
+   stPlan.cStages = {};
+   return;
+end
+
+
+% -- Add a stage to a plan
+
+stPlan = varargin{1};
+
+if ((nargin < 2) || ~ischar(varargin{2}))
+   disp('*** STPipeline: Incorrect usage');
+   help STPipeline;
+   return;
+end
+
+strStage = lower(varargin{2});
+cArgs = varargin(3:end);
+
+% - Find out what the stages so far have done
+bMultiplexed = false;
+bMapped = false;
+
+for (nStageIndex = 1:numel(stPlan.cStages))
+   switch (stPlan.cStages{nStageIndex}{1})
+      case {'map'}
+         bMapped = true;
+      case {'multiplex'}
+         bMultiplexed = true;
+   end
+end
+
+switch (strStage)
+   case {'crop'}
+      if ((numel(cArgs) ~= 2) || ~isnumeric(cArgs{1}) || ~isnumeric(cArgs{2}) || ...
+          (numel(cArgs{1}) ~= 1) || (numel(cArgs{2}) ~= 1))
+         disp('*** STPipeline: ''crop'' needs a minimum and a maximum time');
+         return;
+      end
+
+      stPlan.cStages{end+1} = {'crop', cArgs{1}, cArgs{2}};
+
+   case {'shift'}
+      if ((numel(cArgs) ~= 1) || ~isnumeric(cArgs{1}) || (numel(cArgs{1}) ~= 1))
+         disp('*** STPipeline: ''shift'' needs a time offset');
+         return;
+      end
+
+      stPlan.cStages{end+1} = {'shift', cArgs{1}};
+
+   case {'map'}
+      if (bMapped || bMultiplexed)
+         disp('*** STPipeline: Spike trains can only be mapped once, before they are');
+         disp('       multiplexed');
+         return;
+      end
+
+      if (~all(CellForEach(@FieldExists, stPlan.cTrains, 'instance')))
+         disp('*** STPipeline: Only instantiated spike trains can be mapped');
+         return;
+      end
+
+      % - Mapped trains which are also instantiated can be re-mapped, before
+      %   any other stage has used their mappings
+      if (any(CellForEach(@FieldExists, stPlan.cTrains, 'mapping')))
+         if (~isempty(stPlan.cStages))
+            disp('*** STPipeline: Mapped spike trains can only be re-mapped before any other stage');
+            return;
+         end
+
+         disp('--- STPipeline: Warning: re-mapping a previously mapped train');
+      end
+
+      % - Extract and check the addressing information
+      [stasSpecification, cAddress] = STAddrFilterArgs(cArgs{:});
+
+      if (~STIsValidAddrSpec(stasSpecification))
+         disp('*** STPipeline: Invalid addressing specification supplied');
+         return;
+      end
+
+      % - Find the address of each train, from scalar or array arguments
+      nNumTrains = numel(stPlan.cTrains);
+      vnSynapseAddr = zeros(1, nNumTrains);
+      cAddrFields = cell(1, nNumTrains);
+
+      for (nTrainIndex = 1:nNumTrains)
+         cTrainAddress = cell(size(cAddress));
+
+         for (nFieldIndex = 1:numel(cAddress))
+            if (numel(cAddress{nFieldIndex}) == 1)
+               cTrainAddress{nFieldIndex} = cAddress{nFieldIndex};
+            elseif (numel(cAddress{nFieldIndex}) == nNumTrains)
+               cTrainAddress{nFieldIndex} = cAddress{nFieldIndex}(nTrainIndex);
+            else
+               disp('*** STPipeline: Address arrays must have one address for each spike train');
+               return;
+            end
+         end
+
+         if (~STIsValidAddress(stasSpecification, cTrainAddress{:}))
+            disp('*** STPipeline: Invalid address supplied');
+            return;
+         end
+
+         vnSynapseAddr(nTrainIndex) = STAddrLogicalConstruct(stasSpecification, cTrainAddress{:});
+         cAddrFields{nTrainIndex} = cTrainAddress;
+      end
+
+      stPlan.cStages{end+1} = {'map', stasSpecification, vnSynapseAddr, cAddrFields};
+
+   case {'multiplex'}
+      if (bMultiplexed)
+         disp('*** STPipeline: The spike trains have already been multiplexed');
+         return;
+      end
+
+      if (~isempty(cArgs))
+         disp('--- STPipeline: Extra arguments ignored');
+      end
+
+      % - Trains which weren't mapped by the plan must already share an
+      %   addressing specification
+      if (~bMapped)
+         if (~all(CellForEach(@FieldExists, stPlan.cTrains, 'mapping')))
+            disp('*** STPipeline: Spike trains must be mapped before they are multiplexed');
+            return;
+         end
+
+         sRef.type = '.';
+         sRef.subs = 'mapping';
+         stNodes = CellForEachCell(@subsref, stPlan.cTrains, sRef);
+         sRef.subs = 'stasSpecification';
+         stasSpecs = CellForEachCell(@subsref, stNodes, sRef);
+
+         if (~STAddrSpecCompare(stasSpecs{:}))
+            disp('*** STPipeline: Can only multiplex spike trains with identical');
+            disp('       addressing specifications');
+            return;
+         end
+      end
+
+      stPlan.cStages{end+1} = {'multiplex'};
+
+   otherwise
+      SameLinePrintf('*** STPipeline: Unknown stage [%s]\n', strStage);
+      return;
+end
+
+% --- END of STPipeline.m ---
@@ -0,0 +1,352 @@
+function [varargout] = STPipelineRun(stPlan, strSink, strFilename)
+
+% STPipelineRun - FUNCTION Run a lazy pipeline of spike train operations
+% $Id: STPipelineRun.m $
+%
+% Usage: [stTrain] = STPipelineRun(stPlan)
+%        [mHardTrain] = STPipelineRun(stPlan, 'export')
+%        STPipelineRun(stPlan, 'save', strFilename)
+%
+% Where: 'stPlan' is a plan built by STPipeline.  The first form returns the
+% mapped spike train built by the plan, as the same chain of STCrop, STShift,
+% STMap and STMultiplex calls would.  The 'export' form returns the train as
+% STPciaerExport would, as a [delta addr] matrix of physical addresses.  The
+% 'save' form writes the train to 'strFilename', as STTrainSave would.
+%
+% The spikes of each train are read a buffer at a time, passed through every
+% stage of the plan and merged in time order, and are only stored once they
+% reach the result.  No intermediate train is built.  This is done by the
+% native STSpikeStore, with buffers of a fixed size which are reused as the
+% spikes pass through; the result is built in chunks of at most
+% 'SpikeChunkLength' spikes (see STOptions).  The mapped train is kept in a
+% native spike store if the 'MappingSpikeStore' option is set; the caller
+% owns this store, and frees it with STMaterialise(stTrain, true).
+%
+% If STSpikeStore has not been compiled, the stages are applied one at a time
+% by the toolbox functions instead.
+%
+% Spikes which are shifted before time zero in a mapped train raise an error,
+% since they can't be kept in the result.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin > 3)
+   disp('--- STPipelineRun: Extra arguments ignored');
+end
+
+if (nargin < 1)
+   disp('*** STPipelineRun: Incorrect usage');
+   help STPipelineRun;
+   return;
+end
+
+if (~FieldExists(stPlan, 'cTrains') || ~isfield(stPlan, 'cStages'))
+   disp('*** STPipelineRun: Invalid plan supplied.  Build plans with STPipeline');
+   return;
+end
+
+if (nargin < 2)
+   strSink = 'mapping';
+end
+
+strSink = lower(strSink);
+
+switch (strSink)
+   case {'mapping', 'export'}
+
+   case {'save'}
+      if ((nargin < 3) || ~ischar(strFilename))
+         disp('*** STPipelineRun: The file name must be a string');
+         return;
+      end
+
+   otherwise
+      SameLinePrintf('*** STPipelineRun: Unknown result [%s]\n', strSink);
+      return;
+end
+
+
+% -- Check that the plan can be run
+
+cStages = stPlan.cStages;
+vstrStages = cell(1, numel(cStages));
+
+for (nStageIndex = 1:numel(cStages))
+   vstrStages{nStageIndex} = cStages{nStageIndex}{1};
+end
+
+nMapStage = find(strcmp(vstrStages, 'map'), 1);
+nMuxStage = find(strcmp(vstrStages, 'multiplex'), 1);
+
+if (isempty(nMapStage) && ~all(CellForEach(@FieldExists, stPlan.cTrains, 'mapping')))
+   disp('*** STPipelineRun: The spike trains must be mapped, either before the plan');
+   disp('       or by a ''map'' stage');
+   return;
+end
+
+if (isempty(nMuxStage) && (numel(stPlan.cTrains) > 1))
+   disp('*** STPipelineRun: Several spike trains must be multiplexed by the plan');
+   return;
+end
+
+if (isempty(nMuxStage))
+   nMuxStage = numel(cStages) + 1;
+end
+
+
+% -- Apply the stages one at a time if there is no native spike store
+
+if (exist('STSpikeStore', 'file') ~= 3)
+   if (strcmp(strSink, 'save'))
+      disp('*** STPipelineRun: The STSpikeStore MEX function has not been compiled.');
+      disp('       Please run STWelcome.');
+      return;
+   end
+
+   stTrain = RunStages(stPlan.cTrains, cStages, ~isempty(nMapStage));
+
+   if (strcmp(strSink, 'export'))
+      varargout{1} = STPciaerExport(stTrain);
+   else
+      varargout{1} = stTrain;
+   end
+   return;
+end
+
+
+% -- Compile the stages into native operations on each train
+
+% -- Get options
+stOptions = STOptions;
+MappingTemporalResolution = stOptions.MappingTemporalResolution;
+bCompress = FieldExists(stOptions, 'CompressSpikeStores') && stOptions.CompressSpikeStores;
+
+nNumTrains = numel(stPlan.cTrains);
+vfTemporalResolution = zeros(1, nNumTrains);
+vtDuration = zeros(1, nNumTrains);
+stSources = [];
+
+for (nTrainIndex = 1:nNumTrains)
+   stTrain = stPlan.cTrains{nTrainIndex};
+
+   % - Trains mapped by the plan are read from their instances
+   if (isempty(nMapStage))
+      node = stTrain.mapping;
+      vfTemporalResolution(nTrainIndex) = node.fTemporalResolution;
+      stSources(nTrainIndex).bInstance = false;
+      stSources(nTrainIndex).addrSynapse = [];
+   else
+      node = stTrain.instance;
+      vfTemporalResolution(nTrainIndex) = MappingTemporalResolution;
+      stSources(nTrainIndex).bInstance = true;
+      stSources(nTrainIndex).addrSynapse = cStages{nMapStage}{3}(nTrainIndex);
+   end
+
+   if (isfield(node, 'hSpikeStore'))
+      stSources(nTrainIndex).hSpikeStore = node.hSpikeStore;
+      stSources(nTrainIndex).spikeList = [];
+   else
+      stSources(nTrainIndex).hSpikeStore = [];
+      stSources(nTrainIndex).spikeList = node.spikeList;
+   end
+
+   stSources(nTrainIndex).fTemporalResolution = vfTemporalResolution(nTrainIndex);
+
+   [stSources(nTrainIndex).mTimeOps, stSources(nTrainIndex).mTickOps, vtDuration(nTrainIndex)] = ...
+      CompileStages(cStages(1:nMuxStage-1), isempty(nMapStage), ...
+                    vfTemporalResolution(nTrainIndex), node.tDuration);
+end
+
+% - Rescale the trains to the resolution of the first non-empty train, as
+%   STMultiplex does, and take the longest duration
+nFirstTrain = find(vtDuration > 0, 1);
+if (isempty(nFirstTrain))
+   nFirstTrain = 1;
+end
+
+fTemporalResolution = vfTemporalResolution(nFirstTrain);
+
+for (nTrainIndex = find(vfTemporalResolution ~= fTemporalResolution))
+   stSources(nTrainIndex).mTickOps(end+1, :) = [3 vfTemporalResolution(nTrainIndex) fTemporalResolution];
+end
+
+[nul, mMergedOps, tDuration] = CompileStages(cStages(nMuxStage+1:end), true, fTemporalResolution, max(vtDuration));
+
+
+% -- Build the mapping node for the result
+
+mapping = [];
+mapping.tDuration = tDuration;
+mapping.fTemporalResolution = fTemporalResolution;
+
+if (isempty(nMapStage))
+   mapping.stasSpecification = stPlan.cTrains{1}.mapping.stasSpecification;
+else
+   mapping.stasSpecification = cStages{nMapStage}{2};
+
+   if (nNumTrains == 1)
+      mapping.addrFields = cStages{nMapStage}{4}{1};
+      mapping.addrSynapse = cStages{nMapStage}{3}(1);
+   end
+end
+
+
+% -- Run the pipeline into the requested result
+
+switch (strSink)
+   case {'mapping'}
+      stTrain = [];
+
+      if (FieldExists(stOptions, 'MappingSpikeStore') && stOptions.MappingSpikeStore)
+         hStore = STSpikeStore('pipeline', stSources, mMergedOps, stOptions.SpikeChunkLength, 'store', bCompress);
+         stTrain.mapping = STSpikeStoreNode(mapping, hStore);
+
+      else
+         spikeList = STSpikeStore('pipeline', stSources, mMergedOps, stOptions.SpikeChunkLength, 'spikelist');
+
+         if (numel(spikeList) > 1)
+            mapping.bChunkedMode = true;
+            mapping.nNumChunks = numel(spikeList);
+            mapping.spikeList = spikeList;
+         elseif (numel(spikeList) == 1)
+            mapping.bChunkedMode = false;
+            mapping.spikeList = spikeList{1};
+         else
+            mapping.bChunkedMode = false;
+            mapping.spikeList = [];
+         end
+
+         stTrain.mapping = mapping;
+      end
+
+      varargout{1} = stTrain;
+
+   case {'export'}
+      spikeList = STSpikeStore('pipeline', stSources, mMergedOps, stOptions.SpikeChunkLength, 'export');
+
+      % - Convert each chunk to physical addresses, as STPciaerExport does
+      stasSpecification = mapping.stasSpecification;
+      nRequiredAddressFields = sum(~[stasSpecification.bIgnore]);
+
+      for (nChunkIndex = 1:numel(spikeList))
+         [addr{1:nRequiredAddressFields}] = STAddrLogicalExtract(spikeList{nChunkIndex}(:, 2), stasSpecification);
+         spikeList{nChunkIndex}(:, 2) = STAddrPhysicalConstruct(stasSpecification, addr{:});
+      end
+
+      varargout{1} = vertcat(zeros(0, 2), spikeList{:});
+
+   case {'save'}
+      STSpikeStore('pipeline', stSources, mMergedOps, stOptions.SpikeChunkLength, 'save', ...
+                   strFilename, tDuration, fTemporalResolution, STAddrSpecEncode(mapping.stasSpecification), bCompress);
+end
+
+% --- END of STPipelineRun.m ---
+
+
+% --- FUNCTION CompileStages
+
+function [mTimeOps, mTickOps, tDuration] = CompileStages(cStages, bTicks, fTemporalResolution, tDuration)
+
+% CompileStages - Convert 'crop' and 'shift' stages into native operations
+%
+% Instance spike times ('bTicks' false) are cropped and shifted in seconds,
+% until a 'map' stage converts them to ticks.  Ticks are cropped and shifted
+% with the bins that STCrop and STShift would use for a mapping.  The duration
+% of the train is tracked as STCrop and STShift would change it.
+
+mTimeOps = zeros(0, 3);
+mTickOps = zeros(0, 3);
+
+for (nStageIndex = 1:numel(cStages))
+   cStage = cStages{nStageIndex};
+
+   switch (cStage{1})
+      case {'crop'}
+         tSortedTimes = sort([cStage{2} cStage{3}]);
+
+         if (bTicks)
+            nMinTick = floor(tSortedTimes(1) / fTemporalResolution);
+            nMaxTick = ceil(tSortedTimes(2) / fTemporalResolution);
+            mTickOps(end+1, :) = [1 nMinTick nMaxTick];
+            tDuration = nMaxTick .* fTemporalResolution;
+         else
+            mTimeOps(end+1, :) = [1 tSortedTimes];
+            tDuration = tSortedTimes(2);
+         end
+
+      case {'shift'}
+         % - Zero-duration trains are not shifted
+         if (tDuration == 0)
+            continue;
+         end
+
+         if (bTicks)
+            nBinOffset = round(cStage{2} / fTemporalResolution);
+
+            if (abs(nBinOffset) < 1)
+               disp('--- STPipelineRun: The time offset was negligible for shifting the mapped train');
+            else
+               mTickOps(end+1, :) = [2 nBinOffset 0];
+            end
+         else
+            mTimeOps(end+1, :) = [2 cStage{2} 0];
+         end
+
+         tDuration = tDuration + cStage{2};
+
+      case {'map'}
+         bTicks = true;
+   end
+end
+
+% --- END of CompileStages FUNCTION ---
+
+
+% --- FUNCTION RunStages
+
+function [stTrain] = RunStages(cTrains, cStages, bUseInstance)
+
+% RunStages - Apply the stages of a plan with the toolbox functions, one at a time
+
+% - Keep only the spike train level used by the plan
+for (nTrainIndex = 1:numel(cTrains))
+   if (bUseInstance)
+      cTrains{nTrainIndex} = struct('instance', cTrains{nTrainIndex}.instance);
+   else
+      cTrains{nTrainIndex} = struct('mapping', cTrains{nTrainIndex}.mapping);
+   end
+end
+
+for (nStageIndex = 1:numel(cStages))
+   cStage = cStages{nStageIndex};
+
+   switch (cStage{1})
+      case {'crop'}
+         for (nTrainIndex = 1:numel(cTrains))
+            cTrains{nTrainIndex} = STCrop(cTrains{nTrainIndex}, cStage{2}, cStage{3});
+         end
+
+      case {'shift'}
+         for (nTrainIndex = 1:numel(cTrains))
+            cTrains{nTrainIndex} = STShift(cTrains{nTrainIndex}, cStage{2});
+         end
+
+      case {'map'}
+         for (nTrainIndex = 1:numel(cTrains))
+            cTrains{nTrainIndex} = STMap(cTrains{nTrainIndex}, cStage{2}, cStage{4}{nTrainIndex}{:});
+         end
+
+      case {'multiplex'}
+         if (numel(cTrains) > 1)
+            cTrains = {STMultiplex(cTrains)};
+         end
+   end
+end
+
+stTrain = cTrains{1};
+
+% --- END of RunStages FUNCTION ---
@@ -234,7 +234,7 @@ if (strcmp(strMethod, 'smooth'))
    end
    
    % - Smooth data
-   vfFreq = smooth(vfFreq, nSmoothSamples);
+   vfFreq = MovingAverage(vfFreq, nSmoothSamples);
 end
 
 
@@ -301,4 +301,35 @@ vfFreq = max(vfFreq);
 
 % --- END of InstFreqInterp FUNCTION
 
+
+% --- MovingAverage FUNCTION
+
+function [vfSmooth] = MovingAverage(vfData, nSpan)
+
+% - Moving average over an odd span, which shrinks near each end so that the
+% average is always centred (as the 'smooth' function)
+vfData = vfData(:);
+nNumSamples = numel(vfData);
+nSpan = max(min(nSpan, nNumSamples), 1);
+nSpan = nSpan - 1 + mod(nSpan, 2);
+nHalfSpan = (nSpan - 1) / 2;
+
+% - Smooth the centre with a box kernel
+vfKernel = ones(nSpan, 1) ./ nSpan;
+
+if (exist('STConv', 'file') == 3)
+   vfSmooth = STConv(vfData, vfKernel, 'same');
+else
+   vfSmooth = conv2(vfData, vfKernel, 'same');
+end
+
+% - Average the ends over the shrinking spans
+vfCumSum = cumsum(vfData);
+vfRevCumSum = cumsum(flipud(vfData));
+vnEndSpan = (1:2:nSpan-2)';
+vfSmooth(1:nHalfSpan) = vfCumSum(vnEndSpan) ./ vnEndSpan;
+vfSmooth(end:-1:end-nHalfSpan+1) = vfRevCumSum(vnEndSpan) ./ vnEndSpan;
+
+% --- END of MovingAverage FUNCTION
+
 % --- END of STPlotInstFreq.m ---
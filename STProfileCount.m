@@ -88,6 +88,14 @@ end
 
 function [vBinnedCounts] = STProfileCountNode(stNode, tTimeWindow, bIsMapping)
 
+% - Count a native spike store directly
+if (isfield(stNode, 'hSpikeStore'))
+   nNumWindows = ceil(stNode.tDuration / tTimeWindow);
+   vnCounts = STSpikeStore('count', stNode.hSpikeStore, stNode.fTemporalResolution, tTimeWindow, nNumWindows);
+   vBinnedCounts = [((0:nNumWindows-1)' * tTimeWindow + (tTimeWindow/2)), vnCounts];
+   return;
+end
+
 % - Extract spike lists
 if (stNode.bChunkedMode)
    spikeList = stNode.spikeList;
@@ -95,9 +103,24 @@ else
    spikeList = {stNode.spikeList};
 end
 
-vBinnedCounts = [];
+nNumWindows = ceil(stNode.tDuration / tTimeWindow);
+vtBinCentres = (0:nNumWindows-1)' * tTimeWindow + (tTimeWindow/2);
+
+if (bIsMapping)
+   fTimeScale = stNode.fTemporalResolution;
+else
+   fTimeScale = 1;
+end
+
+% - Count every chunk in a single pass, natively
+if (exist('STBinChunks', 'file') == 3)
+   vBinnedCounts = [vtBinCentres, STBinChunks(spikeList, fTimeScale, tTimeWindow, nNumWindows)];
+   return;
+end
+
+vBinnedCounts = [vtBinCentres, zeros(nNumWindows, 1)];
 
-for (nWindowIndex = 1:ceil(stNode.tDuration / tTimeWindow))
+for (nWindowIndex = 1:nNumWindows)
    % - Calculate time window
    tWindowMin = (nWindowIndex-1) * tTimeWindow;
    tWindowMax = nWindowIndex * tTimeWindow;
@@ -107,19 +130,16 @@ for (nWindowIndex = 1:ceil(stNode.tDuration / tTimeWindow))
       % - Get spike list
       sList = spikeList{nChunkIndex}(:, 1);
       
-      if (bIsMapping)
-         % - Convert to real time signature format
-         sList = sList .* stNode.fTemporalResolution;
-      end
+      % - Convert to real time signature format
+      sList = sList .* fTimeScale;
       
       % - Apply time window
       windowedSpikes = (sList >= tWindowMin) & (sList <= tWindowMax);
       nNumSpikes = nNumSpikes + sum(windowedSpikes);
    end
    
-   % - Append to spike count list
-   vBinnedCounts = [vBinnedCounts;...
-                    [(nWindowIndex-1) * tTimeWindow + (tTimeWindow/2), nNumSpikes] ];
+   % - Record the spike count
+   vBinnedCounts(nWindowIndex, 2) = nNumSpikes;
 end
 
 
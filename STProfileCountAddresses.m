@@ -46,23 +46,35 @@ end
 mapping = stMappedTrain.mapping;
 
 % - Extract spike lists
-if (mapping.bChunkedMode)
+if (isfield(mapping, 'hSpikeStore'))
+   spikeList = STSpikeStore('spikelist', mapping.hSpikeStore);
+elseif (mapping.bChunkedMode)
    spikeList = mapping.spikeList;
 else
    spikeList = {mapping.spikeList};
 end
 
+nNumWindows = ceil(mapping.tDuration / tTimeWindow);
+vtBinCentres = (0:nNumWindows-1)' * tTimeWindow + (tTimeWindow/2);
+
+% - Count every address of every chunk in a single pass, natively
+if (exist('STBinChunks', 'file') == 3)
+   [mCounts, vKey] = STBinChunks(spikeList, mapping.fTemporalResolution, tTimeWindow, nNumWindows, true);
+   vBinnedCounts = [vtBinCentres, mCounts];
+   return;
+end
+
 % - Get a list of used addresses
 % - Convert spike list to real time signature format
 vKey = [];
 for (nChunkIndex = 1:length(spikeList))
-   vKey = unique([vKey  spikeList{nChunkIndex}(:, 2)]);
+   vKey = unique([vKey; spikeList{nChunkIndex}(:, 2)]);
    spikeList{nChunkIndex}(:, 1) = spikeList{nChunkIndex}(:, 1) .* mapping.fTemporalResolution;
 end
 
-vBinnedCounts = [];
+vBinnedCounts = [vtBinCentres, zeros(nNumWindows, length(vKey))];
 
-for (nWindowIndex = 1:ceil(mapping.tDuration / tTimeWindow))
+for (nWindowIndex = 1:nNumWindows)
    % - Calculate time window
    tWindowMin = (nWindowIndex-1) * tTimeWindow;
    tWindowMax = nWindowIndex * tTimeWindow;
@@ -82,9 +94,8 @@ for (nWindowIndex = 1:ceil(mapping.tDuration / tTimeWindow))
       end
    end
    
-   % - Append to spike count list
-   vBinnedCounts = [vBinnedCounts;...
-                    [(nWindowIndex-1) * tTimeWindow + (tTimeWindow/2), vCounts] ];
+   % - Record the spike counts
+   vBinnedCounts(nWindowIndex, 2:end) = vCounts;
 end
 
 
@@ -12,6 +12,15 @@ function [stShiftedTrain] = STShift(stTrain, tOffset)
 % Note that shifting a spike train with a definition will strip the definition
 % from the train.  Shifting a spike train with only a definition will erase
 % the train and STShift will return an empty matrix.
+%
+% Shifting doesn't reorder spikes, so a mapping indexed with STIndexAddresses
+% keeps its index.
+%
+% A mapping held in a native spike store (see STMaterialise) is shifted into a
+% new store, which belongs to the caller: free it with
+% STMaterialise(stShiftedTrain, true) when the shifted train is finished
+% with.  If the offset is less than one tick, the mapping of 'stTrain' is
+% returned unchanged, and shares its store.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 3rd May, 2004
@@ -52,6 +61,15 @@ if (FieldExists(stTrain, 'mapping'))
 		disp('--- STShift: The time offset was negligible for shifting the mapped train');
 		stShiftedTrain.mapping = stTrain.mapping;
 	else
+		% - Spike stores can't hold spikes before time zero
+		if (isfield(stTrain.mapping, 'hSpikeStore'))
+			mChunkInfo = STSpikeStore('info', stTrain.mapping.hSpikeStore);
+			if (mChunkInfo(1, 2) + nBinOffset < 0)
+				disp('--- STShift: Warning: Spikes shifted before time zero can''t be kept in a spike store');
+				stTrain = STMaterialise(stTrain);
+			end
+		end
+
 		stShiftedTrain.mapping = STShiftNode(stTrain.mapping, nBinOffset);
 	end
    
@@ -74,6 +92,12 @@ function [nodeShifted] = STShiftNode(node, tOffset)
 
 nodeShifted = node;
 
+% - Shift a native spike store directly
+if (isfield(node, 'hSpikeStore'))
+   nodeShifted = STSpikeStoreNode(node, STSpikeStore('shift', node.hSpikeStore, tOffset));
+   return;
+end
+
 % - Extract the spike train
 
 if (node.bChunkedMode)
@@ -76,6 +76,12 @@ if (bUseMapping)
    stFiltTrain.mapping = stTrain.mapping;
    stRejectTrain.mapping = stTrain.mapping;
 
+   % - The sieved spike lists no longer match an address index
+   if (isfield(stTrain.mapping, 'stAddrIndex'))
+      stFiltTrain.mapping = rmfield(stFiltTrain.mapping, 'stAddrIndex');
+      stRejectTrain.mapping = rmfield(stRejectTrain.mapping, 'stAddrIndex');
+   end
+
    if (stTrain.mapping.bChunkedMode)
       spikeListMapping = stTrain.mapping.spikeList;
    else
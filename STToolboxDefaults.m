@@ -35,6 +35,16 @@ stOptions.RandomGenerator = @rand;
 % - Set the spike chunk size (maximum length for a spike chunk)
 stOptions.SpikeChunkLength = 1024*2048;
 
+% - Keep mapped spike lists in native spike stores (see STMaterialise)
+stOptions.MappingSpikeStore = false;
+
+% - Compress the spike stores made by STMap and STMultiplex
+stOptions.CompressSpikeStores = false;
+
+% - Set the method used to generate correlated spike trains
+%   ('norta' or 'mixture', see STInstantiate)
+stOptions.CorrelationMethod = 'norta';
+
 % - Set the default window size for synchronous pair matching
 stOptions.DefaultSynchWindowSize = 1e-3;
 
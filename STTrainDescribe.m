@@ -115,7 +115,11 @@ if (isfield(stTrain, 'definition'))
          SameLinePrintf('      Sinusoid period [%.2f] seconds\n', stTrain.definition.tPeriod);
          
       case {'gamma'}
-         SameLinePrintf('      Gamma ISI distribution spike train\n');
+         if (isfield(stTrain.definition, 'strISIDistribution'))
+            SameLinePrintf('      Gamma ISI profile spike train (%s ISI distribution)\n', stTrain.definition.strISIDistribution);
+         else
+            SameLinePrintf('      Gamma ISI distribution spike train\n');
+         end
          SameLinePrintf('      Mean ISI [%.4f] msec | Var ISI [%.4f] msec\n', ...
                         stTrain.definition.fMeanISI / 1e-3, stTrain.definition.fVarISI / 1e-3);
       otherwise
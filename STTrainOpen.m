@@ -0,0 +1,59 @@
+function [stTrain] = STTrainOpen(strFilename)
+
+% STTrainOpen - FUNCTION Map a spike train file into memory
+% $Id: STTrainOpen.m $
+%
+% Usage: [stTrain] = STTrainOpen(strFilename)
+%
+% STTrainOpen opens a spike train file written by STTrainSave, and returns a
+% spike train 'stTrain' containing its mapping.  The file is mapped into
+% memory as a native spike store (see STMaterialise): only its header and
+% chunk index are read, and the operating system reads the spikes of each
+% chunk when they are first used.  STCrop, STExtract and STProfileCount
+% select chunks by their time range before touching their spikes, so they
+% read only the parts of the file they need.
+%
+% The file must not be changed or deleted while the spike train is in use.
+% Use STMaterialise with 'bFreeStore' set to read the whole spike train into
+% an ordinary mapping and close the file.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin > 1)
+   disp('--- STTrainOpen: Extra arguments ignored');
+end
+
+if (nargin < 1)
+   disp('*** STTrainOpen: Incorrect usage');
+   help STTrainOpen;
+   return;
+end
+
+if (~ischar(strFilename))
+   disp('*** STTrainOpen: The file name must be a string');
+   return;
+end
+
+if (exist('STSpikeStore', 'file') ~= 3)
+   disp('*** STTrainOpen: The STSpikeStore MEX function has not been compiled.');
+   disp('       Please run STWelcome.');
+   return;
+end
+
+
+% -- Map the file, and build the mapping
+
+[hStore, tDuration, fTemporalResolution, strSpec] = STSpikeStore('open', strFilename);
+
+mapping.tDuration = tDuration;
+mapping.fTemporalResolution = fTemporalResolution;
+mapping.bChunkedMode = false;
+mapping.stasSpecification = STAddrSpecDecode(strSpec);
+
+stTrain.mapping = STSpikeStoreNode(mapping, hStore);
+
+% --- END of STTrainOpen.m ---
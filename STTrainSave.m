@@ -0,0 +1,88 @@
+function STTrainSave(stTrain, strFilename)
+
+% STTrainSave - FUNCTION Save a mapped spike train to a spike train file
+% $Id: STTrainSave.m $
+%
+% Usage: STTrainSave(stTrain, strFilename)
+%
+% STTrainSave writes the mapping of 'stTrain' to the binary spike train file
+% 'strFilename'.  The file holds the spikes in the same chunked, columnar
+% format as a native spike store (see STMaterialise), along with the
+% duration, temporal resolution and addressing specification of the
+% mapping.  Spikes from a compressed spike store, or from any mapping when
+% the 'CompressSpikeStores' toolbox option is set, are written compressed.
+%
+% Use STTrainOpen to map a spike train file back into memory.  Opening a file
+% only reads its header and chunk index, so that very long spike trains can
+% be cropped, extracted from or counted without reading the whole file.
+%
+% A file can be saved over while it is open: the new file is written under a
+% temporary name and then renamed, so trains opened from the old file keep
+% their spikes.  (Windows refuses to replace a file which is open, and
+% STTrainSave reports an error instead.)
+%
+% Only the mapping is saved.  The 'addrFields' and 'addrSynapse' of a mapping
+% made by STMap are not saved.  Spike train files are written in the byte
+% order of the machine, and can only be opened on machines with the same byte
+% order.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin > 2)
+   disp('--- STTrainSave: Extra arguments ignored');
+end
+
+if (nargin < 2)
+   disp('*** STTrainSave: Incorrect usage');
+   help STTrainSave;
+   return;
+end
+
+if (~ischar(strFilename))
+   disp('*** STTrainSave: The file name must be a string');
+   return;
+end
+
+if (~FieldExists(stTrain, 'mapping'))
+   disp('*** STTrainSave: Only mapped spike trains can be saved');
+   return;
+end
+
+if (exist('STSpikeStore', 'file') ~= 3)
+   disp('*** STTrainSave: The STSpikeStore MEX function has not been compiled.');
+   disp('       Please run STWelcome.');
+   return;
+end
+
+
+% -- Save the mapping
+
+mapping = stTrain.mapping;
+strSpec = STAddrSpecEncode(mapping.stasSpecification);
+
+if (isfield(mapping, 'hSpikeStore'))
+   % - Write the store directly
+   STSpikeStore('save', mapping.hSpikeStore, strFilename, mapping.tDuration, ...
+                mapping.fTemporalResolution, strSpec);
+
+else
+   % - Build a temporary store from the spike list
+   stOptions = STOptions;
+   bCompress = FieldExists(stOptions, 'CompressSpikeStores') && stOptions.CompressSpikeStores;
+   hStore = STSpikeStore('create', mapping.spikeList, bCompress);
+
+   try
+      STSpikeStore('save', hStore, strFilename, mapping.tDuration, mapping.fTemporalResolution, strSpec);
+   catch
+      STSpikeStore('destroy', hStore);
+      rethrow(lasterror);
+   end
+
+   STSpikeStore('destroy', hStore);
+end
+
+% --- END of STTrainSave.m ---
@@ -53,30 +53,37 @@ STW__strPrivatePath = fullfile(STW__strToolboxPath, 'private');
 
 STW__bMexSuccess = true;
 
-% - ConvBarrier.mex___
-if (exist(['ConvBarrier.' mexext], 'file') ~= 3)
-   disp('--- STWelcome: Compiling ConvBarrier.mex___');
-	% - Try to compile it
-	STW__strWD = cd;
-	cd(STW__strPrivatePath);
-   STW__strCommand = sprintf('mex %s ConvBarrier.c', STW__strMexFlags);
-	eval(STW__strCommand);
-	cd(STW__strWD);
-   
-   STW__bMexSuccess = STW__bMexSuccess & (exist(['ConvBarrier.' mexext], 'file') == 3);
-end
-
-% - twister.mex___
-if (exist(['twister.' mexext], 'file') ~= 3)
-   disp('--- STWelcome: Compiling twister.mex___');
-	% - Try to compile it
-	STW__strWD = cd;
-	cd(STW__strPrivatePath);
-   STW__strCommand = sprintf('mex %s twister.cpp', STW__strMexFlags);
-	eval(STW__strCommand);
-	cd(STW__strWD);
+% - Toolbox mex files, and the source files they are compiled from
+STW__cMexFiles = {'ConvBarrier', 'ConvBarrier.c'; ...
+                  'twister', 'twister.cpp'; ...
+                  'STGeneratePoisson', 'STGeneratePoisson.cpp'; ...
+                  'STInstantiateNative', 'STInstantiateNative.cpp'; ...
+                  'STGenerateRenewal', 'STGenerateRenewal.cpp'; ...
+                  'STConv', 'STConv.c'; ...
+                  'STSpikeStore', 'STSpikeStore.cpp'; ...
+                  'STMergeChunks', 'STMergeChunks.cpp'; ...
+                  'STConcatChunks', 'STConcatChunks.cpp'; ...
+                  'STSynchronousChunks', 'STSynchronousChunks.cpp'; ...
+                  'STCorrelogram', 'STCorrelogram.cpp'; ...
+                  'STBinChunks', 'STBinChunks.cpp'; ...
+                  'STPSTHCounts', 'STPSTHCounts.cpp'; ...
+                  'STISIAddresses', 'STISIAddresses.cpp'; ...
+                  'STIndexChunks', 'STIndexChunks.cpp'};
+
+for (STW__nMexIndex = 1:size(STW__cMexFiles, 1))
+   STW__strMexName = STW__cMexFiles{STW__nMexIndex, 1};
    
-   STW__bMexSuccess = STW__bMexSuccess & (exist(['twister.' mexext], 'file') == 3);
+   if (exist([STW__strMexName '.' mexext], 'file') ~= 3)
+      fprintf(1, '--- STWelcome: Compiling %s.mex___\n', STW__strMexName);
+      % - Try to compile it
+      STW__strWD = cd;
+      cd(STW__strPrivatePath);
+      STW__strCommand = sprintf('mex %s %s', STW__strMexFlags, STW__cMexFiles{STW__nMexIndex, 2});
+      eval(STW__strCommand);
+      cd(STW__strWD);
+      
+      STW__bMexSuccess = STW__bMexSuccess & (exist([STW__strMexName '.' mexext], 'file') == 3);
+   end
 end
 
 % - pciaer_stim_mon.mex___
@@ -132,5 +139,6 @@ end
 % -- Clean up
 
 clear STW__stO STW__strWD STW__strMexFlags STW__strToolboxPath STW__strPrivatePath STW__bMexSuccess;
+clear STW__cMexFiles STW__nMexIndex STW__strMexName STW__strCommand;
 
 % --- END of STWelcome.m ---
@@ -11,6 +11,11 @@
  * option can be used to return the rest of the convolution result.  Note that
  * 'vfConv' will be normalised with respect to the area of the partial kernel, 
  * whereas conv will not normalise the result.
+ *
+ * The convolution itself is performed by STConv.h, so long kernels are
+ * convolved by FFT.  The first numel(vfData) elements of
+ * STConv(vfData, vfKernel, 'full', true) give the normalised convolution over
+ * the whole of 'vfData'.
  */
 
 /* Author: Dylan Muir <dylan@ini.phys.ethz.ch>
@@ -19,6 +24,7 @@
  */
 
 #include <mex.h>
+#include "STConv.h"
 
 void 
 mexFunction(int nlhs, mxArray *plhs[],
@@ -27,16 +33,11 @@ mexFunction(int nlhs, mxArray *plhs[],
 	double	*adKernel,			/* Data pointer for kernel array */
 				*adData,				/* Data pointer for source data array */
 				*adReturn;			/* Data pointer for return data array */
-	int		nSmoothingBins,	/* Number of bins to perform convolution over */
-				nEndIndex,			/* Index along smoothing section */
-				nBinIndex,			/* Index into data and kernel arrays */
-				nKernelLength,
+	long		nKernelLength,
 				nDataLength;
-	double	dPartialMag,		/* Magnitude of partial kernel */
-				dKernelElem;		/* Current kernel element */
 
 	/* - Check usage */
-	if (nrhs != 2) {
+	if ((nlhs > 1) || (nrhs != 2)) {
 		mexPrintf("*** ConvBarrier: Incorrect usage\n");
 		mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
 		mexEvalString("help ConvBarrier");
@@ -45,7 +46,7 @@ mexFunction(int nlhs, mxArray *plhs[],
 	
 	/* - Get array lengths */
 	nDataLength = mxGetN(prhs[0]) * mxGetM(prhs[0]);
-	nKernelLength = mxGetN(prhs[1]) * mxGetN(prhs[1]);
+	nKernelLength = mxGetN(prhs[1]) * mxGetM(prhs[1]);
 
 
    /* - Allocate output array */
@@ -59,26 +60,10 @@ mexFunction(int nlhs, mxArray *plhs[],
 	adKernel = mxGetPr(prhs[1]);
 	adReturn = mxGetPr(plhs[0]);
 	
-	/* - Determine how far to smooth */
-	if (nKernelLength < nDataLength) {
-		nSmoothingBins = nKernelLength;
-	} else {
-		nSmoothingBins = nDataLength;
-	}
-	
-
-   
-	/* - Index along data array => point to smooth to */
-	for (nEndIndex = 0; nEndIndex < nSmoothingBins; nEndIndex++) {
-		/* - Reset partial magnitude count */
-		dPartialMag = 0;
-		for (nBinIndex = 0; nBinIndex <= nEndIndex; nBinIndex++) {
-			dKernelElem = adKernel[nBinIndex];
-			adReturn[nEndIndex] += dKernelElem * adData[nEndIndex-nBinIndex];
-			dPartialMag += dKernelElem;
-		}
-		/* - Normalise current point */
-		adReturn[nEndIndex] /= dPartialMag;
+	/* - Convolve up to the length of the kernel, and normalise by the partial kernel */
+	if (STConvBarrier(adData, nDataLength, adKernel, nKernelLength, adReturn)) {
+		mexPrintf("*** ConvBarrier: Couldn't allocate memory for the convolution\n");
+		return;
 	}
 }
 
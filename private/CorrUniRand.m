@@ -1,9 +1,9 @@
-function [mSeq] = CorrUniRand(mCovariance, nSeqLength)
+function [mSeq] = CorrUniRand(mCovariance, nSeqLength, mDecomp)
 
 % CorrUniRand - FUNCTION Generate uniformly-distributed random sequences with specified covariance
 % $Id: CorrUniRand.m 2411 2005-11-07 16:48:24Z dylan $
 %
-% Usage: [mSeq] = CorrUniRand(mCovariance, nSeqLength)
+% Usage: [mSeq] = CorrUniRand(mCovariance, nSeqLength <, mDecomp>)
 %
 % Where: 'mCovariance' is an upper-triangular N x N matrix with unit digonal
 % specifying the correlation structure to generate.  In this matrix, -1
@@ -15,6 +15,11 @@ function [mSeq] = CorrUniRand(mCovariance, nSeqLength)
 % correspond to the rows of 'mCovariance'; the cross-sequence correlations
 % will be given by 'mCovariance'.
 %
+% The optional argument 'mDecomp' is the Cholesky factor of the NORTA
+% covariance matrix, chol(2 * sin(pi * mCovariance / 6)).  If it is supplied,
+% the decomposition is not repeated.  STInstantiate uses this to decompose
+% the covariance once, rather than once for every chunk.
+%
 % This function uses the NORTA method described in
 % [1] Cario and Nelson 1997, "Modeling and Generating Random Vectors with
 % Arbitrary Marginal Distibutions and Correlation Matrix", Northwestern
@@ -32,7 +37,7 @@ RandomGenerator = stO.RandomGenerator;
 
 % -- Check arguments
 
-if (nargin > 2)
+if (nargin > 3)
    disp('--- CorrUniRand: Extra arguments ignored');
 end
 
@@ -68,20 +73,22 @@ end
 
 % -- Construct the NORTA covariance matrix
 
-% - Convert form 'mCovariance' according to transformation described in [1]
-mCovZ = 2 * sin((pi * mCovariance) / 6);
-
-% - Perform a Cholesky decomposition of mCovZ
-try
-   mDecomp = chol(mCovZ);
-
-catch
-   [strMsg, idMsg] = lasterr;
-   
-   if (strcmp(idMsg, 'MATLAB:posdef'))
-      disp('*** CorrUniRand: ''mCovariance'' is not positive definite.  I can''t continue');
-      disp('       under this condition.  Sorry!');
-      return;
+if (~exist('mDecomp', 'var') || isempty(mDecomp))
+   % - Convert form 'mCovariance' according to transformation described in [1]
+   mCovZ = 2 * sin((pi * mCovariance) / 6);
+
+   % - Perform a Cholesky decomposition of mCovZ
+   try
+      mDecomp = chol(mCovZ);
+
+   catch
+      [strMsg, idMsg] = lasterr;
+      
+      if (strcmp(idMsg, 'MATLAB:posdef'))
+         disp('*** CorrUniRand: ''mCovariance'' is not positive definite.  I can''t continue');
+         disp('       under this condition.  Sorry!');
+         return;
+      end
    end
 end
 
@@ -1,11 +1,11 @@
-function [vfNESeq] = MakeNonErgodic(vfRandSeq, fMemTau, fTemporalRes)
+function [vfNESeq, vfFilterState] = MakeNonErgodic(vfRandSeq, fMemTau, fTemporalRes, vfFilterState)
 
 % MakeNonErgodic - FUNCTION (Internal) Give memory to a random sequence
 % $Id: MakeNonErgodic.m 2411 2005-11-07 16:48:24Z dylan $
 %
 % NOT for command-line use.
 
-% Usage: [vfNESeq] = MakeNonErgodic(vfRandSeq, fMemTau, fTemporalRes)
+% Usage: [vfNESeq, vfFilterState] = MakeNonErgodic(vfRandSeq, fMemTau, fTemporalRes <, vfFilterState>)
 %
 % MakeNonErgodic will take an (ergodic, or memoryless) sequence of random
 % numbers and force non-ergodicity with an exponential memory trace.  This
@@ -14,30 +14,29 @@ function [vfNESeq] = MakeNonErgodic(vfRandSeq, fMemTau, fTemporalRes)
 %
 % 'vfRandSeq' is the UNIFORM random sequence to make non-ergodic.  'fMemTau'
 % is the time constant for the exponential filtering, in seconds.  After
-% 'fMemTau' seconds, the memory effect will be reduced to about 35%.  The
-% kernel will extend to around 5 * 'fMemTau' seconds, which corresponds to a
-% memory effect of 0.67%.  'fTemporalRes' is the time step between elements in
-% the random sequence, for both 'vfRandSeq' and 'vfNESeq'.
+% 'fMemTau' seconds, the memory effect will be reduced to about 35%.
+% 'fTemporalRes' is the time step between elements in the random sequence,
+% for both 'vfRandSeq' and 'vfNESeq'.
 %
 % 'vfNESeq' will be a non-ergodic sequence, the same length as 'vfRandSeq',
-% with the memory effect as described above.
+% with the memory effect as described above.  Each element of 'vfNESeq' is
+% still uniformly distributed, so a spike train made from it has the same
+% mean rate as one made from 'vfRandSeq'.
+%
+% The filtering is performed recursively, so the time taken does not depend
+% on 'fMemTau'.  'vfFilterState' returns the state of the filter at the end
+% of the sequence.  If it is passed back to MakeNonErgodic along with the
+% next section of a long random sequence, the memory trace continues across
+% the boundary between the two sections.  If 'vfFilterState' is not
+% supplied, or is empty, the sequence starts with no memory.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 2nd March, 2005
 % Copyright (c) 2005 Dylan Richard Muir
 
-% -- Constants
-
-% - Number of multiples of 'fMemTau' to use to generate the kernel duration
-fKernelDurationFactor = 5;
-
-% - Threshold for warning about smoothing time
-nSmoothWarnThresh = 5000;
-
-
 % -- Check arguments
 
-if (nargin > 3)
+if (nargin > 4)
    disp('--- MakeNonErgodic: Extra arguments ignored');
 end
 
@@ -47,55 +46,37 @@ if (nargin < 3)
    return;
 end
 
+if (~exist('vfFilterState', 'var') || isempty(vfFilterState))
+   % - [fAcc fVar]:  the kernel-weighted sum and its variance
+   vfFilterState = [0 0];
+end
 
-% -- Create exponential kernel for filtering
-
-tKernelDuration = fKernelDurationFactor * fMemTau;
-nNumKernelBins = fix(tKernelDuration / fTemporalRes) + 1;
-
-% - Construct kernel
-tKern = 0:fTemporalRes:tKernelDuration;
-vfKern = exp(-1/fMemTau * tKern);
 
-% -- Note: pure convolution is no good, since we specifically DON'T want
-%    zero-padding at the start of the random sequence.  We'll have to fix the
-%    start ourselves, up to the length of the kernel.
+% -- Filter the sequence with an exponential kernel
 
 % - The smoothing must be done in normal-space, so convert the input sequence
 vfRandSeq = STNormInvCDF(vfRandSeq);
 
-% - Smooth the first part of the array
-nSmoothingEnd = min([nNumKernelBins  length(vfRandSeq)]);
-
-% - Display a warning if the smoothing will take a long time
-if (nSmoothingEnd > nSmoothWarnThresh)
-   disp('--- MakeNonErgodic: Warning: Smoothing is going to take a long time...');
-end
-
-vfPart = ConvBarrier(vfRandSeq, vfKern);
+% - Kernel decay per time step
+fDecay = exp(-fTemporalRes / fMemTau);
 
-% - Normlise the kernel
-vfKern = vfKern ./ sum(vfKern);
+% - Recursive filter:  fAcc(n) = fDecay * fAcc(n-1) + vfRandSeq(n)
+vfAcc = filter(1, [1 -fDecay], vfRandSeq, fDecay * vfFilterState(1));
 
-% - Convolve the rest of the array and append
-vfValid = conv2(vfRandSeq, vfKern, 'valid');
-vfNESeq = [vfPart(1:nSmoothingEnd)  vfValid(2:end)];
+% - Variance of each filtered value, given the samples seen so far
+vnStep = reshape(1:numel(vfRandSeq), size(vfRandSeq));
+vfDecay2 = fDecay .^ (2 .* vnStep);
+vfVar = vfFilterState(2) .* vfDecay2 + (1 - vfDecay2) ./ (1 - fDecay^2);
 
-% -- Renormalise non-ergodic sequence to fix probability extents
 
-% - Get original function extents
-fOrigMin = min(vfRandSeq);
-fOrigMax = max(vfRandSeq);
-fOrigAmp = fOrigMax - fOrigMin;
+% -- Renormalise non-ergodic sequence to unit variance
 
-% - Ignore the only partially smoothed section of the output sequence
-nStartAvg = nSmoothingEnd;
-fNEAmp = max(vfNESeq(nStartAvg+1:end)) - min(vfNESeq(nStartAvg+1:end));
-vfNESeq = vfNESeq ./ fNEAmp .* fOrigAmp;
+vfNESeq = vfAcc ./ sqrt(vfVar);
 
-% - Make sure nothing sticks out
-%vfNESeq(find(vfNESeq > fOrigMax)) = fOrigMax;
-%vfNESeq(find(vfNESeq < fOrigMin)) = fOrigMin;
+% - Return the filter state
+if (~isempty(vfAcc))
+   vfFilterState = [vfAcc(end) vfVar(end)];
+end
 
 % - Convert back to uniform space
 vfNESeq = STNormCDF(vfNESeq);
@@ -0,0 +1,495 @@
+/* MersenneTwister.h - Reentrant MT19937 generator, with jump-ahead
+ * $Id: MersenneTwister.h $
+ *
+ * NOT for command-line use
+ *
+ * This header contains the Mersenne Twister code used by twister.cpp, with
+ * the generator state held in an 'mt_state' structure instead of in global
+ * variables.  Any number of generators can therefore be used at once, for
+ * example one per thread inside a MEX function.
+ *
+ * mt_jump() advances a generator by 2^nLog2Steps 32-bit outputs in time
+ * proportional to the size of the state (rather than to the number of
+ * steps).  This is done with the polynomial method of Haramoto et al.:  the
+ * characteristic polynomial phi(x) of the MT19937 recurrence is found with
+ * the Berlekamp-Massey algorithm, x^(2^nLog2Steps) mod phi(x) is found by
+ * repeated squaring, and the resulting polynomial in the transition matrix
+ * is applied to the state by Horner's rule.  mt_substreams() uses this to
+ * derive non-overlapping substreams from a single master seed, so that
+ * parallel generation is reproducible regardless of how work is shared
+ * between threads.
+ *
+ * Both polynomials are kept in an 'mt_jump_cache' owned by the caller, and
+ * are only computed again when the jump size changes.  The header has no
+ * global state, so threads which jump generators at the same time must each
+ * use their own cache.  A zero-initialised cache is empty.  The jump
+ * functions return zero on success, and non-zero if memory for the
+ * polynomial computation could not be allocated.
+ *
+ * Reference: H. Haramoto, M. Matsumoto, T. Nishimura, F. Panneton and
+ * P. L'Ecuyer, "Efficient Jump Ahead for F2-Linear Random Number
+ * Generators", INFORMS Journal on Computing, Vol. 20, No. 3, 2008,
+ * pp 385--390.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026 (from twister.cpp by Dylan Muir)
+ */
+
+/*
+   A C-program for MT19937, with initialization improved 2002/1/26.
+   Coded by Takuji Nishimura and Makoto Matsumoto.
+
+   Before using, initialize the state by using init_genrand(seed)
+   or init_by_array(init_key, key_length).
+
+   Copyright (C) 1997 - 2002, Makoto Matsumoto and Takuji Nishimura,
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+     1. Redistributions of source code must retain the above copyright
+        notice, this list of conditions and the following disclaimer.
+
+     2. Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimer in the
+        documentation and/or other materials provided with the distribution.
+
+     3. The names of its contributors may not be used to endorse or promote
+        products derived from this software without specific prior written
+        permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+   Any feedback is very welcome.
+   http://www.math.keio.ac.jp/matumoto/emt.html
+   email: matumoto@math.keio.ac.jp
+*/
+
+#ifndef MERSENNE_TWISTER_H
+#define MERSENNE_TWISTER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/****************************************************************************
+ *
+ * Mersenne Twister code:
+ */
+
+/* Period parameters */
+#define MT_N 624
+#define MT_M 397
+#define MT_MATRIX_A 0x9908b0dfUL   /* constant vector a */
+#define MT_UPPER_MASK 0x80000000UL /* most significant w-r bits */
+#define MT_LOWER_MASK 0x7fffffffUL /* least significant r bits */
+
+/* Degree of the MT19937 characteristic polynomial */
+#define MT_MEXP 19937
+
+/* Default jump size for substreams, as log2 of the number of 32-bit outputs */
+#define MT_DEFAULT_LOG2_JUMP 128
+
+typedef struct {
+    uint32_t mt[MT_N];  /* the array for the state vector  */
+    int mti;            /* mti==MT_N+1 means mt[MT_N] is not initialized */
+} mt_state;
+
+/* initializes mt[N] with a seed */
+static inline void init_genrand(mt_state *state, uint32_t s)
+{
+    uint32_t *mt = state->mt;
+    int mti;
+
+    mt[0]= s;
+    for (mti=1; mti<MT_N; mti++) {
+        mt[mti] =
+	    (1812433253UL * (mt[mti-1] ^ (mt[mti-1] >> 30)) + mti);
+        /* See Knuth TAOCP Vol2. 3rd Ed. P.106 for multiplier. */
+        /* In the previous versions, MSBs of the seed affect   */
+        /* only MSBs of the array mt[].                        */
+        /* 2002/01/09 modified by Makoto Matsumoto             */
+    }
+    state->mti = MT_N;
+}
+
+/* initialize by an array with array-length */
+/* init_key is the array for initializing keys */
+/* key_length is its length */
+static inline void init_by_array(mt_state *state, const uint32_t init_key[], int key_length)
+{
+    uint32_t *mt = state->mt;
+    int i, j, k;
+    init_genrand(state, 19650218UL);
+    i=1; j=0;
+    k = (MT_N>key_length ? MT_N : key_length);
+    for (; k; k--) {
+        mt[i] = (mt[i] ^ ((mt[i-1] ^ (mt[i-1] >> 30)) * 1664525UL))
+          + init_key[j] + j; /* non linear */
+        i++; j++;
+        if (i>=MT_N) { mt[0] = mt[MT_N-1]; i=1; }
+        if (j>=key_length) j=0;
+    }
+    for (k=MT_N-1; k; k--) {
+        mt[i] = (mt[i] ^ ((mt[i-1] ^ (mt[i-1] >> 30)) * 1566083941UL))
+          - i; /* non linear */
+        i++;
+        if (i>=MT_N) { mt[0] = mt[MT_N-1]; i=1; }
+    }
+
+    mt[0] = 0x80000000UL; /* MSB is 1; assuring non-zero initial array */
+}
+
+/* generates N words at one time */
+static inline void mt_next_state(mt_state *state)
+{
+    static const uint32_t mag01[2]={0x0UL, MT_MATRIX_A};
+    /* mag01[x] = x * MATRIX_A  for x=0,1 */
+    uint32_t *mt = state->mt, y;
+    int kk;
+
+    for (kk=0;kk<MT_N-MT_M;kk++) {
+        y = (mt[kk]&MT_UPPER_MASK)|(mt[kk+1]&MT_LOWER_MASK);
+        mt[kk] = mt[kk+MT_M] ^ (y >> 1) ^ mag01[y & 0x1UL];
+    }
+    for (;kk<MT_N-1;kk++) {
+        y = (mt[kk]&MT_UPPER_MASK)|(mt[kk+1]&MT_LOWER_MASK);
+        mt[kk] = mt[kk+(MT_M-MT_N)] ^ (y >> 1) ^ mag01[y & 0x1UL];
+    }
+    y = (mt[MT_N-1]&MT_UPPER_MASK)|(mt[0]&MT_LOWER_MASK);
+    mt[MT_N-1] = mt[MT_M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
+
+    state->mti = 0;
+}
+
+/* generates a random number on [0,0xffffffff]-interval */
+static inline uint32_t genrand_int32(mt_state *state)
+{
+    uint32_t y;
+
+    if (state->mti >= MT_N) { /* generate N words at one time */
+        if (state->mti == MT_N+1)   /* if init_genrand() has not been called, */
+            init_genrand(state, 5489UL); /* a default initial seed is used */
+
+        mt_next_state(state);
+    }
+
+    y = state->mt[state->mti++];
+
+    /* Tempering */
+    y ^= (y >> 11);
+    y ^= (y << 7) & 0x9d2c5680UL;
+    y ^= (y << 15) & 0xefc60000UL;
+    y ^= (y >> 18);
+
+    return y;
+}
+
+/* generates a random number on [0,1]-real-interval */
+static inline double genrand_real1(mt_state *state)
+{
+    return genrand_int32(state)*(1.0/4294967295.0);
+    /* divided by 2^32-1 */
+}
+
+/* generates a random number on [0,1)-real-interval */
+static inline double genrand_real2(mt_state *state)
+{
+    return genrand_int32(state)*(1.0/4294967296.0);
+    /* divided by 2^32 */
+}
+
+/* generates a random number on (0,1)-real-interval */
+static inline double genrand_real3(mt_state *state)
+{
+    return (((double)genrand_int32(state)) + 0.5)*(1.0/4294967296.0);
+    /* divided by 2^32 */
+}
+
+/* generates a random number on [0,1) with 53-bit resolution*/
+static inline double genrand_res53(mt_state *state)
+{
+    uint32_t a=genrand_int32(state)>>5, b=genrand_int32(state)>>6;
+    return(a*67108864.0+b)*(1.0/9007199254740992.0);
+}
+/* These real versions are due to Isaku Wada, 2002/01/09 added */
+
+
+/****************************************************************************
+ *
+ * Jump-ahead code:
+ *
+ * Polynomials over GF(2) are stored as arrays of 64-bit words, with the
+ * coefficient of x^i in bit (i % 64) of word (i / 64).
+ */
+
+#define MT_POLY_WORDS ((2*MT_MEXP + 63) / 64 + 1)
+
+typedef struct {
+    uint32_t s[MT_N];   /* Circular buffer of the last N words generated */
+    int i;              /* Index of the oldest word */
+} mt_ring;
+
+/* - Advance a ring state by one word.  This is the MT19937 recurrence, and is
+ *   linear over GF(2) */
+static inline void mt_ring_step(mt_ring *r)
+{
+    static const uint32_t mag01[2]={0x0UL, MT_MATRIX_A};
+    int i = r->i, i1 = (i+1) % MT_N, iM = (i+MT_M) % MT_N;
+    uint32_t y = (r->s[i]&MT_UPPER_MASK)|(r->s[i1]&MT_LOWER_MASK);
+
+    r->s[i] = r->s[iM] ^ (y >> 1) ^ mag01[y & 0x1UL];
+    r->i = i1;
+}
+
+/* - dst ^= src << nShift, over 'nWords' words of 'dst' */
+static inline void mt_poly_xor_shifted(uint64_t *dst, const uint64_t *src, int nSrcWords, int nShift)
+{
+    int nWordShift = nShift / 64, nBitShift = nShift % 64, w;
+
+    if (nBitShift == 0) {
+        for (w = 0; w < nSrcWords; w++) dst[w + nWordShift] ^= src[w];
+    } else {
+        for (w = 0; w < nSrcWords; w++) {
+            dst[w + nWordShift] ^= src[w] << nBitShift;
+            dst[w + nWordShift + 1] ^= src[w] >> (64 - nBitShift);
+        }
+    }
+}
+
+/* - Find the characteristic polynomial of the MT19937 recurrence, with the
+ *   Berlekamp-Massey algorithm over GF(2).  'phi' must hold MT_POLY_WORDS
+ *   words.  Returns the degree of the polynomial found (MT_MEXP), or -1 if
+ *   an allocation failed */
+static inline int mt_char_poly(uint64_t *phi)
+{
+    const int nSeqLength = 2*MT_MEXP;
+    const int nSeqWords = (nSeqLength + 63) / 64 + 2;
+    uint64_t *seqRev, *C, *B, *Tmp;
+    mt_state state;
+    mt_ring ring;
+    int n, L = 0, m = 1, w, nLenC = 1, nLenB = 1, nLenT;
+
+    seqRev = (uint64_t *) calloc(nSeqWords, sizeof(uint64_t));
+    C = (uint64_t *) calloc(MT_POLY_WORDS, sizeof(uint64_t));
+    B = (uint64_t *) calloc(MT_POLY_WORDS, sizeof(uint64_t));
+    Tmp = (uint64_t *) calloc(MT_POLY_WORDS, sizeof(uint64_t));
+
+    if ((seqRev == NULL) || (C == NULL) || (B == NULL) || (Tmp == NULL)) {
+        free(seqRev); free(C); free(B); free(Tmp);
+        return -1;
+    }
+
+    /* - Generate a sequence of bits from the recurrence, stored reversed so
+     *   that the window s(n-1), s(n-2), ... is contiguous in memory */
+    init_genrand(&state, 5489UL);
+    memcpy(ring.s, state.mt, sizeof(ring.s));
+    ring.i = 0;
+    for (n = 0; n < nSeqLength; n++) {
+        int nRev = nSeqLength - 1 - n;
+        mt_ring_step(&ring);
+        if (ring.s[(ring.i + MT_N - 1) % MT_N] & 0x80000000UL) {
+            seqRev[nRev / 64] |= (uint64_t) 1 << (nRev % 64);
+        }
+    }
+
+    /* - Berlekamp-Massey: C(x) = 1 + c1 x + ... + cL x^L */
+    C[0] = B[0] = 1;
+    for (n = 0; n < nSeqLength; n++) {
+        /* - Discrepancy d = s(n) + sum(c(i) s(n-i), i = 1..L) */
+        int nBase = nSeqLength - 1 - n;     /* Reversed index of s(n) */
+        uint64_t d = 0;
+        for (w = 0; w <= L / 64; w++) {
+            int nBit = nBase + 64*w, nW = nBit / 64, nB = nBit % 64;
+            uint64_t window = seqRev[nW] >> nB;
+            if (nB) window |= seqRev[nW + 1] << (64 - nB);
+            d ^= C[w] & window;
+        }
+        d ^= d >> 32; d ^= d >> 16; d ^= d >> 8; d ^= d >> 4; d ^= d >> 2; d ^= d >> 1;
+
+        if ((d & 1) == 0) {
+            m++;
+        } else if (2*L <= n) {
+            nLenT = nLenC;
+            memcpy(Tmp, C, nLenC * sizeof(uint64_t));
+            mt_poly_xor_shifted(C, B, nLenB, m);
+            L = n + 1 - L;
+            nLenC = L / 64 + 1;
+            memcpy(B, Tmp, nLenT * sizeof(uint64_t));
+            memset(B + nLenT, 0, (MT_POLY_WORDS - nLenT) * sizeof(uint64_t));
+            nLenB = nLenT;
+            m = 1;
+        } else {
+            mt_poly_xor_shifted(C, B, nLenB, m);
+            m++;
+        }
+    }
+
+    /* - phi(x) = x^L C(1/x) */
+    memset(phi, 0, MT_POLY_WORDS * sizeof(uint64_t));
+    for (n = 0; n <= L; n++) {
+        if ((C[n / 64] >> (n % 64)) & 1) {
+            int j = L - n;
+            phi[j / 64] |= (uint64_t) 1 << (j % 64);
+        }
+    }
+
+    free(seqRev); free(C); free(B); free(Tmp);
+    return L;
+}
+
+/* - Find x^(2^nLog2Steps) mod phi(x), by repeated squaring.  Returns
+ *   non-zero if an allocation failed */
+static inline int mt_jump_poly(uint64_t *jump, const uint64_t *phi, int nLog2Steps)
+{
+    uint64_t *sq = (uint64_t *) calloc(MT_POLY_WORDS, sizeof(uint64_t));
+    const int nPhiWords = MT_MEXP / 64 + 1;
+    int k, w, nBit;
+
+    if (sq == NULL) return 1;
+
+    /* - Start from x */
+    memset(jump, 0, MT_POLY_WORDS * sizeof(uint64_t));
+    jump[0] = 2;
+
+    for (k = 0; k < nLog2Steps; k++) {
+        /* - Square: over GF(2), bit i moves to bit 2i */
+        memset(sq, 0, MT_POLY_WORDS * sizeof(uint64_t));
+        for (w = 0; w < nPhiWords; w++) {
+            uint64_t v = jump[w];
+            uint64_t lo = 0, hi = 0;
+            int b;
+            for (b = 0; b < 32; b++) {
+                lo |= ((v >> b) & 1) << (2*b);
+                hi |= ((v >> (b + 32)) & 1) << (2*b);
+            }
+            sq[2*w] = lo;
+            if (2*w + 1 < MT_POLY_WORDS) sq[2*w + 1] = hi;
+        }
+
+        /* - Reduce modulo phi, from the highest bit down */
+        for (nBit = 2*(MT_MEXP-1); nBit >= MT_MEXP; nBit--) {
+            if ((sq[nBit / 64] >> (nBit % 64)) & 1) {
+                mt_poly_xor_shifted(sq, phi, nPhiWords, nBit - MT_MEXP);
+            }
+        }
+
+        memcpy(jump, sq, nPhiWords * sizeof(uint64_t));
+        memset(jump + nPhiWords, 0, (MT_POLY_WORDS - nPhiWords) * sizeof(uint64_t));
+    }
+
+    free(sq);
+    return 0;
+}
+
+/* - Apply a jump polynomial to a generator state, by Horner's rule.  The
+ *   generator's position within its current block of outputs is preserved */
+static inline void mt_apply_jump_poly(mt_state *state, const uint64_t *jump)
+{
+    mt_ring src, acc;
+    int nBit, k;
+
+    if (state->mti == MT_N+1) init_genrand(state, 5489UL);
+
+    /* - The state block is the last N words of the output stream */
+    memcpy(src.s, state->mt, sizeof(src.s));
+    src.i = 0;
+    memset(&acc, 0, sizeof(acc));
+
+    for (nBit = MT_MEXP-1; nBit >= 0; nBit--) {
+        mt_ring_step(&acc);
+        if ((jump[nBit / 64] >> (nBit % 64)) & 1) {
+            for (k = 0; k < MT_N; k++) {
+                acc.s[(acc.i + k) % MT_N] ^= src.s[k];
+            }
+        }
+    }
+
+    for (k = 0; k < MT_N; k++) {
+        state->mt[k] = acc.s[(acc.i + k) % MT_N];
+    }
+}
+
+/* - Polynomials for jumping generators, computed on first use.  A
+ *   zero-initialised cache is empty */
+typedef struct {
+    uint64_t phi[MT_POLY_WORDS];    /* Characteristic polynomial */
+    uint64_t jump[MT_POLY_WORDS];   /* x^(2^nLog2Steps) mod phi(x) */
+    int bHavePhi;                   /* 'phi' has been computed */
+    int bHaveJump;                  /* 'jump' is for 'nLog2Steps' */
+    int nLog2Steps;
+} mt_jump_cache;
+
+/* - Return the jump polynomial for 2^nLog2Steps outputs, computing it in
+ *   'cache' if needed.  Returns NULL if an allocation failed */
+static inline const uint64_t *mt_get_jump_poly(mt_jump_cache *cache, int nLog2Steps)
+{
+    if (!cache->bHavePhi) {
+        if (mt_char_poly(cache->phi) < 0) return NULL;
+        cache->bHavePhi = 1;
+    }
+
+    if (!cache->bHaveJump || (cache->nLog2Steps != nLog2Steps)) {
+        cache->bHaveJump = 0;
+        if (mt_jump_poly(cache->jump, cache->phi, nLog2Steps)) return NULL;
+        cache->nLog2Steps = nLog2Steps;
+        cache->bHaveJump = 1;
+    }
+
+    return cache->jump;
+}
+
+/* - Advance a generator by 2^nLog2Steps calls to genrand_int32().  Returns
+ *   non-zero, leaving the generator unchanged, if an allocation failed */
+static inline int mt_jump(mt_state *state, mt_jump_cache *cache, int nLog2Steps)
+{
+    const uint64_t *jump = mt_get_jump_poly(cache, nLog2Steps);
+
+    if (jump == NULL) return 1;
+    mt_apply_jump_poly(state, jump);
+    return 0;
+}
+
+/* - Fill 'streams' with 'nNumStreams' generators, the first a copy of
+ *   'master' and each subsequent one 2^nLog2Steps outputs further along.
+ *   Returns non-zero if an allocation failed */
+static inline int mt_substreams(mt_state *streams, int nNumStreams, const mt_state *master,
+                                mt_jump_cache *cache, int nLog2Steps)
+{
+    const uint64_t *jump;
+    int n;
+
+    if (nNumStreams < 1) return 0;
+
+    jump = mt_get_jump_poly(cache, nLog2Steps);
+    if (jump == NULL) return 1;
+
+    streams[0] = *master;
+    if (streams[0].mti == MT_N+1) init_genrand(&streams[0], 5489UL);
+
+    for (n = 1; n < nNumStreams; n++) {
+        streams[n] = streams[n-1];
+        mt_apply_jump_poly(&streams[n], jump);
+    }
+
+    return 0;
+}
+
+#endif
+
+/* --- END of MersenneTwister.h --- */
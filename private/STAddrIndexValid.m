@@ -0,0 +1,41 @@
+function [bValid] = STAddrIndexValid(node)
+
+% STAddrIndexValid - FUNCTION (Internal) Test the address index of a mapping node
+% $Id: STAddrIndexValid.m $
+%
+% NOT for command-line use
+
+% Usage: [bValid] = STAddrIndexValid(node)
+%
+% STAddrIndexValid returns true if the mapping 'node' has an address index
+% (see STIndexAddresses), and the chunks of its spike list still have the
+% lengths recorded in the index.
+%
+% The index is kept valid explicitly, not detected: STCrop rebuilds it for
+% the spikes it keeps, STShift and STNormalise keep it since they only move
+% spikes in time, and every other toolbox function which builds a mapping
+% from a copy of another removes it.  This test is only a guard against a
+% spike list edited by hand, and can't detect an edit which leaves the
+% length of every chunk unchanged.
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+bValid = false;
+
+if (~isfield(node, 'stAddrIndex') || ~isfield(node, 'spikeList'))
+   return;
+end
+
+if (node.bChunkedMode)
+   spikeList = node.spikeList;
+else
+   spikeList = {node.spikeList};
+end
+
+vnChunkLengths = reshape(CellForEach(@size, spikeList, 1), [], 1);
+bValid = isequal(node.stAddrIndex.vnChunkStarts(:), [0; cumsum(vnChunkLengths)]) && ...
+         (numel(node.stAddrIndex.vnPostings) == sum(vnChunkLengths));
+
+% --- END of STAddrIndexValid.m ---
@@ -0,0 +1,51 @@
+function [stasSpecification] = STAddrSpecDecode(strSpec)
+
+% STAddrSpecDecode - FUNCTION (Internal) Decode an addressing specification from text
+% $Id: STAddrSpecDecode.m $
+%
+% NOT for command-line use
+
+% Usage: [stasSpecification] = STAddrSpecDecode(strSpec)
+%
+% STAddrSpecDecode reads an addressing specification written by
+% STAddrSpecEncode.  An empty string gives an empty specification.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Split the text into fields
+
+stasSpecification = [];
+cstrLines = regexp(strSpec, '\n', 'split');
+nFieldIndex = 0;
+
+for (nLineIndex = 1:length(cstrLines))
+   if (isempty(cstrLines{nLineIndex}))
+      continue;
+   end
+
+   cstrValues = regexp(cstrLines{nLineIndex}, '\t', 'split');
+
+   if (length(cstrValues) ~= 8)
+      disp('*** STAddrSpecDecode: Invalid addressing specification text');
+      stasSpecification = [];
+      return;
+   end
+
+   % - Build the field
+   nFieldIndex = nFieldIndex + 1;
+   stasSpecification(nFieldIndex).Description = cstrValues{1};
+   stasSpecification(nFieldIndex).nWidth = str2double(cstrValues{2});
+   stasSpecification(nFieldIndex).bReverse = logical(str2double(cstrValues{3}));
+   stasSpecification(nFieldIndex).bInvert = logical(str2double(cstrValues{4}));
+   stasSpecification(nFieldIndex).bMajorField = logical(str2double(cstrValues{5}));
+   stasSpecification(nFieldIndex).bRangeCheck = logical(str2double(cstrValues{6}));
+   stasSpecification(nFieldIndex).bIgnore = logical(str2double(cstrValues{7}));
+
+   if (~isempty(cstrValues{8}))
+      stasSpecification(nFieldIndex).nMax = str2double(cstrValues{8});
+   end
+end
+
+% --- END of STAddrSpecDecode.m ---
@@ -0,0 +1,47 @@
+function [strSpec] = STAddrSpecEncode(stasSpecification)
+
+% STAddrSpecEncode - FUNCTION (Internal) Encode an addressing specification as text
+% $Id: STAddrSpecEncode.m $
+%
+% NOT for command-line use
+
+% Usage: [strSpec] = STAddrSpecEncode(stasSpecification)
+%
+% STAddrSpecEncode writes each field of the addressing specification
+% 'stasSpecification' as a line of tab-separated values:
+%    Description nWidth bReverse bInvert bMajorField bRangeCheck bIgnore nMax
+% 'nMax' is left empty for fields without one.  The text can be turned back
+% into a specification with STAddrSpecDecode.  It is used by STTrainSave to
+% store specifications in spike train files.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Fill in defaults, so that every field has a value
+
+stasSpecification = STAddrSpecFill(stasSpecification);
+
+
+% -- Encode each field
+
+strSpec = '';
+
+for (nFieldIndex = 1:length(stasSpecification))
+   stField = stasSpecification(nFieldIndex);
+
+   % - Tabs and line breaks separate values
+   strDescription = regexprep(stField.Description, '[\t\r\n]', ' ');
+
+   if (FieldExists(stField, 'nMax'))
+      strMax = sprintf('%.17g', stField.nMax);
+   else
+      strMax = '';
+   end
+
+   strSpec = [strSpec sprintf('%s\t%d\t%d\t%d\t%d\t%d\t%d\t%s\n', strDescription, stField.nWidth, ...
+                              stField.bReverse, stField.bInvert, stField.bMajorField, ...
+                              stField.bRangeCheck, stField.bIgnore, strMax)];
+end
+
+% --- END of STAddrSpecEncode.m ---
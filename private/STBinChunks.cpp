@@ -0,0 +1,229 @@
+/* STBinChunks - FUNCTION (Internal) Count the spikes of a spike list in consecutive time windows
+ * $Id: STBinChunks.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [mCounts, vKey] = STBinChunks(cChunks, fTimeScale, tTimeWindow, nNumWindows <, bAddresses, nNumThreads>)
+ *
+ * 'cChunks' is a cell array of spike list chunks.  The first column of each
+ * chunk holds spike times, in units of 'fTimeScale' seconds: for a mapping,
+ * the ticks and the temporal resolution of the mapping; for an instance, the
+ * spike times and 1.  Window 'n' (zero-based) spans [n, n+1] * 'tTimeWindow'
+ * seconds, including both ends, so a spike falling exactly on the boundary
+ * between two windows is counted in both, as STProfileCount does.
+ *
+ * If 'bAddresses' is false (the default), 'mCounts' is an 'nNumWindows'x1
+ * vector of spike counts, and 'vKey' is empty.  If 'bAddresses' is true, the
+ * second column of each chunk holds spike addresses.  'vKey' is then a Kx1
+ * vector of every address in the spike list, sorted, and 'mCounts' is an
+ * 'nNumWindows'xK matrix, where column k counts the spikes with address
+ * vKey(k).
+ *
+ * Each spike is visited once: its window is found by division, and the
+ * neighbouring windows are tested so that spikes on a boundary are counted
+ * exactly as the comparisons in STProfileCount count them.  The chunks are
+ * split into pieces of at most BIN_BLOCK spikes, which are counted over
+ * 'nNumThreads' threads (by default, one per hardware thread).  Each piece is
+ * counted into a histogram covering only the windows its spikes span, which
+ * is then added to the result.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 17th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STThreadPool.h"
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+
+/* - Largest number of spikes counted as one piece of work */
+#define BIN_BLOCK          65536
+
+
+/* - One piece of a chunk */
+struct BinPiece {
+   const double   *adTimes, *adAddrs;
+   size_t         nCount;
+};
+
+/* - The histogram being built */
+struct BinResult {
+   double               fTimeScale, tTimeWindow;
+   ptrdiff_t            nNumWindows;
+   std::vector<double>  vfKey;
+   double               *adCounts;
+   std::mutex           mutexCounts;
+};
+
+
+/* --- FindWindow - Window holding the time 'tSpike', clamped to [-1, nNumWindows] */
+static inline ptrdiff_t FindWindow(double tSpike, const BinResult &result)
+{
+   double fWindow = floor(tSpike / result.tTimeWindow);
+
+   if (!(fWindow >= -1)) return -1;
+   if (fWindow > (double) result.nNumWindows) return result.nNumWindows;
+   return (ptrdiff_t) fWindow;
+}
+
+/* --- InWindow - True if 'tSpike' lies in window 'nWindow', including both ends */
+static inline bool InWindow(double tSpike, ptrdiff_t nWindow, const BinResult &result)
+{
+   return ((double) nWindow * result.tTimeWindow <= tSpike) && (tSpike <= (double) (nWindow + 1) * result.tTimeWindow);
+}
+
+
+/* --- CountPiece - Count the spikes of one piece, and add them to the result */
+static void CountPiece(const BinPiece &piece, BinResult &result)
+{
+   const size_t         nNumKeys = result.vfKey.empty() ? 1 : result.vfKey.size();
+   ptrdiff_t            nFirst = result.nNumWindows, nLast = -1, nWindow, nTest;
+   std::vector<double>  vfLocal;
+   std::vector<size_t>  vnKey;
+   size_t               nSpike, nKey;
+
+   /* - Find the windows this piece spans */
+   for (nSpike = 0; nSpike < piece.nCount; nSpike++) {
+      nWindow = FindWindow(piece.adTimes[nSpike] * result.fTimeScale, result);
+      nFirst = std::min(nFirst, nWindow - 1);
+      nLast = std::max(nLast, nWindow + 1);
+   }
+   nFirst = std::max(nFirst, (ptrdiff_t) 0);
+   nLast = std::min(nLast, result.nNumWindows - 1);
+   if (nLast < nFirst) return;
+
+   /* - Count into a histogram of just those windows */
+   const size_t nLocalWindows = (size_t) (nLast - nFirst + 1);
+   vfLocal.assign(nLocalWindows * nNumKeys, 0);
+
+   for (nSpike = 0; nSpike < piece.nCount; nSpike++) {
+      double tSpike = piece.adTimes[nSpike] * result.fTimeScale;
+
+      nKey = 0;
+      if (!result.vfKey.empty()) {
+         nKey = std::lower_bound(result.vfKey.begin(), result.vfKey.end(), piece.adAddrs[nSpike]) - result.vfKey.begin();
+      }
+
+      /* - Test the neighbouring windows too, to match the boundary test exactly */
+      nWindow = FindWindow(tSpike, result);
+      for (nTest = std::max(nFirst, nWindow - 1); nTest <= std::min(nLast, nWindow + 1); nTest++) {
+         if (InWindow(tSpike, nTest, result)) vfLocal[nKey * nLocalWindows + (size_t) (nTest - nFirst)]++;
+      }
+   }
+
+   /* - Add the histogram to the result */
+   std::lock_guard<std::mutex> lock(result.mutexCounts);
+
+   for (nKey = 0; nKey < nNumKeys; nKey++) {
+      double         *adCounts = result.adCounts + nKey * (size_t) result.nNumWindows + nFirst;
+      const double   *adLocal = vfLocal.data() + nKey * nLocalWindows;
+
+      for (size_t nLocal = 0; nLocal < nLocalWindows; nLocal++) adCounts[nLocal] += adLocal[nLocal];
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   std::vector<BinPiece>   vPieces;
+   BinResult               result;
+   bool                    bAddresses = false;
+   unsigned                nNumThreads = STDefaultNumThreads();
+   size_t                  nNumChunks, nChunk, nNumKeys;
+
+   /* - Check usage */
+   if ((nlhs > 2) || (nrhs < 4) || (nrhs > 6) || !mxIsCell(prhs[0])) {
+      mexPrintf("*** STBinChunks: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STBinChunks");
+      return;
+   }
+
+   result.fTimeScale = mxGetScalar(prhs[1]);
+   result.tTimeWindow = mxGetScalar(prhs[2]);
+   if (!(result.tTimeWindow > 0)) {
+      mexErrMsgIdAndTxt("STBinChunks:InvalidArgument", "*** STBinChunks: The time window must be positive");
+   }
+
+   if (!(mxGetScalar(prhs[3]) >= 0) || (mxGetScalar(prhs[3]) > 1e12)) {
+      mexErrMsgIdAndTxt("STBinChunks:InvalidArgument", "*** STBinChunks: Invalid number of windows");
+   }
+   result.nNumWindows = (ptrdiff_t) mxGetScalar(prhs[3]);
+
+   if ((nrhs > 4) && !mxIsEmpty(prhs[4])) bAddresses = (mxGetScalar(prhs[4]) != 0);
+
+   if ((nrhs > 5) && !mxIsEmpty(prhs[5]) && (mxGetScalar(prhs[5]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[5]);
+   }
+
+   /* - Split the non-empty chunks into pieces */
+   nNumChunks = mxGetNumberOfElements(prhs[0]);
+   for (nChunk = 0; nChunk < nNumChunks; nChunk++) {
+      const mxArray  *pChunk = mxGetCell(prhs[0], nChunk);
+      size_t         nCount;
+      const double   *adTimes;
+
+      if ((pChunk == NULL) || mxIsEmpty(pChunk)) continue;
+
+      if (!mxIsDouble(pChunk) || mxIsComplex(pChunk) || (bAddresses && (mxGetN(pChunk) < 2))) {
+         mexErrMsgIdAndTxt("STBinChunks:InvalidSpikeList",
+                           "*** STBinChunks: Chunks must be real double spike lists, with two columns for addresses");
+      }
+
+      nCount = mxGetM(pChunk);
+      adTimes = mxGetPr(pChunk);
+
+      for (size_t nFirst = 0; nFirst < nCount; nFirst += BIN_BLOCK) {
+         BinPiece piece;
+
+         piece.adTimes = adTimes + nFirst;
+         piece.adAddrs = bAddresses ? adTimes + nCount + nFirst : NULL;
+         piece.nCount = std::min((size_t) BIN_BLOCK, nCount - nFirst);
+         vPieces.push_back(piece);
+      }
+   }
+
+   /* - Collect every address, sorted, for the columns of the result */
+   if (bAddresses) {
+      std::vector< std::vector<double> > vvfKeys(vPieces.size());
+
+      STParallelFor(vPieces.size(), nNumThreads, [&](size_t nPiece, unsigned) {
+         std::vector<double> &vfKeys = vvfKeys[nPiece];
+
+         vfKeys.assign(vPieces[nPiece].adAddrs, vPieces[nPiece].adAddrs + vPieces[nPiece].nCount);
+         std::sort(vfKeys.begin(), vfKeys.end());
+         vfKeys.erase(std::unique(vfKeys.begin(), vfKeys.end()), vfKeys.end());
+      });
+
+      for (size_t nPiece = 0; nPiece < vvfKeys.size(); nPiece++) {
+         result.vfKey.insert(result.vfKey.end(), vvfKeys[nPiece].begin(), vvfKeys[nPiece].end());
+      }
+      std::sort(result.vfKey.begin(), result.vfKey.end());
+      result.vfKey.erase(std::unique(result.vfKey.begin(), result.vfKey.end()), result.vfKey.end());
+   }
+
+   nNumKeys = bAddresses ? result.vfKey.size() : 1;
+   plhs[0] = mxCreateDoubleMatrix(result.nNumWindows, nNumKeys, mxREAL);
+   result.adCounts = mxGetPr(plhs[0]);
+
+   /* - Count each piece */
+   if ((result.nNumWindows > 0) && (nNumKeys > 0)) {
+      STParallelFor(vPieces.size(), nNumThreads, [&](size_t nPiece, unsigned) {
+         CountPiece(vPieces[nPiece], result);
+      });
+   }
+
+   if (nlhs > 1) {
+      plhs[1] = mxCreateDoubleMatrix(result.vfKey.size(), bAddresses ? 1 : 0, mxREAL);
+      std::copy(result.vfKey.begin(), result.vfKey.end(), mxGetPr(plhs[1]));
+   }
+}
+
+/* --- END of STBinChunks.cpp --- */
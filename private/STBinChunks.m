@@ -0,0 +1,33 @@
+function [mCounts, vKey] = STBinChunks(cChunks, fTimeScale, tTimeWindow, nNumWindows, bAddresses, nNumThreads)
+
+% STBinChunks - FUNCTION (Internal) Count the spikes of a spike list in consecutive time windows
+% $Id: STBinChunks.m $
+%
+% NOT for command-line use
+
+% Usage: [mCounts, vKey] = STBinChunks(cChunks, fTimeScale, tTimeWindow, nNumWindows <, bAddresses, nNumThreads>)
+%
+% 'cChunks' is a cell array of spike list chunks, whose first columns hold
+% spike times in units of 'fTimeScale' seconds.  STBinChunks counts the spikes
+% in each of 'nNumWindows' consecutive windows of 'tTimeWindow' seconds,
+% counting a spike on the boundary between two windows in both, as
+% STProfileCount does.  If 'bAddresses' is true, the second column of each
+% chunk holds addresses; 'vKey' returns every address, sorted, and 'mCounts'
+% has one column of counts for each.  Every spike is visited once, and the
+% chunks are counted over 'nNumThreads' threads, by default one per hardware
+% thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STBinChunks.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STBinChunks: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STBinChunks.m ---
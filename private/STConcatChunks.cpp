@@ -0,0 +1,199 @@
+/* STConcatChunks - FUNCTION (Internal) Concatenate spike train segments end-to-end into new chunks
+ * $Id: STConcatChunks.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [cCatList] = STConcatChunks(cChunks, vnSegment, vfOffset, vfTemporalResolution, fTemporalResolution, nChunkLength, bMapping <, nNumThreads>)
+ *
+ * 'cChunks' is a cell array of spike list chunks, taken from a number of
+ * spike train segments in order.  'vnSegment' gives the (1-based) segment of
+ * each chunk, 'vfOffset' the time offset of each segment, and
+ * 'vfTemporalResolution' the temporal resolution of each segment.  If
+ * 'bMapping' is true, each chunk is an Nx2 [tick addr] mapping spike list; its
+ * ticks are rescaled exactly to 'fTemporalResolution', as
+ * floor(tick * res_i / res) (see STTicks.h), and the segment's offset in ticks
+ * is then added.  Otherwise each chunk is a vector of spike times in seconds
+ * from an instance, and the segment's offset in seconds is added.
+ *
+ * STConcatChunks returns the spikes of every chunk in order, as a 1xC cell
+ * array of chunks of at most 'nChunkLength' spikes.  The spikes are not
+ * sorted: each segment is expected to lie before the offset of the next.
+ *
+ * The size of the result is known before any spike is copied, so every
+ * output chunk is created once, and the position of each source chunk in
+ * the output is found from the running total of the chunk lengths.  The
+ * source chunks are then copied in a single pass, spread over 'nNumThreads'
+ * threads (by default, one per hardware thread).  Concatenating n segments
+ * therefore costs time proportional to the number of spikes, rather than to
+ * n times the number of spikes as concatenating them in pairs does.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STThreadPool.h"
+#include "STTicks.h"
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+/* - One source chunk, and where it starts in the output */
+struct ConcatSource {
+   const double   *adTimes, *adAddrs;
+   size_t         nCount, nOutFirst;
+   double         fOffset;
+   STTickRatio    ratio;
+};
+
+/* - The output chunks */
+struct ConcatOutput {
+   std::vector<double *>   vadChunks;
+   size_t                  nChunkLength, nTotal;
+   bool                    bMapping;
+};
+
+
+/* --- CopySource - Copy one source chunk to its place in the output
+ *
+ * The source may span several output chunks, so it is copied in pieces that
+ * each lie within one output chunk.
+ */
+static void CopySource(const ConcatSource &source, const ConcatOutput &output)
+{
+   size_t nDone = 0;
+
+   while (nDone < source.nCount) {
+      size_t   nOut = source.nOutFirst + nDone,
+               nChunk = nOut / output.nChunkLength,
+               nPos = nOut % output.nChunkLength,
+               nChunkCount = std::min(output.nChunkLength, output.nTotal - nChunk * output.nChunkLength),
+               nPiece = std::min(source.nCount - nDone, nChunkCount - nPos);
+      double   *adTimes = output.vadChunks[nChunk] + nPos;
+
+      if (output.bMapping) {
+         /* - Rescale the ticks, then offset them; copy the addresses */
+         STRescaleDoubleTicks(source.adTimes + nDone, nPiece, source.ratio, adTimes);
+         for (size_t nSpike = 0; nSpike < nPiece; nSpike++) adTimes[nSpike] += source.fOffset;
+         std::copy(source.adAddrs + nDone, source.adAddrs + nDone + nPiece, adTimes + nChunkCount);
+      } else {
+         for (size_t nSpike = 0; nSpike < nPiece; nSpike++) adTimes[nSpike] = source.adTimes[nDone + nSpike] + source.fOffset;
+      }
+
+      nDone += nPiece;
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   std::vector<ConcatSource>  vSources;
+   std::vector<STTickRatio>   vSegmentRatios;
+   ConcatOutput               output;
+   size_t                     nNumChunks, nNumSegments, nChunk, nSegment;
+   unsigned                   nNumThreads = STDefaultNumThreads();
+   const double               *adSegment, *adOffset, *adResolution;
+
+   /* - Check usage */
+   if ((nlhs > 1) || (nrhs < 7) || (nrhs > 8) || !mxIsCell(prhs[0]) ||
+       !mxIsDouble(prhs[1]) || !mxIsDouble(prhs[2]) || !mxIsDouble(prhs[3])) {
+      mexPrintf("*** STConcatChunks: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STConcatChunks");
+      return;
+   }
+
+   nNumChunks = mxGetNumberOfElements(prhs[0]);
+   nNumSegments = mxGetNumberOfElements(prhs[2]);
+   output.bMapping = (mxGetScalar(prhs[6]) != 0);
+
+   if ((mxGetNumberOfElements(prhs[1]) != nNumChunks) || (mxGetNumberOfElements(prhs[3]) != nNumSegments)) {
+      mexErrMsgIdAndTxt("STConcatChunks:InvalidArgument",
+                        "*** STConcatChunks: 'vnSegment' must hold one segment for each chunk, and 'vfOffset' and "
+                        "'vfTemporalResolution' one value for each segment");
+   }
+
+   if (!(mxGetScalar(prhs[5]) >= 1)) {
+      mexErrMsgIdAndTxt("STConcatChunks:InvalidArgument",
+                        "*** STConcatChunks: The chunk length must be at least one spike");
+   }
+   output.nChunkLength = (size_t) mxGetScalar(prhs[5]);
+
+   if ((nrhs > 7) && !mxIsEmpty(prhs[7]) && (mxGetScalar(prhs[7]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[7]);
+   }
+
+   adSegment = mxGetPr(prhs[1]);
+   adOffset = mxGetPr(prhs[2]);
+   adResolution = mxGetPr(prhs[3]);
+
+   /* - Find the ratio for rescaling the ticks of each segment */
+   vSegmentRatios.resize(nNumSegments);
+   for (nSegment = 0; nSegment < nNumSegments; nSegment++) {
+      STTickRatio ratio = { 1, 1 };
+
+      if (output.bMapping) {
+         try {
+            ratio = STTickRatioBetween(adResolution[nSegment], mxGetScalar(prhs[4]));
+         } catch (std::exception &e) {
+            mexErrMsgIdAndTxt("STConcatChunks:InvalidArgument", "*** STConcatChunks: %s", e.what());
+         }
+      }
+      vSegmentRatios[nSegment] = ratio;
+   }
+
+   /* - Collect the non-empty chunks, and find where each starts in the output */
+   output.nTotal = 0;
+   for (nChunk = 0; nChunk < nNumChunks; nChunk++) {
+      const mxArray  *pChunk = mxGetCell(prhs[0], nChunk);
+      ConcatSource   source;
+
+      if ((pChunk == NULL) || mxIsEmpty(pChunk)) continue;
+
+      if (!mxIsDouble(pChunk) || mxIsComplex(pChunk) || (output.bMapping && (mxGetN(pChunk) != 2))) {
+         mexErrMsgIdAndTxt("STConcatChunks:InvalidSpikeList",
+                           "*** STConcatChunks: Chunks must be real double spike lists, with two columns for mappings");
+      }
+
+      if (!(adSegment[nChunk] >= 1) || !(adSegment[nChunk] <= (double) nNumSegments)) {
+         mexErrMsgIdAndTxt("STConcatChunks:InvalidArgument",
+                           "*** STConcatChunks: Invalid segment [%g] for chunk [%d]", adSegment[nChunk], (int) nChunk + 1);
+      }
+      nSegment = (size_t) adSegment[nChunk] - 1;
+
+      source.nCount = output.bMapping ? mxGetM(pChunk) : mxGetNumberOfElements(pChunk);
+      source.adTimes = mxGetPr(pChunk);
+      source.adAddrs = output.bMapping ? source.adTimes + source.nCount : NULL;
+      source.nOutFirst = output.nTotal;
+      source.fOffset = adOffset[nSegment];
+      source.ratio = vSegmentRatios[nSegment];
+
+      vSources.push_back(source);
+      output.nTotal += source.nCount;
+   }
+
+   /* - Create every output chunk here, since MATLAB can't be called from threads */
+   size_t   nNumOutChunks = (output.nTotal + output.nChunkLength - 1) / output.nChunkLength;
+   mxArray  *pCat = mxCreateCellMatrix(1, nNumOutChunks);
+
+   for (nChunk = 0; nChunk < nNumOutChunks; nChunk++) {
+      size_t   nChunkCount = std::min(output.nChunkLength, output.nTotal - nChunk * output.nChunkLength);
+      mxArray  *pChunk = mxCreateDoubleMatrix(nChunkCount, output.bMapping ? 2 : 1, mxREAL);
+      output.vadChunks.push_back(mxGetPr(pChunk));
+      mxSetCell(pCat, nChunk, pChunk);
+   }
+
+   /* - Copy each source chunk into place */
+   STParallelFor(vSources.size(), nNumThreads, [&](size_t nSource, unsigned) {
+      CopySource(vSources[nSource], output);
+   });
+
+   plhs[0] = pCat;
+}
+
+/* --- END of STConcatChunks.cpp --- */
@@ -0,0 +1,34 @@
+function [cCatList] = STConcatChunks(cChunks, vnSegment, vfOffset, vfTemporalResolution, fTemporalResolution, nChunkLength, bMapping, nNumThreads)
+
+% STConcatChunks - FUNCTION (Internal) Concatenate spike train segments end-to-end into new chunks
+% $Id: STConcatChunks.m $
+%
+% NOT for command-line use
+
+% Usage: [cCatList] = STConcatChunks(cChunks, vnSegment, vfOffset, vfTemporalResolution, fTemporalResolution, nChunkLength, bMapping <, nNumThreads>)
+%
+% 'cChunks' is a cell array of spike list chunks from several spike train
+% segments, in order.  'vnSegment' gives the segment of each chunk, and
+% 'vfOffset' and 'vfTemporalResolution' the time offset and temporal
+% resolution of each segment.  If 'bMapping' is true, the chunks are [tick
+% addr] mapping spike lists; their ticks are rescaled exactly to
+% 'fTemporalResolution', and then offset.  Otherwise they are instance spike
+% time vectors, in seconds.  STConcatChunks returns every spike in order, as a
+% cell array of chunks of at most 'nChunkLength' spikes.  The output is
+% allocated once, and filled over 'nNumThreads' threads, by default one per
+% hardware thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STConcatChunks.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STConcatChunks: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STConcatChunks.m ---
@@ -0,0 +1,120 @@
+/* STConv - FUNCTION (Internal) Fast convolution of a data vector with a kernel
+ * $Id: STConv.c $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [vfConv] = STConv(vfData, vfKernel <, strShape, bNormaliseBorder>)
+ *
+ * STConv returns the same result as conv2(vfData(:)', vfKernel(:)', strShape),
+ * using the faster of direct and FFT (overlap-save) convolution for the length
+ * of 'vfKernel'.  Short kernels are convolved directly, using SIMD
+ * instructions where available; long kernels are convolved by FFT, at a cost
+ * which grows only with the log of the kernel length.  See STConv.h.
+ *
+ * 'strShape' is one of 'full', 'same' (the default) or 'valid', as for conv2.
+ *
+ * If 'bNormaliseBorder' is true, each output is normalised by the area of the
+ * part of the kernel which does not overhang the start of 'vfData', as
+ * ConvBarrier.  Outputs clear of the start are normalised by the area of the
+ * whole kernel.  Otherwise the result is not normalised, as conv2.
+ *
+ * 'vfConv' will have the same orientation as 'vfData'.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STConv.h"
+#include <string.h>
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   const double   *adData,          /* Data pointer for source data array */
+                  *adKernel;        /* Data pointer for kernel array */
+   double         *adReturn;        /* Data pointer for return data array */
+   long           nDataLength,
+                  nKernelLength,
+                  nFirst,           /* First output, as an index into the full convolution */
+                  nCount;           /* Number of outputs */
+   STConvShape    nShape = ST_CONV_SAME;
+   int            bNormaliseBorder = 0;
+   char           strShape[8];
+
+   /* - Check usage */
+   if ((nlhs > 1) || (nrhs < 2) || (nrhs > 4)) {
+      mexPrintf("*** STConv: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STConv");
+      return;
+   }
+
+   if (!mxIsDouble(prhs[0]) || !mxIsDouble(prhs[1]) || mxIsComplex(prhs[0]) || mxIsComplex(prhs[1])) {
+      mexErrMsgIdAndTxt("STConv:InvalidArgument",
+                        "*** STConv: 'vfData' and 'vfKernel' must be real double vectors");
+   }
+
+   /* - Get the output shape */
+   if ((nrhs > 2) && !mxIsEmpty(prhs[2])) {
+      if (mxGetString(prhs[2], strShape, sizeof(strShape))) {
+         mexErrMsgIdAndTxt("STConv:InvalidArgument",
+                           "*** STConv: 'strShape' must be one of 'full', 'same' or 'valid'");
+      }
+
+      if (strcmp(strShape, "full") == 0) {
+         nShape = ST_CONV_FULL;
+      } else if (strcmp(strShape, "same") == 0) {
+         nShape = ST_CONV_SAME;
+      } else if (strcmp(strShape, "valid") == 0) {
+         nShape = ST_CONV_VALID;
+      } else {
+         mexErrMsgIdAndTxt("STConv:InvalidArgument",
+                           "*** STConv: 'strShape' must be one of 'full', 'same' or 'valid'");
+      }
+   }
+
+   if ((nrhs > 3) && !mxIsEmpty(prhs[3])) {
+      bNormaliseBorder = (mxGetScalar(prhs[3]) != 0);
+   }
+
+   /* - Get array lengths and the range of the full convolution to return */
+   nDataLength = (long) mxGetNumberOfElements(prhs[0]);
+   nKernelLength = (long) mxGetNumberOfElements(prhs[1]);
+   STConvShapeRange(nDataLength, nKernelLength, nShape, &nFirst, &nCount);
+
+   if ((nKernelLength == 0) && (nShape == ST_CONV_SAME)) {
+      /* - conv2 returns zeros for an empty kernel */
+      nCount = nDataLength;
+      nFirst = -1;
+   }
+
+   /* - Allocate output array, in the orientation of 'vfData' */
+   if (mxGetM(prhs[0]) > 1) {
+      plhs[0] = mxCreateDoubleMatrix(nCount, 1, mxREAL);
+   } else {
+      plhs[0] = mxCreateDoubleMatrix(1, nCount, mxREAL);
+   }
+
+   if ((nCount == 0) || (nFirst < 0)) return;
+
+   /* - Get data pointers */
+   adData = mxGetPr(prhs[0]);
+   adKernel = mxGetPr(prhs[1]);
+   adReturn = mxGetPr(plhs[0]);
+
+   /* - Perform the convolution */
+   if (STConvRange(adData, nDataLength, adKernel, nKernelLength, nFirst, nCount, adReturn)) {
+      mexErrMsgIdAndTxt("STConv:OutOfMemory",
+                        "*** STConv: Couldn't allocate memory for the convolution");
+   }
+
+   if (bNormaliseBorder) {
+      STConvNormaliseBorder(adKernel, nKernelLength, nFirst, nCount, adReturn);
+   }
+}
+
+/* --- END of STConv.c --- */
@@ -0,0 +1,419 @@
+/* STConv.h - Direct and FFT convolution of real sequences for toolbox MEX functions
+ * $Id: STConv.h $
+ *
+ * NOT for command-line use
+ *
+ * This header implements the linear convolution of a real data sequence with
+ * a real kernel, for STConv and ConvBarrier.  Any contiguous range of the
+ * full convolution can be computed, so the shapes used by conv2 ('full',
+ * 'same' and 'valid') are all available without computing unused outputs.
+ *
+ * Two methods are provided:
+ *
+ *    STConvDirect   - The direct sum, one kernel tap at a time over a tile of
+ *                     outputs, using SSE2 or AVX instructions where the
+ *                     compiler targets them.  Cost is proportional to the
+ *                     kernel length per output.
+ *    STConvFFT      - Overlap-save convolution with a radix-2 FFT.  Two
+ *                     blocks of data are transformed at once, as the real and
+ *                     imaginary parts of one complex sequence.  Cost is
+ *                     proportional to the log of the block length per output.
+ *
+ * STConvRange chooses between them by estimating the cost of each, for the
+ * kernel length and number of outputs required.  ST_CONV_FFT_COST is the
+ * relative cost of FFT and direct operations, as reported by STConv_bench
+ * ("make bench" in the toolbox private directory), and may be overridden at
+ * compile time.  On a 1M point sequence with AVX, the direct method is faster
+ * up to 64 taps, the two are about equal at 128 taps, and FFT convolution is
+ * faster beyond; the bench reports a cost ratio of 10 to 13 around this
+ * crossover, rising to 30 or more for long kernels.  With the default
+ * setting, FFT convolution is used from 128 taps on long sequences, and only
+ * for longer kernels on sequences of a few thousand points.
+ *
+ * STConvBarrier computes the convolution at the start of a sequence, with
+ * each output normalised by the area of the part of the kernel which
+ * overlaps the data, as ConvBarrier.
+ *
+ * The code is plain C, so it can be included by C and C++ MEX files.
+ * Functions which allocate memory return zero on success and non-zero if an
+ * allocation failed.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_CONV_H
+#define ST_CONV_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__AVX__)
+   #include <immintrin.h>
+   #define ST_CONV_HAVE_AVX
+#elif defined(__SSE2__) || defined(_M_X64)
+   #include <emmintrin.h>
+   #define ST_CONV_HAVE_SSE2
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* - Functions are inline where the compiler allows, so that unused functions
+ *   don't produce warnings */
+#if defined(__cplusplus)
+   #define ST_CONV_FUNC static inline
+#elif defined(__GNUC__)
+   #define ST_CONV_FUNC static __inline__
+#elif defined(_MSC_VER)
+   #define ST_CONV_FUNC static __inline
+#else
+   #define ST_CONV_FUNC static
+#endif
+
+
+/* - Cost of one FFT butterfly per point, relative to one direct multiply-add,
+ *   and the cost of building an FFT plan, in transforms */
+#ifndef ST_CONV_FFT_COST
+#define ST_CONV_FFT_COST            14
+#endif
+#define ST_CONV_PLAN_COST           4
+
+/* - Number of outputs computed together by the direct method.  The tile of
+ *   outputs and the data it needs should stay in L1 cache */
+#define ST_CONV_TILE                1024
+
+/* - Smallest FFT used by the overlap-save method, and the smallest ratio of
+ *   FFT length to kernel length */
+#define ST_CONV_MIN_FFT             256
+#define ST_CONV_FFT_KERNEL_RATIO    8
+
+
+/* - Output shapes, as for conv2 */
+typedef enum {
+   ST_CONV_FULL,
+   ST_CONV_SAME,
+   ST_CONV_VALID
+} STConvShape;
+
+
+/* --- STConvShapeRange - Find the range of the full convolution returned for
+ *   a given shape.  The full convolution has nData + nKernel - 1 outputs */
+ST_CONV_FUNC void STConvShapeRange(long nData, long nKernel, STConvShape nShape, long *pnFirst, long *pnCount)
+{
+   switch (nShape) {
+      case ST_CONV_SAME:
+         *pnFirst = nKernel / 2;
+         *pnCount = nData;
+         break;
+
+      case ST_CONV_VALID:
+         *pnFirst = nKernel - 1;
+         *pnCount = (nData >= nKernel) ? nData - nKernel + 1 : 0;
+         break;
+
+      default:
+         *pnFirst = 0;
+         *pnCount = (nData > 0) && (nKernel > 0) ? nData + nKernel - 1 : 0;
+         break;
+   }
+}
+
+
+/* --- STConvAxpy - adOut[i] += fScale * adIn[i], for i in [0, nCount) */
+ST_CONV_FUNC void STConvAxpy(double *adOut, const double *adIn, double fScale, long nCount)
+{
+   long nIndex = 0;
+
+#if defined(ST_CONV_HAVE_AVX)
+   __m256d v4Scale = _mm256_set1_pd(fScale);
+   for (; nIndex + 4 <= nCount; nIndex += 4) {
+      __m256d v4Out = _mm256_loadu_pd(adOut + nIndex);
+      v4Out = _mm256_add_pd(v4Out, _mm256_mul_pd(v4Scale, _mm256_loadu_pd(adIn + nIndex)));
+      _mm256_storeu_pd(adOut + nIndex, v4Out);
+   }
+#elif defined(ST_CONV_HAVE_SSE2)
+   __m128d v2Scale = _mm_set1_pd(fScale);
+   for (; nIndex + 2 <= nCount; nIndex += 2) {
+      __m128d v2Out = _mm_loadu_pd(adOut + nIndex);
+      v2Out = _mm_add_pd(v2Out, _mm_mul_pd(v2Scale, _mm_loadu_pd(adIn + nIndex)));
+      _mm_storeu_pd(adOut + nIndex, v2Out);
+   }
+#endif
+
+   for (; nIndex < nCount; nIndex++) adOut[nIndex] += fScale * adIn[nIndex];
+}
+
+
+/* --- STConvDirect - Outputs [nFirst, nFirst+nCount) of the full convolution,
+ *   by the direct sum */
+ST_CONV_FUNC void STConvDirect(const double *adData, long nData, const double *adKernel, long nKernel,
+                               long nFirst, long nCount, double *adOut)
+{
+   long  nTile, nTileEnd, nTap, nLow, nHigh;
+
+   memset(adOut, 0, nCount * sizeof(double));
+
+   for (nTile = nFirst; nTile < nFirst + nCount; nTile += ST_CONV_TILE) {
+      nTileEnd = (nTile + ST_CONV_TILE < nFirst + nCount) ? nTile + ST_CONV_TILE : nFirst + nCount;
+
+      /* - Output i takes adKernel[nTap] * adData[i - nTap], for 0 <= i - nTap < nData */
+      for (nTap = 0; nTap < nKernel; nTap++) {
+         nLow = (nTile > nTap) ? nTile : nTap;
+         nHigh = (nTileEnd < nTap + nData) ? nTileEnd : nTap + nData;
+         if (nLow < nHigh) {
+            STConvAxpy(adOut + (nLow - nFirst), adData + (nLow - nTap), adKernel[nTap], nHigh - nLow);
+         }
+      }
+   }
+}
+
+
+/* - A radix-2 FFT of a fixed length */
+typedef struct {
+   long     nSize;
+   double   *adCos, *adSin;      /* Twiddle factors, nSize/2 of each */
+   long     *anBitRev;           /* Bit-reversal permutation */
+} STFFTPlan;
+
+/* --- STFFTPlanFree - Release the tables of an FFT plan */
+ST_CONV_FUNC void STFFTPlanFree(STFFTPlan *pPlan)
+{
+   free(pPlan->adCos);
+   free(pPlan->adSin);
+   free(pPlan->anBitRev);
+   pPlan->adCos = pPlan->adSin = NULL;
+   pPlan->anBitRev = NULL;
+}
+
+/* --- STFFTPlanInit - Build the tables for an FFT of 'nSize' points, a power of two */
+ST_CONV_FUNC int STFFTPlanInit(STFFTPlan *pPlan, long nSize)
+{
+   long  nIndex, nBit, nRev, nLog2;
+
+   pPlan->nSize = nSize;
+   pPlan->adCos = (double *) malloc((nSize / 2 + 1) * sizeof(double));
+   pPlan->adSin = (double *) malloc((nSize / 2 + 1) * sizeof(double));
+   pPlan->anBitRev = (long *) malloc(nSize * sizeof(long));
+
+   if ((pPlan->adCos == NULL) || (pPlan->adSin == NULL) || (pPlan->anBitRev == NULL)) {
+      STFFTPlanFree(pPlan);
+      return -1;
+   }
+
+   for (nIndex = 0; nIndex < nSize / 2; nIndex++) {
+      pPlan->adCos[nIndex] = cos(2 * M_PI * nIndex / nSize);
+      pPlan->adSin[nIndex] = sin(2 * M_PI * nIndex / nSize);
+   }
+
+   for (nLog2 = 0; (1L << nLog2) < nSize; nLog2++) ;
+   for (nIndex = 0; nIndex < nSize; nIndex++) {
+      for (nBit = 0, nRev = 0; nBit < nLog2; nBit++) nRev |= ((nIndex >> nBit) & 1) << (nLog2 - 1 - nBit);
+      pPlan->anBitRev[nIndex] = nRev;
+   }
+
+   return 0;
+}
+
+/* --- STFFT - In-place complex FFT of split real and imaginary arrays.  The
+ *   inverse transform is not scaled by 1/nSize */
+ST_CONV_FUNC void STFFT(const STFFTPlan *pPlan, double *adRe, double *adIm, int bInverse)
+{
+   const long  nSize = pPlan->nSize;
+   const double fSign = bInverse ? 1.0 : -1.0;
+   long        nIndex, nSwap, nLength, nHalf, nStride, nBlock, nPair;
+   double      fTemp;
+
+   /* - Reorder into bit-reversed order */
+   for (nIndex = 0; nIndex < nSize; nIndex++) {
+      nSwap = pPlan->anBitRev[nIndex];
+      if (nSwap > nIndex) {
+         fTemp = adRe[nIndex]; adRe[nIndex] = adRe[nSwap]; adRe[nSwap] = fTemp;
+         fTemp = adIm[nIndex]; adIm[nIndex] = adIm[nSwap]; adIm[nSwap] = fTemp;
+      }
+   }
+
+   /* - Butterflies, doubling the transform length at each stage */
+   for (nLength = 2; nLength <= nSize; nLength <<= 1) {
+      nHalf = nLength / 2;
+      nStride = nSize / nLength;
+
+      for (nPair = 0; nPair < nHalf; nPair++) {
+         const double fWRe = pPlan->adCos[nPair * nStride],
+                      fWIm = fSign * pPlan->adSin[nPair * nStride];
+
+         for (nBlock = nPair; nBlock < nSize; nBlock += nLength) {
+            const long  nOdd = nBlock + nHalf;
+            const double fVRe = adRe[nOdd] * fWRe - adIm[nOdd] * fWIm,
+                         fVIm = adRe[nOdd] * fWIm + adIm[nOdd] * fWRe;
+
+            adRe[nOdd] = adRe[nBlock] - fVRe;
+            adIm[nOdd] = adIm[nBlock] - fVIm;
+            adRe[nBlock] += fVRe;
+            adIm[nBlock] += fVIm;
+         }
+      }
+   }
+}
+
+
+/* --- STConvFFTSize - Choose the FFT length for overlap-save convolution */
+ST_CONV_FUNC long STConvFFTSize(long nKernel, long nCount)
+{
+   long nSize = ST_CONV_MIN_FFT, nNeeded = nCount + nKernel - 1;
+
+   while (nSize < ST_CONV_FFT_KERNEL_RATIO * nKernel) nSize <<= 1;
+
+   /* - Don't use a longer FFT than a single block needs */
+   while ((nSize / 2 >= nNeeded) && (nSize / 2 >= nKernel)) nSize >>= 1;
+
+   return nSize;
+}
+
+/* --- STConvFFT - Outputs [nFirst, nFirst+nCount) of the full convolution, by
+ *   overlap-save FFT convolution */
+ST_CONV_FUNC int STConvFFT(const double *adData, long nData, const double *adKernel, long nKernel,
+                           long nFirst, long nCount, double *adOut)
+{
+   const long  nSize = STConvFFTSize(nKernel, nCount),
+               nStep = nSize - nKernel + 1;
+   STFFTPlan   plan;
+   double      *adHRe, *adHIm, *adZRe, *adZIm;
+   long        nBlock, nIndex, nSource, nPart, nNumOut;
+
+   if (nCount <= 0) return 0;
+
+   if (STFFTPlanInit(&plan, nSize)) return -1;
+   adHRe = (double *) calloc(nSize, sizeof(double));
+   adHIm = (double *) calloc(nSize, sizeof(double));
+   adZRe = (double *) malloc(nSize * sizeof(double));
+   adZIm = (double *) malloc(nSize * sizeof(double));
+
+   if ((adHRe == NULL) || (adHIm == NULL) || (adZRe == NULL) || (adZIm == NULL)) {
+      free(adHRe); free(adHIm); free(adZRe); free(adZIm);
+      STFFTPlanFree(&plan);
+      return -1;
+   }
+
+   /* - Kernel spectrum, including the 1/nSize scaling of the inverse transform */
+   for (nIndex = 0; nIndex < nKernel; nIndex++) adHRe[nIndex] = adKernel[nIndex] / nSize;
+   STFFT(&plan, adHRe, adHIm, 0);
+
+   /* - Each transform gives two blocks of 'nStep' outputs:  one from the real
+    *   part, and one from the imaginary part */
+   for (nBlock = nFirst; nBlock < nFirst + nCount; nBlock += 2 * nStep) {
+      /* - Output i of a block needs adData[i - nKernel + 1 .. i] */
+      for (nPart = 0; nPart < 2; nPart++) {
+         double *adZ = nPart ? adZIm : adZRe;
+         nSource = nBlock + nPart * nStep - nKernel + 1;
+
+         for (nIndex = 0; nIndex < nSize; nIndex++, nSource++) {
+            adZ[nIndex] = ((nSource >= 0) && (nSource < nData)) ? adData[nSource] : 0;
+         }
+      }
+
+      STFFT(&plan, adZRe, adZIm, 0);
+      for (nIndex = 0; nIndex < nSize; nIndex++) {
+         const double fRe = adZRe[nIndex] * adHRe[nIndex] - adZIm[nIndex] * adHIm[nIndex];
+         adZIm[nIndex] = adZRe[nIndex] * adHIm[nIndex] + adZIm[nIndex] * adHRe[nIndex];
+         adZRe[nIndex] = fRe;
+      }
+      STFFT(&plan, adZRe, adZIm, 1);
+
+      /* - The last 'nStep' points of each circular convolution are valid */
+      for (nPart = 0; nPart < 2; nPart++) {
+         const long nStart = nBlock + nPart * nStep;
+         if (nStart >= nFirst + nCount) break;
+
+         nNumOut = (nStart + nStep < nFirst + nCount) ? nStep : nFirst + nCount - nStart;
+         memcpy(adOut + (nStart - nFirst), (nPart ? adZIm : adZRe) + nKernel - 1, nNumOut * sizeof(double));
+      }
+   }
+
+   free(adHRe); free(adHIm); free(adZRe); free(adZIm);
+   STFFTPlanFree(&plan);
+   return 0;
+}
+
+
+/* --- STConvUseFFT - Decide whether FFT convolution will be faster than the
+ *   direct method, for 'nCount' outputs */
+ST_CONV_FUNC int STConvUseFFT(long nKernel, long nCount)
+{
+   const long  nSize = STConvFFTSize(nKernel, nCount),
+               nStep = nSize - nKernel + 1;
+   long        nLog2;
+   double      fDirectCost, fFFTCost;
+
+   for (nLog2 = 0; (1L << nLog2) < nSize; nLog2++) ;
+
+   /* - Two blocks per transform, plus the kernel transform and the plan */
+   fDirectCost = (double) nCount * nKernel;
+   fFFTCost = ST_CONV_FFT_COST * (double) nSize * nLog2 *
+              ((nCount + 2 * nStep - 1) / (2 * nStep) + 1 + ST_CONV_PLAN_COST);
+
+   return fFFTCost < fDirectCost;
+}
+
+/* --- STConvRange - Outputs [nFirst, nFirst+nCount) of the full convolution,
+ *   by whichever method is faster */
+ST_CONV_FUNC int STConvRange(const double *adData, long nData, const double *adKernel, long nKernel,
+                             long nFirst, long nCount, double *adOut)
+{
+   if (nCount <= 0) return 0;
+
+   if (!STConvUseFFT(nKernel, nCount)) {
+      STConvDirect(adData, nData, adKernel, nKernel, nFirst, nCount, adOut);
+      return 0;
+   }
+
+   return STConvFFT(adData, nData, adKernel, nKernel, nFirst, nCount, adOut);
+}
+
+/* --- STConvNormaliseBorder - Normalise outputs [nFirst, nFirst+nCount) of the
+ *   full convolution by the area of the part of the kernel which does not
+ *   overhang the start of the data, as ConvBarrier.  Outputs beyond the left
+ *   border are normalised by the area of the whole kernel */
+ST_CONV_FUNC void STConvNormaliseBorder(const double *adKernel, long nKernel, long nFirst, long nCount, double *adOut)
+{
+   double   fPartialArea = 0;
+   long     nIndex;
+
+   for (nIndex = 0; (nIndex < nKernel) && (nIndex < nFirst + nCount); nIndex++) {
+      fPartialArea += adKernel[nIndex];
+      if (nIndex >= nFirst) adOut[nIndex - nFirst] /= fPartialArea;
+   }
+
+   /* - fPartialArea is now the area of the whole kernel */
+   for (nIndex = (nFirst > nKernel) ? nFirst : nKernel; nIndex < nFirst + nCount; nIndex++) {
+      adOut[nIndex - nFirst] /= fPartialArea;
+   }
+}
+
+/* --- STConvBarrier - The first min(nKernel, nData) outputs of the
+ *   convolution, normalised by the area of the partial kernel, as ConvBarrier.
+ *   The remaining elements of 'adOut' (nData in total) are set to zero */
+ST_CONV_FUNC int STConvBarrier(const double *adData, long nData, const double *adKernel, long nKernel, double *adOut)
+{
+   const long nSmoothingBins = (nKernel < nData) ? nKernel : nData;
+   double     fPartialArea = 0;
+   long       nIndex;
+
+   memset(adOut, 0, nData * sizeof(double));
+   if (STConvRange(adData, nData, adKernel, nKernel, 0, nSmoothingBins, adOut)) return -1;
+
+   for (nIndex = 0; nIndex < nSmoothingBins; nIndex++) {
+      fPartialArea += adKernel[nIndex];
+      adOut[nIndex] /= fPartialArea;
+   }
+
+   return 0;
+}
+
+#endif
+
+/* --- END of STConv.h --- */
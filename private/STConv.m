@@ -0,0 +1,32 @@
+function [vfConv] = STConv(vfData, vfKernel, strShape, bNormaliseBorder)
+
+% STConv - FUNCTION (Internal) Fast convolution of a data vector with a kernel
+% $Id: STConv.m $
+%
+% NOT for command-line use
+
+% Usage: [vfConv] = STConv(vfData, vfKernel <, strShape, bNormaliseBorder>)
+%
+% STConv returns the same result as conv2(vfData(:)', vfKernel(:)', strShape),
+% using the faster of direct and FFT (overlap-save) convolution for the length
+% of 'vfKernel'.  'strShape' is one of 'full', 'same' (the default) or
+% 'valid'.
+%
+% If 'bNormaliseBorder' is true, each output is normalised by the area of the
+% part of the kernel which does not overhang the start of 'vfData', as
+% ConvBarrier.  'vfConv' will have the same orientation as 'vfData'.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STConv.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STConv: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STConv.m ---
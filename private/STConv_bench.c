@@ -0,0 +1,152 @@
+/* STConv_bench - Benchmark direct and FFT convolution for the STConv MEX file
+ * $Id: STConv_bench.c $
+ *
+ * Usage: STConv_bench [nDataLength [nMaxKernelLength]]
+ *
+ * This is a stand-alone program (not a MEX file), built with "make bench" in
+ * the toolbox private directory.  It convolves 'nDataLength' random values
+ * (default 1M) with kernels of 4, 8, 16, ... up to 'nMaxKernelLength' taps
+ * (default 4096), using each of the methods in STConv.h, and reports the
+ * throughput of each in outputs per second:
+ *
+ *    direct      - STConvDirect, using the SIMD code compiled in
+ *    fft         - STConvFFT, overlap-save convolution
+ *
+ * For each kernel, the cost of an FFT butterfly relative to a direct
+ * multiply-add is also reported ("ratio"), as a guide to setting
+ * ST_CONV_FFT_COST, along with the method STConvRange would choose.  Both
+ * methods are also checked against each other, and against a plain reference
+ * sum for a short prefix.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "STConv.h"
+
+
+/* - Minimum time to spend timing each method, in seconds */
+#define MIN_TIMING      0.2
+
+/* - Number of outputs checked against the reference sum */
+#define NUM_CHECKED     2048
+
+
+/* --- Now - Return a wall-clock time in seconds */
+static double Now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* --- TimeMethod - Return the throughput of one method, in outputs per second */
+static double TimeMethod(int bFFT, const double *adData, long nData, const double *adKernel, long nKernel,
+                         long nCount, double *adOut)
+{
+   double   tStart = Now(), tElapsed;
+   long     nRepeats = 0;
+
+   do {
+      if (bFFT) {
+         STConvFFT(adData, nData, adKernel, nKernel, 0, nCount, adOut);
+      } else {
+         STConvDirect(adData, nData, adKernel, nKernel, 0, nCount, adOut);
+      }
+      nRepeats++;
+      tElapsed = Now() - tStart;
+   } while (tElapsed < MIN_TIMING);
+
+   return (double) nCount * nRepeats / tElapsed;
+}
+
+int main(int argc, char *argv[])
+{
+   long     nDataLength = 1024L * 1024,
+            nMaxKernel = 4096,
+            nKernel, nCount, nIndex, nTap,
+            nSize, nStep, nLog2;
+   double   *adData, *adKernel, *adDirect, *adFFT,
+            fDirectRate, fFFTRate, fMaxError, fScale, fRef, fCostRatio;
+
+   if (argc > 1) nDataLength = atol(argv[1]);
+   if (argc > 2) nMaxKernel = atol(argv[2]);
+   if ((nDataLength < 1) || (nMaxKernel < 4)) {
+      printf("Usage: STConv_bench [nDataLength [nMaxKernelLength]]\n");
+      return 1;
+   }
+
+   adData = (double *) malloc(nDataLength * sizeof(double));
+   adKernel = (double *) malloc(nMaxKernel * sizeof(double));
+   adDirect = (double *) malloc((nDataLength + nMaxKernel) * sizeof(double));
+   adFFT = (double *) malloc((nDataLength + nMaxKernel) * sizeof(double));
+
+   srand(5489);
+   for (nIndex = 0; nIndex < nDataLength; nIndex++) adData[nIndex] = (double) rand() / RAND_MAX;
+   for (nIndex = 0; nIndex < nMaxKernel; nIndex++) adKernel[nIndex] = (double) rand() / RAND_MAX - 0.5;
+
+   printf("STConv_bench: %ld data points, ST_CONV_FFT_COST %g\n", nDataLength, (double) ST_CONV_FFT_COST);
+#if defined(ST_CONV_HAVE_AVX)
+   printf("   SIMD support: AVX\n");
+#elif defined(ST_CONV_HAVE_SSE2)
+   printf("   SIMD support: SSE2\n");
+#else
+   printf("   SIMD support: none (scalar fallback)\n");
+#endif
+   printf("   %8s %14s %14s %8s %8s %12s\n", "taps", "direct Mout/s", "fft Mout/s", "ratio", "chosen", "max error");
+
+   for (nKernel = 4; nKernel <= nMaxKernel; nKernel *= 2) {
+      nCount = nDataLength + nKernel - 1;
+
+      fDirectRate = TimeMethod(0, adData, nDataLength, adKernel, nKernel, nCount, adDirect);
+      fFFTRate = TimeMethod(1, adData, nDataLength, adKernel, nKernel, nCount, adFFT);
+
+      /* - Compare the methods, relative to the size of the kernel */
+      for (nTap = 0, fScale = 0; nTap < nKernel; nTap++) fScale += fabs(adKernel[nTap]);
+      for (nIndex = 0, fMaxError = 0; nIndex < nCount; nIndex++) {
+         if (fabs(adDirect[nIndex] - adFFT[nIndex]) > fMaxError) fMaxError = fabs(adDirect[nIndex] - adFFT[nIndex]);
+      }
+
+      /* - Check a prefix of the direct method against the reference sum */
+      for (nIndex = 0; (nIndex < NUM_CHECKED) && (nIndex < nCount); nIndex++) {
+         for (nTap = 0, fRef = 0; nTap < nKernel; nTap++) {
+            if ((nIndex - nTap >= 0) && (nIndex - nTap < nDataLength)) fRef += adKernel[nTap] * adData[nIndex - nTap];
+         }
+         if (fabs(fRef - adDirect[nIndex]) > 1e-12 * fScale) {
+            printf("*** STConv_bench: Direct convolution differs from the reference at [%ld]\n", nIndex);
+            return 1;
+         }
+      }
+
+      /* - Butterfly operations per output, as estimated by STConvUseFFT */
+      nSize = STConvFFTSize(nKernel, nCount);
+      nStep = nSize - nKernel + 1;
+      for (nLog2 = 0; (1L << nLog2) < nSize; nLog2++) ;
+      fCostRatio = (fDirectRate / fFFTRate) * nKernel * nCount /
+                   ((double) nSize * nLog2 * ((nCount + 2 * nStep - 1) / (2 * nStep) + 1 + ST_CONV_PLAN_COST));
+
+      printf("   %8ld %14.1f %14.1f %8.1f %8s %12.2e\n", nKernel, fDirectRate / 1e6, fFFTRate / 1e6, fCostRatio,
+             STConvUseFFT(nKernel, nCount) ? "fft" : "direct", fMaxError / fScale);
+
+      if (fMaxError > 1e-10 * fScale) {
+         printf("*** STConv_bench: FFT and direct convolution differ\n");
+         return 1;
+      }
+   }
+
+   free(adData);
+   free(adKernel);
+   free(adDirect);
+   free(adFFT);
+   return 0;
+}
+
+/* --- END of STConv_bench.c --- */
@@ -0,0 +1,395 @@
+/* STCorrelogram - FUNCTION (Internal) Raw cross-correlogram of two spike trains
+ * $Id: STCorrelogram.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [vCorrRaw, strMethod] = STCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize <, strMethod, nNumThreads>)
+ *
+ * 'vSpikeIndex1' and 'vSpikeIndex2' are the spike times of two trains, as
+ * integer sample indices.  'vCorrRaw' is a 1x(2*nWindowSize+1) vector, in
+ * which element (nLag + nWindowSize + 1) counts the pairs of a spike from
+ * train 1 and a spike from train 2 with
+ *
+ *    vSpikeIndex2(j) - vSpikeIndex1(i) == nLag,   |nLag| <= nWindowSize
+ *
+ * Two methods are provided, selected by 'strMethod':
+ *
+ *    'sweep'  - Both trains are sorted (copies are made if they are not),
+ *               and swept together: for each spike of train 1, a pointer into
+ *               train 2 marks the first spike inside the window, and only
+ *               moves forward.  The cost is O(N + M + P), where P is the
+ *               number of pairs inside the window.
+ *    'fft'    - Both trains are binned, one sample per bin, and correlated by
+ *               FFT a block at a time.  Each block of train 1 is correlated
+ *               with the bins of train 2 that lie within the window of it, in
+ *               a zero-padded transform of at least 4 times the window
+ *               length, and the results are summed.  The bins of both
+ *               trains are transformed together, as the real and imaginary
+ *               parts of one complex sequence, and two blocks share each
+ *               inverse transform.  Blocks with no spikes are skipped.  The
+ *               cost grows with the length of the recording, but not with
+ *               the number of pairs, so it suits dense trains and wide
+ *               windows.  Counts are rounded to whole numbers, and are exact.
+ *    'auto'   - (The default) The number of pairs inside the window is
+ *               counted, in O(N + M), and compared with the cost of the FFT
+ *               method; the cheaper method is used.
+ *
+ * 'strMethod' is returned with the method used.  Work is spread over
+ * 'nNumThreads' threads (by default, one per hardware thread), each into its
+ * own correlogram, and the correlograms are then summed.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STConv.h"
+#include "STThreadPool.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+
+/* - Smallest number of train 1 spikes worth counting on a separate thread */
+#define CORR_MIN_BLOCK           16384
+
+/* - Smallest FFT used by the binned method, and the smallest ratio of FFT
+ *   length to correlogram length */
+#define CORR_MIN_FFT             1024
+#define CORR_FFT_WINDOW_RATIO    4
+
+/* - Largest FFT used by the binned method */
+#define CORR_MAX_FFT             (1L << 22)
+
+
+/* - Sorted spike indices of both trains */
+struct CorrTrains {
+   std::vector<double>  vfIndices1, vfIndices2;
+   double               fWindowSize;
+};
+
+/* - Blocks for the binned method */
+struct CorrBlocks {
+   long                 nSize, nBlockLength;
+   double               fOrigin;
+   std::vector<long>    vnBlocks;      /* Blocks with spikes to correlate */
+};
+
+
+/* --- ReadIndices - Return the spike indices of a train, sorted */
+static std::vector<double> ReadIndices(const mxArray *pIndices)
+{
+   const double         *adIndices = mxGetPr(pIndices);
+   std::vector<double>  vfIndices(adIndices, adIndices + mxGetNumberOfElements(pIndices));
+
+   for (size_t nSpike = 0; nSpike < vfIndices.size(); nSpike++) {
+      if ((vfIndices[nSpike] != floor(vfIndices[nSpike])) || (fabs(vfIndices[nSpike]) > 4503599627370496.0)) {
+         mexErrMsgIdAndTxt("STCorrelogram:InvalidArgument", "*** STCorrelogram: Spike indices must be whole numbers");
+      }
+   }
+
+   if (!std::is_sorted(vfIndices.begin(), vfIndices.end())) std::sort(vfIndices.begin(), vfIndices.end());
+   return vfIndices;
+}
+
+/* --- FirstAtLeast - Index of the first spike with an index of at least 'fIndex' */
+static inline size_t FirstAtLeast(const std::vector<double> &vfIndices, double fIndex)
+{
+   return std::lower_bound(vfIndices.begin(), vfIndices.end(), fIndex) - vfIndices.begin();
+}
+
+
+/* --- CountBlock - Count the lags from spikes [nFirst, nLast) of train 1, by sweeping */
+static void CountBlock(const CorrTrains &trains, size_t nFirst, size_t nLast, std::vector<double> &vfCorr)
+{
+   const std::vector<double>  &vfIndices1 = trains.vfIndices1,
+                              &vfIndices2 = trains.vfIndices2;
+   const double               fWindowSize = trains.fWindowSize;
+
+   /* - Start the window pointer at the first spike of train 2 inside the window */
+   size_t nStart = FirstAtLeast(vfIndices2, vfIndices1[nFirst] - fWindowSize);
+
+   for (size_t nSpike1 = nFirst; nSpike1 < nLast; nSpike1++) {
+      double fIndex1 = vfIndices1[nSpike1];
+
+      while ((nStart < vfIndices2.size()) && (vfIndices2[nStart] - fIndex1 < -fWindowSize)) nStart++;
+
+      for (size_t nSpike2 = nStart; (nSpike2 < vfIndices2.size()) && (vfIndices2[nSpike2] - fIndex1 <= fWindowSize); nSpike2++) {
+         vfCorr[(size_t) (vfIndices2[nSpike2] - fIndex1 + fWindowSize)] += 1;
+      }
+   }
+}
+
+/* --- CountPairs - Count the pairs inside the window, without visiting them */
+static double CountPairs(const CorrTrains &trains)
+{
+   const std::vector<double>  &vfIndices1 = trains.vfIndices1,
+                              &vfIndices2 = trains.vfIndices2;
+   size_t                     nStart = 0, nEnd = 0;
+   double                     fPairs = 0;
+
+   for (size_t nSpike1 = 0; nSpike1 < vfIndices1.size(); nSpike1++) {
+      while ((nStart < vfIndices2.size()) && (vfIndices2[nStart] - vfIndices1[nSpike1] < -trains.fWindowSize)) nStart++;
+      if (nEnd < nStart) nEnd = nStart;
+      while ((nEnd < vfIndices2.size()) && (vfIndices2[nEnd] - vfIndices1[nSpike1] <= trains.fWindowSize)) nEnd++;
+      fPairs += (double) (nEnd - nStart);
+   }
+
+   return fPairs;
+}
+
+
+/* --- PlanBlocks - Choose the FFT length, and find the blocks of train 1 with
+ *     spikes of train 2 inside their windows */
+static void PlanBlocks(const CorrTrains &trains, CorrBlocks &blocks)
+{
+   const std::vector<double>  &vfIndices1 = trains.vfIndices1,
+                              &vfIndices2 = trains.vfIndices2;
+   const long                 nWindowSize = (long) trains.fWindowSize,
+                              nCorrLength = 2 * nWindowSize + 1;
+   double                     fSpan = vfIndices1.back() - vfIndices1.front() + 1;
+   long                       nBlock, nLastBlock = -1;
+
+   /* - The FFT holds a block of train 1 and a window on each side of it */
+   blocks.nSize = CORR_MIN_FFT;
+   while ((blocks.nSize < CORR_FFT_WINDOW_RATIO * nCorrLength) && (blocks.nSize < CORR_MAX_FFT)) blocks.nSize <<= 1;
+   if (blocks.nSize <= 2 * nWindowSize) {
+      blocks.nSize = 0;
+      return;
+   }
+
+   /* - Don't use a longer FFT than a single block needs */
+   while ((blocks.nSize / 2 > 2 * nWindowSize) && (blocks.nSize / 2 >= fSpan + 2 * nWindowSize)) blocks.nSize >>= 1;
+
+   blocks.nBlockLength = blocks.nSize - 2 * nWindowSize;
+   blocks.fOrigin = vfIndices1.front();
+   blocks.vnBlocks.clear();
+
+   /* - Keep each block holding a spike of train 1, if train 2 has spikes near it */
+   for (size_t nSpike1 = 0; nSpike1 < vfIndices1.size(); nSpike1++) {
+      nBlock = (long) ((vfIndices1[nSpike1] - blocks.fOrigin) / blocks.nBlockLength);
+      if (nBlock == nLastBlock) continue;
+      nLastBlock = nBlock;
+
+      double   fStart = blocks.fOrigin + (double) nBlock * blocks.nBlockLength;
+      size_t   nFirst2 = FirstAtLeast(vfIndices2, fStart - nWindowSize);
+
+      if ((nFirst2 < vfIndices2.size()) && (vfIndices2[nFirst2] < fStart + blocks.nBlockLength + nWindowSize)) {
+         blocks.vnBlocks.push_back(nBlock);
+      }
+   }
+}
+
+/* --- FFTCost - Estimate the cost of the binned method, in pair visits */
+static double FFTCost(const CorrBlocks &blocks)
+{
+   long nLog2;
+
+   if (blocks.nSize == 0) return HUGE_VAL;
+   for (nLog2 = 0; (1L << nLog2) < blocks.nSize; nLog2++) ;
+
+   /* - One forward transform per block, and one inverse per two blocks */
+   return ST_CONV_FFT_COST * (double) blocks.nSize * nLog2 * (1.5 * blocks.vnBlocks.size() + ST_CONV_PLAN_COST);
+}
+
+
+/* - Scratch space for one worker of the binned method */
+struct CorrScratch {
+   std::vector<double>  vfRe, vfIm, vfPRe[2], vfPIm[2];
+};
+
+/* --- BlockSpectrum - Cross-spectrum conj(X1) * X2 of one block
+ *
+ * The bins of the block of train 1 are placed in the real part, and the bins
+ * of train 2 from one window before it to one window after it in the
+ * imaginary part.  After one transform, the spectra of the two real sequences
+ * are separated using the symmetry of real transforms:
+ *
+ *    X1[f] = (Z[f] + conj(Z[-f])) / 2,   X2[f] = (Z[f] - conj(Z[-f])) / 2i
+ */
+static void BlockSpectrum(const CorrTrains &trains, const CorrBlocks &blocks, const STFFTPlan &plan, long nBlock,
+                          CorrScratch &scratch, std::vector<double> &vfPRe, std::vector<double> &vfPIm)
+{
+   const long     nSize = blocks.nSize,
+                  nWindowSize = (long) trains.fWindowSize;
+   const double   fStart = blocks.fOrigin + (double) nBlock * blocks.nBlockLength,
+                  fEnd = fStart + blocks.nBlockLength;
+   double         *afRe = scratch.vfRe.data(), *afIm = scratch.vfIm.data();
+   size_t         nSpike;
+   long           nFreq;
+
+   std::fill(scratch.vfRe.begin(), scratch.vfRe.end(), 0.0);
+   std::fill(scratch.vfIm.begin(), scratch.vfIm.end(), 0.0);
+
+   for (nSpike = FirstAtLeast(trains.vfIndices1, fStart);
+        (nSpike < trains.vfIndices1.size()) && (trains.vfIndices1[nSpike] < fEnd); nSpike++) {
+      afRe[(long) (trains.vfIndices1[nSpike] - fStart)] += 1;
+   }
+
+   for (nSpike = FirstAtLeast(trains.vfIndices2, fStart - nWindowSize);
+        (nSpike < trains.vfIndices2.size()) && (trains.vfIndices2[nSpike] < fEnd + nWindowSize); nSpike++) {
+      afIm[(long) (trains.vfIndices2[nSpike] - (fStart - nWindowSize))] += 1;
+   }
+
+   STFFT(&plan, afRe, afIm, 0);
+
+   for (nFreq = 0; nFreq < nSize; nFreq++) {
+      const long     nNeg = (nSize - nFreq) & (nSize - 1);
+      const double   fA = afRe[nFreq], fB = afIm[nFreq],
+                     fC = afRe[nNeg], fD = afIm[nNeg];
+
+      vfPRe[nFreq] = ((fA + fC) * (fB + fD) + (fB - fD) * (fC - fA)) / 4;
+      vfPIm[nFreq] = ((fA + fC) * (fC - fA) - (fB - fD) * (fB + fD)) / 4;
+   }
+}
+
+/* --- CorrelatePair - Correlate up to two blocks, sharing one inverse transform */
+static void CorrelatePair(const CorrTrains &trains, const CorrBlocks &blocks, const STFFTPlan &plan,
+                          size_t nFirst, CorrScratch &scratch, std::vector<double> &vfCorr)
+{
+   const long  nSize = blocks.nSize,
+               nCorrLength = 2 * (long) trains.fWindowSize + 1;
+   const bool  bSecond = (nFirst + 1 < blocks.vnBlocks.size());
+   long        nIndex;
+
+   BlockSpectrum(trains, blocks, plan, blocks.vnBlocks[nFirst], scratch, scratch.vfPRe[0], scratch.vfPIm[0]);
+   if (bSecond) {
+      BlockSpectrum(trains, blocks, plan, blocks.vnBlocks[nFirst + 1], scratch, scratch.vfPRe[1], scratch.vfPIm[1]);
+   }
+
+   /* - Each correlation is real, so the two share an inverse transform as P1 + i P2 */
+   for (nIndex = 0; nIndex < nSize; nIndex++) {
+      scratch.vfRe[nIndex] = scratch.vfPRe[0][nIndex] - (bSecond ? scratch.vfPIm[1][nIndex] : 0);
+      scratch.vfIm[nIndex] = scratch.vfPIm[0][nIndex] + (bSecond ? scratch.vfPRe[1][nIndex] : 0);
+   }
+   STFFT(&plan, scratch.vfRe.data(), scratch.vfIm.data(), 1);
+
+   /* - Lag (k - nWindowSize) is at point k; counts are whole numbers */
+   for (nIndex = 0; nIndex < nCorrLength; nIndex++) {
+      vfCorr[nIndex] += floor(scratch.vfRe[nIndex] / nSize + 0.5);
+      if (bSecond) vfCorr[nIndex] += floor(scratch.vfIm[nIndex] / nSize + 0.5);
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   CorrTrains                          trains;
+   CorrBlocks                          blocks;
+   std::vector< std::vector<double> >  vvfCorr;
+   unsigned                            nNumThreads = STDefaultNumThreads(), nNumWorkers;
+   size_t                              nNumBins, nBin, nCorr;
+   char                                strMethod[8] = "auto";
+   bool                                bFFT = false;
+   double                              *adCorr;
+
+   /* - Check usage */
+   if ((nlhs > 2) || (nrhs < 3) || (nrhs > 5) || !mxIsDouble(prhs[0]) || !mxIsDouble(prhs[1]) ||
+       ((nrhs > 3) && !mxIsEmpty(prhs[3]) && !mxIsChar(prhs[3]))) {
+      mexPrintf("*** STCorrelogram: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STCorrelogram");
+      return;
+   }
+
+   trains.fWindowSize = mxGetScalar(prhs[2]);
+   if (!(trains.fWindowSize >= 0) || (trains.fWindowSize != floor(trains.fWindowSize)) || (trains.fWindowSize > 1e9)) {
+      mexErrMsgIdAndTxt("STCorrelogram:InvalidArgument",
+                        "*** STCorrelogram: The window size must be a non-negative whole number of samples");
+   }
+
+   if ((nrhs > 3) && !mxIsEmpty(prhs[3])) {
+      mxGetString(prhs[3], strMethod, sizeof(strMethod));
+      if (strcmp(strMethod, "auto") && strcmp(strMethod, "sweep") && strcmp(strMethod, "fft")) {
+         mexErrMsgIdAndTxt("STCorrelogram:InvalidArgument",
+                           "*** STCorrelogram: 'strMethod' must be one of {'auto', 'sweep', 'fft'}");
+      }
+   }
+
+   if ((nrhs > 4) && !mxIsEmpty(prhs[4]) && (mxGetScalar(prhs[4]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[4]);
+   }
+
+   trains.vfIndices1 = ReadIndices(prhs[0]);
+   trains.vfIndices2 = ReadIndices(prhs[1]);
+   nNumBins = 2 * (size_t) trains.fWindowSize + 1;
+
+   /* - Choose a method */
+   if (!trains.vfIndices1.empty() && !trains.vfIndices2.empty() && strcmp(strMethod, "sweep")) {
+      PlanBlocks(trains, blocks);
+
+      if (!strcmp(strMethod, "fft")) {
+         if (blocks.nSize == 0) {
+            mexErrMsgIdAndTxt("STCorrelogram:InvalidArgument",
+                              "*** STCorrelogram: The window is too long to correlate by FFT");
+         }
+         bFFT = true;
+      } else {
+         bFFT = FFTCost(blocks) < (double) (trains.vfIndices1.size() + trains.vfIndices2.size()) + CountPairs(trains);
+      }
+   }
+
+   /* - Count, each worker into its own correlogram */
+   if (bFFT) {
+      STFFTPlan   plan;
+      size_t      nNumPairs = (blocks.vnBlocks.size() + 1) / 2;
+
+      nNumWorkers = (unsigned) std::max((size_t) 1, std::min((size_t) nNumThreads, nNumPairs));
+      vvfCorr.assign(nNumWorkers, std::vector<double>(nNumBins, 0));
+
+      if (STFFTPlanInit(&plan, blocks.nSize)) {
+         mexErrMsgIdAndTxt("STCorrelogram:OutOfMemory", "*** STCorrelogram: Out of memory");
+      }
+
+      std::vector<CorrScratch> vScratch(nNumWorkers);
+      for (size_t nWorker = 0; nWorker < vScratch.size(); nWorker++) {
+         vScratch[nWorker].vfRe.resize(blocks.nSize);
+         vScratch[nWorker].vfIm.resize(blocks.nSize);
+         for (int nPart = 0; nPart < 2; nPart++) {
+            vScratch[nWorker].vfPRe[nPart].resize(blocks.nSize);
+            vScratch[nWorker].vfPIm[nPart].resize(blocks.nSize);
+         }
+      }
+
+      try {
+         STParallelFor(nNumPairs, nNumWorkers, [&](size_t nPair, unsigned nWorker) {
+            CorrelatePair(trains, blocks, plan, 2 * nPair, vScratch[nWorker], vvfCorr[nWorker]);
+         });
+      } catch (...) {
+         STFFTPlanFree(&plan);
+         throw;
+      }
+      STFFTPlanFree(&plan);
+      strcpy(strMethod, "fft");
+
+   } else {
+      size_t nNumBlocks = std::max((size_t) 1, std::min((size_t) nNumThreads, trains.vfIndices1.size() / CORR_MIN_BLOCK));
+
+      nNumWorkers = (unsigned) std::min((size_t) nNumThreads, nNumBlocks);
+      vvfCorr.assign(nNumWorkers, std::vector<double>(nNumBins, 0));
+
+      if (!trains.vfIndices1.empty() && !trains.vfIndices2.empty()) {
+         STParallelFor(nNumBlocks, nNumWorkers, [&](size_t nBlock, unsigned nWorker) {
+            CountBlock(trains, nBlock * trains.vfIndices1.size() / nNumBlocks,
+                       (nBlock + 1) * trains.vfIndices1.size() / nNumBlocks, vvfCorr[nWorker]);
+         });
+      }
+      strcpy(strMethod, "sweep");
+   }
+
+   /* - Sum the correlograms */
+   plhs[0] = mxCreateDoubleMatrix(1, nNumBins, mxREAL);
+   adCorr = mxGetPr(plhs[0]);
+
+   for (nCorr = 0; nCorr < vvfCorr.size(); nCorr++) {
+      for (nBin = 0; nBin < nNumBins; nBin++) adCorr[nBin] += vvfCorr[nCorr][nBin];
+   }
+
+   if (nlhs > 1) plhs[1] = mxCreateString(strMethod);
+}
+
+/* --- END of STCorrelogram.cpp --- */
@@ -0,0 +1,34 @@
+function [vCorrRaw, strMethod] = STCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize, strMethod, nNumThreads)
+
+% STCorrelogram - FUNCTION (Internal) Raw cross-correlogram of two spike trains
+% $Id: STCorrelogram.m $
+%
+% NOT for command-line use
+
+% Usage: [vCorrRaw, strMethod] = STCorrelogram(vSpikeIndex1, vSpikeIndex2, nWindowSize <, strMethod, nNumThreads>)
+%
+% 'vSpikeIndex1' and 'vSpikeIndex2' are the spike times of two trains, as
+% integer sample indices.  'vCorrRaw' is a 1x(2*nWindowSize+1) vector, in which
+% element (nLag + nWindowSize + 1) counts the pairs of spikes with
+% vSpikeIndex2(j) - vSpikeIndex1(i) == nLag.  If 'strMethod' is 'sweep', the
+% sorted trains are swept together with a sliding window, so only pairs inside
+% the window are visited.  If it is 'fft', both trains are binned and
+% correlated by FFT in zero-padded blocks.  If it is 'auto' (the default), the
+% pairs inside the window are counted and the cheaper method is used; the
+% method used is returned in 'strMethod'.  The work is split over
+% 'nNumThreads' threads, by default one per hardware thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STCorrelogram.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STCorrelogram: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STCorrelogram.m ---
@@ -0,0 +1,52 @@
+function STFreeTemporaryStore(stTemporary, varargin)
+
+% STFreeTemporaryStore - FUNCTION (Internal) Free the spike store of an intermediate spike train
+% $Id: STFreeTemporaryStore.m $
+%
+% NOT for command-line use
+
+% Usage: STFreeTemporaryStore(stTemporary, stKeep1, stKeep2, ...)
+%
+% STCrop, STShift, STMap, STMultiplex, STExtract and STConcat return a new
+% native spike store (see STSpikeStore) when they work on a spike store
+% mapping, and the caller owns it.  A toolbox function which chains these
+% calls uses STFreeTemporaryStore to free the store of an intermediate train
+% 'stTemporary' once it is no longer needed.  The store is kept if the
+% mapping of any of the trains 'stKeep1', 'stKeep2', ... holds the same
+% handle: STShift returns its input mapping unchanged for a negligible
+% offset, for example, and the caller's own trains must never be freed.
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+hStore = StoreHandle(stTemporary);
+
+if (isempty(hStore))
+   return;
+end
+
+for (nKeepIndex = 1:numel(varargin))
+   if (isequal(StoreHandle(varargin{nKeepIndex}), hStore))
+      return;
+   end
+end
+
+STSpikeStore('destroy', hStore);
+
+% --- END of STFreeTemporaryStore FUNCTION ---
+
+
+% --- FUNCTION StoreHandle
+
+function [hStore] = StoreHandle(stTrain)
+
+if (FieldExists(stTrain, 'mapping') && isfield(stTrain.mapping, 'hSpikeStore'))
+   hStore = stTrain.mapping.hSpikeStore;
+else
+   hStore = [];
+end
+
+% --- END of StoreHandle FUNCTION ---
+
+% --- END of STFreeTemporaryStore.m ---
@@ -0,0 +1,190 @@
+/* STGeneratePoisson - FUNCTION (Internal) Event-driven generation of a poisson spike train
+ * $Id: STGeneratePoisson.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [vtSpikeTimes] = STGeneratePoisson(tTimeStart, nNumBins, fTemporalResolution, fFreq <, fhRandomGenerator>)
+ *
+ * STGeneratePoisson produces the same spike train distribution as
+ * STTestSpikePoisson with a constant 'fFreq', but without building a random
+ * sequence or probability vector the length of the time trace.  The time
+ * trace is the set of 'nNumBins' bins starting at 'tTimeStart' and spaced by
+ * 'fTemporalResolution' seconds, as built by STInstantiate for each chunk.
+ *
+ * STTestSpikePoisson places a spike in each bin independently with
+ * probability p = fFreq*dT * exp(-fFreq*dT).  The number of bins between
+ * successive spikes of such a process is geometrically distributed, and is
+ * drawn here directly from a single uniform deviate per spike:
+ *
+ *    nGap = 1 + floor(log(u) / log(1-p))
+ *
+ * which is the discrete-time counterpart of drawing an exponential inter-spike
+ * interval.  The cost is therefore proportional to the number of spikes
+ * generated, not to the duration of the train.
+ *
+ * 'fhRandomGenerator' is the function handle used to obtain uniform deviates
+ * (normally STOptions.RandomGenerator).  It is called as
+ * feval(fhRandomGenerator, 1, n), so seeding 'rand' or 'twister' controls this
+ * function in exactly the same way as the rest of the toolbox.  If it is not
+ * supplied, 'rand' is used.
+ *
+ * 'vtSpikeTimes' will be a row vector of spike times, in seconds, aligned to
+ * the bins of the time trace.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include <math.h>
+
+
+/* - Minimum and maximum number of uniform deviates to request at a time */
+#define MIN_RAND_BLOCK     256
+#define MAX_RAND_BLOCK     65536
+
+
+/* --- RandBlock - Fetch a block of uniform deviates from the toolbox generator */
+static mxArray *RandBlock(const mxArray *mxRandomGenerator, long nBlockSize)
+{
+   mxArray  *mxArgs[3],
+            *mxRand = NULL;
+
+   if (mxRandomGenerator != NULL) {
+      /* - feval(fhRandomGenerator, 1, nBlockSize) */
+      mxArgs[0] = (mxArray *) mxRandomGenerator;
+      mxArgs[1] = mxCreateDoubleScalar(1);
+      mxArgs[2] = mxCreateDoubleScalar((double) nBlockSize);
+      mexCallMATLAB(1, &mxRand, 3, mxArgs, "feval");
+      mxDestroyArray(mxArgs[1]);
+      mxDestroyArray(mxArgs[2]);
+
+   } else {
+      /* - rand(1, nBlockSize) */
+      mxArgs[0] = mxCreateDoubleScalar(1);
+      mxArgs[1] = mxCreateDoubleScalar((double) nBlockSize);
+      mexCallMATLAB(1, &mxRand, 2, mxArgs, "rand");
+      mxDestroyArray(mxArgs[0]);
+      mxDestroyArray(mxArgs[1]);
+   }
+
+   if (!mxIsDouble(mxRand) || ((long) mxGetNumberOfElements(mxRand) < nBlockSize)) {
+      mexErrMsgIdAndTxt("STGeneratePoisson:RandomGenerator",
+                        "*** STGeneratePoisson: The random generator did not return a double vector");
+   }
+
+   return mxRand;
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   double   tTimeStart,          /* Time of the first bin */
+            fTemporalResolution, /* Spacing between bins */
+            fFreq,               /* Desired spiking frequency */
+            fSpikeAvgNum,        /* Average number of spikes per bin */
+            fSpikeProb,          /* Probability of a spike in a single bin */
+            fLogNoSpike,         /* log(1 - fSpikeProb) */
+            fExpected,           /* Expected number of spikes */
+            fGap,                /* Number of bins to the next spike */
+            *adRand,             /* Current block of uniform deviates */
+            *adSpikes;           /* Output spike times */
+   long     nNumBins,            /* Number of bins in the time trace */
+            nBin,                /* Index of the current spike bin */
+            nNumSpikes,          /* Number of spikes generated */
+            nCapacity,           /* Allocated length of 'adSpikes' */
+            nBlockSize,          /* Size of the current random block */
+            nRandIndex;          /* Index into 'adRand' */
+   const mxArray *mxRandomGenerator = NULL;
+   mxArray  *mxRand;
+
+   /* - Check usage */
+   if ((nlhs > 1) || (nrhs < 4) || (nrhs > 5)) {
+      mexPrintf("*** STGeneratePoisson: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STGeneratePoisson");
+      return;
+   }
+
+   /* - Get arguments */
+   tTimeStart = mxGetScalar(prhs[0]);
+   nNumBins = (long) mxGetScalar(prhs[1]);
+   fTemporalResolution = mxGetScalar(prhs[2]);
+   fFreq = mxGetScalar(prhs[3]);
+
+   if ((nrhs > 4) && !mxIsEmpty(prhs[4])) {
+      mxRandomGenerator = prhs[4];
+   }
+
+   /* - Determine the per-bin spike probability, as in STTestSpikePoisson */
+   fSpikeAvgNum = fFreq * fTemporalResolution;
+   fSpikeProb = exp(-fSpikeAvgNum) * fSpikeAvgNum;
+
+   /* - Trivial trains have no spikes */
+   if ((nNumBins <= 0) || !(fSpikeProb > 0)) {
+      plhs[0] = mxCreateDoubleMatrix(1, 0, mxREAL);
+      return;
+   }
+
+   fLogNoSpike = log1p(-fSpikeProb);
+
+   /* - Allocate an output buffer big enough for almost every train */
+   fExpected = fSpikeProb * (double) nNumBins;
+   nCapacity = (long) (fExpected + 6 * sqrt(fExpected)) + 16;
+   adSpikes = (double *) mxMalloc(nCapacity * sizeof(double));
+
+   /* - Get an initial block of random deviates */
+   nBlockSize = (long) (fExpected + 6 * sqrt(fExpected)) + 1;
+   if (nBlockSize < MIN_RAND_BLOCK) nBlockSize = MIN_RAND_BLOCK;
+   if (nBlockSize > MAX_RAND_BLOCK) nBlockSize = MAX_RAND_BLOCK;
+   mxRand = RandBlock(mxRandomGenerator, nBlockSize);
+   adRand = mxGetPr(mxRand);
+   nRandIndex = 0;
+
+   /* - Hop from spike to spike */
+   nBin = -1;
+   nNumSpikes = 0;
+   for (;;) {
+      /* - Refill the random block, if necessary */
+      if (nRandIndex >= nBlockSize) {
+         mxDestroyArray(mxRand);
+         mxRand = RandBlock(mxRandomGenerator, nBlockSize);
+         adRand = mxGetPr(mxRand);
+         nRandIndex = 0;
+      }
+
+      /* - Draw the number of bins to the next spike.  A deviate of exactly
+       *   zero corresponds to an infinitely long gap */
+      if (adRand[nRandIndex] <= 0) {
+         break;
+      }
+      fGap = 1 + floor(log(adRand[nRandIndex++]) / fLogNoSpike);
+
+      if (fGap >= (double) (nNumBins - nBin)) {
+         /* - The next spike falls beyond the end of the time trace */
+         break;
+      }
+      nBin += (long) fGap;
+
+      /* - Grow the output buffer, if necessary */
+      if (nNumSpikes >= nCapacity) {
+         nCapacity *= 2;
+         adSpikes = (double *) mxRealloc(adSpikes, nCapacity * sizeof(double));
+      }
+
+      adSpikes[nNumSpikes++] = tTimeStart + nBin * fTemporalResolution;
+   }
+
+   mxDestroyArray(mxRand);
+
+   /* - Return the spike list as a row vector */
+   plhs[0] = mxCreateDoubleMatrix(0, 0, mxREAL);
+   mxSetPr(plhs[0], adSpikes);
+   mxSetM(plhs[0], 1);
+   mxSetN(plhs[0], nNumSpikes);
+}
+
+/* --- END of STGeneratePoisson.cpp --- */
@@ -0,0 +1,35 @@
+function [vtSpikeTimes] = STGeneratePoisson(tTimeStart, nNumBins, fTemporalResolution, fFreq, fhRandomGenerator)
+
+% STGeneratePoisson - FUNCTION (Internal) Event-driven generation of a poisson spike train
+% $Id: STGeneratePoisson.m $
+%
+% NOT for command-line use
+
+% Usage: [vtSpikeTimes] = STGeneratePoisson(tTimeStart, nNumBins, fTemporalResolution, fFreq <, fhRandomGenerator>)
+%
+% STGeneratePoisson produces the same spike train distribution as
+% STTestSpikePoisson with a constant 'fFreq', but without building a random
+% sequence or probability vector the length of the time trace.  The time
+% trace is the set of 'nNumBins' bins starting at 'tTimeStart' and spaced by
+% 'fTemporalResolution' seconds.  The number of bins between spikes is drawn
+% directly from the geometric distribution corresponding to the per-bin spike
+% probability, so the cost is proportional to the number of spikes generated.
+%
+% 'fhRandomGenerator' is the function handle used to obtain uniform deviates
+% (normally STOptions.RandomGenerator).  'vtSpikeTimes' will be a row vector of
+% spike times, in seconds, aligned to the bins of the time trace.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STGeneratePoisson.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STGeneratePoisson: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STGeneratePoisson.m ---
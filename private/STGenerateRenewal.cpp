@@ -0,0 +1,322 @@
+/* STGenerateRenewal - FUNCTION (Internal) Event-driven generation of a renewal-process spike train
+ * $Id: STGenerateRenewal.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [vtSpikeTimes] = STGenerateRenewal(strISIDistribution, fMeanISI, fVarISI, tTimeStart, tTimeEnd,
+ *                                           fTemporalResolution, vnSeed <, bRoundISIs>)
+ *
+ * STGenerateRenewal draws successive inter-spike intervals (ISIs) from a
+ * distribution with mean 'fMeanISI' and variance 'fVarISI' (both in seconds),
+ * starting at 'tTimeStart', until 'tTimeEnd' is reached.  Spikes are returned
+ * directly, so the cost is proportional to the number of spikes generated.
+ *
+ * 'strISIDistribution' is one of
+ *
+ *    'gamma'        - Gamma distribution, drawn using the method of Marsaglia
+ *                     and Tsang
+ *    'exponential'  - Exponential distribution shifted by a dead time.  The
+ *                     standard deviation of the ISIs is the mean of the
+ *                     exponential part, and the dead time makes up the rest
+ *                     of the mean ISI ('fVarISI' <= 'fMeanISI'^2).
+ *    'lognormal'    - Log-normal distribution
+ *    'invgauss'     - Inverse gaussian (Wald) distribution, drawn using the
+ *                     method of Michael, Schucany and Haas
+ *
+ * Spike times are aligned to bins of 'fTemporalResolution' seconds from
+ * 'tTimeStart'.  By default, the time of each spike is computed exactly and
+ * truncated to its bin, as STInstantaneousFrequencyGamma does.  If
+ * 'bRoundISIs' is true, each ISI is instead rounded to a whole number of bins,
+ * as STCreateFastPoisson does.  At most one spike is returned per bin.  Only
+ * spikes strictly before 'tTimeEnd' are returned.
+ *
+ * 'vnSeed' is a pair of 32-bit integers used to seed the generator, normally
+ * drawn from the toolbox random generator.
+ *
+ * 'vtSpikeTimes' will be a row vector of spike times, in seconds.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include <math.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "dSFMT.h"
+
+
+/* - ISI distributions */
+enum {
+   ISI_GAMMA,
+   ISI_EXPONENTIAL,
+   ISI_LOGNORMAL,
+   ISI_INVGAUSS
+};
+
+/* - Parameters of an ISI distribution */
+typedef struct {
+   int      nDistribution;
+   double   fParam1, fParam2,    /* Distribution parameters, see SetISIParams */
+            fGammaD, fGammaC;    /* Marsaglia-Tsang constants */
+   bool     bGammaBoost;         /* Shape < 1, so use the boosting trick */
+} ISIParams;
+
+
+/* --- Uniform - A uniform deviate on the open interval (0,1) */
+static inline double Uniform(dsfmt_state *state)
+{
+   return dsfmt_genrand_close_open(state) + (0.5 / 4503599627370496.0);
+}
+
+/* --- Normal - A standard normal deviate, by Marsaglia's polar method */
+static double Normal(dsfmt_state *state, double *pfSpare, bool *pbHaveSpare)
+{
+   double   u, v, s;
+
+   if (*pbHaveSpare) {
+      *pbHaveSpare = false;
+      return *pfSpare;
+   }
+
+   do {
+      u = 2 * dsfmt_genrand_close_open(state) - 1;
+      v = 2 * dsfmt_genrand_close_open(state) - 1;
+      s = u * u + v * v;
+   } while ((s >= 1) || (s == 0));
+
+   s = sqrt(-2 * log(s) / s);
+   *pfSpare = v * s;
+   *pbHaveSpare = true;
+   return u * s;
+}
+
+
+/* --- SetISIParams - Convert a mean and variance into distribution parameters */
+static void SetISIParams(ISIParams *params, int nDistribution, double fMeanISI, double fVarISI)
+{
+   double   fShape, fSigma2;
+
+   params->nDistribution = nDistribution;
+
+   switch (nDistribution) {
+      case ISI_GAMMA:
+         /* - Shape and scale */
+         fShape = fMeanISI * fMeanISI / fVarISI;
+         params->fParam1 = fShape;
+         params->fParam2 = fVarISI / fMeanISI;
+         params->bGammaBoost = (fShape < 1);
+         if (params->bGammaBoost) fShape += 1;
+         params->fGammaD = fShape - 1.0 / 3.0;
+         params->fGammaC = 1 / sqrt(9 * params->fGammaD);
+         break;
+
+      case ISI_EXPONENTIAL:
+         /* - Dead time and mean of the exponential part */
+         params->fParam2 = sqrt(fVarISI);
+         params->fParam1 = fMeanISI - params->fParam2;
+         break;
+
+      case ISI_LOGNORMAL:
+         /* - Mean and standard deviation of log(ISI) */
+         fSigma2 = log1p(fVarISI / (fMeanISI * fMeanISI));
+         params->fParam1 = log(fMeanISI) - fSigma2 / 2;
+         params->fParam2 = sqrt(fSigma2);
+         break;
+
+      case ISI_INVGAUSS:
+         /* - Mean and shape */
+         params->fParam1 = fMeanISI;
+         params->fParam2 = fMeanISI * fMeanISI * fMeanISI / fVarISI;
+         break;
+   }
+}
+
+/* --- DrawISI - Draw a single ISI */
+static double DrawISI(const ISIParams *params, dsfmt_state *state, double *pfSpare, bool *pbHaveSpare)
+{
+   double   x, v, u, y, fMu, fLambda;
+
+   switch (params->nDistribution) {
+      case ISI_GAMMA:
+         /* - Marsaglia and Tsang, "A Simple Method for Generating Gamma
+          *   Variables", ACM TOMS 26(3), 2000 */
+         for (;;) {
+            do {
+               x = Normal(state, pfSpare, pbHaveSpare);
+               v = 1 + params->fGammaC * x;
+            } while (v <= 0);
+
+            v = v * v * v;
+            u = Uniform(state);
+            if ((u < 1 - 0.0331 * (x * x) * (x * x)) ||
+                (log(u) < 0.5 * x * x + params->fGammaD * (1 - v + log(v)))) {
+               break;
+            }
+         }
+         y = params->fGammaD * v;
+
+         /* - Shapes < 1 are drawn at shape + 1, then scaled by U^(1/shape) */
+         if (params->bGammaBoost) y *= pow(Uniform(state), 1 / params->fParam1);
+         return y * params->fParam2;
+
+      case ISI_EXPONENTIAL:
+         return params->fParam1 - log(Uniform(state)) * params->fParam2;
+
+      case ISI_LOGNORMAL:
+         return exp(params->fParam1 + params->fParam2 * Normal(state, pfSpare, pbHaveSpare));
+
+      case ISI_INVGAUSS:
+         /* - Michael, Schucany and Haas, "Generating Random Variates Using
+          *   Transformations with Multiple Roots", Am. Stat. 30(2), 1976 */
+         fMu = params->fParam1;
+         fLambda = params->fParam2;
+         x = Normal(state, pfSpare, pbHaveSpare);
+         y = x * x;
+         x = fMu + (fMu * fMu * y) / (2 * fLambda)
+                 - (fMu / (2 * fLambda)) * sqrt(4 * fMu * fLambda * y + fMu * fMu * y * y);
+         if (Uniform(state) <= fMu / (fMu + x)) return x;
+         return fMu * fMu / x;
+   }
+
+   return 0;
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   char        strDistribution[16], *p;
+   int         nDistribution;
+   double      fMeanISI,            /* Mean ISI */
+               fVarISI,             /* ISI variance */
+               tTimeStart,          /* Time of the first bin */
+               tTimeEnd,            /* End of the train */
+               fTemporalResolution, /* Spacing between bins */
+               fNumBins,            /* Number of bins before 'tTimeEnd' */
+               tTimeCurr,           /* Time since 'tTimeStart', exact */
+               fBin,                /* Bin of the current spike */
+               fLastBin,            /* Bin of the last spike returned */
+               fSpare,              /* Spare normal deviate */
+               fExpected,           /* Expected number of spikes */
+               *adSeed,
+               *adSpikes;           /* Output spike times */
+   bool        bRoundISIs = false,
+               bHaveSpare = false;
+   long        nNumSpikes,          /* Number of spikes generated */
+               nCapacity;           /* Allocated length of 'adSpikes' */
+   uint32_t    anSeed[2];
+   ISIParams   params;
+   dsfmt_state state;
+
+   /* - Check usage */
+   if ((nlhs > 1) || (nrhs < 7) || (nrhs > 8)) {
+      mexPrintf("*** STGenerateRenewal: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STGenerateRenewal");
+      return;
+   }
+
+   /* - Get arguments */
+   if (!mxIsChar(prhs[0]) || mxGetString(prhs[0], strDistribution, sizeof(strDistribution))) {
+      mexErrMsgIdAndTxt("STGenerateRenewal:Distribution",
+                        "*** STGenerateRenewal: Unknown ISI distribution");
+   }
+   for (p = strDistribution; *p; p++) *p = tolower(*p);
+
+   if (!strcmp(strDistribution, "gamma")) {
+      nDistribution = ISI_GAMMA;
+   } else if (!strcmp(strDistribution, "exponential")) {
+      nDistribution = ISI_EXPONENTIAL;
+   } else if (!strcmp(strDistribution, "lognormal")) {
+      nDistribution = ISI_LOGNORMAL;
+   } else if (!strcmp(strDistribution, "invgauss")) {
+      nDistribution = ISI_INVGAUSS;
+   } else {
+      mexErrMsgIdAndTxt("STGenerateRenewal:Distribution",
+                        "*** STGenerateRenewal: Unknown ISI distribution [%s]", strDistribution);
+      return;
+   }
+
+   fMeanISI = mxGetScalar(prhs[1]);
+   fVarISI = mxGetScalar(prhs[2]);
+   tTimeStart = mxGetScalar(prhs[3]);
+   tTimeEnd = mxGetScalar(prhs[4]);
+   fTemporalResolution = mxGetScalar(prhs[5]);
+
+   if (!mxIsDouble(prhs[6]) || (mxGetNumberOfElements(prhs[6]) != 2)) {
+      mexErrMsgIdAndTxt("STGenerateRenewal:Seed",
+                        "*** STGenerateRenewal: 'vnSeed' must be a pair of integers");
+   }
+   adSeed = mxGetPr(prhs[6]);
+   anSeed[0] = (uint32_t) fmod(adSeed[0], 4294967296.0);
+   anSeed[1] = (uint32_t) fmod(adSeed[1], 4294967296.0);
+
+   if (nrhs > 7) bRoundISIs = mxGetScalar(prhs[7]) != 0;
+
+   if (!(fMeanISI > 0) || !(fVarISI > 0) || !(fTemporalResolution > 0)) {
+      mexErrMsgIdAndTxt("STGenerateRenewal:Parameters",
+                        "*** STGenerateRenewal: 'fMeanISI', 'fVarISI' and 'fTemporalResolution' must be positive");
+   }
+
+   if ((nDistribution == ISI_EXPONENTIAL) && (fVarISI > fMeanISI * fMeanISI)) {
+      mexErrMsgIdAndTxt("STGenerateRenewal:Parameters",
+                        "*** STGenerateRenewal: An exponential ISI distribution requires 'fVarISI' <= 'fMeanISI'^2");
+   }
+
+   /* - Trivial trains have no spikes */
+   fNumBins = (tTimeEnd - tTimeStart) / fTemporalResolution;
+   if (!(fNumBins > 0)) {
+      plhs[0] = mxCreateDoubleMatrix(1, 0, mxREAL);
+      return;
+   }
+
+   SetISIParams(&params, nDistribution, fMeanISI, fVarISI);
+   dsfmt_init_by_array(&state, anSeed, 2);
+
+   /* - Allocate an output buffer big enough for almost every train */
+   fExpected = (tTimeEnd - tTimeStart) / fMeanISI;
+   if (fExpected > fNumBins) fExpected = fNumBins;
+   nCapacity = (long) (fExpected + 6 * sqrt(fExpected)) + 16;
+   adSpikes = (double *) mxMalloc(nCapacity * sizeof(double));
+
+   /* - Hop from spike to spike */
+   nNumSpikes = 0;
+   tTimeCurr = 0;
+   fBin = 0;
+   fLastBin = -1;
+   for (;;) {
+      if (bRoundISIs) {
+         fBin += floor(DrawISI(&params, &state, &fSpare, &bHaveSpare) / fTemporalResolution + 0.5);
+         if (fBin >= fNumBins) break;
+
+      } else {
+         tTimeCurr += DrawISI(&params, &state, &fSpare, &bHaveSpare);
+         if (tTimeCurr >= tTimeEnd - tTimeStart) break;
+         fBin = trunc(tTimeCurr / fTemporalResolution);
+      }
+
+      /* - Only one spike per bin */
+      if (fBin == fLastBin) continue;
+      fLastBin = fBin;
+
+      /* - Grow the output buffer, if necessary */
+      if (nNumSpikes >= nCapacity) {
+         nCapacity *= 2;
+         adSpikes = (double *) mxRealloc(adSpikes, nCapacity * sizeof(double));
+      }
+
+      adSpikes[nNumSpikes++] = tTimeStart + fBin * fTemporalResolution;
+   }
+
+   /* - Return the spike list as a row vector */
+   plhs[0] = mxCreateDoubleMatrix(0, 0, mxREAL);
+   mxSetPr(plhs[0], adSpikes);
+   mxSetM(plhs[0], 1);
+   mxSetN(plhs[0], nNumSpikes);
+}
+
+/* --- END of STGenerateRenewal.cpp --- */
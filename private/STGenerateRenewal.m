@@ -0,0 +1,33 @@
+function [vtSpikeTimes] = STGenerateRenewal(strISIDistribution, fMeanISI, fVarISI, tTimeStart, tTimeEnd, fTemporalResolution, vnSeed, bRoundISIs)
+
+% STGenerateRenewal - FUNCTION (Internal) Event-driven generation of a renewal-process spike train
+% $Id: STGenerateRenewal.m $
+%
+% NOT for command-line use
+
+% Usage: [vtSpikeTimes] = STGenerateRenewal(strISIDistribution, fMeanISI, fVarISI, tTimeStart, tTimeEnd,
+%                                           fTemporalResolution, vnSeed <, bRoundISIs>)
+%
+% STGenerateRenewal draws successive inter-spike intervals from a 'gamma',
+% 'exponential' (with a dead time), 'lognormal' or 'invgauss' distribution
+% with mean 'fMeanISI' and variance 'fVarISI', from 'tTimeStart' until
+% 'tTimeEnd', aligning spikes to bins of 'fTemporalResolution'.  The cost is
+% proportional to the number of spikes generated.  See STGenerateRenewal.cpp
+% for a description of the arguments.
+%
+% 'vtSpikeTimes' will be a row vector of spike times in seconds.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STGenerateRenewal.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STGenerateRenewal: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STGenerateRenewal.m ---
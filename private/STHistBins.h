@@ -0,0 +1,49 @@
+/* STHistBins.h - Histogram bins which match MATLAB's 'hist'
+ * $Id: STHistBins.h $
+ *
+ * NOT for command-line use
+ *
+ * 'hist' takes a vector of bin centres.  The edge between two bins lies
+ * halfway between their centres, computed as c(k) + (c(k+1) - c(k)) / 2, and
+ * the first and last bins extend without limit.  'hist' moves each edge up by
+ * eps before counting, so a bin holds the values in (edge(k-1), edge(k)], and
+ * a value which lies exactly on an edge falls in the lower bin.
+ *
+ *    STHistEdges  - Find the edges between a vector of bin centres
+ *    STHistBin    - Find the bin of a value, as 'hist' would
+ */
+
+/* Author: agent <agent@local>
+ * Created: 17th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_HIST_BINS_H
+#define ST_HIST_BINS_H
+
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+
+/* --- STHistEdges - Find the nNumBins-1 edges between the bin centres 'adCentres' */
+static inline std::vector<double> STHistEdges(const double *adCentres, size_t nNumBins)
+{
+   std::vector<double> vfEdges;
+
+   for (size_t nBin = 1; nBin < nNumBins; nBin++) {
+      vfEdges.push_back(adCentres[nBin - 1] + (adCentres[nBin] - adCentres[nBin - 1]) / 2);
+   }
+
+   return vfEdges;
+}
+
+/* --- STHistBin - Return the (zero-based) bin of 'fValue'; values on an edge fall in the lower bin */
+static inline size_t STHistBin(const std::vector<double> &vfEdges, double fValue)
+{
+   return std::lower_bound(vfEdges.begin(), vfEdges.end(), fValue) - vfEdges.begin();
+}
+
+#endif  /* ST_HIST_BINS_H */
+
+/* --- END of STHistBins.h --- */
@@ -0,0 +1,115 @@
+/* STHistBins_test - Check that STHistBins.h bins values as 'hist' does
+ * $Id: STHistBins_test.cpp $
+ *
+ * Usage: STHistBins_test
+ *
+ * This is a stand-alone program (not a MEX file), built and run with "make
+ * test" in the toolbox private directory.  It compares STHistBin with a
+ * transcription of the binning done by MATLAB's 'hist', which moves each edge
+ * up by eps and counts with 'histc', for random values and for values lying
+ * exactly on an edge.  The tie cases include tick-quantised ISIs, as found by
+ * STISIAddresses.  It prints "passed" and returns zero if every value falls
+ * in the same bin.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 17th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include "STHistBins.h"
+
+
+/* --- HistBin - The bin 'hist' chooses for 'fValue' */
+static size_t HistBin(const std::vector<double> &vfEdges, double fValue)
+{
+   size_t nBin = 0;
+
+   /* - Bin k holds [edge(k-1) + eps, edge(k) + eps), as histc counts */
+   while ((nBin < vfEdges.size()) && (fValue >= nextafter(vfEdges[nBin], HUGE_VAL))) nBin++;
+   return nBin;
+}
+
+/* --- CheckBin - Compare STHistBin with 'hist' for one value */
+static int CheckBin(const std::vector<double> &vfEdges, double fValue, const char *strCase)
+{
+   size_t nExpected = HistBin(vfEdges, fValue), nFound = STHistBin(vfEdges, fValue);
+
+   if (nFound == nExpected) return 0;
+
+   printf("*** STHistBins_test: %s: %.17g falls in bin %u, not %u\n",
+          strCase, fValue, (unsigned) nFound, (unsigned) nExpected);
+   return 1;
+}
+
+
+int main(void)
+{
+   int nFailures = 0;
+
+   /* - Values on an edge fall in the lower bin */
+   {
+      const double         afCentres[] = { 1, 2, 3 };
+      std::vector<double>  vfEdges = STHistEdges(afCentres, 3);
+
+      if ((STHistBin(vfEdges, 1.5) != 0) || (STHistBin(vfEdges, 2.5) != 1)) {
+         printf("*** STHistBins_test: Values on an edge don't fall in the lower bin\n");
+         nFailures++;
+      }
+
+      nFailures += CheckBin(vfEdges, -10, "below the first centre");
+      nFailures += CheckBin(vfEdges, 10, "above the last centre");
+      nFailures += CheckBin(vfEdges, nextafter(1.5, HUGE_VAL), "just above an edge");
+      nFailures += CheckBin(vfEdges, nextafter(2.5, -HUGE_VAL), "just below an edge");
+   }
+
+   /* - Tick-quantised ISIs lying on the edges of bins spaced by two ticks */
+   {
+      const double         fTemporalResolution = 1e-6;
+      std::vector<double>  vfCentres;
+
+      for (int nBin = 0; nBin < 50; nBin++) vfCentres.push_back((3 + 2 * nBin) * fTemporalResolution);
+      std::vector<double> vfEdges = STHistEdges(vfCentres.data(), vfCentres.size());
+
+      for (int nTick = 0; nTick < 200; nTick++) {
+         double tISI = (1000 + nTick) * fTemporalResolution - 1000 * fTemporalResolution;
+         nFailures += CheckBin(vfEdges, tISI, "tick-quantised ISI");
+      }
+
+      for (size_t nEdge = 0; nEdge < vfEdges.size(); nEdge++) {
+         nFailures += CheckBin(vfEdges, vfEdges[nEdge], "value on an edge");
+      }
+   }
+
+   /* - Random values over uneven bins */
+   {
+      std::vector<double> vfCentres;
+      double              fCentre = 0;
+
+      srand(1);
+      for (int nBin = 0; nBin < 40; nBin++) {
+         fCentre += 0.01 + (double) rand() / RAND_MAX;
+         vfCentres.push_back(fCentre);
+      }
+      std::vector<double> vfEdges = STHistEdges(vfCentres.data(), vfCentres.size());
+
+      for (int nValue = 0; nValue < 100000; nValue++) {
+         nFailures += CheckBin(vfEdges, -1 + (fCentre + 2) * rand() / RAND_MAX, "random value");
+      }
+   }
+
+   if (nFailures > 0) {
+      printf("*** STHistBins_test: %d failures\n", nFailures);
+      return 1;
+   }
+
+   printf("STHistBins_test: passed\n");
+   return 0;
+}
+
+/* --- END of STHistBins_test.cpp --- */
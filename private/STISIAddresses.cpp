@@ -0,0 +1,316 @@
+/* STISIAddresses - FUNCTION (Internal) Inter-spike interval statistics for each address of a mapping
+ * $Id: STISIAddresses.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [mISIHist, vKey, vtMeanISI, vfCV, vtMinISI, vtMaxISI] = ...
+ *             STISIAddresses(cChunks, fTemporalResolution, tTimeBins <, nNumThreads>)
+ *
+ * 'cChunks' is a cell array of [tick addr] mapping spike list chunks, in time
+ * order, with ticks of 'fTemporalResolution' seconds.  The spikes of each
+ * address form a train, and the intervals between its consecutive spikes are
+ * its inter-spike intervals (ISIs), in seconds, found as the difference of
+ * the spike times tick * 'fTemporalResolution'.
+ *
+ * 'vKey' returns every address in the spike list, sorted, as a Kx1 vector.
+ * For each address, 'vtMeanISI' returns the mean ISI, 'vfCV' the coefficient
+ * of variation of the ISIs (their sample standard deviation divided by their
+ * mean), and 'vtMinISI' and 'vtMaxISI' the shortest and longest ISIs.  These
+ * are NaN for addresses with too few spikes.
+ *
+ * 'tTimeBins' is a vector of histogram bin centres, as used by 'hist'.  The
+ * edge between two bins lies halfway between their centres, an ISI on an edge
+ * falls in the lower bin, and the first and last bins extend without limit
+ * (see STHistBins.h).
+ * 'mISIHist' returns a KxB matrix, with the ISI histogram of each address
+ * along its row.  If 'tTimeBins' is empty, no histograms are made.
+ *
+ * The spike list is read once.  It is split into contiguous ranges of spikes,
+ * one per thread (by default, one per hardware thread), and only the first
+ * and last spike of each address is kept as state, along with running
+ * statistics.  The ranges are then joined in order: the ISI spanning the
+ * join is added, and the statistics are combined.  Chunks which are not
+ * sorted by tick are sorted first; if the chunks overlap in time, the whole
+ * spike list is sorted.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 17th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STHistBins.h"
+#include "STThreadPool.h"
+#include <math.h>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+/* - Largest number of spikes in one piece of a chunk */
+#define ISI_BLOCK          65536
+
+
+/* - A piece of the spike list, sorted by tick */
+struct ISIPiece {
+   const double   *adTicks, *adAddrs;
+   size_t         nCount;
+};
+
+/* - The spike list, and the histogram bins */
+struct ISISpikes {
+   std::vector<ISIPiece>   vPieces;
+   std::vector<double>     vfSorted;      /* Storage for sorted copies of chunks */
+   std::vector<double>     vfEdges;
+   double                  fTemporalResolution;
+   size_t                  nNumBins;
+};
+
+/* - Running statistics of the spikes of one address */
+struct ISIState {
+   double   tFirst, tLast;
+   double   fNum, tMean, fM2, tMin, tMax;
+};
+
+/* - The addresses seen in one range of spikes */
+struct ISIRange {
+   std::unordered_map<double, size_t>  mapIndex;
+   std::vector<double>                 vfAddrs;
+   std::vector<ISIState>               vState;
+   std::vector<double>                 vfHist;
+};
+
+
+/* --- AddISI - Add one ISI to the statistics and histogram of an address */
+static inline void AddISI(const ISISpikes &spikes, double tISI, ISIState &state, double *afHist)
+{
+   double tDelta = tISI - state.tMean;
+
+   state.fNum++;
+   state.tMean += tDelta / state.fNum;
+   state.fM2 += tDelta * (tISI - state.tMean);
+   state.tMin = std::min(state.tMin, tISI);
+   state.tMax = std::max(state.tMax, tISI);
+
+   if (spikes.nNumBins > 0) {
+      afHist[STHistBin(spikes.vfEdges, tISI)]++;
+   }
+}
+
+/* --- CountRange - Collect the statistics of each address over pieces [nFirst, nLast) */
+static void CountRange(const ISISpikes &spikes, size_t nFirst, size_t nLast, ISIRange &range)
+{
+   for (size_t nPiece = nFirst; nPiece < nLast; nPiece++) {
+      const ISIPiece &piece = spikes.vPieces[nPiece];
+
+      for (size_t nSpike = 0; nSpike < piece.nCount; nSpike++) {
+         double   tSpike = piece.adTicks[nSpike] * spikes.fTemporalResolution,
+                  fAddr = piece.adAddrs[nSpike];
+
+         std::pair<std::unordered_map<double, size_t>::iterator, bool> found =
+            range.mapIndex.insert(std::make_pair(fAddr, range.vState.size()));
+
+         if (found.second) {
+            /* - The first spike of this address in the range */
+            ISIState state = { tSpike, tSpike, 0, 0, 0, HUGE_VAL, -HUGE_VAL };
+            range.vState.push_back(state);
+            range.vfAddrs.push_back(fAddr);
+            range.vfHist.resize(range.vfHist.size() + spikes.nNumBins, 0);
+            continue;
+         }
+
+         ISIState &state = range.vState[found.first->second];
+         AddISI(spikes, tSpike - state.tLast, state, range.vfHist.data() + found.first->second * spikes.nNumBins);
+         state.tLast = tSpike;
+      }
+   }
+}
+
+/* --- JoinRange - Append the statistics of a later range to 'total' */
+static void JoinRange(const ISISpikes &spikes, const ISIRange &range, ISIRange &total)
+{
+   for (size_t nLocal = 0; nLocal < range.vState.size(); nLocal++) {
+      const ISIState &later = range.vState[nLocal];
+
+      std::pair<std::unordered_map<double, size_t>::iterator, bool> found =
+         total.mapIndex.insert(std::make_pair(range.vfAddrs[nLocal], total.vState.size()));
+
+      if (found.second) {
+         total.vState.push_back(later);
+         total.vfAddrs.push_back(range.vfAddrs[nLocal]);
+         total.vfHist.insert(total.vfHist.end(), range.vfHist.begin() + nLocal * spikes.nNumBins,
+                             range.vfHist.begin() + (nLocal + 1) * spikes.nNumBins);
+         continue;
+      }
+
+      ISIState &state = total.vState[found.first->second];
+      double   *afHist = total.vfHist.data() + found.first->second * spikes.nNumBins;
+
+      /* - Add the ISI spanning the join */
+      AddISI(spikes, later.tFirst - state.tLast, state, afHist);
+
+      /* - Combine the statistics of the two ranges */
+      if (later.fNum > 0) {
+         double fNum = state.fNum + later.fNum,
+                tDelta = later.tMean - state.tMean;
+
+         state.fM2 += later.fM2 + tDelta * tDelta * state.fNum * later.fNum / fNum;
+         state.tMean += tDelta * later.fNum / fNum;
+         state.fNum = fNum;
+         state.tMin = std::min(state.tMin, later.tMin);
+         state.tMax = std::max(state.tMax, later.tMax);
+      }
+      state.tLast = later.tLast;
+
+      for (size_t nBin = 0; nBin < spikes.nNumBins; nBin++) afHist[nBin] += range.vfHist[nLocal * spikes.nNumBins + nBin];
+   }
+}
+
+
+/* --- ReadChunks - Split the chunks into sorted pieces */
+static void ReadChunks(const mxArray *pCell, ISISpikes &spikes)
+{
+   std::vector< std::pair<const double *, size_t> >   vChunks;
+   size_t                                             nTotal = 0;
+   bool                                               bSorted = true;
+   double                                             fLastTick = -HUGE_VAL;
+
+   for (size_t nChunk = 0; nChunk < mxGetNumberOfElements(pCell); nChunk++) {
+      const mxArray *pChunk = mxGetCell(pCell, nChunk);
+
+      if ((pChunk == NULL) || mxIsEmpty(pChunk)) continue;
+
+      if (!mxIsDouble(pChunk) || mxIsComplex(pChunk) || (mxGetN(pChunk) != 2)) {
+         mexErrMsgIdAndTxt("STISIAddresses:InvalidSpikeList",
+                           "*** STISIAddresses: Chunks must be real double [tick addr] spike lists");
+      }
+
+      const double   *adTicks = mxGetPr(pChunk);
+      size_t         nCount = mxGetM(pChunk);
+
+      if (!std::is_sorted(adTicks, adTicks + nCount) || (adTicks[0] < fLastTick)) bSorted = false;
+      fLastTick = std::max(fLastTick, adTicks[nCount - 1]);
+
+      vChunks.push_back(std::make_pair(adTicks, nCount));
+      nTotal += nCount;
+   }
+
+   if (!bSorted) {
+      /* - Sort every spike by tick, keeping the order of simultaneous spikes */
+      std::vector< std::pair<double, double> > vSpikes;
+      vSpikes.reserve(nTotal);
+
+      for (size_t nChunk = 0; nChunk < vChunks.size(); nChunk++) {
+         const double *adTicks = vChunks[nChunk].first;
+         size_t       nCount = vChunks[nChunk].second;
+
+         for (size_t nSpike = 0; nSpike < nCount; nSpike++) vSpikes.push_back(std::make_pair(adTicks[nSpike], adTicks[nCount + nSpike]));
+      }
+
+      std::stable_sort(vSpikes.begin(), vSpikes.end(),
+                       [](const std::pair<double, double> &a, const std::pair<double, double> &b) { return a.first < b.first; });
+
+      spikes.vfSorted.resize(2 * nTotal);
+      for (size_t nSpike = 0; nSpike < nTotal; nSpike++) {
+         spikes.vfSorted[nSpike] = vSpikes[nSpike].first;
+         spikes.vfSorted[nTotal + nSpike] = vSpikes[nSpike].second;
+      }
+
+      vChunks.assign(1, std::make_pair((const double *) spikes.vfSorted.data(), nTotal));
+   }
+
+   for (size_t nChunk = 0; nChunk < vChunks.size(); nChunk++) {
+      const double *adTicks = vChunks[nChunk].first;
+      size_t       nCount = vChunks[nChunk].second;
+
+      for (size_t nFirst = 0; nFirst < nCount; nFirst += ISI_BLOCK) {
+         ISIPiece piece = { adTicks + nFirst, adTicks + nCount + nFirst, std::min((size_t) ISI_BLOCK, nCount - nFirst) };
+         spikes.vPieces.push_back(piece);
+      }
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   ISISpikes               spikes;
+   std::vector<ISIRange>   vRanges;
+   unsigned                nNumThreads = STDefaultNumThreads();
+   size_t                  nNumRanges, nNumKeys, nKey, nBin;
+
+   /* - Check usage */
+   if ((nlhs > 6) || (nrhs < 3) || (nrhs > 4) || !mxIsCell(prhs[0]) || (!mxIsEmpty(prhs[2]) && !mxIsDouble(prhs[2]))) {
+      mexPrintf("*** STISIAddresses: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STISIAddresses");
+      return;
+   }
+
+   spikes.fTemporalResolution = mxGetScalar(prhs[1]);
+
+   /* - Place each edge halfway between two bin centres, as 'hist' does */
+   spikes.nNumBins = mxGetNumberOfElements(prhs[2]);
+   if (spikes.nNumBins > 0) spikes.vfEdges = STHistEdges(mxGetPr(prhs[2]), spikes.nNumBins);
+
+   if (!std::is_sorted(spikes.vfEdges.begin(), spikes.vfEdges.end())) {
+      mexErrMsgIdAndTxt("STISIAddresses:InvalidArgument", "*** STISIAddresses: Bin centres must be increasing");
+   }
+
+   if ((nrhs > 3) && !mxIsEmpty(prhs[3]) && (mxGetScalar(prhs[3]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[3]);
+   }
+
+   ReadChunks(prhs[0], spikes);
+
+   /* - Collect statistics over contiguous ranges of pieces, then join the ranges in order */
+   nNumRanges = std::max((size_t) 1, std::min((size_t) nNumThreads, spikes.vPieces.size()));
+   vRanges.resize(nNumRanges);
+
+   STParallelFor(nNumRanges, nNumThreads, [&](size_t nRange, unsigned) {
+      CountRange(spikes, nRange * spikes.vPieces.size() / nNumRanges,
+                 (nRange + 1) * spikes.vPieces.size() / nNumRanges, vRanges[nRange]);
+   });
+
+   for (size_t nRange = 1; nRange < nNumRanges; nRange++) JoinRange(spikes, vRanges[nRange], vRanges[0]);
+
+   const ISIRange &total = vRanges[0];
+
+   /* - Order the addresses */
+   std::vector< std::pair<double, size_t> > vKeys;
+   for (nKey = 0; nKey < total.vfAddrs.size(); nKey++) vKeys.push_back(std::make_pair(total.vfAddrs[nKey], nKey));
+   std::sort(vKeys.begin(), vKeys.end());
+   nNumKeys = vKeys.size();
+
+   /* - Return the histograms and statistics */
+   plhs[0] = mxCreateDoubleMatrix(nNumKeys, spikes.nNumBins, mxREAL);
+   double   *adHist = mxGetPr(plhs[0]),
+            *adOut[5];
+
+   for (int nOut = 1; nOut < 6; nOut++) {
+      adOut[nOut - 1] = NULL;
+      if (nOut < nlhs) {
+         plhs[nOut] = mxCreateDoubleMatrix(nNumKeys, 1, mxREAL);
+         adOut[nOut - 1] = mxGetPr(plhs[nOut]);
+      }
+   }
+
+   for (nKey = 0; nKey < nNumKeys; nKey++) {
+      const ISIState &state = total.vState[vKeys[nKey].second];
+      const double   fNaN = mxGetNaN();
+
+      for (nBin = 0; nBin < spikes.nNumBins; nBin++) {
+         adHist[nKey + nBin * nNumKeys] = total.vfHist[vKeys[nKey].second * spikes.nNumBins + nBin];
+      }
+
+      if (adOut[0] != NULL) adOut[0][nKey] = vKeys[nKey].first;
+      if (adOut[1] != NULL) adOut[1][nKey] = (state.fNum > 0) ? state.tMean : fNaN;
+      if (adOut[2] != NULL) adOut[2][nKey] = (state.fNum > 1) ? sqrt(state.fM2 / (state.fNum - 1)) / state.tMean : fNaN;
+      if (adOut[3] != NULL) adOut[3][nKey] = (state.fNum > 0) ? state.tMin : fNaN;
+      if (adOut[4] != NULL) adOut[4][nKey] = (state.fNum > 0) ? state.tMax : fNaN;
+   }
+}
+
+/* --- END of STISIAddresses.cpp --- */
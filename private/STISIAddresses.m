@@ -0,0 +1,33 @@
+function [mISIHist, vKey, vtMeanISI, vfCV, vtMinISI, vtMaxISI] = STISIAddresses(cChunks, fTemporalResolution, tTimeBins, nNumThreads)
+
+% STISIAddresses - FUNCTION (Internal) Inter-spike interval statistics for each address of a mapping
+% $Id: STISIAddresses.m $
+%
+% NOT for command-line use
+
+% Usage: [mISIHist, vKey, vtMeanISI, vfCV, vtMinISI, vtMaxISI] = ...
+%             STISIAddresses(cChunks, fTemporalResolution, tTimeBins <, nNumThreads>)
+%
+% 'cChunks' is a cell array of [tick addr] mapping spike list chunks, in time
+% order.  For the spikes of each address, STISIAddresses finds the ISI
+% histogram over the bin centres 'tTimeBins' (as 'hist' would; none if
+% 'tTimeBins' is empty), and the mean, coefficient of variation, minimum and
+% maximum ISI.  'vKey' returns the sorted addresses, one per row of each
+% result.  The spike list is read once, keeping only the last spike of each
+% address, in ranges spread over 'nNumThreads' threads, by default one per
+% hardware thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STISIAddresses.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STISIAddresses: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STISIAddresses.m ---
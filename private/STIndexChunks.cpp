@@ -0,0 +1,197 @@
+/* STIndexChunks - FUNCTION (Internal) Build an address index of a mapping spike list
+ * $Id: STIndexChunks.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [vAddrKey, vnOffsets, vnPostings, vnChunkStarts] = STIndexChunks(cChunks <, nNumThreads>)
+ *
+ * 'cChunks' is a cell array of [tick addr] mapping spike list chunks.  The
+ * spikes of all chunks are numbered in order from 1, so that spike 'n' is
+ * row n - vnChunkStarts(c) of chunk 'c', where 'vnChunkStarts' is the (C+1)x1
+ * running total of the chunk lengths, starting with 0.
+ *
+ * STIndexChunks returns an inverted index of the spike list, in compressed
+ * sparse row form.  'vAddrKey' is a Kx1 vector of every address in the spike
+ * list, sorted.  The spikes with address vAddrKey(k) are numbered
+ *
+ *    vnPostings(vnOffsets(k)+1 : vnOffsets(k+1))
+ *
+ * in increasing order, where 'vnOffsets' is (K+1)x1.  Since the keys are
+ * sorted, the spikes of any range of addresses are also a single range of
+ * 'vnPostings'.
+ *
+ * The index is built by counting sort, in time proportional to the number of
+ * spikes (plus the time to sort the distinct addresses).  The spike list is
+ * split into contiguous ranges, one per thread (by default, one per hardware
+ * thread), which first collect their addresses, then count the spikes of
+ * each address, and finally place their spikes in the postings.  Placing the
+ * ranges in order keeps the spikes of each address in order.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 17th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STThreadPool.h"
+#include <stdint.h>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+/* - Smallest number of spikes worth indexing on a separate thread */
+#define INDEX_MIN_RANGE    65536
+
+
+/* - The spike list, as its chunks' address columns */
+struct IndexSpikes {
+   std::vector<const double *>   vadAddrs;
+   std::vector<size_t>           vnStarts;
+   size_t                        nTotal;
+};
+
+
+/* --- ForEachSpike - Call fn(nSpike, fAddr) for the spikes [nFirst, nLast), in order */
+template <typename Fn>
+static void ForEachSpike(const IndexSpikes &spikes, size_t nFirst, size_t nLast, Fn fn)
+{
+   size_t nChunk = std::upper_bound(spikes.vnStarts.begin(), spikes.vnStarts.end(), nFirst) - spikes.vnStarts.begin() - 1;
+
+   for (size_t nSpike = nFirst; nSpike < nLast; nSpike++) {
+      while (nSpike >= spikes.vnStarts[nChunk + 1]) nChunk++;
+      fn(nSpike, spikes.vadAddrs[nChunk][nSpike - spikes.vnStarts[nChunk]]);
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   IndexSpikes                            spikes;
+   std::vector<double>                    vfKey;
+   std::unordered_map<double, uint32_t>   mapRank;
+   std::vector<uint32_t>                  vnSpikeKey;
+   std::vector< std::vector<size_t> >     vvnPlace;
+   unsigned                               nNumThreads = STDefaultNumThreads();
+   size_t                                 nNumRanges, nChunk, nKey;
+   double                                 *adOut;
+
+   /* - Check usage */
+   if ((nlhs > 4) || (nrhs < 1) || (nrhs > 2) || !mxIsCell(prhs[0])) {
+      mexPrintf("*** STIndexChunks: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STIndexChunks");
+      return;
+   }
+
+   if ((nrhs > 1) && !mxIsEmpty(prhs[1]) && (mxGetScalar(prhs[1]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[1]);
+   }
+
+   /* - Number the spikes of every chunk */
+   spikes.vnStarts.push_back(0);
+   for (nChunk = 0; nChunk < mxGetNumberOfElements(prhs[0]); nChunk++) {
+      const mxArray  *pChunk = mxGetCell(prhs[0], nChunk);
+      size_t         nCount = 0;
+
+      if ((pChunk != NULL) && !mxIsEmpty(pChunk)) {
+         if (!mxIsDouble(pChunk) || mxIsComplex(pChunk) || (mxGetN(pChunk) != 2)) {
+            mexErrMsgIdAndTxt("STIndexChunks:InvalidSpikeList",
+                              "*** STIndexChunks: Chunks must be real double [tick addr] spike lists");
+         }
+         nCount = mxGetM(pChunk);
+      }
+
+      spikes.vadAddrs.push_back((nCount > 0) ? mxGetPr(pChunk) + nCount : NULL);
+      spikes.vnStarts.push_back(spikes.vnStarts.back() + nCount);
+   }
+   spikes.nTotal = spikes.vnStarts.back();
+
+   if (spikes.nTotal > (size_t) UINT32_MAX) {
+      mexErrMsgIdAndTxt("STIndexChunks:InvalidSpikeList", "*** STIndexChunks: The spike list is too long to index");
+   }
+
+   nNumRanges = std::max((size_t) 1, std::min((size_t) nNumThreads, spikes.nTotal / INDEX_MIN_RANGE));
+   std::vector< std::unordered_set<double> > vsetAddrs(nNumRanges);
+   std::vector<char>                         vbNaN(nNumRanges, 0);
+
+   /* - Collect the addresses of each range */
+   STParallelFor(nNumRanges, nNumThreads, [&](size_t nRange, unsigned) {
+      ForEachSpike(spikes, nRange * spikes.nTotal / nNumRanges, (nRange + 1) * spikes.nTotal / nNumRanges,
+                   [&](size_t, double fAddr) {
+                      if (fAddr != fAddr) vbNaN[nRange] = 1;
+                      else vsetAddrs[nRange].insert(fAddr);
+                   });
+   });
+
+   if (std::find(vbNaN.begin(), vbNaN.end(), 1) != vbNaN.end()) {
+      mexErrMsgIdAndTxt("STIndexChunks:InvalidSpikeList", "*** STIndexChunks: Spike addresses must not be NaN");
+   }
+
+   /* - Sort the addresses, and rank them */
+   for (size_t nRange = 0; nRange < nNumRanges; nRange++) vfKey.insert(vfKey.end(), vsetAddrs[nRange].begin(), vsetAddrs[nRange].end());
+   std::sort(vfKey.begin(), vfKey.end());
+   vfKey.erase(std::unique(vfKey.begin(), vfKey.end()), vfKey.end());
+
+   mapRank.reserve(vfKey.size());
+   for (nKey = 0; nKey < vfKey.size(); nKey++) mapRank[vfKey[nKey]] = (uint32_t) nKey;
+
+   /* - Count the spikes of each address in each range */
+   vnSpikeKey.resize(spikes.nTotal);
+   vvnPlace.assign(nNumRanges, std::vector<size_t>(vfKey.size(), 0));
+
+   STParallelFor(nNumRanges, nNumThreads, [&](size_t nRange, unsigned) {
+      std::vector<size_t> &vnCount = vvnPlace[nRange];
+
+      ForEachSpike(spikes, nRange * spikes.nTotal / nNumRanges, (nRange + 1) * spikes.nTotal / nNumRanges,
+                   [&](size_t nSpike, double fAddr) {
+                      uint32_t nRank = mapRank.find(fAddr)->second;
+                      vnSpikeKey[nSpike] = nRank;
+                      vnCount[nRank]++;
+                   });
+   });
+
+   /* - Find the offset of each address, and where each range places its spikes */
+   plhs[1] = mxCreateDoubleMatrix(vfKey.size() + 1, 1, mxREAL);
+   adOut = mxGetPr(plhs[1]);
+
+   size_t nOffset = 0;
+   for (nKey = 0; nKey < vfKey.size(); nKey++) {
+      adOut[nKey] = (double) nOffset;
+
+      for (size_t nRange = 0; nRange < nNumRanges; nRange++) {
+         size_t nCount = vvnPlace[nRange][nKey];
+         vvnPlace[nRange][nKey] = nOffset;
+         nOffset += nCount;
+      }
+   }
+   adOut[vfKey.size()] = (double) nOffset;
+
+   /* - Place the spikes, numbered from 1 */
+   plhs[2] = mxCreateDoubleMatrix(spikes.nTotal, 1, mxREAL);
+   adOut = mxGetPr(plhs[2]);
+
+   STParallelFor(nNumRanges, nNumThreads, [&](size_t nRange, unsigned) {
+      std::vector<size_t>  &vnPlace = vvnPlace[nRange];
+      size_t               nLast = (nRange + 1) * spikes.nTotal / nNumRanges;
+
+      for (size_t nSpike = nRange * spikes.nTotal / nNumRanges; nSpike < nLast; nSpike++) {
+         adOut[vnPlace[vnSpikeKey[nSpike]]++] = (double) (nSpike + 1);
+      }
+   });
+
+   /* - Return the keys and the chunk numbering */
+   plhs[0] = mxCreateDoubleMatrix(vfKey.size(), 1, mxREAL);
+   std::copy(vfKey.begin(), vfKey.end(), mxGetPr(plhs[0]));
+
+   if (nlhs > 3) {
+      plhs[3] = mxCreateDoubleMatrix(spikes.vnStarts.size(), 1, mxREAL);
+      adOut = mxGetPr(plhs[3]);
+      for (nChunk = 0; nChunk < spikes.vnStarts.size(); nChunk++) adOut[nChunk] = (double) spikes.vnStarts[nChunk];
+   }
+}
+
+/* --- END of STIndexChunks.cpp --- */
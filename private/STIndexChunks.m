@@ -0,0 +1,32 @@
+function [vAddrKey, vnOffsets, vnPostings, vnChunkStarts] = STIndexChunks(cChunks, nNumThreads)
+
+% STIndexChunks - FUNCTION (Internal) Build an address index of a mapping spike list
+% $Id: STIndexChunks.m $
+%
+% NOT for command-line use
+
+% Usage: [vAddrKey, vnOffsets, vnPostings, vnChunkStarts] = STIndexChunks(cChunks <, nNumThreads>)
+%
+% 'cChunks' is a cell array of [tick addr] mapping spike list chunks, whose
+% spikes are numbered in order from 1.  'vnChunkStarts' returns the running
+% total of the chunk lengths, starting with 0.  STIndexChunks builds an
+% inverted index of the spike list by counting sort: 'vAddrKey' returns the
+% sorted addresses, and the spikes with address vAddrKey(k) are numbered
+% vnPostings(vnOffsets(k)+1 : vnOffsets(k+1)), in order.  The spike list is
+% split into ranges over 'nNumThreads' threads, by default one per hardware
+% thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STIndexChunks.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STIndexChunks: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STIndexChunks.m ---
@@ -4,6 +4,16 @@
 % These functions should not be called from the command line.  They are
 % designed to be called from within STInstantiate to provide a frequency
 % profile for a spike train.  See STInstantiate for calling syntax.
+%
+% STInstantaneousFrequency... functions return the frequency profile of a
+% definition, evaluated at a vector of times.  When called with a third
+% argument [tTimeStart tTimeEnd], the times need not be a complete time
+% trace; the profile is evaluated as if the trace spanned that range.
+%
+% STMaxFrequency... functions return an upper bound on the frequency profile
+% of a definition between two times.  Definitions that provide a bound in
+% their 'fhMaxFreq' field can be instantiated as poisson trains by thinning,
+% where the profile is only evaluated at candidate spike times.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 2004
@@ -1,11 +1,13 @@
-function [fInstFreq] = STInstantaneousFrequencyConstant(stTrainDef, tTimeCurr)
+function [fInstFreq] = STInstantaneousFrequencyConstant(stTrainDef, tTimeCurr, vtTimeRange)
 
 % STInstantaneousFrequencyConstant - FUNCTION Internal frequency profile function
 % $Id: STInstantaneousFrequencyConstant.m 2411 2005-11-07 16:48:24Z dylan $
 %
 % NOT for command-line use
 
-% Usage: [fInstFreq] = STInstantaneousFrequencyConstant(stTrainDef, tTimeCurr)
+% Usage: [fInstFreq] = STInstantaneousFrequencyConstant(stTrainDef, tTimeCurr <, vtTimeRange>)
+%
+% The frequency doesn't vary with time, so 'vtTimeRange' is ignored.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 26th March, 2004
@@ -21,7 +21,7 @@ function [fInstFreq] = STInstantaneousFrequencyGamma(stTrainDef, tTimeTrace)
 
 % -- Constants
 
-nISIBlockSize = 100;       % Generate this many ISIs at once
+nISIBlockSize = 100;       % Generate at least this many ISIs at once
 
 
 % -- Check arguments
@@ -35,49 +35,91 @@ if (nargin < 2)
 end
 
 
-% -- Pull ISIs from the gamma distribution
+% -- Pull ISIs from the ISI distribution
 
-% - Calculate gamma function parameters
-fAlpha = stTrainDef.fMeanISI^2 / stTrainDef.fVarISI;
-fBeta = fAlpha / stTrainDef.fMeanISI;
+% - Definitions without an ISI distribution use a gamma distribution
+if (isfield(stTrainDef, 'strISIDistribution'))
+   strISIDistribution = stTrainDef.strISIDistribution;
+else
+   strISIDistribution = 'gamma';
+end
 
-% - Fill a duration with ISIs
-vISIs = [];
 tMinTime = min(tTimeTrace);
 tMaxTime = max(tTimeTrace);
-tCurrTime = tMinTime;
+fTemporalResolution = tTimeTrace(2) - tTimeTrace(1);
 
-while (tCurrTime < tMaxTime)
-   % - Generate a block of ISIs
-   vISIBlock = gamrnd(fAlpha, 1/fBeta, [1 nISIBlockSize]);
+if (exist('STGenerateRenewal', 'file') == 3)
+   % - Draw spikes directly, seeded from the toolbox random generator
+   stOptions = STOptions;
+   vnSeed = floor(feval(stOptions.RandomGenerator, 1, 2) * 2^32);
+   vtSpikeTimes = STGenerateRenewal(strISIDistribution, stTrainDef.fMeanISI, stTrainDef.fVarISI, ...
+                                    tMinTime, tMaxTime, fTemporalResolution, vnSeed);
    
-   % - Append to the current list
-   vISIs = [vISIs  vISIBlock];
+   % - Convert to bin indices
+   vTimes = round((vtSpikeTimes - tMinTime) ./ fTemporalResolution);
+
+else
+   % - Fill a duration with spikes.  Enough ISIs are drawn to cover the
+   %   duration on average; if more are needed, the spike list is doubled
+   %   until the duration is covered
+   tSpan = tMaxTime - tMinTime;
+   nNumISIs = max(nISIBlockSize, ceil(1.1 * tSpan / stTrainDef.fMeanISI));
+   vTimes = cumsum(STDrawISIs(strISIDistribution, stTrainDef, nNumISIs));
    
-   % - Update total duration
-   tCurrTime = tCurrTime + sum(vISIBlock);
-end
-
-
-% -- Select required ISIs, return mock instantaneous frequency vector
+   while (vTimes(end) < tSpan)
+      vTimes = [vTimes  (vTimes(end) + cumsum(STDrawISIs(strISIDistribution, stTrainDef, numel(vTimes))))];
+   end
 
-% - Get spike times
-vTimes = cumsum(vISIs);
+   % - Find the spikes we should take
+   %   Should be < not <=, because we add one below to get the index into
+   %   'fInstFreq'
+   vTimes = vTimes(vTimes < tSpan);
 
-% - Find the last spike we should take
-%   Should be < not <=, because we add one below to get the index into
-%   'fInstFreq'
-nLastSpike = max(find(vTimes < (tMaxTime - tMinTime)));
+   % - Fix to the correct temporal resolution
+   vTimes = fix(vTimes ./ fTemporalResolution);
+end
 
-% - Trim ISI array
-vTimes= vTimes(1:nLastSpike);
 
-% - Fix to the correct temporal resolution
-fTemporalResolution = tTimeTrace(2) - tTimeTrace(1);
-vTimes = fix(vTimes ./ fTemporalResolution);
+% -- Return mock instantaneous frequency vector
 
-% - Mock up the instantaneous frequency vector
 fInstFreq = zeros(1, length(tTimeTrace));
 fInstFreq(vTimes+1) = 1 / fTemporalResolution;
 
+% --- END of STInstantaneousFrequencyGamma FUNCTION ---
+
+
+% --- FUNCTION STDrawISIs
+function [vISIs] = STDrawISIs(strISIDistribution, stTrainDef, nNumISIs)
+% Draw a row of ISIs with the definition's mean and variance
+
+fMeanISI = stTrainDef.fMeanISI;
+fVarISI = stTrainDef.fVarISI;
+
+switch lower(strISIDistribution)
+   case 'gamma'
+      fAlpha = fMeanISI^2 / fVarISI;
+      fBeta = fAlpha / fMeanISI;
+      vISIs = gamrnd(fAlpha, 1/fBeta, [1 nNumISIs]);
+      
+   case 'exponential'
+      % - Exponential distribution, shifted by a dead time
+      fStdISI = sqrt(fVarISI);
+      vISIs = (fMeanISI - fStdISI) - log(1 - rand(1, nNumISIs)) .* fStdISI;
+      
+   case 'lognormal'
+      fSigma2 = log(1 + fVarISI / fMeanISI^2);
+      vISIs = exp(log(fMeanISI) - fSigma2/2 + sqrt(fSigma2) .* randn(1, nNumISIs));
+      
+   case 'invgauss'
+      % - Method of Michael, Schucany and Haas
+      fLambda = fMeanISI^3 / fVarISI;
+      vfY = randn(1, nNumISIs).^2;
+      vISIs = fMeanISI + (fMeanISI^2 .* vfY) ./ (2*fLambda) ...
+              - (fMeanISI / (2*fLambda)) .* sqrt(4*fMeanISI*fLambda .* vfY + fMeanISI^2 .* vfY.^2);
+      vbFlip = rand(1, nNumISIs) > (fMeanISI ./ (fMeanISI + vISIs));
+      vISIs(vbFlip) = fMeanISI^2 ./ vISIs(vbFlip);
+end
+
+% --- END of STDrawISIs FUNCTION ---
+
 % --- END of STInstantaneousFrequencyGamma.m ---
@@ -1,11 +1,15 @@
-function [fInstFreq] = STInstantaneousFrequencyLinear(stTrainDef, tTimeCurr)
+function [fInstFreq] = STInstantaneousFrequencyLinear(stTrainDef, tTimeCurr, vtTimeRange)
 
 % STInstantaneousFrequencyLinear - FUNCTION Internal frequency profile function
 % $Id: STInstantaneousFrequencyLinear.m 2411 2005-11-07 16:48:24Z dylan $
 %
 % NOT for command-line use
 
-% Usage: [fInstFreq] = STInstantaneousFrequencyLinear(stTrainDef, tTimeCurr)
+% Usage: [fInstFreq] = STInstantaneousFrequencyLinear(stTrainDef, tTimeCurr <, vtTimeRange>)
+%
+% The frequency ramps linearly across 'tTimeCurr'.  If 'vtTimeRange' is
+% supplied, 'tTimeCurr' may be any set of times; the ramp then runs from
+% 'vtTimeRange(1)' to 'vtTimeRange(2)' instead.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 26th March, 2004
@@ -24,6 +28,13 @@ end
 
 % - linear frequency gradient from min to max
 
-fInstFreq = (0:(1/(length(tTimeCurr)-1)):1) .* (stTrainDef.fEndFreq - stTrainDef.fStartFreq) + stTrainDef.fStartFreq;
+if (exist('vtTimeRange', 'var'))
+   % - Evaluate the ramp at arbitrary times within the range
+   fRampPos = (tTimeCurr - vtTimeRange(1)) ./ (vtTimeRange(2) - vtTimeRange(1));
+else
+   fRampPos = (0:(1/(length(tTimeCurr)-1)):1);
+end
+
+fInstFreq = fRampPos .* (stTrainDef.fEndFreq - stTrainDef.fStartFreq) + stTrainDef.fStartFreq;
 
 % --- END of STInstantaneousFrequencyLinear.m ---
@@ -1,11 +1,13 @@
-function [fInstFreq] = STInstantaneousFrequencySinusoid(stTrainDef, tTimeCurr)
+function [fInstFreq] = STInstantaneousFrequencySinusoid(stTrainDef, tTimeCurr, vtTimeRange)
 
 % STInstantaneousFrequencySinusoid - FUNCTION Internal frequency profile function
 % $Id: STInstantaneousFrequencySinusoid.m 2411 2005-11-07 16:48:24Z dylan $
 %
 % NOT for command-line use
 
-% Usage: [fInstFreq] = STInstantaneousFrequencySinusoid(stTrainDef, tTimeCurr)
+% Usage: [fInstFreq] = STInstantaneousFrequencySinusoid(stTrainDef, tTimeCurr <, vtTimeRange>)
+%
+% This profile depends only on absolute time, so 'vtTimeRange' is ignored.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 26th March, 2004
@@ -0,0 +1,927 @@
+/* STInstantiateNative - FUNCTION (Internal) Multithreaded instantiation of spike train definitions
+ * $Id: STInstantiateNative.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [cSpikeLists] = STInstantiateNative(mTrainParams, vtChunkStart, vnChunkBins, fTemporalResolution, vnSeed
+ *                                            <, mCorrDecomp, vfMemTau, fMixtureCorr, nNumThreads>)
+ *
+ * STInstantiateNative performs the spike generation loop of STInstantiate for
+ * a set of trains over a set of chunks, spreading the work over a pool of
+ * threads.  It produces the same spike train distributions as
+ * STTestSpikeRegular and STTestSpikePoisson (with CorrUniRand and
+ * MakeNonErgodic, if requested), for the frequency profiles built by
+ * STCreateConstant, STCreateLinear and STCreateSinusoid.
+ *
+ * 'mTrainParams' has one row per train: [nProfile bPoisson fParam1 fParam2 fParam3],
+ * where 'nProfile' and the parameters are
+ *
+ *    0 - constant:  fFreq, -, -
+ *    1 - linear:    fStartFreq, fEndFreq, -
+ *    2 - sinusoid:  fMinFreq, fMaxFreq, tPeriod
+ *
+ * and 'bPoisson' selects a 'poisson' (true) or 'regular' (false) train.
+ *
+ * 'vtChunkStart' and 'vnChunkBins' give the time of the first bin of each
+ * chunk and the number of bins in each chunk, spaced by 'fTemporalResolution'
+ * seconds.  As in STInstantiate, linear frequency ramps run over each chunk.
+ *
+ * 'vnSeed' is a pair of 32-bit integers.  Each work item seeds its own dSFMT
+ * generator from 'vnSeed' and the train and chunk indices of the item, so the
+ * output depends only on 'vnSeed' and not on the number of threads or the
+ * order in which items are run.  STInstantiate draws 'vnSeed' from the toolbox
+ * random generator.
+ *
+ * 'mCorrDecomp', if supplied and non-empty, is the upper triangular Cholesky
+ * factor of the normal correlation matrix used by CorrUniRand.  Correlated
+ * random sequences are then shared between all trains.  The factor is
+ * applied to blocks of normal deviates small enough to stay in cache, so no
+ * sequence longer than a block is ever stored.  Ergodic correlated trains are
+ * split into segments of SEGMENT_BINS bins, each of which is one work item.
+ * Otherwise, each (train, chunk) pair is a work item.
+ *
+ * 'vfMemTau', if supplied and non-empty, gives the memory time constant of
+ * each train, as for MakeNonErgodic.  The random sequence of a non-ergodic
+ * train is smoothed by a recursive exponential filter, at a cost per bin
+ * which does not depend on the time constant.  The filter carries its state
+ * from one chunk to the next, so a non-ergodic train (or a set of correlated
+ * non-ergodic trains) is a single work item covering every chunk.
+ *
+ * 'fMixtureCorr', if supplied and non-empty, selects an event-based
+ * correlated mode in place of 'mCorrDecomp', for ergodic trains.  A shared
+ * "mother" train is drawn spike-by-spike, at a per-bin probability of
+ * 1/'fMixtureCorr' times the largest spike probability of any poisson train,
+ * and each poisson train copies each mother spike with the probability that
+ * gives it the same per-bin spike probability as STTestSpikePoisson.  Trains
+ * 'i' and 'j' then have a spike count correlation of about
+ * 'fMixtureCorr' * sqrt(P_i * P_j) / max(P), where P are the per-bin spike
+ * probabilities; for trains with equal frequencies this is 'fMixtureCorr'.
+ * The cost depends on the number of spikes rather than on the number of bins
+ * or on the square of the number of trains.
+ *
+ * Regular trains integrate their frequency profile in closed form, and place
+ * a spike in the bin in which the integral passes each whole number, so
+ * changing frequencies are followed correctly.  The time of each spike is
+ * found directly from the previous one (by Newton's method, for sinusoids),
+ * so the cost depends on the number of spikes.  The integral is carried from
+ * one chunk to the next.
+ *
+ * Uncorrelated, ergodic poisson trains are generated by thinning, drawing
+ * candidate spikes spike-by-spike as in STGeneratePoisson, so their cost
+ * depends on the number of spikes rather than on the number of bins.
+ *
+ * 'nNumThreads' is the number of threads to use.  By default, one thread is
+ * used per hardware thread.
+ *
+ * 'cSpikeLists' will be a cell array, with one row per train and one column
+ * per chunk, of column vectors of spike times in seconds.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <vector>
+
+#include "dSFMT.h"
+#include "STThreadPool.h"
+
+
+/* - Frequency profile types */
+#define PROFILE_CONSTANT   0
+#define PROFILE_LINEAR     1
+#define PROFILE_SINUSOID   2
+
+/* - Seed word used in place of a train index for correlated chunk items */
+#define CORRELATED_ITEM    0xFFFFFFFFUL
+
+/* - Regular trains:  tolerance in phase when rounding to whole spikes, and in
+ *   time (as a fraction of a bin) when finding the time of a spike */
+#define PHASE_TOLERANCE          1e-9
+#define CROSSING_TOLERANCE       1e-6
+#define MAX_CROSSING_ITERATIONS  100
+
+/* - Length of a correlated work item, for ergodic trains */
+#define SEGMENT_BINS             65536L
+
+/* - Number of deviates in a block of a correlated random sequence.  A block
+ *   of normal deviates and a block of correlated deviates should stay in L2
+ *   cache while the correlation factor is streamed past them */
+#define SEQUENCE_BLOCK_VALUES    8192L
+#define SEQUENCE_BLOCK_MAX_ROWS  256L
+
+
+/* - Parameters of a single train */
+struct TrainParams {
+   int      nProfile;
+   bool     bPoisson;
+   double   fParam1, fParam2, fParam3;
+   double   fMemTau;             /* Zero for ergodic trains */
+};
+
+/* - Description of the whole instantiation task */
+struct Task {
+   std::vector<TrainParams>   vTrains;
+   std::vector<double>        vtChunkStart;
+   std::vector<long>          vnChunkBins;
+   double                     fTemporalResolution;
+   uint32_t                   anSeed[2];
+   bool                       bCorrelated;
+   std::vector<double>        vfCorrFactor;        /* Transpose of 'mCorrDecomp' */
+   double                     fMixtureCorr;        /* Zero unless in mixture mode */
+   std::vector<double>        vfChunkPhase;        /* Phase of each regular train at the start of each chunk */
+};
+
+
+/* --- InstFreq - Frequency of a train at bin 'nBin' of a chunk of 'nNumBins' bins */
+static inline double InstFreq(const TrainParams &train, long nBin, long nNumBins, double tTime)
+{
+   switch (train.nProfile) {
+      case PROFILE_LINEAR:
+         if (nNumBins < 2) return train.fParam1;
+         return ((double) nBin / (double) (nNumBins - 1)) * (train.fParam2 - train.fParam1) + train.fParam1;
+
+      case PROFILE_SINUSOID:
+         return (sin(2 * M_PI * tTime / train.fParam3) + 1) * (train.fParam2 - train.fParam1) / 2 + train.fParam1;
+
+      default:
+         return train.fParam1;
+   }
+}
+
+/* --- MaxFreq - A bound on the frequency of a train, as given by STMaxFrequency* */
+static inline double MaxFreq(const TrainParams &train)
+{
+   switch (train.nProfile) {
+      case PROFILE_LINEAR:
+      case PROFILE_SINUSOID:
+         return (train.fParam1 > train.fParam2) ? train.fParam1 : train.fParam2;
+
+      default:
+         return train.fParam1;
+   }
+}
+
+/* --- SpikeProb - Per-bin spike probability, as in STTestSpikePoisson */
+static inline double SpikeProb(double fFreq, double fTemporalResolution)
+{
+   double fSpikeAvgNum = fFreq * fTemporalResolution;
+   return exp(-fSpikeAvgNum) * fSpikeAvgNum;
+}
+
+/* --- ChunkPhase - Phase of a regular train (the integral of its frequency)
+ *   at 'tTau' seconds after the start of chunk 'nChunk', relative to the phase
+ *   at the start of the chunk */
+static double ChunkPhase(const Task &task, const TrainParams &train, size_t nChunk, double tTau)
+{
+   const long  nNumBins = task.vnChunkBins[nChunk];
+
+   switch (train.nProfile) {
+      case PROFILE_LINEAR: {
+         /* - The frequency ramps from fParam1 at the first bin to fParam2 at
+          *   the last bin of the chunk */
+         if (nNumBins < 2) return train.fParam1 * tTau;
+         double fSlope = (train.fParam2 - train.fParam1) / ((nNumBins - 1) * task.fTemporalResolution);
+         return (train.fParam1 + fSlope * tTau / 2) * tTau;
+      }
+
+      case PROFILE_SINUSOID: {
+         double   fMean = (train.fParam1 + train.fParam2) / 2,
+                  fAmplitude = (train.fParam2 - train.fParam1) / 2,
+                  fOmega = 2 * M_PI / train.fParam3,
+                  tTimeStart = task.vtChunkStart[nChunk];
+         return fMean * tTau + fAmplitude / fOmega * (cos(fOmega * tTimeStart) - cos(fOmega * (tTimeStart + tTau)));
+      }
+
+      default:
+         return train.fParam1 * tTau;
+   }
+}
+
+/* --- RegularCrossing - The time 'tTau' after the start of chunk 'nChunk' at
+ *   which ChunkPhase reaches 'fPhase'.  The crossing must lie in
+ *   [tLow, tHigh].  Constant and linear profiles are solved in closed form;
+ *   sinusoids by Newton's method, safeguarded by bisection */
+static double RegularCrossing(const Task &task, const TrainParams &train, size_t nChunk, double fPhase,
+                              double tLow, double tHigh)
+{
+   const long  nNumBins = task.vnChunkBins[nChunk];
+
+   /* - A spike at the very start of the chunk */
+   if (!(fPhase > 0)) return 0;
+
+   switch (train.nProfile) {
+      case PROFILE_LINEAR: {
+         if (nNumBins < 2) return fPhase / train.fParam1;
+
+         /* - Solve fSlope/2 * t^2 + fParam1 * t = fPhase, in a form which is
+          *   stable for small slopes */
+         double   fSlope = (train.fParam2 - train.fParam1) / ((nNumBins - 1) * task.fTemporalResolution),
+                  fDisc = train.fParam1 * train.fParam1 + 2 * fSlope * fPhase,
+                  fDenom = train.fParam1 + sqrt((fDisc > 0) ? fDisc : 0);
+         return (fDenom > 0) ? 2 * fPhase / fDenom : tHigh;
+      }
+
+      case PROFILE_SINUSOID: {
+         double   fMean = (train.fParam1 + train.fParam2) / 2,
+                  fAmplitude = (train.fParam2 - train.fParam1) / 2,
+                  fOmega = 2 * M_PI / train.fParam3,
+                  tTimeStart = task.vtChunkStart[nChunk],
+                  tTol = task.fTemporalResolution * CROSSING_TOLERANCE,
+                  tTau = tLow;
+
+         for (int nIter = 0; (nIter < MAX_CROSSING_ITERATIONS) && (tHigh - tLow > tTol); nIter++) {
+            double   fError = ChunkPhase(task, train, nChunk, tTau) - fPhase,
+                     fFreq = fMean + fAmplitude * sin(fOmega * (tTimeStart + tTau));
+
+            if (fabs(fError) < fFreq * tTol) break;
+            if (fError < 0) tLow = tTau; else tHigh = tTau;
+
+            /* - Take a Newton step if it stays inside the bracket, otherwise bisect */
+            tTau = (fFreq > 0) ? tTau - fError / fFreq : tHigh;
+            if (!(tTau > tLow) || !(tTau < tHigh)) tTau = (tLow + tHigh) / 2;
+         }
+         return tTau;
+      }
+
+      default:
+         return fPhase / train.fParam1;
+   }
+}
+
+
+/* --- NormInvCDF - Inverse of the standard normal CDF, for p in (0,1)
+ *   Rational approximation by P. J. Acklam, with a relative error below
+ *   1.2e-9.  If 'bRefine' is true, the approximation is refined by one step
+ *   of Halley's method, which gives full double precision */
+static double NormInvCDF(double p, bool bRefine = true)
+{
+   static const double a[6] = {-3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00};
+   static const double b[5] = {-5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01};
+   static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00};
+   static const double d[4] = { 7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+                                3.754408661907416e+00};
+   const double   pLow = 0.02425;
+   double         q, r, x, e, u;
+
+   if (p < pLow) {
+      q = sqrt(-2 * log(p));
+      x = (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+           ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+   } else if (p <= 1 - pLow) {
+      q = p - 0.5;
+      r = q * q;
+      x = (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q /
+          (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+   } else {
+      q = sqrt(-2 * log1p(-p));
+      x = -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5]) /
+            ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+   }
+
+   if (!bRefine) return x;
+
+   /* - Halley refinement */
+   e = 0.5 * erfc(-x / M_SQRT2) - p;
+   u = e * sqrt(2 * M_PI) * exp(x * x / 2);
+   x = x - u / (1 + x * u / 2);
+
+   return x;
+}
+
+/* --- NormCDF - Standard normal CDF, as in STNormCDF */
+static inline double NormCDF(double x)
+{
+   return 0.5 * erfc(-x / M_SQRT2);
+}
+
+/* --- NormThreshold - The normal deviate 'x' such that NormCDF(x) <= p
+ *   exactly when a deviate is below 'x' */
+static inline double NormThreshold(double p)
+{
+   if (!(p > 0)) return -HUGE_VAL;
+   if (p >= 1) return HUGE_VAL;
+   return NormInvCDF(p);
+}
+
+
+/* --- SeedItem - Seed a generator for a single work item.  Items covering a
+ *   whole chunk have 'nSegment' < 0 */
+static void SeedItem(dsfmt_state *state, const Task &task, uint32_t nTrain, uint32_t nChunk, long nSegment = -1)
+{
+   uint32_t anKey[5] = {task.anSeed[0], task.anSeed[1], nTrain, nChunk, (uint32_t) nSegment};
+   dsfmt_init_by_array(state, anKey, (nSegment < 0) ? 4 : 5);
+}
+
+/* --- UniformOpen - A uniform deviate on the open interval (0,1) */
+static inline double UniformOpen(dsfmt_state *state)
+{
+   /* - Values on [0, 1-2^-52] are shifted to the centres of their intervals */
+   return dsfmt_genrand_close_open(state) + (0.5 / 4503599627370496.0);
+}
+
+
+/* - Source of the random sequence of a work item, as normal deviates.  For
+ *   correlated items, each step gives one correlated deviate per train, as
+ *   CorrUniRand before its final transformation to uniform deviates.  For
+ *   uncorrelated items, each step gives a single deviate.
+ *
+ *   Deviates are generated a block of steps at a time.  For correlated items,
+ *   each row of the block of normal deviates mZ is multiplied by the upper
+ *   triangular factor mDecomp.  This is done as a sum of the columns of
+ *   mDecomp' weighted by the elements of each row of mZ, one column for all
+ *   rows of the block at a time, so mDecomp is read from memory once per
+ *   block rather than once per step */
+class NormalSource {
+public:
+   NormalSource(const Task &task, uint32_t nTrain, uint32_t nChunk, long nSegment, long nNumSeq) :
+      task_(task), nTrain_(nTrain), nChunk_(nChunk), nSegment_(nSegment), nNumSeq_(nNumSeq) {
+      nBlockRows_ = SEQUENCE_BLOCK_VALUES / nNumSeq_;
+      if (nBlockRows_ > SEQUENCE_BLOCK_MAX_ROWS) nBlockRows_ = SEQUENCE_BLOCK_MAX_ROWS;
+      if (nBlockRows_ < 1) nBlockRows_ = 1;
+
+      vfZ_.resize(nBlockRows_ * nNumSeq_);
+      if (task_.bCorrelated) vfC_.resize(nBlockRows_ * nNumSeq_);
+      Reset();
+   }
+
+   /* - Restart the sequence from the beginning */
+   void Reset(void) {
+      SeedItem(&state_, task_, nTrain_, nChunk_, nSegment_);
+      nRow_ = nBlockRows_;
+   }
+
+   /* - Get the next step of the sequence, one deviate per sequence */
+   const double *Next(void) {
+      if (nRow_ == nBlockRows_) Fill();
+      return (task_.bCorrelated ? &vfC_[0] : &vfZ_[0]) + (nRow_++) * nNumSeq_;
+   }
+
+private:
+   /* - Generate the next block of steps */
+   void Fill(void) {
+      const long  nNumValues = nBlockRows_ * nNumSeq_;
+      long        nRow, nCol, nSeq;
+
+      /* - Uniform deviates, in the same order as drawing them one by one.
+       *   The unrefined inverse CDF is ample for the sequence, and avoids an
+       *   erfc() and an exp() per deviate */
+      dsfmt_fill_close_open(&state_, &vfZ_[0], nNumValues);
+      for (nSeq = 0; nSeq < nNumValues; nSeq++) {
+         vfZ_[nSeq] = NormInvCDF(vfZ_[nSeq] + (0.5 / 4503599627370496.0), false);
+      }
+
+      /* - mC = mZ * mDecomp, a column of mDecomp' at a time */
+      if (task_.bCorrelated) {
+         memset(&vfC_[0], 0, nNumValues * sizeof(double));
+         for (nCol = 0; nCol < nNumSeq_; nCol++) {
+            const double *adFactor = &task_.vfCorrFactor[nCol * nNumSeq_];
+
+            for (nRow = 0; nRow < nBlockRows_; nRow++) {
+               const double   fZ = vfZ_[nRow * nNumSeq_ + nCol];
+               double         *afC = &vfC_[nRow * nNumSeq_];
+
+               for (nSeq = nCol; nSeq < nNumSeq_; nSeq++) afC[nSeq] += fZ * adFactor[nSeq];
+            }
+         }
+      }
+
+      nRow_ = 0;
+   }
+
+   const Task           &task_;
+   uint32_t             nTrain_, nChunk_;
+   long                 nSegment_, nNumSeq_,
+                        nBlockRows_, nRow_;
+   std::vector<double>  vfZ_, vfC_;
+   dsfmt_state          state_;
+};
+
+
+/* - Exponential smoothing of a normal sequence, as MakeNonErgodic.  The
+ *   kernel exp(-t/fMemTau) is applied recursively, so each sample costs the
+ *   same whatever the time constant.  The smoothed value is divided by its
+ *   standard deviation given the samples seen so far, so the output is
+ *   always a standard normal deviate.  The state carries over from one chunk
+ *   to the next */
+struct NonErgodicFilter {
+   double   fDecay,        /* Kernel decay per bin */
+            fDecay2,       /* Square of 'fDecay' */
+            fAcc,          /* Current kernel-weighted sum */
+            fVar;          /* Variance of 'fAcc' */
+
+   void Init(double fMemTau, double fTemporalResolution) {
+      fDecay = exp(-fTemporalResolution / fMemTau);
+      fDecay2 = fDecay * fDecay;
+      fAcc = 0;
+      fVar = 0;
+   }
+
+   double Next(double fX) {
+      fAcc = fDecay * fAcc + fX;
+      fVar = fDecay2 * fVar + 1;
+      return fAcc / sqrt(fVar);
+   }
+};
+
+
+/* --- ThinPoisson - An uncorrelated, ergodic poisson train, by thinning */
+static void ThinPoisson(const Task &task, size_t nTrain, size_t nChunk, std::vector<double> &vtSpikes)
+{
+   const TrainParams &train = task.vTrains[nTrain];
+   const double   fRes = task.fTemporalResolution,
+                  tTimeStart = task.vtChunkStart[nChunk];
+   const long     nNumBins = task.vnChunkBins[nChunk];
+   double         fMaxFreq, fMaxProb, fLogNoSpike, fGap;
+   long           nBin;
+   dsfmt_state    state;
+
+   /* - Bound the spike probability.  P(f) is maximal at f*dT = 1 */
+   fMaxFreq = MaxFreq(train);
+   if (fMaxFreq > 1 / fRes) fMaxFreq = 1 / fRes;
+   fMaxProb = SpikeProb(fMaxFreq, fRes);
+
+   if ((nNumBins <= 0) || !(fMaxProb > 0)) return;
+
+   fLogNoSpike = log1p(-fMaxProb);
+   SeedItem(&state, task, (uint32_t) nTrain, (uint32_t) nChunk);
+
+   /* - Hop from candidate to candidate, as STGeneratePoisson */
+   for (nBin = -1; ; ) {
+      fGap = 1 + floor(log(UniformOpen(&state)) / fLogNoSpike);
+      if (fGap >= (double) (nNumBins - nBin)) break;
+      nBin += (long) fGap;
+
+      double tTime = tTimeStart + nBin * fRes;
+
+      /* - Keep the candidate with probability P(f(t)) / P(fMaxFreq) */
+      if (train.nProfile != PROFILE_CONSTANT) {
+         double fProb = SpikeProb(InstFreq(train, nBin, nNumBins, tTime), fRes);
+         if (UniformOpen(&state) * fMaxProb > fProb) continue;
+      }
+
+      vtSpikes.push_back(tTime);
+   }
+}
+
+/* --- RegularTrain - A regular train, over bins [nBinStart, nBinEnd) of a
+ *   chunk.  The phase of the train (the integral of its frequency) is carried
+ *   from the start of the train, and a spike is placed in the bin in which
+ *   the phase passes each whole number.  The time of each spike is found
+ *   directly from the previous one, so the cost depends on the number of
+ *   spikes rather than on the number of bins.  Frequencies above one spike
+ *   per bin are clipped */
+static void RegularTrain(const Task &task, size_t nTrain, size_t nChunk, long nBinStart, long nBinEnd,
+                         std::vector<double> &vtSpikes)
+{
+   const TrainParams &train = task.vTrains[nTrain];
+   const double   fRes = task.fTemporalResolution,
+                  tTimeStart = task.vtChunkStart[nChunk],
+                  fPhaseStart = task.vfChunkPhase[nTrain + nChunk * task.vTrains.size()],
+                  tRangeEnd = nBinEnd * fRes,
+                  fPhaseEnd = ChunkPhase(task, train, nChunk, tRangeEnd);
+   double         fPhase, tTau = nBinStart * fRes;
+   long           nBin;
+
+   /* - Phase of the first spike in the range, relative to the chunk start */
+   fPhase = ceil(fPhaseStart + ChunkPhase(task, train, nChunk, tTau) - PHASE_TOLERANCE) - fPhaseStart;
+
+   while (fPhase < fPhaseEnd - PHASE_TOLERANCE) {
+      tTau = RegularCrossing(task, train, nChunk, fPhase, tTau, tRangeEnd);
+
+      nBin = (long) floor(tTau / fRes + CROSSING_TOLERANCE);
+      if (nBin >= nBinEnd) break;
+      if (nBin < nBinStart) nBin = nBinStart;
+      vtSpikes.push_back(tTimeStart + nBin * fRes);
+
+      /* - The next spike must lie in a later bin */
+      tTau = (nBin + 1) * fRes;
+      double fNextPhase = ceil(fPhaseStart + ChunkPhase(task, train, nChunk, tTau) - PHASE_TOLERANCE) - fPhaseStart;
+      fPhase = (fNextPhase > fPhase + 1) ? fNextPhase : fPhase + 1;
+   }
+}
+
+/* --- ChunkPhases - Find the phase of each regular train at the start of
+ *   each chunk.  The profile of each chunk is continued up to the start of the
+ *   next chunk */
+static void ChunkPhases(Task &task)
+{
+   const size_t   nNumTrains = task.vTrains.size(),
+                  nNumChunks = task.vtChunkStart.size();
+
+   task.vfChunkPhase.assign(nNumTrains * nNumChunks, 0.0);
+   for (size_t nTrain = 0; nTrain < nNumTrains; nTrain++) {
+      if (task.vTrains[nTrain].bPoisson) continue;
+
+      for (size_t nChunk = 1; nChunk < nNumChunks; nChunk++) {
+         task.vfChunkPhase[nTrain + nChunk * nNumTrains] = task.vfChunkPhase[nTrain + (nChunk - 1) * nNumTrains] +
+            ChunkPhase(task, task.vTrains[nTrain], nChunk - 1, task.vtChunkStart[nChunk] - task.vtChunkStart[nChunk - 1]);
+      }
+   }
+}
+
+/* - A range of bins of a chunk:  bins [nBinStart, nBinEnd) of chunk 'nChunk' */
+struct BinRange {
+   size_t   nChunk;
+   long     nSegment,         /* -1 for a whole chunk */
+            nBinStart, nBinEnd;
+};
+
+/* --- SequenceTrains - Poisson trains tested bin by bin against a random
+ *   sequence, which may be correlated between trains and / or smoothed.
+ *   'vnTrains' lists the trains sharing the sequence (all trains for a
+ *   correlated item, otherwise a single train).  The sequence is seeded from
+ *   'nSeedTrain' and the first range, and runs on through each range of
+ *   'vRanges' in turn, so that non-ergodic trains carry their memory from one
+ *   chunk to the next.  'vvtSpikes[nIndex + nRange * vnTrains.size()]'
+ *   receives the spikes of train 'vnTrains[nIndex]' in range 'nRange'.
+ *   Regular trains in 'vnTrains' don't use the sequence, and are generated
+ *   by RegularTrain over the same ranges */
+static void SequenceTrains(const Task &task, const std::vector<size_t> &vnTrains, uint32_t nSeedTrain,
+                           const std::vector<BinRange> &vRanges, std::vector< std::vector<double> > &vvtSpikes)
+{
+   const double   fRes = task.fTemporalResolution;
+   const long     nNumSeq = task.bCorrelated ? (long) task.vTrains.size() : 1;
+   const size_t   nNumTrains = vnTrains.size();
+   size_t         nIndex, nRange;
+   long           nBin;
+
+   std::vector<NonErgodicFilter>    vFilters(nNumTrains);
+   std::vector<double>              vfThreshold(nNumTrains, 0.0);
+   NormalSource                     source(task, nSeedTrain, (uint32_t) vRanges[0].nChunk, vRanges[0].nSegment, nNumSeq);
+
+   for (nIndex = 0; nIndex < nNumTrains; nIndex++) {
+      const TrainParams &train = task.vTrains[vnTrains[nIndex]];
+
+      /* - Constant trains test the sequence against a fixed threshold,
+       *   rather than transforming each deviate back to a probability */
+      if (train.nProfile == PROFILE_CONSTANT) {
+         vfThreshold[nIndex] = NormThreshold(SpikeProb(train.fParam1, fRes));
+      }
+
+      if (train.fMemTau > 0) vFilters[nIndex].Init(train.fMemTau, fRes);
+   }
+
+   for (nRange = 0; nRange < vRanges.size(); nRange++) {
+      const BinRange &range = vRanges[nRange];
+      const double   tTimeStart = task.vtChunkStart[range.nChunk];
+      const long     nNumBins = task.vnChunkBins[range.nChunk];
+
+      /* - Regular trains don't use the random sequence */
+      for (nIndex = 0; nIndex < nNumTrains; nIndex++) {
+         if (!task.vTrains[vnTrains[nIndex]].bPoisson) {
+            RegularTrain(task, vnTrains[nIndex], range.nChunk, range.nBinStart, range.nBinEnd,
+                         vvtSpikes[nIndex + nRange * nNumTrains]);
+         }
+      }
+
+      for (nBin = range.nBinStart; nBin < range.nBinEnd; nBin++) {
+         const double   tTime = tTimeStart + nBin * fRes,
+                        *afX = source.Next();
+
+         for (nIndex = 0; nIndex < nNumTrains; nIndex++) {
+            const TrainParams &train = task.vTrains[vnTrains[nIndex]];
+            const long        nSeq = (nNumSeq > 1) ? (long) vnTrains[nIndex] : 0;
+            double            fX = afX[nSeq];
+            bool              bSpike;
+
+            if (!train.bPoisson) continue;
+
+            if (train.fMemTau > 0) fX = vFilters[nIndex].Next(fX);
+
+            if (train.nProfile == PROFILE_CONSTANT) {
+               bSpike = fX <= vfThreshold[nIndex];
+            } else {
+               bSpike = NormCDF(fX) <= SpikeProb(InstFreq(train, nBin, nNumBins, tTime), fRes);
+            }
+
+            if (bSpike) vvtSpikes[nIndex + nRange * nNumTrains].push_back(tTime);
+         }
+      }
+   }
+}
+
+
+/* --- MixtureTrains - Ergodic trains correlated through a shared mother
+ *   train, over bins [nBinStart, nBinEnd) of a chunk.  Poisson trains copy
+ *   spikes from the mother train; regular trains are generated as usual.
+ *   'vvtSpikes' receives the spikes of every train */
+static void MixtureTrains(const Task &task, size_t nChunk, long nSegment, long nBinStart, long nBinEnd,
+                          std::vector< std::vector<double> > &vvtSpikes)
+{
+   const double   fRes = task.fTemporalResolution,
+                  tTimeStart = task.vtChunkStart[nChunk];
+   const long     nNumBins = task.vnChunkBins[nChunk];
+   const size_t   nNumTrains = task.vTrains.size();
+   std::vector<size_t>  vnPoisson;
+   double         fMaxProb = 0, fMotherProb, fCopyProb, fLogNoMother, fLogNoCopy, fGap;
+   long           nBin, nIndex;
+   size_t         nTrain;
+   dsfmt_state    state;
+
+   /* - Bound the per-bin spike probability of every poisson train */
+   for (nTrain = 0; nTrain < nNumTrains; nTrain++) {
+      const TrainParams &train = task.vTrains[nTrain];
+
+      if (!train.bPoisson) {
+         RegularTrain(task, nTrain, nChunk, nBinStart, nBinEnd, vvtSpikes[nTrain]);
+         continue;
+      }
+
+      /* - P(f) is maximal at f*dT = 1 */
+      double fMaxFreq = MaxFreq(train);
+      if (fMaxFreq > 1 / fRes) fMaxFreq = 1 / fRes;
+      double fProb = SpikeProb(fMaxFreq, fRes);
+      if (fProb > fMaxProb) fMaxProb = fProb;
+      vnPoisson.push_back(nTrain);
+   }
+
+   if (vnPoisson.empty() || !(fMaxProb > 0)) return;
+
+   /* - Each mother spike is offered to each poisson train with probability
+    *   'fCopyProb', and accepted with probability P(f(t)) / 'fMaxProb' */
+   fMotherProb = fMaxProb / task.fMixtureCorr;
+   if (fMotherProb > 1) fMotherProb = 1;
+   fCopyProb = fMaxProb / fMotherProb;
+   fLogNoMother = log1p(-fMotherProb);
+   fLogNoCopy = log1p(-fCopyProb);
+
+   SeedItem(&state, task, (uint32_t) CORRELATED_ITEM, (uint32_t) nChunk, nSegment);
+
+   /* - Hop from mother spike to mother spike, and for each from copy to copy */
+   for (nBin = nBinStart - 1; ; ) {
+      fGap = 1 + floor(log(UniformOpen(&state)) / fLogNoMother);
+      if (fGap >= (double) (nBinEnd - nBin)) break;
+      nBin += (long) fGap;
+
+      const double tTime = tTimeStart + nBin * fRes;
+
+      for (nIndex = -1; ; ) {
+         fGap = 1 + floor(log(UniformOpen(&state)) / fLogNoCopy);
+         if (fGap >= (double) ((long) vnPoisson.size() - nIndex)) break;
+         nIndex += (long) fGap;
+
+         const TrainParams &train = task.vTrains[vnPoisson[nIndex]];
+         const double fProb = SpikeProb(InstFreq(train, nBin, nNumBins, tTime), fRes);
+         if (fProb < fMaxProb) {
+            if (UniformOpen(&state) * fMaxProb > fProb) continue;
+         }
+
+         vvtSpikes[vnPoisson[nIndex]].push_back(tTime);
+      }
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   Task           task;
+   const double   *adParams, *adSeed;
+   size_t         nNumTrains, nNumChunks, nTrain, nChunk, nNumItems;
+   unsigned       nNumThreads = STDefaultNumThreads();
+   bool           bMemory = false, bShared;
+
+   /* - Check usage */
+   if ((nlhs > 1) || (nrhs < 5) || (nrhs > 9)) {
+      mexPrintf("*** STInstantiateNative: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STInstantiateNative");
+      return;
+   }
+
+   /* - Get train parameters */
+   if (!mxIsDouble(prhs[0]) || (mxGetN(prhs[0]) != 5)) {
+      mexErrMsgIdAndTxt("STInstantiateNative:Params",
+                        "*** STInstantiateNative: 'mTrainParams' must have five columns");
+   }
+   nNumTrains = mxGetM(prhs[0]);
+   adParams = mxGetPr(prhs[0]);
+   task.vTrains.resize(nNumTrains);
+   for (nTrain = 0; nTrain < nNumTrains; nTrain++) {
+      TrainParams &train = task.vTrains[nTrain];
+      train.nProfile = (int) adParams[nTrain];
+      train.bPoisson = adParams[nTrain + nNumTrains] != 0;
+      train.fParam1 = adParams[nTrain + 2*nNumTrains];
+      train.fParam2 = adParams[nTrain + 3*nNumTrains];
+      train.fParam3 = adParams[nTrain + 4*nNumTrains];
+      train.fMemTau = 0;
+   }
+
+   /* - Get chunks */
+   nNumChunks = mxGetNumberOfElements(prhs[1]);
+   if (!mxIsDouble(prhs[1]) || !mxIsDouble(prhs[2]) || (mxGetNumberOfElements(prhs[2]) != nNumChunks)) {
+      mexErrMsgIdAndTxt("STInstantiateNative:Chunks",
+                        "*** STInstantiateNative: 'vtChunkStart' and 'vnChunkBins' must be the same size");
+   }
+   task.vtChunkStart.assign(mxGetPr(prhs[1]), mxGetPr(prhs[1]) + nNumChunks);
+   task.vnChunkBins.resize(nNumChunks);
+   for (nChunk = 0; nChunk < nNumChunks; nChunk++) task.vnChunkBins[nChunk] = (long) mxGetPr(prhs[2])[nChunk];
+
+   task.fTemporalResolution = mxGetScalar(prhs[3]);
+   ChunkPhases(task);
+
+   if (!mxIsDouble(prhs[4]) || (mxGetNumberOfElements(prhs[4]) != 2)) {
+      mexErrMsgIdAndTxt("STInstantiateNative:Seed",
+                        "*** STInstantiateNative: 'vnSeed' must be a pair of integers");
+   }
+   adSeed = mxGetPr(prhs[4]);
+   task.anSeed[0] = (uint32_t) fmod(adSeed[0], 4294967296.0);
+   task.anSeed[1] = (uint32_t) fmod(adSeed[1], 4294967296.0);
+
+   /* - Get correlation decomposition, and store its transpose */
+   task.bCorrelated = false;
+   if ((nrhs > 5) && !mxIsEmpty(prhs[5])) {
+      if (!mxIsDouble(prhs[5]) || (mxGetM(prhs[5]) != nNumTrains) || (mxGetN(prhs[5]) != nNumTrains)) {
+         mexErrMsgIdAndTxt("STInstantiateNative:Correlation",
+                           "*** STInstantiateNative: 'mCorrDecomp' must be square, with one row per train");
+      }
+      const double *adCorrDecomp = mxGetPr(prhs[5]);
+      task.vfCorrFactor.resize(nNumTrains * nNumTrains);
+      for (size_t nRow = 0; nRow < nNumTrains; nRow++) {
+         for (size_t nCol = 0; nCol < nNumTrains; nCol++) {
+            task.vfCorrFactor[nCol + nRow * nNumTrains] = (nCol >= nRow) ? adCorrDecomp[nRow + nCol * nNumTrains] : 0;
+         }
+      }
+      task.bCorrelated = true;
+   }
+
+   /* - Get memory time constants */
+   if ((nrhs > 6) && !mxIsEmpty(prhs[6])) {
+      if (!mxIsDouble(prhs[6]) || (mxGetNumberOfElements(prhs[6]) != nNumTrains)) {
+         mexErrMsgIdAndTxt("STInstantiateNative:MemTau",
+                           "*** STInstantiateNative: 'vfMemTau' must have one element per train");
+      }
+      for (nTrain = 0; nTrain < nNumTrains; nTrain++) {
+         double fMemTau = mxGetPr(prhs[6])[nTrain];
+         task.vTrains[nTrain].fMemTau = (fMemTau > 0) ? fMemTau : 0;
+         if (task.vTrains[nTrain].bPoisson && (fMemTau > 0)) bMemory = true;
+      }
+   }
+
+   /* - Get mixture correlation */
+   task.fMixtureCorr = 0;
+   if ((nrhs > 7) && !mxIsEmpty(prhs[7])) {
+      task.fMixtureCorr = mxGetScalar(prhs[7]);
+      if (!(task.fMixtureCorr > 0) || (task.fMixtureCorr > 1)) {
+         mexErrMsgIdAndTxt("STInstantiateNative:Mixture",
+                           "*** STInstantiateNative: 'fMixtureCorr' must be in (0, 1]");
+      }
+      if (task.bCorrelated || bMemory) {
+         mexErrMsgIdAndTxt("STInstantiateNative:Mixture",
+                           "*** STInstantiateNative: 'fMixtureCorr' can't be combined with 'mCorrDecomp' or 'vfMemTau'");
+      }
+   }
+
+   if ((nrhs > 8) && !mxIsEmpty(prhs[8]) && (mxGetScalar(prhs[8]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[8]);
+   }
+
+   /* - Correlated trains share a random sequence, so each item covers all
+    *   trains.  Ergodic trains are split into segments.  Non-ergodic trains
+    *   carry their memory from chunk to chunk, so one item runs through
+    *   every chunk in turn */
+   bShared = task.bCorrelated || (task.fMixtureCorr > 0);
+   std::vector<BinRange> vItems;
+   for (nChunk = 0; bShared && (nChunk < nNumChunks); nChunk++) {
+      const long nNumBins = task.vnChunkBins[nChunk];
+      BinRange item;
+      item.nChunk = nChunk;
+
+      if (bMemory) {
+         item.nSegment = -1;
+         item.nBinStart = 0;
+         item.nBinEnd = nNumBins;
+         vItems.push_back(item);
+         continue;
+      }
+
+      for (item.nSegment = 0; item.nSegment * SEGMENT_BINS < nNumBins; item.nSegment++) {
+         item.nBinStart = item.nSegment * SEGMENT_BINS;
+         item.nBinEnd = (item.nBinStart + SEGMENT_BINS < nNumBins) ? item.nBinStart + SEGMENT_BINS : nNumBins;
+         vItems.push_back(item);
+      }
+   }
+
+   /* - Whole chunks of every train, for uncorrelated trains */
+   std::vector<BinRange> vChunks(nNumChunks);
+   for (nChunk = 0; nChunk < nNumChunks; nChunk++) {
+      vChunks[nChunk].nChunk = nChunk;
+      vChunks[nChunk].nSegment = -1;
+      vChunks[nChunk].nBinStart = 0;
+      vChunks[nChunk].nBinEnd = task.vnChunkBins[nChunk];
+   }
+
+   if (bShared) {
+      nNumItems = bMemory ? 1 : vItems.size();
+   } else {
+      nNumItems = nNumTrains * nNumChunks;
+   }
+
+   /* - Generate spikes for each work item.  Correlated items are stored by
+    *   item and train, and gathered into chunks afterwards */
+   std::vector< std::vector<double> > vvtSpikes(bShared ? vItems.size() * nNumTrains : nNumTrains * nNumChunks);
+
+   try {
+      STParallelFor(nNumItems, nNumThreads, [&](size_t nItem, unsigned) {
+         if (bShared && bMemory) {
+            std::vector<size_t> vnTrains(nNumTrains);
+            for (size_t nIndex = 0; nIndex < nNumTrains; nIndex++) vnTrains[nIndex] = nIndex;
+            SequenceTrains(task, vnTrains, (uint32_t) CORRELATED_ITEM, vItems, vvtSpikes);
+
+         } else if (bShared) {
+            const BinRange &item = vItems[nItem];
+            std::vector<size_t> vnTrains(nNumTrains);
+            std::vector< std::vector<double> > vvtItemSpikes(nNumTrains);
+
+            if (task.fMixtureCorr > 0) {
+               MixtureTrains(task, item.nChunk, item.nSegment, item.nBinStart, item.nBinEnd, vvtItemSpikes);
+
+            } else {
+               for (size_t nIndex = 0; nIndex < nNumTrains; nIndex++) vnTrains[nIndex] = nIndex;
+               SequenceTrains(task, vnTrains, (uint32_t) CORRELATED_ITEM, std::vector<BinRange>(1, item), vvtItemSpikes);
+            }
+
+            for (size_t nIndex = 0; nIndex < nNumTrains; nIndex++) {
+               vvtSpikes[nIndex + nItem * nNumTrains].swap(vvtItemSpikes[nIndex]);
+            }
+
+         } else {
+            size_t nItemTrain = nItem % nNumTrains,
+                   nItemChunk = nItem / nNumTrains;
+            const TrainParams &train = task.vTrains[nItemTrain];
+            std::vector<double> &vtSpikes = vvtSpikes[nItem];
+
+            if (!train.bPoisson) {
+               RegularTrain(task, nItemTrain, nItemChunk, 0, task.vnChunkBins[nItemChunk], vtSpikes);
+
+            } else if (train.fMemTau > 0) {
+               /* - The item for the first chunk runs through every chunk */
+               if (nItemChunk > 0) return;
+
+               std::vector<size_t> vnTrains(1, nItemTrain);
+               std::vector< std::vector<double> > vvtItemSpikes(nNumChunks);
+               SequenceTrains(task, vnTrains, (uint32_t) nItemTrain, vChunks, vvtItemSpikes);
+               for (size_t nIndex = 0; nIndex < nNumChunks; nIndex++) {
+                  vvtSpikes[nItemTrain + nIndex * nNumTrains].swap(vvtItemSpikes[nIndex]);
+               }
+
+            } else {
+               ThinPoisson(task, nItemTrain, nItemChunk, vtSpikes);
+            }
+         }
+      });
+
+   } catch (std::bad_alloc &) {
+      mexErrMsgIdAndTxt("STInstantiateNative:OutOfMemory",
+                        "*** STInstantiateNative: Out of memory");
+   }
+
+   /* - Return the spike lists as a cell array, trains by chunks */
+   plhs[0] = mxCreateCellMatrix(nNumTrains, nNumChunks);
+   size_t nChunkFirstItem = 0, nChunkEndItem = 0;
+   for (nChunk = 0; nChunk < nNumChunks; nChunk++) {
+      /* - Find the correlated items covering this chunk */
+      if (bShared) {
+         nChunkFirstItem = nChunkEndItem;
+         while ((nChunkEndItem < vItems.size()) && (vItems[nChunkEndItem].nChunk == nChunk)) nChunkEndItem++;
+      }
+
+      for (nTrain = 0; nTrain < nNumTrains; nTrain++) {
+         size_t   nNumSpikes = 0, nItem,
+                  nFirstItem = nTrain + nChunk * nNumTrains,
+                  nLastItem = nFirstItem + 1,
+                  nItemStep = 1;
+         double   *adSpikes;
+
+         if (bShared) {
+            nFirstItem = nTrain + nChunkFirstItem * nNumTrains;
+            nLastItem = nTrain + nChunkEndItem * nNumTrains;
+            nItemStep = nNumTrains;
+         }
+
+         for (nItem = nFirstItem; nItem < nLastItem; nItem += nItemStep) nNumSpikes += vvtSpikes[nItem].size();
+
+         mxArray *mxSpikes = mxCreateDoubleMatrix(nNumSpikes, 1, mxREAL);
+         adSpikes = mxGetPr(mxSpikes);
+         for (nItem = nFirstItem; nItem < nLastItem; nItem += nItemStep) {
+            std::vector<double> &vtSpikes = vvtSpikes[nItem];
+            if (!vtSpikes.empty()) memcpy(adSpikes, &vtSpikes[0], vtSpikes.size() * sizeof(double));
+            adSpikes += vtSpikes.size();
+            std::vector<double>().swap(vtSpikes);
+         }
+         mxSetCell(plhs[0], nTrain + nChunk * nNumTrains, mxSpikes);
+      }
+   }
+}
+
+/* --- END of STInstantiateNative.cpp --- */
@@ -0,0 +1,37 @@
+function [cSpikeLists] = STInstantiateNative(mTrainParams, vtChunkStart, vnChunkBins, fTemporalResolution, vnSeed, mCorrDecomp, vfMemTau, fMixtureCorr, nNumThreads)
+
+% STInstantiateNative - FUNCTION (Internal) Multithreaded instantiation of spike train definitions
+% $Id: STInstantiateNative.m $
+%
+% NOT for command-line use
+
+% Usage: [cSpikeLists] = STInstantiateNative(mTrainParams, vtChunkStart, vnChunkBins, fTemporalResolution, vnSeed
+%                                            <, mCorrDecomp, vfMemTau, fMixtureCorr, nNumThreads>)
+%
+% STInstantiateNative performs the spike generation loop of STInstantiate for
+% trains with constant, linear or sinusoidal definitions, spreading the work
+% for each train and chunk (or each segment of a chunk, for correlated
+% trains) over a pool of threads.  Each piece of work seeds its own generator
+% from 'vnSeed' and its train and chunk indices, so the output does not
+% depend on the number of threads.  Correlated trains are generated either
+% from a NORTA decomposition 'mCorrDecomp', in cache-sized blocks, or from a
+% shared mother train with correlation 'fMixtureCorr'.  See
+% STInstantiateNative.cpp for a description of the arguments.
+%
+% 'cSpikeLists' will be a cell array, with one row per train and one column
+% per chunk, of column vectors of spike times in seconds.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STInstantiateNative.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STInstantiateNative: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STInstantiateNative.m ---
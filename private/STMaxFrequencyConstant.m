@@ -0,0 +1,28 @@
+function [fMaxFreq] = STMaxFrequencyConstant(stTrainDef, tTimeStart, tTimeEnd)
+
+% STMaxFrequencyConstant - FUNCTION Internal frequency bound function
+% $Id: STMaxFrequencyConstant.m $
+%
+% NOT for command-line use
+
+% Usage: [fMaxFreq] = STMaxFrequencyConstant(stTrainDef, tTimeStart, tTimeEnd)
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin < 3)
+   disp('*** STMaxFrequencyConstant: Incorrect usage');
+   disp('       This is an internal frequency bound function');
+   help private/STMaxFrequencyConstant;
+   help private/STInstFreqDescription;
+   return;
+end
+
+
+% - Constant frequency, so the bound is the frequency itself
+fMaxFreq = stTrainDef.fFreq;
+
+% --- END of STMaxFrequencyConstant.m ---
@@ -0,0 +1,28 @@
+function [fMaxFreq] = STMaxFrequencyLinear(stTrainDef, tTimeStart, tTimeEnd)
+
+% STMaxFrequencyLinear - FUNCTION Internal frequency bound function
+% $Id: STMaxFrequencyLinear.m $
+%
+% NOT for command-line use
+
+% Usage: [fMaxFreq] = STMaxFrequencyLinear(stTrainDef, tTimeStart, tTimeEnd)
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin < 3)
+   disp('*** STMaxFrequencyLinear: Incorrect usage');
+   disp('       This is an internal frequency bound function');
+   help private/STMaxFrequencyLinear;
+   help private/STInstFreqDescription;
+   return;
+end
+
+
+% - The frequency is monotonic over the interval, so the bound is at one end
+fMaxFreq = max([stTrainDef.fStartFreq stTrainDef.fEndFreq]);
+
+% --- END of STMaxFrequencyLinear.m ---
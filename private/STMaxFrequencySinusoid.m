@@ -0,0 +1,28 @@
+function [fMaxFreq] = STMaxFrequencySinusoid(stTrainDef, tTimeStart, tTimeEnd)
+
+% STMaxFrequencySinusoid - FUNCTION Internal frequency bound function
+% $Id: STMaxFrequencySinusoid.m $
+%
+% NOT for command-line use
+
+% Usage: [fMaxFreq] = STMaxFrequencySinusoid(stTrainDef, tTimeStart, tTimeEnd)
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Check arguments
+
+if (nargin < 3)
+   disp('*** STMaxFrequencySinusoid: Incorrect usage');
+   disp('       This is an internal frequency bound function');
+   help private/STMaxFrequencySinusoid;
+   help private/STInstFreqDescription;
+   return;
+end
+
+
+% - The sinusoid peaks at the maximum frequency once every period
+fMaxFreq = stTrainDef.fMaxFreq;
+
+% --- END of STMaxFrequencySinusoid.m ---
@@ -0,0 +1,316 @@
+/* STMergeChunks - FUNCTION (Internal) Merge sorted spike list chunks into new chunks
+ * $Id: STMergeChunks.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [cMergedList] = STMergeChunks(cChunks, vfTemporalResolution, fTemporalResolution, nChunkLength, bMapping <, nNumThreads>)
+ *
+ * 'cChunks' is a cell array of spike list chunks, each sorted by time, and
+ * 'vfTemporalResolution' holds the temporal resolution of each chunk.  If
+ * 'bMapping' is true, each chunk is an Nx2 [tick addr] mapping spike list, and
+ * its ticks are first rescaled exactly to 'fTemporalResolution', as
+ * floor(tick * res_i / res) (see STTicks.h).  This takes a single vectorised
+ * pass over the ticks of each chunk whose resolution differs.  Otherwise each
+ * chunk is a vector of spike times in seconds from an instance, and is merged
+ * as it is.
+ *
+ * STMergeChunks merges the chunks with a heap, and returns the spikes in time
+ * order as a 1xC cell array of chunks of at most 'nChunkLength' spikes.
+ * Spikes with equal times keep the order of 'cChunks', so the result is the
+ * same as concatenating the rescaled chunks, sorting them with sortrows and
+ * splitting the result into chunks.  No working spike list is built beyond
+ * the output chunks themselves and the rescaled ticks.
+ *
+ * Merging k chunks of n spikes in total costs O(n log k).  Large merges are
+ * split over 'nNumThreads' threads (by default, one per hardware thread) by
+ * merge-path partitioning: the output is cut into equal ranges, and the
+ * position in every source chunk at which each range starts is found by a
+ * binary search on spike time.  Spikes with the time at a cut are divided in
+ * the order of the source chunks, so each range can be merged on its own and
+ * the result is still stable.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STMergeHeap.h"
+#include "STThreadPool.h"
+#include "STTicks.h"
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+/* - Smallest number of spikes worth merging on a separate thread */
+#define MERGE_MIN_PART     65536
+
+/* - Number of output ranges per thread, to balance the load */
+#define MERGE_PARTS_PER_THREAD   4
+
+
+/* - One source chunk */
+struct MergeSource {
+   const double   *adTimes, *adAddrs;
+   size_t         nCount;
+};
+
+/* - The output chunks */
+struct MergeOutput {
+   std::vector<double *>   vadChunks;
+   size_t                  nChunkLength, nTotal;
+   bool                    bMapping;
+};
+
+
+/* --- OrderedKey - Map a double to a uint64, preserving order (except for NaN) */
+static inline uint64_t OrderedKey(double fValue)
+{
+   uint64_t nBits;
+   memcpy(&nBits, &fValue, sizeof(nBits));
+   return (nBits & 0x8000000000000000ull) ? ~nBits : (nBits | 0x8000000000000000ull);
+}
+
+/* --- KeyValue - Invert OrderedKey */
+static inline double KeyValue(uint64_t nKey)
+{
+   uint64_t nBits = (nKey & 0x8000000000000000ull) ? (nKey & ~0x8000000000000000ull) : ~nKey;
+   double   fValue;
+   memcpy(&fValue, &nBits, sizeof(fValue));
+   return fValue;
+}
+
+/* --- CountBelow - Return the number of spikes of 'source' with times below
+ *     'fTime', or not above it if 'bInclusive' */
+static inline size_t CountBelow(const MergeSource &source, double fTime, bool bInclusive)
+{
+   const double *adEnd = source.adTimes + source.nCount;
+
+   if (bInclusive) {
+      return std::upper_bound(source.adTimes, adEnd, fTime) - source.adTimes;
+   } else {
+      return std::lower_bound(source.adTimes, adEnd, fTime) - source.adTimes;
+   }
+}
+
+/* --- FindSplit - Find where output spike 'nRank' starts in each source
+ *
+ * 'vnSplit[j]' is set to the number of spikes of source 'j' which precede
+ * output spike 'nRank' in the stable merge.  The time of that spike is the
+ * smallest time with more than 'nRank' spikes at or before it; it is found
+ * by bisection over the ordered bit patterns of doubles, so it takes at most
+ * 64 steps.  Spikes before that time all precede the split, and spikes at
+ * that time are taken from the sources in order until 'nRank' is reached.
+ */
+static void FindSplit(const std::vector<MergeSource> &vSources, size_t nRank, double fMinTime, double fMaxTime,
+                      std::vector<size_t> &vnSplit)
+{
+   size_t   nSource, nNumSources = vSources.size(), nBefore;
+   uint64_t nLowKey = OrderedKey(fMinTime),
+            nHighKey = OrderedKey(fMaxTime);
+
+   while (nLowKey < nHighKey) {
+      uint64_t nMidKey = nLowKey + (nHighKey - nLowKey) / 2;
+      double   fMid = KeyValue(nMidKey);
+
+      for (nSource = 0, nBefore = 0; nSource < nNumSources; nSource++) {
+         nBefore += CountBelow(vSources[nSource], fMid, true);
+      }
+
+      if (nBefore > nRank) {
+         nHighKey = nMidKey;
+      } else {
+         nLowKey = nMidKey + 1;
+      }
+   }
+
+   /* - Take every spike before the split time, then spikes at it in order */
+   double   fSplit = KeyValue(nLowKey);
+   size_t   nRemaining = nRank;
+
+   for (nSource = 0; nSource < nNumSources; nSource++) {
+      vnSplit[nSource] = CountBelow(vSources[nSource], fSplit, false);
+      nRemaining -= vnSplit[nSource];
+   }
+
+   for (nSource = 0; (nSource < nNumSources) && (nRemaining > 0); nSource++) {
+      size_t nEqual = CountBelow(vSources[nSource], fSplit, true) - vnSplit[nSource],
+             nTake = std::min(nEqual, nRemaining);
+      vnSplit[nSource] += nTake;
+      nRemaining -= nTake;
+   }
+}
+
+/* --- MergeRange - Merge the spikes between two splits into the output */
+static void MergeRange(const std::vector<MergeSource> &vSources, const std::vector<size_t> &vnStart,
+                       const std::vector<size_t> &vnEnd, size_t nOutFirst, const MergeOutput &output)
+{
+   STMergeHeap<double>  heap;
+   std::vector<size_t>  vnPos(vnStart);
+   size_t               nSource,
+                        nChunk = nOutFirst / output.nChunkLength,
+                        nOffset = nOutFirst % output.nChunkLength,
+                        nChunkCount = 0;
+   double               *adTimes = NULL;
+
+   heap.Reserve(vSources.size());
+   for (nSource = 0; nSource < vSources.size(); nSource++) {
+      if (vnPos[nSource] < vnEnd[nSource]) {
+         heap.Push(vSources[nSource].adTimes[vnPos[nSource]], nSource);
+      }
+   }
+
+   if (!heap.Empty()) {
+      adTimes = output.vadChunks[nChunk];
+      nChunkCount = std::min(output.nChunkLength, output.nTotal - nChunk * output.nChunkLength);
+   }
+
+   while (!heap.Empty()) {
+      size_t               nTop = heap.TopSource();
+      const MergeSource    &source = vSources[nTop];
+
+      /* - Move on to the next output chunk */
+      if (nOffset == nChunkCount) {
+         nChunk++;
+         nOffset = 0;
+         adTimes = output.vadChunks[nChunk];
+         nChunkCount = std::min(output.nChunkLength, output.nTotal - nChunk * output.nChunkLength);
+      }
+
+      adTimes[nOffset] = heap.TopTick();
+      if (output.bMapping) adTimes[nChunkCount + nOffset] = source.adAddrs[vnPos[nTop]];
+      nOffset++;
+
+      if (++vnPos[nTop] < vnEnd[nTop]) {
+         heap.Replace(source.adTimes[vnPos[nTop]]);
+      } else {
+         heap.Pop();
+      }
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   std::vector<MergeSource>   vSources;
+   std::vector<STTickRatio>   vRatios;
+   std::vector< std::vector<double> > vvfRescaled;
+   MergeOutput                output;
+   size_t                     nNumChunks, nChunk, nSource;
+   unsigned                   nNumThreads = STDefaultNumThreads();
+   double                     fMinTime = 0, fMaxTime = 0;
+
+   /* - Check usage */
+   if ((nlhs > 1) || (nrhs < 5) || (nrhs > 6) || !mxIsCell(prhs[0]) || !mxIsDouble(prhs[1])) {
+      mexPrintf("*** STMergeChunks: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STMergeChunks");
+      return;
+   }
+
+   nNumChunks = mxGetNumberOfElements(prhs[0]);
+   output.bMapping = (mxGetScalar(prhs[4]) != 0);
+
+   if (mxGetNumberOfElements(prhs[1]) != nNumChunks) {
+      mexErrMsgIdAndTxt("STMergeChunks:InvalidArgument",
+                        "*** STMergeChunks: 'vfTemporalResolution' must hold one resolution for each chunk");
+   }
+
+   if (!(mxGetScalar(prhs[3]) >= 1)) {
+      mexErrMsgIdAndTxt("STMergeChunks:InvalidArgument",
+                        "*** STMergeChunks: The chunk length must be at least one spike");
+   }
+   output.nChunkLength = (size_t) mxGetScalar(prhs[3]);
+
+   if ((nrhs > 5) && !mxIsEmpty(prhs[5]) && (mxGetScalar(prhs[5]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[5]);
+   }
+
+   /* - Collect the non-empty chunks, and the ratio for rescaling each */
+   output.nTotal = 0;
+   for (nChunk = 0; nChunk < nNumChunks; nChunk++) {
+      const mxArray  *pChunk = mxGetCell(prhs[0], nChunk);
+      MergeSource    source;
+
+      if ((pChunk == NULL) || mxIsEmpty(pChunk)) continue;
+
+      if (!mxIsDouble(pChunk) || mxIsComplex(pChunk) || (output.bMapping && (mxGetN(pChunk) != 2))) {
+         mexErrMsgIdAndTxt("STMergeChunks:InvalidSpikeList",
+                           "*** STMergeChunks: Chunks must be real double spike lists, with two columns for mappings");
+      }
+
+      source.nCount = output.bMapping ? mxGetM(pChunk) : mxGetNumberOfElements(pChunk);
+      source.adTimes = mxGetPr(pChunk);
+      source.adAddrs = output.bMapping ? source.adTimes + source.nCount : NULL;
+
+      STTickRatio ratio = { 1, 1 };
+      if (output.bMapping) {
+         try {
+            ratio = STTickRatioBetween(mxGetPr(prhs[1])[nChunk], mxGetScalar(prhs[2]));
+         } catch (std::exception &e) {
+            mexErrMsgIdAndTxt("STMergeChunks:InvalidArgument", "*** STMergeChunks: %s", e.what());
+         }
+      }
+
+      vSources.push_back(source);
+      vRatios.push_back(ratio);
+      output.nTotal += source.nCount;
+   }
+
+   /* - Rescale the ticks of each chunk that needs it, in one pass */
+   vvfRescaled.resize(vSources.size());
+   for (nSource = 0; nSource < vSources.size(); nSource++) {
+      if (!STTickRatioIsUnit(vRatios[nSource])) vvfRescaled[nSource].resize(vSources[nSource].nCount);
+   }
+
+   STParallelFor(vSources.size(), nNumThreads, [&](size_t nSource, unsigned) {
+      if (STTickRatioIsUnit(vRatios[nSource])) return;
+      STRescaleDoubleTicks(vSources[nSource].adTimes, vSources[nSource].nCount, vRatios[nSource],
+                           vvfRescaled[nSource].data());
+      vSources[nSource].adTimes = vvfRescaled[nSource].data();
+   });
+
+   /* - Find the range of the times */
+   for (nSource = 0; nSource < vSources.size(); nSource++) {
+      double fFirst = vSources[nSource].adTimes[0],
+             fLast = vSources[nSource].adTimes[vSources[nSource].nCount - 1];
+      fMinTime = (nSource == 0) ? fFirst : std::min(fMinTime, fFirst);
+      fMaxTime = (nSource == 0) ? fLast : std::max(fMaxTime, fLast);
+   }
+
+   /* - Create every output chunk here, since MATLAB can't be called from threads */
+   size_t   nNumOutChunks = (output.nTotal + output.nChunkLength - 1) / output.nChunkLength;
+   mxArray  *pMerged = mxCreateCellMatrix(1, nNumOutChunks);
+
+   for (nChunk = 0; nChunk < nNumOutChunks; nChunk++) {
+      size_t   nChunkCount = std::min(output.nChunkLength, output.nTotal - nChunk * output.nChunkLength);
+      mxArray  *pChunk = mxCreateDoubleMatrix(nChunkCount, output.bMapping ? 2 : 1, mxREAL);
+      output.vadChunks.push_back(mxGetPr(pChunk));
+      mxSetCell(pMerged, nChunk, pChunk);
+   }
+
+   /* - Cut the output into ranges, and find where each starts in every source */
+   size_t nNumParts = std::min((size_t) nNumThreads * MERGE_PARTS_PER_THREAD, output.nTotal / MERGE_MIN_PART);
+   if ((nNumThreads < 2) || (vSources.size() < 2) || (nNumParts < 2)) nNumParts = 1;
+
+   std::vector< std::vector<size_t> > vvnSplits(nNumParts + 1, std::vector<size_t>(vSources.size(), 0));
+   for (nSource = 0; nSource < vSources.size(); nSource++) vvnSplits[nNumParts][nSource] = vSources[nSource].nCount;
+
+   STParallelFor(nNumParts - 1, nNumThreads, [&](size_t nPart, unsigned) {
+      FindSplit(vSources, (nPart + 1) * output.nTotal / nNumParts, fMinTime, fMaxTime, vvnSplits[nPart + 1]);
+   });
+
+   /* - Merge each range */
+   STParallelFor(nNumParts, nNumThreads, [&](size_t nPart, unsigned) {
+      MergeRange(vSources, vvnSplits[nPart], vvnSplits[nPart + 1], nPart * output.nTotal / nNumParts, output);
+   });
+
+   plhs[0] = pMerged;
+}
+
+/* --- END of STMergeChunks.cpp --- */
@@ -0,0 +1,33 @@
+function [cMergedList] = STMergeChunks(cChunks, vfTemporalResolution, fTemporalResolution, nChunkLength, bMapping, nNumThreads)
+
+% STMergeChunks - FUNCTION (Internal) Merge sorted spike list chunks into new chunks
+% $Id: STMergeChunks.m $
+%
+% NOT for command-line use
+
+% Usage: [cMergedList] = STMergeChunks(cChunks, vfTemporalResolution, fTemporalResolution, nChunkLength, bMapping <, nNumThreads>)
+%
+% 'cChunks' is a cell array of spike list chunks, each sorted by time, with
+% one temporal resolution in 'vfTemporalResolution' for each chunk.  If
+% 'bMapping' is true, the chunks are [tick addr] mapping spike lists, and their
+% ticks are rescaled exactly to 'fTemporalResolution'; otherwise they are
+% instance spike time vectors, in seconds.  STMergeChunks merges the chunks in
+% time order, and returns the result as a cell array of chunks of at most
+% 'nChunkLength' spikes.  Spikes with equal times keep the order of 'cChunks',
+% as sortrows would.  Large merges are split over 'nNumThreads' threads, by
+% default one per hardware thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STMergeChunks.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STMergeChunks: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STMergeChunks.m ---
@@ -0,0 +1,111 @@
+/* STMergeHeap.h - Binary heap for k-way merging of sorted spike lists
+ * $Id: STMergeHeap.h $
+ *
+ * NOT for command-line use
+ *
+ * STMergeHeap holds the current tick of each of a set of sorted sources, and
+ * returns the source with the smallest tick.  Sources with equal ticks are
+ * returned in order of their index, so a merge which draws from the sources
+ * in this order is stable: it gives the same order as concatenating the
+ * sources and sorting with a stable sort (as sortrows).
+ *
+ * A merge reads the top source, advances it, and then either calls Replace
+ * with the next tick of the source or Pop if it is exhausted.  Replace costs
+ * a single comparison while the top source keeps the smallest tick, so runs
+ * of spikes from one source are merged cheaply.
+ *
+ * The tick type 'Tick' may be any type ordered by operator<, such as uint64_t
+ * for spike store ticks or double for MATLAB spike lists.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_MERGE_HEAP_H
+#define ST_MERGE_HEAP_H
+
+#include <stddef.h>
+#include <vector>
+
+
+/* --- STMergeHeap - Min-heap of (tick, source) pairs */
+template <typename Tick>
+class STMergeHeap {
+public:
+   /* - Reserve space for 'nNumSources' sources */
+   void Reserve(size_t nNumSources) { vEntries.reserve(nNumSources); }
+
+   /* - Add a source with current tick 'tick' */
+   void Push(Tick tick, size_t nSource)
+   {
+      Entry entry = { tick, nSource };
+      size_t nPos = vEntries.size();
+
+      vEntries.push_back(entry);
+      while (nPos > 0) {
+         size_t nParent = (nPos - 1) / 2;
+         if (!Before(entry, vEntries[nParent])) break;
+         vEntries[nPos] = vEntries[nParent];
+         nPos = nParent;
+      }
+      vEntries[nPos] = entry;
+   }
+
+   bool Empty(void) const { return vEntries.empty(); }
+
+   /* - Return the source with the smallest tick, and that tick */
+   size_t TopSource(void) const { return vEntries[0].nSource; }
+   Tick TopTick(void) const { return vEntries[0].tick; }
+
+   /* - Set the tick of the top source, which must not decrease */
+   void Replace(Tick tick)
+   {
+      vEntries[0].tick = tick;
+      SiftDown();
+   }
+
+   /* - Remove the top source */
+   void Pop(void)
+   {
+      vEntries[0] = vEntries.back();
+      vEntries.pop_back();
+      if (!vEntries.empty()) SiftDown();
+   }
+
+private:
+   struct Entry {
+      Tick     tick;
+      size_t   nSource;
+   };
+
+   std::vector<Entry> vEntries;
+
+   static bool Before(const Entry &a, const Entry &b)
+   {
+      return (a.tick < b.tick) || (!(b.tick < a.tick) && (a.nSource < b.nSource));
+   }
+
+   /* - Move the top entry down to its place */
+   void SiftDown(void)
+   {
+      Entry    entry = vEntries[0];
+      size_t   nPos = 0,
+               nSize = vEntries.size();
+
+      for (;;) {
+         size_t nChild = 2 * nPos + 1;
+         if (nChild >= nSize) break;
+         if ((nChild + 1 < nSize) && Before(vEntries[nChild + 1], vEntries[nChild])) nChild++;
+         if (!Before(vEntries[nChild], entry)) break;
+         vEntries[nPos] = vEntries[nChild];
+         nPos = nChild;
+      }
+      vEntries[nPos] = entry;
+   }
+};
+
+#endif  /* ST_MERGE_HEAP_H */
+
+/* --- END of STMergeHeap.h --- */
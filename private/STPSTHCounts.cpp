@@ -0,0 +1,215 @@
+/* STPSTHCounts - FUNCTION (Internal) Accumulate a peri-stimulus time histogram over many trials
+ * $Id: STPSTHCounts.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [vPSTHist, vMeanHist, vStdErr, mRaster] = STPSTHCounts(vtSpikeTimes, vtStimOnset, vtWindow, nNumBins <, nNumThreads>)
+ *
+ * 'vtSpikeTimes' is a vector of spike times in seconds, and 'vtStimOnset' a
+ * vector of stimulus onset times.  Each onset defines one trial, covering the
+ * times [tOnset + vtWindow(1), tOnset + vtWindow(2)], which is divided into
+ * 'nNumBins' bins of equal duration.  A spike at time 't' lies at
+ *
+ *    tRel = (t - tOnset) - vtWindow(1)
+ *
+ * from the start of the trial.  Bin 'n' (zero-based) spans [n, n+1] * tBin,
+ * including both ends, so a spike falling exactly on the boundary between two
+ * bins is counted in both, as STProfileCount does.
+ *
+ * 'vPSTHist' returns the 1x'nNumBins' sum of the bin counts over all trials,
+ * 'vMeanHist' their mean, and 'vStdErr' the standard error of the mean
+ * (the sample standard deviation divided by the square root of the number of
+ * trials).  If it is requested, 'mRaster' returns the counts of every trial,
+ * as a (trials)x'nNumBins' matrix.
+ *
+ * The spike times are sorted once (a copy is made if they are not sorted),
+ * and the first spike of each trial is found by binary search, so each trial
+ * visits only its own spikes.  Trials are spread over 'nNumThreads' threads
+ * (by default, one per hardware thread), each accumulating its own sums and
+ * sums of squares, which are combined at the end.  Since the counts are whole
+ * numbers, these sums are exact.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 17th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STThreadPool.h"
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+
+
+/* - Number of trials counted as one piece of work */
+#define PSTH_BLOCK         256
+
+
+/* - The trial window, and the sorted spike times */
+struct PSTHTrials {
+   std::vector<double>  vfSorted;
+   const double         *adTimes, *adOnsets;
+   size_t               nNumSpikes, nNumTrials;
+   double               tWindowStart, tWindowDuration, tBinDuration;
+   ptrdiff_t            nNumBins;
+};
+
+/* - Sums accumulated by one worker */
+struct PSTHSums {
+   std::vector<double>  vfSum, vfSumSq, vfTrial;
+};
+
+
+/* --- RelativeTime - Time of spike 'nSpike' from the start of a trial */
+static inline double RelativeTime(const PSTHTrials &trials, size_t nSpike, double tOnset)
+{
+   return (trials.adTimes[nSpike] - tOnset) - trials.tWindowStart;
+}
+
+/* --- CountTrial - Count the spikes of one trial into 'vfTrial'
+ *
+ * The relative time never decreases as the spike time increases, so the
+ * spikes of the trial are contiguous in the sorted list.
+ */
+static void CountTrial(const PSTHTrials &trials, double tOnset, std::vector<double> &vfTrial)
+{
+   size_t      nSpike = std::lower_bound(trials.adTimes, trials.adTimes + trials.nNumSpikes,
+                                         tOnset + trials.tWindowStart) - trials.adTimes;
+   ptrdiff_t   nBin, nTest;
+
+   std::fill(vfTrial.begin(), vfTrial.end(), 0.0);
+
+   /* - The search used a rounded start time, so step back to the first spike in the trial */
+   while ((nSpike > 0) && (RelativeTime(trials, nSpike - 1, tOnset) >= 0)) nSpike--;
+
+   for (; nSpike < trials.nNumSpikes; nSpike++) {
+      double tRel = RelativeTime(trials, nSpike, tOnset);
+
+      if (tRel < 0) continue;
+      if (tRel > trials.tWindowDuration) break;
+
+      /* - Test the neighbouring bins too, to match the boundary test exactly */
+      double fBin = floor(tRel / trials.tBinDuration);
+      nBin = (fBin > (double) trials.nNumBins) ? trials.nNumBins : (ptrdiff_t) fBin;
+
+      for (nTest = std::max((ptrdiff_t) 0, nBin - 1); nTest <= std::min(trials.nNumBins - 1, nBin + 1); nTest++) {
+         if (((double) nTest * trials.tBinDuration <= tRel) && (tRel <= (double) (nTest + 1) * trials.tBinDuration)) {
+            vfTrial[nTest]++;
+         }
+      }
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   PSTHTrials              trials;
+   std::vector<PSTHSums>   vSums;
+   unsigned                nNumThreads = STDefaultNumThreads(), nNumWorkers;
+   size_t                  nNumBlocks;
+   double                  *adRaster = NULL, *adSum, *adMean, *adStdErr;
+
+   /* - Check usage */
+   if ((nlhs > 4) || (nrhs < 4) || (nrhs > 5) || !mxIsDouble(prhs[0]) || !mxIsDouble(prhs[1]) ||
+       !mxIsDouble(prhs[2]) || (mxGetNumberOfElements(prhs[2]) != 2)) {
+      mexPrintf("*** STPSTHCounts: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STPSTHCounts");
+      return;
+   }
+
+   trials.tWindowStart = mxGetPr(prhs[2])[0];
+   trials.tWindowDuration = mxGetPr(prhs[2])[1] - trials.tWindowStart;
+   if (!(trials.tWindowDuration > 0)) {
+      mexErrMsgIdAndTxt("STPSTHCounts:InvalidArgument", "*** STPSTHCounts: The trial window must have a positive duration");
+   }
+
+   if (!(mxGetScalar(prhs[3]) >= 1) || (mxGetScalar(prhs[3]) > 1e9)) {
+      mexErrMsgIdAndTxt("STPSTHCounts:InvalidArgument", "*** STPSTHCounts: There must be at least one bin");
+   }
+   trials.nNumBins = (ptrdiff_t) mxGetScalar(prhs[3]);
+   trials.tBinDuration = trials.tWindowDuration / (double) trials.nNumBins;
+
+   if ((nrhs > 4) && !mxIsEmpty(prhs[4]) && (mxGetScalar(prhs[4]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[4]);
+   }
+
+   /* - Sort the spike times, if they are not sorted already */
+   trials.nNumSpikes = mxGetNumberOfElements(prhs[0]);
+   trials.adTimes = mxGetPr(prhs[0]);
+
+   if (!std::is_sorted(trials.adTimes, trials.adTimes + trials.nNumSpikes)) {
+      trials.vfSorted.assign(trials.adTimes, trials.adTimes + trials.nNumSpikes);
+      std::sort(trials.vfSorted.begin(), trials.vfSorted.end());
+      trials.adTimes = trials.vfSorted.data();
+   }
+
+   trials.nNumTrials = mxGetNumberOfElements(prhs[1]);
+   trials.adOnsets = mxGetPr(prhs[1]);
+
+   /* - Create the raster here, since MATLAB can't be called from threads */
+   if (nlhs > 3) {
+      plhs[3] = mxCreateDoubleMatrix(trials.nNumTrials, trials.nNumBins, mxREAL);
+      adRaster = mxGetPr(plhs[3]);
+   }
+
+   /* - Count blocks of trials, each worker into its own sums */
+   nNumBlocks = (trials.nNumTrials + PSTH_BLOCK - 1) / PSTH_BLOCK;
+   nNumWorkers = (unsigned) std::max((size_t) 1, std::min((size_t) nNumThreads, nNumBlocks));
+   vSums.resize(nNumWorkers);
+
+   for (size_t nWorker = 0; nWorker < vSums.size(); nWorker++) {
+      vSums[nWorker].vfSum.assign(trials.nNumBins, 0);
+      vSums[nWorker].vfSumSq.assign(trials.nNumBins, 0);
+      vSums[nWorker].vfTrial.resize(trials.nNumBins);
+   }
+
+   STParallelFor(nNumBlocks, nNumWorkers, [&](size_t nBlock, unsigned nWorker) {
+      PSTHSums &sums = vSums[nWorker];
+
+      for (size_t nTrial = nBlock * PSTH_BLOCK; nTrial < std::min(trials.nNumTrials, (nBlock + 1) * PSTH_BLOCK); nTrial++) {
+         CountTrial(trials, trials.adOnsets[nTrial], sums.vfTrial);
+
+         for (ptrdiff_t nBin = 0; nBin < trials.nNumBins; nBin++) {
+            double fCount = sums.vfTrial[nBin];
+
+            sums.vfSum[nBin] += fCount;
+            sums.vfSumSq[nBin] += fCount * fCount;
+            if (adRaster != NULL) adRaster[nTrial + nBin * trials.nNumTrials] = fCount;
+         }
+      }
+   });
+
+   /* - Combine the sums, and find the mean and standard error of each bin */
+   plhs[0] = mxCreateDoubleMatrix(1, trials.nNumBins, mxREAL);
+   adSum = mxGetPr(plhs[0]);
+   if (nlhs > 1) plhs[1] = mxCreateDoubleMatrix(1, trials.nNumBins, mxREAL);
+   if (nlhs > 2) plhs[2] = mxCreateDoubleMatrix(1, trials.nNumBins, mxREAL);
+
+   for (ptrdiff_t nBin = 0; nBin < trials.nNumBins; nBin++) {
+      double   fSum = 0, fSumSq = 0, fNum = (double) trials.nNumTrials;
+
+      for (size_t nWorker = 0; nWorker < vSums.size(); nWorker++) {
+         fSum += vSums[nWorker].vfSum[nBin];
+         fSumSq += vSums[nWorker].vfSumSq[nBin];
+      }
+      adSum[nBin] = fSum;
+
+      if (nlhs > 1) {
+         adMean = mxGetPr(plhs[1]);
+         adMean[nBin] = (trials.nNumTrials > 0) ? fSum / fNum : mxGetNaN();
+      }
+
+      if (nlhs > 2) {
+         /* - The numerator is a whole number, so is found without cancellation */
+         adStdErr = mxGetPr(plhs[2]);
+         adStdErr[nBin] = (trials.nNumTrials > 1) ?
+                          sqrt(std::max(0.0, fNum * fSumSq - fSum * fSum) / (fNum * (fNum - 1))) / sqrt(fNum) : 0;
+      }
+   }
+}
+
+/* --- END of STPSTHCounts.cpp --- */
@@ -0,0 +1,33 @@
+function [vPSTHist, vMeanHist, vStdErr, mRaster] = STPSTHCounts(vtSpikeTimes, vtStimOnset, vtWindow, nNumBins, nNumThreads)
+
+% STPSTHCounts - FUNCTION (Internal) Accumulate a peri-stimulus time histogram over many trials
+% $Id: STPSTHCounts.m $
+%
+% NOT for command-line use
+
+% Usage: [vPSTHist, vMeanHist, vStdErr, mRaster] = STPSTHCounts(vtSpikeTimes, vtStimOnset, vtWindow, nNumBins <, nNumThreads>)
+%
+% 'vtSpikeTimes' is a vector of spike times in seconds.  Each onset in
+% 'vtStimOnset' defines a trial over [tOnset + vtWindow(1), tOnset +
+% vtWindow(2)], divided into 'nNumBins' bins; a spike on the boundary between
+% two bins is counted in both, as STProfileCount does.  'vPSTHist' returns the
+% sum of the bin counts over all trials, 'vMeanHist' their mean and 'vStdErr'
+% the standard error of the mean.  'mRaster' optionally returns the counts of
+% every trial, one row per trial.  The first spike of each trial is found by
+% binary search, and trials are counted over 'nNumThreads' threads, by
+% default one per hardware thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STPSTHCounts.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STPSTHCounts: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STPSTHCounts.m ---
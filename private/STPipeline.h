@@ -0,0 +1,493 @@
+/* STPipeline.h - Lazy chunk-at-a-time pipelines of spike train operations
+ * $Id: STPipeline.h $
+ *
+ * NOT for command-line use
+ *
+ * A pipeline applies a chain of operations to one or more spike trains
+ * without building the result of each operation.  Each stage is an
+ * STSpikeStream, which returns the spikes of its result as a sequence of
+ * buffers of [uint64 tick, uint32 address] columns, pulling buffers from the
+ * stage before it only as they are needed.  Buffers come from an
+ * STSpikeBufferPool and are returned to it once they have been read, so a
+ * pipeline uses a fixed number of small buffers however long its trains are.
+ * Only the final sink, drained with STPipelineDrain, holds a whole result.
+ * The pool owns every buffer, so it must outlive the streams which use it,
+ * and it frees any buffers still held by a stage which throws.
+ *
+ *    STStreamStore     - Read the spikes of a store
+ *    STStreamTicks     - Read the chunks of a mapping spike list
+ *    STStreamTimes     - Crop, shift and map the chunks of an instance spike list
+ *    STStreamCrop      - Keep the spikes in a range of ticks
+ *    STStreamShift     - Offset every tick
+ *    STStreamRescale   - Rescale every tick exactly (see STTicks.h)
+ *    STStreamMerge     - Interleave several streams in tick order
+ *    STPipelineDrain   - Pass the spikes of a stream to a sink, in chunks
+ *
+ * Every stream returns its spikes in tick order, and never returns an empty
+ * buffer.  The sources read spike lists whose chunks follow one another in
+ * time, as STInstantiate and STMultiplex build them; STStreamMerge checks
+ * this, and throws std::invalid_argument for a source which is out of order.
+ * Like STSpikeStore.h, these classes throw std::bad_alloc if memory runs out
+ * and do not use MATLAB API functions.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_PIPELINE_H
+#define ST_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "STSpikeStore.h"
+
+
+/* - Number of spikes in each pooled buffer */
+#define ST_PIPELINE_BUFFER    16384
+
+/* - Operations on instance spike times, or on ticks */
+#define ST_PIPELINE_CROP      1        /* Keep [fA, fB] */
+#define ST_PIPELINE_SHIFT     2        /* Add fA */
+#define ST_PIPELINE_RESCALE   3        /* Rescale ticks from resolution fA to fB */
+
+
+/* - One operation of a pipeline stage */
+struct STPipelineOp {
+   int      nOp;
+   double   fA, fB;
+};
+
+/* - A buffer of spikes, in columns of 'nCount' ticks and addresses */
+struct STSpikeBuffer {
+   std::vector<uint64_t>   vnTicks;
+   std::vector<uint32_t>   vnAddrs;
+   size_t                  nCount;
+};
+
+
+/* --- STSpikeBufferPool - Reusable spike buffers for a pipeline */
+class STSpikeBufferPool {
+public:
+   explicit STSpikeBufferPool(size_t nLength = ST_PIPELINE_BUFFER) : nBufferLength(nLength) {}
+
+   /* - Return an empty buffer, allocating one only if none is free */
+   STSpikeBuffer *Acquire(void)
+   {
+      if (vpFree.empty()) {
+         std::unique_ptr<STSpikeBuffer> pBuffer(new STSpikeBuffer);
+         pBuffer->vnTicks.resize(nBufferLength);
+         pBuffer->vnAddrs.resize(nBufferLength);
+         vpFree.reserve(vpBuffers.size() + 1);
+         vpBuffers.push_back(std::move(pBuffer));
+         vpFree.push_back(vpBuffers.back().get());
+      }
+
+      STSpikeBuffer *pBuffer = vpFree.back();
+      vpFree.pop_back();
+      pBuffer->nCount = 0;
+      return pBuffer;
+   }
+
+   /* - Return a buffer to the pool */
+   void Release(STSpikeBuffer *pBuffer) { if (pBuffer != NULL) vpFree.push_back(pBuffer); }
+
+   size_t Length(void) const { return nBufferLength; }
+
+   /* - Return the number of buffers allocated so far */
+   size_t NumBuffers(void) const { return vpBuffers.size(); }
+
+private:
+   std::vector< std::unique_ptr<STSpikeBuffer> >   vpBuffers;
+   std::vector<STSpikeBuffer *>                    vpFree;
+   size_t                                          nBufferLength;
+};
+
+
+/* --- STSpikeStream - One stage of a pipeline */
+class STSpikeStream {
+public:
+   explicit STSpikeStream(STSpikeBufferPool &pool) : pool(pool) {}
+   virtual ~STSpikeStream() {}
+
+   /* - Return the next non-empty buffer of spikes, or NULL at the end.  The
+    *   caller must give the buffer back to the pool */
+   virtual STSpikeBuffer *Next(void) = 0;
+
+protected:
+   STSpikeBufferPool &pool;
+};
+
+/* --- STStreamFilter - Base for stages which change the buffers of another stream in place */
+class STStreamFilter : public STSpikeStream {
+public:
+   explicit STStreamFilter(std::unique_ptr<STSpikeStream> pSource, STSpikeBufferPool &pool)
+      : STSpikeStream(pool), pSource(std::move(pSource)) {}
+
+   STSpikeBuffer *Next(void)
+   {
+      STSpikeBuffer *pBuffer;
+
+      /* - Skip buffers which the stage empties */
+      while ((pBuffer = pSource->Next()) != NULL) {
+         Apply(*pBuffer);
+         if (pBuffer->nCount > 0) return pBuffer;
+         pool.Release(pBuffer);
+      }
+      return NULL;
+   }
+
+protected:
+   virtual void Apply(STSpikeBuffer &buffer) = 0;
+
+private:
+   std::unique_ptr<STSpikeStream> pSource;
+};
+
+
+/* --- STStreamStore - Read the spikes of a store, a buffer at a time */
+class STStreamStore : public STSpikeStream {
+public:
+   STStreamStore(const STSpikeStore &store, STSpikeBufferPool &pool)
+      : STSpikeStream(pool), store(store), nChunk(0), nNext(0) {}
+
+   STSpikeBuffer *Next(void)
+   {
+      while ((nChunk < store.vChunks.size()) && (nNext >= store.vChunks[nChunk].nCount)) {
+         nChunk++;
+         nNext = 0;
+      }
+      if (nChunk >= store.vChunks.size()) return NULL;
+
+      const STSpikeChunk   &chunk = store.vChunks[nChunk];
+      STSpikeBuffer        *pBuffer = pool.Acquire();
+
+      pBuffer->nCount = std::min(pool.Length(), chunk.nCount - nNext);
+      STSpikeStore::Decode(chunk, nNext, pBuffer->nCount, pBuffer->vnTicks.data(), pBuffer->vnAddrs.data());
+      nNext += pBuffer->nCount;
+      return pBuffer;
+   }
+
+private:
+   const STSpikeStore   &store;
+   size_t               nChunk, nNext;
+};
+
+
+/* - One chunk of a MATLAB spike list: a column of ticks or times, and a
+ *   column of addresses for mappings */
+struct STSpikeListChunk {
+   const double   *adTimes, *adAddrs;
+   size_t         nCount;
+};
+
+/* --- STStreamTicks - Read the chunks of a mapping spike list, as STSpikeStore 'create' does */
+class STStreamTicks : public STSpikeStream {
+public:
+   STStreamTicks(const std::vector<STSpikeListChunk> &vChunks, STSpikeBufferPool &pool)
+      : STSpikeStream(pool), vChunks(vChunks), nChunk(0), nNext(0) {}
+
+   STSpikeBuffer *Next(void)
+   {
+      while ((nChunk < vChunks.size()) && (nNext >= vChunks[nChunk].nCount)) {
+         nChunk++;
+         nNext = 0;
+      }
+      if (nChunk >= vChunks.size()) return NULL;
+
+      const STSpikeListChunk  &chunk = vChunks[nChunk];
+      STSpikeBuffer           *pBuffer = pool.Acquire();
+
+      pBuffer->nCount = std::min(pool.Length(), chunk.nCount - nNext);
+      for (size_t nSpike = 0; nSpike < pBuffer->nCount; nSpike++, nNext++) {
+         double fTick = chunk.adTimes[nNext],
+                fAddr = chunk.adAddrs[nNext];
+
+         if (!(fTick >= 0) || !(fTick <= 9007199254740992.0) ||
+             !(fAddr >= 0) || !(fAddr <= 4294967295.0) || (fAddr != floor(fAddr))) {
+            throw std::invalid_argument("Ticks must be non-negative, and addresses must be 32-bit unsigned integers");
+         }
+         pBuffer->vnTicks[nSpike] = (uint64_t) floor(fTick);
+         pBuffer->vnAddrs[nSpike] = (uint32_t) fAddr;
+      }
+      return pBuffer;
+   }
+
+private:
+   std::vector<STSpikeListChunk>    vChunks;
+   size_t                           nChunk, nNext;
+};
+
+/* --- STStreamTimes - Crop, shift and map the chunks of an instance spike list
+ *
+ * The operations in 'vOps' are applied to each spike time in seconds, in
+ * order, as STCrop and STShift would apply them to an instance.  Each
+ * remaining time 't' is then mapped to tick floor(t / 'fTemporalResolution')
+ * and to the address 'nAddr', as STMap does.
+ */
+class STStreamTimes : public STSpikeStream {
+public:
+   STStreamTimes(const std::vector<STSpikeListChunk> &vChunks, const std::vector<STPipelineOp> &vOps,
+                 double fTemporalResolution, uint32_t nAddr, STSpikeBufferPool &pool)
+      : STSpikeStream(pool), vChunks(vChunks), vOps(vOps), fTemporalResolution(fTemporalResolution),
+        nAddr(nAddr), nChunk(0), nNext(0)
+   {
+      if (!(fTemporalResolution > 0)) throw std::invalid_argument("The temporal resolution must be positive");
+   }
+
+   STSpikeBuffer *Next(void)
+   {
+      STSpikeBuffer *pBuffer = NULL;
+
+      while (nChunk < vChunks.size()) {
+         const STSpikeListChunk &chunk = vChunks[nChunk];
+
+         if (nNext >= chunk.nCount) {
+            nChunk++;
+            nNext = 0;
+            continue;
+         }
+
+         if (pBuffer == NULL) pBuffer = pool.Acquire();
+
+         for (; (nNext < chunk.nCount) && (pBuffer->nCount < pool.Length()); nNext++) {
+            double   tSpike = chunk.adTimes[nNext];
+            bool     bKeep = true;
+
+            for (size_t nOp = 0; bKeep && (nOp < vOps.size()); nOp++) {
+               if (vOps[nOp].nOp == ST_PIPELINE_CROP) {
+                  bKeep = (tSpike >= vOps[nOp].fA) && (tSpike <= vOps[nOp].fB);
+               } else if (vOps[nOp].nOp == ST_PIPELINE_SHIFT) {
+                  tSpike = tSpike + vOps[nOp].fA;
+               }
+            }
+            if (!bKeep) continue;
+
+            double fTick = floor(tSpike / fTemporalResolution);
+            if (!(fTick >= 0) || !(fTick <= 9007199254740992.0)) {
+               throw std::invalid_argument("Spike times must be non-negative");
+            }
+            pBuffer->vnTicks[pBuffer->nCount] = (uint64_t) fTick;
+            pBuffer->vnAddrs[pBuffer->nCount] = nAddr;
+            pBuffer->nCount++;
+         }
+
+         if (pBuffer->nCount == pool.Length()) return pBuffer;
+      }
+
+      /* - Return the last, partly filled buffer */
+      if ((pBuffer != NULL) && (pBuffer->nCount == 0)) {
+         pool.Release(pBuffer);
+         pBuffer = NULL;
+      }
+      return pBuffer;
+   }
+
+private:
+   std::vector<STSpikeListChunk>    vChunks;
+   std::vector<STPipelineOp>        vOps;
+   double                           fTemporalResolution;
+   uint32_t                         nAddr;
+   size_t                           nChunk, nNext;
+};
+
+
+/* --- STStreamCrop - Keep the spikes with ticks in [nMinTick, nMaxTick] */
+class STStreamCrop : public STStreamFilter {
+public:
+   STStreamCrop(std::unique_ptr<STSpikeStream> pSource, uint64_t nMinTick, uint64_t nMaxTick, STSpikeBufferPool &pool)
+      : STStreamFilter(std::move(pSource), pool), nMinTick(nMinTick), nMaxTick(nMaxTick) {}
+
+protected:
+   void Apply(STSpikeBuffer &buffer)
+   {
+      size_t nOut = 0;
+
+      for (size_t nSpike = 0; nSpike < buffer.nCount; nSpike++) {
+         if ((buffer.vnTicks[nSpike] >= nMinTick) && (buffer.vnTicks[nSpike] <= nMaxTick)) {
+            buffer.vnTicks[nOut] = buffer.vnTicks[nSpike];
+            buffer.vnAddrs[nOut] = buffer.vnAddrs[nSpike];
+            nOut++;
+         }
+      }
+      buffer.nCount = nOut;
+   }
+
+private:
+   uint64_t nMinTick, nMaxTick;
+};
+
+/* --- STStreamShift - Add 'nOffset' to every tick, which must not move a spike before tick zero */
+class STStreamShift : public STStreamFilter {
+public:
+   STStreamShift(std::unique_ptr<STSpikeStream> pSource, int64_t nOffset, STSpikeBufferPool &pool)
+      : STStreamFilter(std::move(pSource), pool), nOffset(nOffset) {}
+
+protected:
+   void Apply(STSpikeBuffer &buffer)
+   {
+      for (size_t nSpike = 0; nSpike < buffer.nCount; nSpike++) {
+         if ((nOffset < 0) && (buffer.vnTicks[nSpike] < (uint64_t) -nOffset)) {
+            throw std::invalid_argument("Shifting would move spikes before time zero");
+         }
+
+         /* - Unsigned wrap-around gives the right answer for negative offsets */
+         buffer.vnTicks[nSpike] += (uint64_t) nOffset;
+      }
+   }
+
+private:
+   int64_t nOffset;
+};
+
+/* --- STStreamRescale - Rescale every tick exactly by 'ratio' */
+class STStreamRescale : public STStreamFilter {
+public:
+   STStreamRescale(std::unique_ptr<STSpikeStream> pSource, const STTickRatio &ratio, STSpikeBufferPool &pool)
+      : STStreamFilter(std::move(pSource), pool), ratio(ratio) {}
+
+protected:
+   void Apply(STSpikeBuffer &buffer) { STRescaleTicks(buffer.vnTicks.data(), buffer.nCount, ratio); }
+
+private:
+   STTickRatio ratio;
+};
+
+
+/* --- STStreamMerge - Interleave several streams in tick order
+ *
+ * Spikes with equal ticks are taken in the order of the streams, as sortrows
+ * would order the concatenated trains.  Each source holds at most one buffer
+ * at a time.
+ */
+class STStreamMerge : public STSpikeStream {
+public:
+   STStreamMerge(std::vector< std::unique_ptr<STSpikeStream> > &vpSourceStreams, STSpikeBufferPool &pool)
+      : STSpikeStream(pool), bStarted(false)
+   {
+      for (size_t nSource = 0; nSource < vpSourceStreams.size(); nSource++) {
+         Source source = { std::move(vpSourceStreams[nSource]), NULL, 0 };
+         vSources.push_back(std::move(source));
+      }
+   }
+
+   ~STStreamMerge()
+   {
+      for (size_t nSource = 0; nSource < vSources.size(); nSource++) pool.Release(vSources[nSource].pBuffer);
+   }
+
+   STSpikeBuffer *Next(void)
+   {
+      if (!bStarted) {
+         bStarted = true;
+         heap.Reserve(vSources.size());
+         for (size_t nSource = 0; nSource < vSources.size(); nSource++) {
+            if (Refill(nSource)) heap.Push(vSources[nSource].pBuffer->vnTicks[0], nSource);
+         }
+      }
+
+      if (heap.Empty()) return NULL;
+
+      STSpikeBuffer *pOut = pool.Acquire();
+
+      while (!heap.Empty() && (pOut->nCount < pool.Length())) {
+         size_t   nTop = heap.TopSource();
+         Source   &source = vSources[nTop];
+         uint64_t nTick = source.pBuffer->vnTicks[source.nPos];
+
+         pOut->vnTicks[pOut->nCount] = nTick;
+         pOut->vnAddrs[pOut->nCount] = source.pBuffer->vnAddrs[source.nPos];
+         pOut->nCount++;
+
+         if ((++source.nPos < source.pBuffer->nCount) || Refill(nTop)) {
+            if (source.pBuffer->vnTicks[source.nPos] < nTick) {
+               throw std::invalid_argument("Spike trains must be sorted in time to be merged");
+            }
+            heap.Replace(source.pBuffer->vnTicks[source.nPos]);
+         } else {
+            heap.Pop();
+         }
+      }
+
+      return pOut;
+   }
+
+private:
+   struct Source {
+      std::unique_ptr<STSpikeStream>   pStream;
+      STSpikeBuffer                    *pBuffer;
+      size_t                           nPos;
+   };
+
+   std::vector<Source>     vSources;
+   STMergeHeap<uint64_t>   heap;
+   bool                    bStarted;
+
+   /* - Replace the buffer of a source with its next one, returning false at its end */
+   bool Refill(size_t nSource)
+   {
+      Source &source = vSources[nSource];
+
+      pool.Release(source.pBuffer);
+      source.pBuffer = NULL;
+      source.pBuffer = source.pStream->Next();
+      source.nPos = 0;
+      return source.pBuffer != NULL;
+   }
+};
+
+
+/* --- STPipelineDrain - Pass the spikes of a stream to a sink, in chunks
+ *
+ * 'fnSink(anTicks, anAddrs, nCount)' is called once for each chunk of at
+ * most 'nChunkLength' spikes, with every chunk but the last full.
+ */
+template <typename Sink>
+static inline void STPipelineDrain(STSpikeStream &stream, STSpikeBufferPool &pool, size_t nChunkLength, Sink fnSink)
+{
+   std::vector<uint64_t>   vnTicks;
+   std::vector<uint32_t>   vnAddrs;
+   size_t                  nOut = 0;
+   STSpikeBuffer           *pBuffer;
+
+   if (nChunkLength < 1) throw std::invalid_argument("The chunk length must be at least one spike");
+
+   while ((pBuffer = stream.Next()) != NULL) {
+      size_t nPos = 0;
+
+      /* - Allocate the chunk once the first spikes arrive */
+      if (vnTicks.empty()) {
+         vnTicks.resize(nChunkLength);
+         vnAddrs.resize(nChunkLength);
+      }
+
+      while (nPos < pBuffer->nCount) {
+         size_t nCopy = std::min(pBuffer->nCount - nPos, nChunkLength - nOut);
+
+         std::copy(pBuffer->vnTicks.begin() + nPos, pBuffer->vnTicks.begin() + nPos + nCopy, vnTicks.begin() + nOut);
+         std::copy(pBuffer->vnAddrs.begin() + nPos, pBuffer->vnAddrs.begin() + nPos + nCopy, vnAddrs.begin() + nOut);
+         nPos += nCopy;
+         nOut += nCopy;
+
+         if (nOut == nChunkLength) {
+            fnSink(vnTicks.data(), vnAddrs.data(), nOut);
+            nOut = 0;
+         }
+      }
+
+      pool.Release(pBuffer);
+   }
+
+   if (nOut > 0) fnSink(vnTicks.data(), vnAddrs.data(), nOut);
+}
+
+#endif  /* ST_PIPELINE_H */
+
+/* --- END of STPipeline.h --- */
@@ -51,12 +51,19 @@ end
 
 % -- Construct the plot
 
+% - Definitions without an ISI distribution use a gamma distribution
+if (isfield(stDef, 'strISIDistribution'))
+   strISIDistribution = stDef.strISIDistribution;
+else
+   strISIDistribution = 'gamma';
+end
+
 % - Calculate gamma function parameters
 fAlpha = stDef.fMeanISI^2 / stDef.fVarISI;
 fBeta = fAlpha / stDef.fMeanISI;
 
 % - Check to see if we'll get a reasonable plot
-if (fAlpha < 1)
+if (strcmp(strISIDistribution, 'gamma') && (fAlpha < 1))
    disp('*** STPlotDefGamma: The alpha parameter is too small for these distribution');
    disp('       parameters.  I can''t plot the distribution');
    return;
@@ -67,11 +74,18 @@ if (bNewFigure)
    hFigure = figure;
 end
 
-% - Get the gamma function extents 
-vfISI = gaminv(vfProbRange, fAlpha, 1/fBeta);
+if (strcmp(strISIDistribution, 'gamma'))
+   % - Get the gamma function extents 
+   vfISI = gaminv(vfProbRange, fAlpha, 1/fBeta);
 
-% - Plot the frequency profile
-vfProb = gampdf(vfISI, fAlpha, 1/fBeta);
+   % - Plot the frequency profile
+   vfProb = gampdf(vfISI, fAlpha, 1/fBeta);
+else
+   % - Plot the other distributions over the mean +/- four standard deviations
+   fStdISI = sqrt(stDef.fVarISI);
+   vfISI = linspace(max(0, stDef.fMeanISI - 4*fStdISI), stDef.fMeanISI + 4*fStdISI, numel(vfProbRange));
+   vfProb = STISIDensity(strISIDistribution, stDef.fMeanISI, stDef.fVarISI, vfISI);
+end
 vfProb = vfProb ./ sum(vfProb);
 plot(vfISI, vfProb);
 hold on;
@@ -85,7 +99,7 @@ hAxis = gca;
 % - Set labels and titles
 xlabel('ISI (sec)');
 ylabel('Ocurrence probability');
-strTitle = sprintf('Gamma ISI profile spike train definition\nISI drawing distribution');
+strTitle = sprintf('Gamma ISI profile spike train definition\nISI drawing distribution (%s)', strISIDistribution);
 title(strTitle);
 
 % - Get axis extents
@@ -113,4 +127,35 @@ if (~bKeepHandle)
    clear hFigure;
 end
 
+% --- END of STPlotDefGamma FUNCTION ---
+
+
+% --- FUNCTION STISIDensity
+function [vfDensity] = STISIDensity(strISIDistribution, fMeanISI, fVarISI, vfISI)
+% Probability density of an ISI distribution with a given mean and variance
+
+switch (strISIDistribution)
+   case 'exponential'
+      % - Exponential distribution, shifted by a dead time
+      fStdISI = sqrt(fVarISI);
+      vfDensity = exp(-(vfISI - (fMeanISI - fStdISI)) ./ fStdISI) ./ fStdISI;
+      vfDensity(vfISI < (fMeanISI - fStdISI)) = 0;
+      
+   case 'lognormal'
+      fSigma2 = log(1 + fVarISI / fMeanISI^2);
+      fMu = log(fMeanISI) - fSigma2/2;
+      vfDensity = zeros(size(vfISI));
+      vbPos = vfISI > 0;
+      vfDensity(vbPos) = exp(-(log(vfISI(vbPos)) - fMu).^2 ./ (2*fSigma2)) ./ (vfISI(vbPos) .* sqrt(2*pi*fSigma2));
+      
+   case 'invgauss'
+      fLambda = fMeanISI^3 / fVarISI;
+      vfDensity = zeros(size(vfISI));
+      vbPos = vfISI > 0;
+      vfDensity(vbPos) = sqrt(fLambda ./ (2*pi*vfISI(vbPos).^3)) .* ...
+                         exp(-fLambda .* (vfISI(vbPos) - fMeanISI).^2 ./ (2*fMeanISI^2 .* vfISI(vbPos)));
+end
+
+% --- END of STISIDensity FUNCTION ---
+
 % --- END of STPlotDefGamma.m ---
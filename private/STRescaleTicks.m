@@ -0,0 +1,97 @@
+function [vnTicks] = STRescaleTicks(vnTicks, fFromResolution, fToResolution)
+
+% STRescaleTicks - FUNCTION (Internal) Convert spike ticks exactly between temporal resolutions
+% $Id: STRescaleTicks.m $
+%
+% NOT for command-line use
+
+% Usage: [vnTicks] = STRescaleTicks(vnTicks, fFromResolution, fToResolution)
+%
+% 'vnTicks' is a vector of integer ticks of 'fFromResolution' seconds.
+% STRescaleTicks returns them as ticks of 'fToResolution' seconds, rounded
+% down, as the native toolbox functions do (see STTicks.h).  Each resolution
+% is read as an exact decimal fraction, and the ticks are multiplied by the
+% exact rational ratio num/den between the two resolutions as
+%
+%    floor(tick / den) * num + floor(mod(tick, den) * num / den)
+%
+% in integer arithmetic.  Multiplying by the floating-point ratio of the
+% resolutions instead can land a spike one tick away: 0.3/0.1 is slightly
+% less than 3, for example.  If the ratio is too large to be used exactly in
+% doubles, the ticks are rescaled in floating point.
+
+% Author: agent <agent@local>
+% Created: 17th October, 2026
+% Copyright (c) 2026 agent
+
+% - Largest integer held exactly in a double
+nExactLimit = 2^53;
+
+[nFromNum, nFromDen] = DecimalFraction(fFromResolution);
+[nToNum, nToDen] = DecimalFraction(fToResolution);
+
+% - (nFromNum / nFromDen) / (nToNum / nToDen), reduced crosswise first
+nGCD1 = gcd(nFromNum, nToNum);
+nGCD2 = gcd(nToDen, nFromDen);
+nNum = (nFromNum / nGCD1) * (nToDen / nGCD2);
+nDen = (nFromDen / nGCD2) * (nToNum / nGCD1);
+
+if (~isempty(nNum) && (nNum == nDen))
+   return;
+end
+
+if (isempty(nNum) || (nNum * nDen >= nExactLimit) || any(abs(vnTicks(:)) >= nExactLimit / nNum))
+   % - The ratio can't be used exactly
+   vnTicks = floor(vnTicks .* (fFromResolution / fToResolution));
+   return;
+end
+
+% - Rescale the whole multiples of 'nDen', then the remainders; every product
+%   is an integer below 2^53, and each quotient is corrected to its floor
+vnWhole = FloorDivide(vnTicks, nDen);
+vnTicks = vnWhole .* nNum + FloorDivide((vnTicks - vnWhole .* nDen) .* nNum, nDen);
+
+% --- END of STRescaleTicks FUNCTION ---
+
+
+% --- FUNCTION DecimalFraction
+
+function [nNum, nDen] = DecimalFraction(fResolution)
+
+% - Find the smallest power of ten 'nDen' for which fResolution * nDen is an
+%   integer, to within the precision of a double, as STTicks.h does
+for (nDen = 10.^(0:15))
+   fNum = fResolution * nDen;
+   nNum = floor(fNum + 0.5);
+
+   if ((nNum >= 1) && (abs(fNum - nNum) <= nNum * 1e-12))
+      nGCD = gcd(nNum, nDen);
+      nNum = nNum / nGCD;
+      nDen = nDen / nGCD;
+      return;
+   end
+end
+
+% - Not a decimal number of seconds
+nNum = [];
+nDen = [];
+
+% --- END of DecimalFraction FUNCTION ---
+
+
+% --- FUNCTION FloorDivide
+
+function [vnQuotient] = FloorDivide(vnDividend, nDivisor)
+
+vnQuotient = floor(vnDividend ./ nDivisor);
+
+% - The division can round up to the next integer
+vbHigh = (vnQuotient .* nDivisor) > vnDividend;
+vnQuotient(vbHigh) = vnQuotient(vbHigh) - 1;
+
+vbLow = ((vnQuotient + 1) .* nDivisor) <= vnDividend;
+vnQuotient(vbLow) = vnQuotient(vbLow) + 1;
+
+% --- END of FloorDivide FUNCTION ---
+
+% --- END of STRescaleTicks.m ---
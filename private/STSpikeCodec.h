@@ -0,0 +1,330 @@
+/* STSpikeCodec.h - Compressed encoding of spike store columns
+ * $Id: STSpikeCodec.h $
+ *
+ * NOT for command-line use
+ *
+ * STSpikeCodec packs the sorted tick column of a spike chunk into blocks of
+ * ST_CODEC_BLOCK ticks.  Each block keeps its first tick in a block index;
+ * the remaining ticks are stored as differences from the previous tick.
+ * The smallest difference in the block (its "frame of reference") is kept
+ * in the index and subtracted from every difference, and the results are
+ * packed with the fewest bits that hold the largest of them.  A regular or
+ * Poisson train at a few Hz, with microsecond ticks, packs into 2 to 3 bytes
+ * per spike, against 8 for a uint64 tick or a double.
+ *
+ * Packed values are laid out vertically: value 'j' of a block is held in
+ * lane (j % 4) of row (j / 4), and the 32 rows of each lane are packed one
+ * after the other into every fourth 32-bit word.  One SSE2 shift-and-mask
+ * then unpacks four values at once.  The unpacking loop is instantiated for
+ * each bit width, so every shift is a constant.
+ *
+ * Differences that don't fit in 32 bits (gaps of over an hour, at a
+ * microsecond resolution) are stored as two 32-bit planes, flagged with a
+ * bit width of ST_CODEC_ESCAPE.
+ *
+ * Because every block starts from a known tick, any block can be decoded
+ * without the blocks before it.  STCodecSeek finds the first tick at or
+ * after a given tick by binary search of the block index, then decodes the
+ * one block it falls in.
+ *
+ * The address column is run-length encoded, as a list of addresses and the
+ * index one past the end of each run.  Mapped trains have a single address,
+ * so a whole chunk is one run.  Multiplexed trains with no runs to speak of
+ * are better kept as plain addresses; see STCodecUseRuns.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_SPIKE_CODEC_H
+#define ST_SPIKE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+   #include <emmintrin.h>
+   #define ST_CODEC_HAVE_SSE2
+#endif
+
+
+/* - Number of ticks in each block */
+#define ST_CODEC_BLOCK        128
+
+/* - Bit width flagging a block of 64-bit differences */
+#define ST_CODEC_ESCAPE       64
+
+
+/* - One entry of the block index */
+struct STCodecBlock {
+   uint64_t    nFirstTick;       /* First tick of the block */
+   uint64_t    nMinDelta;        /* Frame of reference for the differences */
+   uint64_t    nOffset;          /* Offset of the block in the packed words */
+   uint32_t    nBits;            /* Bits per packed value, or ST_CODEC_ESCAPE */
+};
+
+
+/* --- STCodecBlockWords - Return the number of 32-bit words in a packed block */
+static inline size_t STCodecBlockWords(uint32_t nBits)
+{
+   return (nBits == ST_CODEC_ESCAPE) ? 2 * 4 * 32 : 4 * nBits;
+}
+
+
+/* --- STCodecPack - Pack a block of values with 'nBits' bits each (nBits <= 32) */
+static inline void STCodecPack(const uint32_t *anValues, uint32_t nBits, uint32_t *anWords)
+{
+   if (nBits == 0) return;
+   memset(anWords, 0, STCodecBlockWords(nBits) * sizeof(uint32_t));
+
+   for (uint32_t nRow = 0; nRow < ST_CODEC_BLOCK / 4; nRow++) {
+      uint32_t nPos = nRow * nBits, nWord = nPos >> 5, nShift = nPos & 31;
+
+      for (uint32_t nLane = 0; nLane < 4; nLane++) {
+         uint32_t nValue = anValues[4*nRow + nLane];
+         anWords[4*nWord + nLane] |= nValue << nShift;
+         if (nShift + nBits > 32) anWords[4*(nWord+1) + nLane] |= nValue >> (32 - nShift);
+      }
+   }
+}
+
+
+/* --- STCodecUnpackBits - Unpack a block of values with a fixed bit width */
+template <uint32_t nBits>
+static void STCodecUnpackBits(const uint32_t *anWords, uint32_t *anValues)
+{
+   const uint32_t nMask = (nBits == 32) ? 0xFFFFFFFFu : ((1u << (nBits & 31)) - 1);
+
+   /* - Zero bits: every value is zero, and there are no words to read */
+   if (nBits == 0) {
+      memset(anValues, 0, ST_CODEC_BLOCK * sizeof(uint32_t));
+      return;
+   }
+
+#if defined(ST_CODEC_HAVE_SSE2)
+   const __m128i vMask = _mm_set1_epi32((int) nMask);
+
+   for (uint32_t nRow = 0; nRow < ST_CODEC_BLOCK / 4; nRow++) {
+      const uint32_t nPos = nRow * nBits, nWord = nPos >> 5, nShift = nPos & 31;
+      __m128i vValue = _mm_srli_epi32(_mm_loadu_si128((const __m128i *) (anWords + 4*nWord)), nShift);
+      if (nShift + nBits > 32) {
+         vValue = _mm_or_si128(vValue, _mm_slli_epi32(_mm_loadu_si128((const __m128i *) (anWords + 4*(nWord+1))),
+                                                      32 - nShift));
+      }
+      _mm_storeu_si128((__m128i *) (anValues + 4*nRow), _mm_and_si128(vValue, vMask));
+   }
+#else
+   for (uint32_t nRow = 0; nRow < ST_CODEC_BLOCK / 4; nRow++) {
+      const uint32_t nPos = nRow * nBits, nWord = nPos >> 5, nShift = nPos & 31;
+      for (uint32_t nLane = 0; nLane < 4; nLane++) {
+         uint32_t nValue = anWords[4*nWord + nLane] >> nShift;
+         if (nShift + nBits > 32) nValue |= anWords[4*(nWord+1) + nLane] << ((32 - nShift) & 31);
+         anValues[4*nRow + nLane] = nValue & nMask;
+      }
+   }
+#endif
+}
+
+/* --- STCodecUnpack - Unpack a block of values with 'nBits' bits each (nBits <= 32) */
+static inline void STCodecUnpack(const uint32_t *anWords, uint32_t nBits, uint32_t *anValues)
+{
+   typedef void (*UnpackFn)(const uint32_t *, uint32_t *);
+   static const UnpackFn afnUnpack[33] = {
+      STCodecUnpackBits<0>,  STCodecUnpackBits<1>,  STCodecUnpackBits<2>,  STCodecUnpackBits<3>,
+      STCodecUnpackBits<4>,  STCodecUnpackBits<5>,  STCodecUnpackBits<6>,  STCodecUnpackBits<7>,
+      STCodecUnpackBits<8>,  STCodecUnpackBits<9>,  STCodecUnpackBits<10>, STCodecUnpackBits<11>,
+      STCodecUnpackBits<12>, STCodecUnpackBits<13>, STCodecUnpackBits<14>, STCodecUnpackBits<15>,
+      STCodecUnpackBits<16>, STCodecUnpackBits<17>, STCodecUnpackBits<18>, STCodecUnpackBits<19>,
+      STCodecUnpackBits<20>, STCodecUnpackBits<21>, STCodecUnpackBits<22>, STCodecUnpackBits<23>,
+      STCodecUnpackBits<24>, STCodecUnpackBits<25>, STCodecUnpackBits<26>, STCodecUnpackBits<27>,
+      STCodecUnpackBits<28>, STCodecUnpackBits<29>, STCodecUnpackBits<30>, STCodecUnpackBits<31>,
+      STCodecUnpackBits<32>
+   };
+
+   afnUnpack[nBits](anWords, anValues);
+}
+
+
+/* --- STCodecEncode - Append the packed blocks of a sorted tick column
+ *
+ * Blocks are appended to 'vBlocks', and their packed words to 'vnPacked'.
+ * Block offsets are relative to the start of 'vnPacked'.
+ */
+static inline void STCodecEncode(const uint64_t *anTicks, size_t nCount,
+                                 std::vector<STCodecBlock> &vBlocks, std::vector<uint32_t> &vnPacked)
+{
+   uint32_t anLow[ST_CODEC_BLOCK], anHigh[ST_CODEC_BLOCK];
+
+   for (size_t nFirst = 0; nFirst < nCount; nFirst += ST_CODEC_BLOCK) {
+      const size_t   nBlockCount = std::min((size_t) ST_CODEC_BLOCK, nCount - nFirst);
+      const uint64_t *anBlock = anTicks + nFirst;
+      STCodecBlock   block;
+      uint64_t       nMinDelta = UINT64_MAX, nMaxValue = 0;
+      size_t         nIndex;
+
+      /* - Find the frame of reference and the range of the differences */
+      for (nIndex = 1; nIndex < nBlockCount; nIndex++) {
+         nMinDelta = std::min(nMinDelta, anBlock[nIndex] - anBlock[nIndex-1]);
+      }
+      if (nBlockCount == 1) nMinDelta = 0;
+
+      for (nIndex = 1; nIndex < nBlockCount; nIndex++) {
+         nMaxValue = std::max(nMaxValue, anBlock[nIndex] - anBlock[nIndex-1] - nMinDelta);
+      }
+
+      block.nFirstTick = anBlock[0];
+      block.nMinDelta = nMinDelta;
+      block.nOffset = vnPacked.size();
+      if (nMaxValue > 0xFFFFFFFFu) {
+         block.nBits = ST_CODEC_ESCAPE;
+      } else {
+         for (block.nBits = 0; (block.nBits < 32) && (nMaxValue >> block.nBits); block.nBits++) ;
+      }
+
+      /* - The first value and any padding are zero */
+      memset(anLow, 0, sizeof(anLow));
+      memset(anHigh, 0, sizeof(anHigh));
+      for (nIndex = 1; nIndex < nBlockCount; nIndex++) {
+         uint64_t nValue = anBlock[nIndex] - anBlock[nIndex-1] - nMinDelta;
+         anLow[nIndex] = (uint32_t) nValue;
+         anHigh[nIndex] = (uint32_t) (nValue >> 32);
+      }
+
+      vnPacked.resize(block.nOffset + STCodecBlockWords(block.nBits));
+      if (block.nBits == ST_CODEC_ESCAPE) {
+         STCodecPack(anLow, 32, &vnPacked[block.nOffset]);
+         STCodecPack(anHigh, 32, &vnPacked[block.nOffset + 4*32]);
+      } else {
+         STCodecPack(anLow, block.nBits, vnPacked.data() + block.nOffset);
+      }
+
+      vBlocks.push_back(block);
+   }
+}
+
+
+/* --- STCodecDecodeBlock - Decode the first 'nCount' ticks of a block */
+static inline void STCodecDecodeBlock(const STCodecBlock &block, const uint32_t *anPacked, size_t nCount,
+                                      uint64_t *anTicks)
+{
+   uint32_t anLow[ST_CODEC_BLOCK], anHigh[ST_CODEC_BLOCK];
+   uint64_t nTick = block.nFirstTick;
+   size_t   nIndex;
+
+   anTicks[0] = nTick;
+
+   if (block.nBits == ST_CODEC_ESCAPE) {
+      STCodecUnpack(anPacked + block.nOffset, 32, anLow);
+      STCodecUnpack(anPacked + block.nOffset + 4*32, 32, anHigh);
+      for (nIndex = 1; nIndex < nCount; nIndex++) {
+         nTick += block.nMinDelta + (((uint64_t) anHigh[nIndex] << 32) | anLow[nIndex]);
+         anTicks[nIndex] = nTick;
+      }
+
+   } else {
+      STCodecUnpack(anPacked + block.nOffset, block.nBits, anLow);
+      for (nIndex = 1; nIndex < nCount; nIndex++) {
+         nTick += block.nMinDelta + anLow[nIndex];
+         anTicks[nIndex] = nTick;
+      }
+   }
+}
+
+/* --- STCodecDecode - Decode ticks [nFirst, nFirst + nCount) of a column of 'nTotal' ticks */
+static inline void STCodecDecode(const STCodecBlock *aBlocks, const uint32_t *anPacked, size_t nTotal,
+                                 size_t nFirst, size_t nCount, uint64_t *anTicks)
+{
+   uint64_t anBlock[ST_CODEC_BLOCK];
+   size_t   nEnd = nFirst + nCount;
+
+   while (nFirst < nEnd) {
+      size_t   nBlock = nFirst / ST_CODEC_BLOCK,
+               nBlockStart = nBlock * ST_CODEC_BLOCK,
+               nBlockCount = std::min((size_t) ST_CODEC_BLOCK, nTotal - nBlockStart),
+               nTake = std::min(nBlockStart + nBlockCount, nEnd) - nFirst;
+
+      if ((nFirst == nBlockStart) && (nTake == nBlockCount)) {
+         /* - Decode whole blocks in place */
+         STCodecDecodeBlock(aBlocks[nBlock], anPacked, nBlockCount, anTicks);
+      } else {
+         STCodecDecodeBlock(aBlocks[nBlock], anPacked, nFirst - nBlockStart + nTake, anBlock);
+         memcpy(anTicks, anBlock + (nFirst - nBlockStart), nTake * sizeof(uint64_t));
+      }
+
+      anTicks += nTake;
+      nFirst += nTake;
+   }
+}
+
+/* --- STCodecSeek - Return the index of the first tick >= 'nTick', in a column of 'nTotal' ticks */
+static inline size_t STCodecSeek(const STCodecBlock *aBlocks, const uint32_t *anPacked, size_t nTotal, uint64_t nTick)
+{
+   size_t   nNumBlocks = (nTotal + ST_CODEC_BLOCK - 1) / ST_CODEC_BLOCK,
+            nBlock, nBlockCount;
+   uint64_t anBlock[ST_CODEC_BLOCK];
+
+   /* - Find the last block starting before 'nTick' */
+   nBlock = std::upper_bound(aBlocks, aBlocks + nNumBlocks, nTick,
+                             [](uint64_t nValue, const STCodecBlock &block) {
+                                return nValue <= block.nFirstTick;
+                             }) - aBlocks;
+   if (nBlock == 0) return 0;
+   nBlock--;
+
+   nBlockCount = std::min((size_t) ST_CODEC_BLOCK, nTotal - nBlock * ST_CODEC_BLOCK);
+   STCodecDecodeBlock(aBlocks[nBlock], anPacked, nBlockCount, anBlock);
+   return nBlock * ST_CODEC_BLOCK + (std::lower_bound(anBlock, anBlock + nBlockCount, nTick) - anBlock);
+}
+
+
+/* --- STCodecUseRuns - Return true if run-length encoding will shrink an address column */
+static inline bool STCodecUseRuns(const uint32_t *anAddrs, size_t nCount, size_t *pnNumRuns)
+{
+   size_t nNumRuns = (nCount > 0) ? 1 : 0;
+
+   for (size_t nIndex = 1; nIndex < nCount; nIndex++) {
+      if (anAddrs[nIndex] != anAddrs[nIndex-1]) nNumRuns++;
+   }
+
+   /* - A run costs an address and a 64-bit end index, three plain addresses */
+   *pnNumRuns = nNumRuns;
+   return 3 * nNumRuns < nCount;
+}
+
+/* --- STCodecEncodeRuns - Run-length encode an address column */
+static inline void STCodecEncodeRuns(const uint32_t *anAddrs, size_t nCount, uint32_t *anRunAddrs, uint64_t *anRunEnds)
+{
+   size_t nRun = 0;
+
+   for (size_t nIndex = 1; nIndex <= nCount; nIndex++) {
+      if ((nIndex == nCount) || (anAddrs[nIndex] != anAddrs[nIndex-1])) {
+         anRunAddrs[nRun] = anAddrs[nIndex-1];
+         anRunEnds[nRun] = nIndex;
+         nRun++;
+      }
+   }
+}
+
+/* --- STCodecDecodeRuns - Decode addresses [nFirst, nFirst + nCount) of a run-length encoded column */
+static inline void STCodecDecodeRuns(const uint32_t *anRunAddrs, const uint64_t *anRunEnds, size_t nNumRuns,
+                                     size_t nFirst, size_t nCount, uint32_t *anAddrs)
+{
+   size_t nEnd = nFirst + nCount,
+          nRun = std::upper_bound(anRunEnds, anRunEnds + nNumRuns, (uint64_t) nFirst) - anRunEnds;
+
+   for (; nFirst < nEnd; nRun++) {
+      size_t nTake = std::min((size_t) anRunEnds[nRun], nEnd) - nFirst;
+      std::fill(anAddrs, anAddrs + nTake, anRunAddrs[nRun]);
+      anAddrs += nTake;
+      nFirst += nTake;
+   }
+}
+
+#endif  /* ST_SPIKE_CODEC_H */
+
+/* --- END of STSpikeCodec.h --- */
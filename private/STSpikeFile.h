@@ -0,0 +1,466 @@
+/* STSpikeFile.h - Binary spike train files, mapped into memory as spike stores
+ * $Id: STSpikeFile.h $
+ *
+ * NOT for command-line use
+ *
+ * A spike train file holds a mapped spike list in the same columns as an
+ * STSpikeStore (see STSpikeStore.h), so that a file can be mapped into memory
+ * and used as a store without reading it.  Only the header and the chunk
+ * index are read when a file is opened; the operating system pages in the
+ * columns of a chunk when they are first touched.  Operations which select
+ * chunks by their metadata, such as STStoreCrop, never touch the others.
+ *
+ * All values are stored in the byte order of the machine that wrote the
+ * file, which is checked when the file is opened.  The file is laid out as
+ *
+ *    STSpikeFileHeader          - Fixed header, at offset 0
+ *    Addressing specification   - Text, as written by STTrainSave
+ *    Column data                - The columns of each chunk in turn
+ *    STSpikeFileChunk[]         - The chunk index, at 'nIndexOffset'
+ *
+ * Each column starts on an ST_FILE_ALIGN byte boundary.  Offsets are in bytes
+ * from the start of the file; an offset of zero marks a column which is not
+ * present.  A chunk has either a plain tick column or compressed ticks, and
+ * either a plain address column or run-length encoded addresses, as
+ * STSpikeChunk.
+ *
+ * STSpikeFileOpen checks that the header and every column of the chunk
+ * index lie within the file.  The contents of the columns are trusted, and
+ * must have been written by STSpikeFileWrite, or by STSpikeFileStream one
+ * chunk at a time.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_SPIKE_FILE_H
+#define ST_SPIKE_FILE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+   #include <windows.h>
+#else
+   #include <fcntl.h>
+   #include <stdlib.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+#endif
+
+#include "STSpikeStore.h"
+
+
+/* - File identification */
+#define ST_FILE_MAGIC         "STSPIKES"
+#define ST_FILE_VERSION       1
+#define ST_FILE_BYTE_ORDER    0x01020304u
+
+/* - Header flags */
+#define ST_FILE_COMPRESSED    0x1u
+
+/* - Alignment of each column, in bytes */
+#define ST_FILE_ALIGN         64
+
+
+/* - File header */
+struct STSpikeFileHeader {
+   char        acMagic[8];             /* ST_FILE_MAGIC, without a terminator */
+   uint32_t    nVersion;               /* ST_FILE_VERSION */
+   uint32_t    nByteOrder;             /* ST_FILE_BYTE_ORDER, as written */
+   uint32_t    nFlags;
+   uint32_t    nReserved;
+   double      tDuration;              /* Duration of the mapping, in seconds */
+   double      fTemporalResolution;    /* Duration of a tick, in seconds */
+   uint64_t    nNumChunks;
+   uint64_t    nSpecOffset;            /* Addressing specification text */
+   uint64_t    nSpecBytes;
+   uint64_t    nIndexOffset;           /* Chunk index */
+};
+
+/* - One entry of the chunk index */
+struct STSpikeFileChunk {
+   uint64_t    nCount, nFirstTick, nLastTick;
+   uint64_t    nTicksOffset;           /* Plain ticks */
+   uint64_t    nAddrsOffset;           /* Plain addresses */
+   uint64_t    nBlocksOffset;          /* Compressed ticks */
+   uint64_t    nPackedOffset, nPackedWords;
+   uint64_t    nRunAddrsOffset;        /* Run-length encoded addresses */
+   uint64_t    nRunEndsOffset, nNumRuns;
+};
+
+
+/* --- STSpikeFileMap - A read-only mapping of a whole file */
+class STSpikeFileMap {
+public:
+   const char  *pData;
+   uint64_t    nSize;
+
+   explicit STSpikeFileMap(const char *strFileName) : pData(NULL), nSize(0)
+   {
+#if defined(_WIN32)
+      hFile = CreateFileA(strFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+      if (hFile == INVALID_HANDLE_VALUE) throw std::runtime_error("Couldn't open the file");
+
+      LARGE_INTEGER liSize;
+      GetFileSizeEx(hFile, &liSize);
+      nSize = (uint64_t) liSize.QuadPart;
+
+      hMapping = NULL;
+      if (nSize > 0) {
+         hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+         if (hMapping != NULL) pData = (const char *) MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+         if (pData == NULL) {
+            Close();
+            throw std::runtime_error("Couldn't map the file into memory");
+         }
+      }
+#else
+      struct stat  stFile;
+
+      nFile = open(strFileName, O_RDONLY);
+      if (nFile < 0) throw std::runtime_error("Couldn't open the file");
+
+      if (fstat(nFile, &stFile) != 0) {
+         Close();
+         throw std::runtime_error("Couldn't read the size of the file");
+      }
+      nSize = (uint64_t) stFile.st_size;
+
+      if (nSize > 0) {
+         void *pMap = mmap(NULL, (size_t) nSize, PROT_READ, MAP_SHARED, nFile, 0);
+         if (pMap == MAP_FAILED) {
+            Close();
+            throw std::runtime_error("Couldn't map the file into memory");
+         }
+         pData = (const char *) pMap;
+      }
+#endif
+   }
+
+   ~STSpikeFileMap() { Close(); }
+
+private:
+#if defined(_WIN32)
+   HANDLE   hFile, hMapping;
+
+   void Close(void)
+   {
+      if (pData != NULL) UnmapViewOfFile(pData);
+      if (hMapping != NULL) CloseHandle(hMapping);
+      if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+      pData = NULL;
+      hMapping = NULL;
+      hFile = INVALID_HANDLE_VALUE;
+   }
+#else
+   int      nFile;
+
+   void Close(void)
+   {
+      if (pData != NULL) munmap((void *) pData, (size_t) nSize);
+      if (nFile >= 0) close(nFile);
+      pData = NULL;
+      nFile = -1;
+   }
+#endif
+
+   /* - Mappings can't be copied */
+   STSpikeFileMap(const STSpikeFileMap &);
+   STSpikeFileMap &operator=(const STSpikeFileMap &);
+};
+
+
+/* --- STSpikeFileWriter - Aligned, checked writes to a new file
+ *
+ * The file is written under a temporary name in the same directory, and
+ * renamed over 'strFileName' by Finish.  An existing file of that name is
+ * never truncated, so a store mapped from it (see STSpikeFileMap) stays
+ * valid, even while it is being saved over its own file.  Windows refuses
+ * to replace a file which is mapped, in which case Finish throws instead.
+ * The temporary file is removed if the writer is destroyed before Finish.
+ */
+class STSpikeFileWriter {
+public:
+   explicit STSpikeFileWriter(const char *strFileName) : pFile(NULL), nOffset(0), strTarget(strFileName)
+   {
+#if defined(_WIN32)
+      strTemp = strTarget + ".tmp";
+      pFile = fopen(strTemp.c_str(), "wb");
+#else
+      std::vector<char> vcTemplate(strTarget.begin(), strTarget.end());
+      const char        *strSuffix = ".XXXXXX";
+
+      vcTemplate.insert(vcTemplate.end(), strSuffix, strSuffix + strlen(strSuffix) + 1);
+      int nFile = mkstemp(vcTemplate.data());
+      if (nFile < 0) throw std::runtime_error("Couldn't open the file for writing");
+      strTemp = vcTemplate.data();
+
+      /* - Give the file the permissions fopen would, rather than mkstemp's */
+      mode_t nMask = umask(0);
+      umask(nMask);
+      fchmod(nFile, 0666 & ~nMask);
+
+      pFile = fdopen(nFile, "wb");
+      if (pFile == NULL) {
+         close(nFile);
+         remove(strTemp.c_str());
+      }
+#endif
+      if (pFile == NULL) throw std::runtime_error("Couldn't open the file for writing");
+   }
+
+   ~STSpikeFileWriter()
+   {
+      if (pFile != NULL) {
+         fclose(pFile);
+         remove(strTemp.c_str());
+      }
+   }
+
+   /* - Write 'nBytes' at the next aligned offset, and return that offset */
+   uint64_t Write(const void *pData, size_t nBytes)
+   {
+      static const char acPadding[ST_FILE_ALIGN] = { 0 };
+      size_t nPadding = (size_t) ((ST_FILE_ALIGN - nOffset % ST_FILE_ALIGN) % ST_FILE_ALIGN);
+
+      if (fwrite(acPadding, 1, nPadding, pFile) != nPadding) throw std::runtime_error("Couldn't write to the file");
+      nOffset += nPadding;
+
+      uint64_t nStart = nOffset;
+      if ((nBytes > 0) && (fwrite(pData, 1, nBytes, pFile) != nBytes)) {
+         throw std::runtime_error("Couldn't write to the file");
+      }
+      nOffset += nBytes;
+      return nStart;
+   }
+
+   /* - Rewrite the header at the start of the file, close it and move it into place */
+   void Finish(const STSpikeFileHeader &header)
+   {
+      if ((fseek(pFile, 0, SEEK_SET) != 0) || (fwrite(&header, sizeof(header), 1, pFile) != 1)) {
+         throw std::runtime_error("Couldn't write to the file");
+      }
+
+      FILE *pClosing = pFile;
+      pFile = NULL;
+      if (fclose(pClosing) != 0) {
+         remove(strTemp.c_str());
+         throw std::runtime_error("Couldn't write to the file");
+      }
+
+#if defined(_WIN32)
+      if (!MoveFileExA(strTemp.c_str(), strTarget.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+         remove(strTemp.c_str());
+         throw std::runtime_error("Couldn't replace the file; it may be open as a spike train");
+      }
+#else
+      if (rename(strTemp.c_str(), strTarget.c_str()) != 0) {
+         remove(strTemp.c_str());
+         throw std::runtime_error("Couldn't replace the file");
+      }
+#endif
+   }
+
+private:
+   FILE           *pFile;
+   uint64_t       nOffset;
+   std::string    strTarget, strTemp;
+
+   /* - Writers can't be copied */
+   STSpikeFileWriter(const STSpikeFileWriter &);
+   STSpikeFileWriter &operator=(const STSpikeFileWriter &);
+};
+
+
+/* --- STSpikeFileStream - Write a spike train file one chunk at a time
+ *
+ * The header and specification are written when the stream is created, each
+ * chunk as it is passed to WriteChunk, and the chunk index by Finish.  The
+ * file is incomplete until Finish returns.
+ */
+class STSpikeFileStream {
+public:
+   STSpikeFileStream(const char *strFileName, double tDuration, double fTemporalResolution,
+                     const std::string &strSpec, bool bCompressed)
+      : writer(strFileName)
+   {
+      memset(&header, 0, sizeof(header));
+      memcpy(header.acMagic, ST_FILE_MAGIC, sizeof(header.acMagic));
+      header.nVersion = ST_FILE_VERSION;
+      header.nByteOrder = ST_FILE_BYTE_ORDER;
+      header.nFlags = bCompressed ? ST_FILE_COMPRESSED : 0;
+      header.tDuration = tDuration;
+      header.fTemporalResolution = fTemporalResolution;
+
+      /* - Reserve space for the header, then write the specification */
+      writer.Write(&header, sizeof(header));
+      header.nSpecOffset = writer.Write(strSpec.data(), strSpec.size());
+      header.nSpecBytes = strSpec.size();
+   }
+
+   /* - Write the columns of a chunk, plain or compressed as the file is */
+   void WriteChunk(const STSpikeChunk &chunk)
+   {
+      STSpikeFileChunk entry;
+
+      if ((chunk.anTicks == NULL) != ((header.nFlags & ST_FILE_COMPRESSED) != 0)) {
+         throw std::invalid_argument("Chunks must all be plain or all be compressed");
+      }
+
+      memset(&entry, 0, sizeof(entry));
+      entry.nCount = chunk.nCount;
+      entry.nFirstTick = chunk.nFirstTick;
+      entry.nLastTick = chunk.nLastTick;
+
+      if (chunk.anTicks != NULL) {
+         entry.nTicksOffset = writer.Write(chunk.anTicks, chunk.nCount * sizeof(uint64_t));
+      } else {
+         size_t               nNumBlocks = (chunk.nCount + ST_CODEC_BLOCK - 1) / ST_CODEC_BLOCK;
+         const STCodecBlock   &last = chunk.aBlocks[nNumBlocks-1];
+
+         entry.nPackedWords = last.nOffset + STCodecBlockWords(last.nBits);
+         entry.nBlocksOffset = writer.Write(chunk.aBlocks, nNumBlocks * sizeof(STCodecBlock));
+         entry.nPackedOffset = writer.Write(chunk.anPacked, (size_t) entry.nPackedWords * sizeof(uint32_t));
+      }
+
+      if (chunk.anAddrs != NULL) {
+         entry.nAddrsOffset = writer.Write(chunk.anAddrs, chunk.nCount * sizeof(uint32_t));
+      } else {
+         entry.nNumRuns = chunk.nNumRuns;
+         entry.nRunAddrsOffset = writer.Write(chunk.anRunAddrs, chunk.nNumRuns * sizeof(uint32_t));
+         entry.nRunEndsOffset = writer.Write(chunk.anRunEnds, chunk.nNumRuns * sizeof(uint64_t));
+      }
+
+      vIndex.push_back(entry);
+   }
+
+   /* - Write the index, then fill in the header and close the file */
+   void Finish(void)
+   {
+      header.nNumChunks = vIndex.size();
+      header.nIndexOffset = writer.Write(vIndex.data(), vIndex.size() * sizeof(STSpikeFileChunk));
+      writer.Finish(header);
+   }
+
+private:
+   STSpikeFileWriter                writer;
+   STSpikeFileHeader                header;
+   std::vector<STSpikeFileChunk>    vIndex;
+};
+
+/* --- STSpikeFileWrite - Write a store to a spike train file */
+static inline void STSpikeFileWrite(const STSpikeStore &store, const char *strFileName, double tDuration,
+                                    double fTemporalResolution, const std::string &strSpec)
+{
+   STSpikeFileStream stream(strFileName, tDuration, fTemporalResolution, strSpec, store.bCompressed);
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) stream.WriteChunk(store.vChunks[nChunk]);
+   stream.Finish();
+}
+
+
+/* --- STSpikeFileColumn - Return a pointer to a column in a mapped file, checking its extent */
+static inline const char *STSpikeFileColumn(const STSpikeFileMap &map, uint64_t nOffset, uint64_t nBytes)
+{
+   if ((nOffset == 0) || (nOffset % 8) || (nOffset > map.nSize) || (nBytes > map.nSize - nOffset)) {
+      throw std::runtime_error("The file is truncated or corrupt");
+   }
+   return map.pData + nOffset;
+}
+
+/* --- STSpikeFileOpen - Map a spike train file into memory as a store */
+static inline STSpikeStore *STSpikeFileOpen(const char *strFileName, double *ptDuration, double *pfTemporalResolution,
+                                            std::string *pstrSpec)
+{
+   std::shared_ptr<STSpikeFileMap>  pMap(new STSpikeFileMap(strFileName));
+   STSpikeFileHeader                header;
+
+   /* - Check the header */
+   if (pMap->nSize < sizeof(header)) throw std::runtime_error("The file is not a spike train file");
+   memcpy(&header, pMap->pData, sizeof(header));
+
+   if (memcmp(header.acMagic, ST_FILE_MAGIC, sizeof(header.acMagic)) != 0) {
+      throw std::runtime_error("The file is not a spike train file");
+   }
+   if (header.nByteOrder != ST_FILE_BYTE_ORDER) {
+      throw std::runtime_error("The file was written on a machine with a different byte order");
+   }
+   if (header.nVersion != ST_FILE_VERSION) {
+      throw std::runtime_error("The file was written by a different version of the toolbox");
+   }
+   if (header.nNumChunks > pMap->nSize / sizeof(STSpikeFileChunk)) {
+      throw std::runtime_error("The file is truncated or corrupt");
+   }
+
+   *ptDuration = header.tDuration;
+   *pfTemporalResolution = header.fTemporalResolution;
+   pstrSpec->clear();
+   if (header.nSpecBytes > 0) {
+      pstrSpec->assign(STSpikeFileColumn(*pMap, header.nSpecOffset, header.nSpecBytes), (size_t) header.nSpecBytes);
+   }
+
+   /* - Point the chunks of a new store at the columns in the file */
+   std::unique_ptr<STSpikeStore> pStore(new STSpikeStore((header.nFlags & ST_FILE_COMPRESSED) != 0));
+   const STSpikeFileChunk *aIndex = (const STSpikeFileChunk *)
+      STSpikeFileColumn(*pMap, header.nIndexOffset, header.nNumChunks * sizeof(STSpikeFileChunk));
+
+   for (uint64_t nChunk = 0; nChunk < header.nNumChunks; nChunk++) {
+      const STSpikeFileChunk  &entry = aIndex[nChunk];
+      STSpikeChunk            chunk;
+
+      /* - Every block of a chunk needs at least an index entry, so bound the
+       *   count by that; compressed chunks can hold more spikes than bytes */
+      if ((entry.nCount == 0) || (entry.nCount / ST_CODEC_BLOCK > pMap->nSize / sizeof(STCodecBlock)) ||
+          (entry.nFirstTick > entry.nLastTick)) {
+         throw std::runtime_error("The file is truncated or corrupt");
+      }
+
+      memset(&chunk, 0, sizeof(chunk));
+      chunk.nCount = (size_t) entry.nCount;
+      chunk.nFirstTick = entry.nFirstTick;
+      chunk.nLastTick = entry.nLastTick;
+
+      if (entry.nTicksOffset != 0) {
+         chunk.anTicks = (uint64_t *) STSpikeFileColumn(*pMap, entry.nTicksOffset, entry.nCount * sizeof(uint64_t));
+         chunk.nBytes += entry.nCount * sizeof(uint64_t);
+      } else {
+         uint64_t nNumBlocks = (entry.nCount + ST_CODEC_BLOCK - 1) / ST_CODEC_BLOCK;
+         chunk.aBlocks = (STCodecBlock *) STSpikeFileColumn(*pMap, entry.nBlocksOffset, nNumBlocks * sizeof(STCodecBlock));
+         chunk.anPacked = (uint32_t *) STSpikeFileColumn(*pMap, entry.nPackedOffset, entry.nPackedWords * sizeof(uint32_t));
+         chunk.nBytes += nNumBlocks * sizeof(STCodecBlock) + entry.nPackedWords * sizeof(uint32_t);
+      }
+
+      if (entry.nAddrsOffset != 0) {
+         chunk.anAddrs = (uint32_t *) STSpikeFileColumn(*pMap, entry.nAddrsOffset, entry.nCount * sizeof(uint32_t));
+         chunk.nBytes += entry.nCount * sizeof(uint32_t);
+      } else {
+         if ((entry.nNumRuns == 0) || (entry.nNumRuns > entry.nCount)) {
+            throw std::runtime_error("The file is truncated or corrupt");
+         }
+         chunk.nNumRuns = (size_t) entry.nNumRuns;
+         chunk.anRunAddrs = (uint32_t *) STSpikeFileColumn(*pMap, entry.nRunAddrsOffset, entry.nNumRuns * sizeof(uint32_t));
+         chunk.anRunEnds = (uint64_t *) STSpikeFileColumn(*pMap, entry.nRunEndsOffset, entry.nNumRuns * sizeof(uint64_t));
+         chunk.nBytes += entry.nNumRuns * (sizeof(uint32_t) + sizeof(uint64_t));
+      }
+
+      pStore->AdoptChunk(chunk);
+   }
+
+   pStore->pBacking = pMap;
+   return pStore.release();
+}
+
+#endif  /* ST_SPIKE_FILE_H */
+
+/* --- END of STSpikeFile.h --- */
@@ -0,0 +1,150 @@
+/* STSpikeFile_test - Check that spike train files can be saved over while mapped
+ * $Id: STSpikeFile_test.cpp $
+ *
+ * Usage: STSpikeFile_test
+ *
+ * This is a stand-alone program (not a MEX file), built and run with "make
+ * test" in the toolbox private directory.  It writes plain and compressed
+ * stores to a spike train file, maps the file back as a store with
+ * STSpikeFileOpen, and then saves over the file while that store is still
+ * mapped: first with the mapped store itself, as STTrainSave(STTrainOpen(f),
+ * f) does, then with a smaller store.  The mapped store must still read back
+ * its own spikes, and the file the spikes last written.  Truncating a mapped
+ * file makes the next read of the mapping fault, so a regression ends this
+ * program with a bus error rather than a message.  It prints "passed" and
+ * returns zero if every check succeeds.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 17th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "STSpikeFile.h"
+
+
+/* - File written by the test, in the current directory */
+#define TEST_FILE    "STSpikeFile_test.stf"
+
+
+/* --- MakeStore - Build a store with 'nNumChunks' chunks of 'nChunkLength' spikes */
+static STSpikeStore *MakeStore(bool bCompress, size_t nNumChunks, size_t nChunkLength, uint32_t nSeed)
+{
+   std::unique_ptr<STSpikeStore> pStore(new STSpikeStore(bCompress));
+   std::vector<uint64_t>         vnTicks(nChunkLength);
+   std::vector<uint32_t>         vnAddrs(nChunkLength);
+   uint64_t                      nTick = nSeed;
+
+   srand(nSeed);
+   for (size_t nChunk = 0; nChunk < nNumChunks; nChunk++) {
+      for (size_t nSpike = 0; nSpike < nChunkLength; nSpike++) {
+         nTick += 1 + rand() % 50;
+         vnTicks[nSpike] = nTick;
+         vnAddrs[nSpike] = (uint32_t) (rand() % 64);
+      }
+      pStore->AppendChunk(vnTicks.data(), vnAddrs.data(), nChunkLength);
+   }
+
+   return pStore.release();
+}
+
+/* --- SameSpikes - Test whether two stores hold the same spikes, chunk by chunk */
+static bool SameSpikes(const STSpikeStore &store1, const STSpikeStore &store2)
+{
+   if (store1.vChunks.size() != store2.vChunks.size()) return false;
+
+   for (size_t nChunk = 0; nChunk < store1.vChunks.size(); nChunk++) {
+      const STSpikeChunk   &chunk1 = store1.vChunks[nChunk], &chunk2 = store2.vChunks[nChunk];
+      size_t               nCount = chunk1.nCount;
+
+      if (chunk2.nCount != nCount) return false;
+
+      std::vector<uint64_t> vnTicks1(nCount), vnTicks2(nCount);
+      std::vector<uint32_t> vnAddrs1(nCount), vnAddrs2(nCount);
+      STSpikeStore::Decode(chunk1, 0, nCount, vnTicks1.data(), vnAddrs1.data());
+      STSpikeStore::Decode(chunk2, 0, nCount, vnTicks2.data(), vnAddrs2.data());
+
+      if ((vnTicks1 != vnTicks2) || (vnAddrs1 != vnAddrs2)) return false;
+   }
+
+   return true;
+}
+
+/* --- CheckOverwrite - Save over a mapped file, with itself and then with another store */
+static int CheckOverwrite(bool bCompress)
+{
+   const char                    *strKind = bCompress ? "compressed" : "plain";
+   std::unique_ptr<STSpikeStore> pOriginal(MakeStore(bCompress, 8, 20000, 1)),
+                                 pSmaller(MakeStore(bCompress, 1, 100, 2)),
+                                 pMapped, pReopened;
+   double                        tDuration, fTemporalResolution;
+   std::string                   strSpec;
+   int                           nFailures = 0;
+
+   STSpikeFileWrite(*pOriginal, TEST_FILE, 10, 1e-6, "spec");
+   pMapped.reset(STSpikeFileOpen(TEST_FILE, &tDuration, &fTemporalResolution, &strSpec));
+
+   /* - Save the mapped store over its own file */
+   STSpikeFileWrite(*pMapped, TEST_FILE, tDuration, fTemporalResolution, strSpec);
+
+   if (!SameSpikes(*pMapped, *pOriginal)) {
+      printf("*** STSpikeFile_test: A %s store changed when saved over its own file\n", strKind);
+      nFailures++;
+   }
+
+   pReopened.reset(STSpikeFileOpen(TEST_FILE, &tDuration, &fTemporalResolution, &strSpec));
+   if (!SameSpikes(*pReopened, *pOriginal) || (tDuration != 10) || (strSpec != "spec")) {
+      printf("*** STSpikeFile_test: A %s store saved over its own file reads back wrongly\n", strKind);
+      nFailures++;
+   }
+
+   /* - Replace the file with fewer spikes while both stores are mapped */
+   STSpikeFileWrite(*pSmaller, TEST_FILE, 1, 1e-6, "");
+
+   if (!SameSpikes(*pMapped, *pOriginal) || !SameSpikes(*pReopened, *pOriginal)) {
+      printf("*** STSpikeFile_test: A mapped %s store changed when its file was replaced\n", strKind);
+      nFailures++;
+   }
+
+   pReopened.reset(STSpikeFileOpen(TEST_FILE, &tDuration, &fTemporalResolution, &strSpec));
+   if (!SameSpikes(*pReopened, *pSmaller)) {
+      printf("*** STSpikeFile_test: A replaced %s file reads back wrongly\n", strKind);
+      nFailures++;
+   }
+
+   return nFailures;
+}
+
+
+int main(void)
+{
+   int nFailures = 0;
+
+   try {
+      nFailures += CheckOverwrite(false);
+      nFailures += CheckOverwrite(true);
+   } catch (std::exception &e) {
+      printf("*** STSpikeFile_test: %s\n", e.what());
+      nFailures++;
+   }
+
+   remove(TEST_FILE);
+
+   if (nFailures > 0) {
+      printf("*** STSpikeFile_test: %d failures\n", nFailures);
+      return 1;
+   }
+
+   printf("STSpikeFile_test: passed\n");
+   return 0;
+}
+
+/* --- END of STSpikeFile_test.cpp --- */
@@ -0,0 +1,823 @@
+/* STSpikeStore - FUNCTION (Internal) Native columnar storage for mapped spike lists
+ * $Id: STSpikeStore.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [hStore] = STSpikeStore('create', spikeList <, bCompress>)
+ *        [hStore] = STSpikeStore('map', spikeList, fTemporalResolution, addrSynapse <, bCompress>)
+ *        [cSpikeList] = STSpikeStore('spikelist', hStore)
+ *        [cSpikeTimes] = STSpikeStore('times', hStore, fTemporalResolution)
+ *        [mChunkInfo] = STSpikeStore('info', hStore)
+ *        [nBytes] = STSpikeStore('bytes', hStore)
+ *        [hCropped] = STSpikeStore('crop', hStore, nMinTick, nMaxTick)
+ *        [hShifted] = STSpikeStore('shift', hStore, nTickOffset)
+ *        [hMux] = STSpikeStore('multiplex', vhStores, vfTemporalResolution, fTemporalResolution, nChunkLength <, bCompress>)
+ *        [mDeltaAddr, vnChunkCounts] = STSpikeStore('export', hStore)
+ *        [hExtracted] = STSpikeStore('extract', hStore, nMinAddr, nMaxAddr)
+ *        [vnCounts] = STSpikeStore('count', hStore, fTemporalResolution, tTimeWindow, nNumWindows)
+ *        STSpikeStore('save', hStore, strFilename, tDuration, fTemporalResolution, strSpec)
+ *        [hStore, tDuration, fTemporalResolution, strSpec] = STSpikeStore('open', strFilename)
+ *        [result] = STSpikeStore('pipeline', stSources, mMergedOps, nChunkLength, strSink <, ...>)
+ *        STSpikeStore('destroy', vhStores)
+ *
+ * STSpikeStore keeps mapped spike lists in native memory, as a set of chunks
+ * of [uint64 tick, uint32 address] columns (see STSpikeStore.h), and returns
+ * a UINT32 handle to each store.  A mapping node holds this handle in the
+ * 'hSpikeStore' field, in place of a 'spikeList'.  STMap, STCrop, STShift,
+ * STMultiplex and STPciaerExport then work on the stores directly, without
+ * building [tick addr] double matrices for their intermediate results.
+ *
+ * 'create' builds a store from a mapping spike list: either an Nx2 [tick addr]
+ * matrix or a cell array of them, one per chunk.  Ticks are rounded down to
+ * integers, and each chunk is sorted by tick if it is not already.
+ *
+ * 'map' builds a store from an instance spike list (a vector of spike times
+ * in seconds, or a cell array of them), as STMap would: each tick is
+ * floor(t / 'fTemporalResolution'), and every spike has the logical address
+ * 'addrSynapse'.
+ *
+ * If 'bCompress' is true, 'create', 'map' and 'multiplex' build a compressed
+ * store, with the columns of each chunk encoded as in STSpikeCodec.h.  This
+ * usually takes a fifth or less of the memory of a plain store.  The stores
+ * built from a compressed store by 'crop' and 'shift' are also compressed.
+ *
+ * 'spikelist' returns the spikes of a store as a 1xC cell array of Nx2
+ * [tick addr] double matrices, one per chunk.  'info' returns a Cx4 matrix of
+ * [nCount nFirstTick nLastTick nBytes] for the chunks of a store, where
+ * 'nBytes' is the size of the encoded columns of the chunk.  'bytes' returns
+ * the total memory used by a store.
+ *
+ * 'times' returns the spike times of a store in seconds, as a 1xC cell array
+ * of Nx1 vectors, one per chunk, where the ticks are counted in units of
+ * 'fTemporalResolution'.
+ *
+ * 'crop', 'shift' and 'multiplex' each return a new store.  'crop' keeps the
+ * spikes with ticks in ['nMinTick', 'nMaxTick'].  'shift' adds 'nTickOffset'
+ * to every tick, and fails if a spike would move before tick zero.
+ * 'multiplex' rescales the ticks of each store in 'vhStores' from the matching
+ * element of 'vfTemporalResolution' to 'fTemporalResolution', interleaves all
+ * the spikes in tick order, and splits them into chunks of at most
+ * 'nChunkLength' spikes.  Ticks are rescaled exactly, as floor(tick * res_i /
+ * res), with the resolutions read as decimal fractions (see STTicks.h).
+ *
+ * 'export' returns the spikes of a store as [delta addr] rows, where 'delta'
+ * is the number of ticks since the previous spike (or since tick zero, for
+ * the first spike) and 'addr' is the logical address.  'vnChunkCounts' gives
+ * the number of rows from each chunk.
+ *
+ * 'extract' returns a new store with the spikes of 'hStore' whose logical
+ * addresses lie in ['nMinAddr', 'nMaxAddr'].  'count' returns the number of
+ * spikes in each of 'nNumWindows' consecutive windows of 'tTimeWindow'
+ * seconds, as an Nx1 vector, counting a spike on the boundary between two
+ * windows in both (see STProfileCount).
+ *
+ * 'save' writes a store to a spike train file (see STSpikeFile.h), along with
+ * the duration, temporal resolution and addressing specification text of its
+ * mapping.  'open' maps a spike train file into memory, and returns a store
+ * whose columns are read from the file as they are needed, along with the
+ * values passed to 'save'.  The file must not be changed while the store is
+ * open.
+ *
+ * 'pipeline' runs a lazy pipeline of operations over several spike trains
+ * (see STPipeline.h), reading the trains a buffer at a time and building
+ * only the final result.  Each element of the structure array 'stSources'
+ * describes one train, with the fields
+ *
+ *    hSpikeStore          - A store handle, or empty to use 'spikeList'
+ *    spikeList            - A mapping or instance spike list (matrix or cell)
+ *    bInstance            - True if 'spikeList' holds instance spike times
+ *    fTemporalResolution  - Resolution for mapping instance spike times
+ *    addrSynapse          - Logical address for instance spikes
+ *    mTimeOps             - Operations on instance spike times
+ *    mTickOps             - Operations on ticks
+ *
+ * Operations are Kx3 matrices of [nOp fA fB] rows, applied in order: nOp = 1
+ * keeps the spikes in [fA, fB], 2 adds fA, and 3 rescales ticks from
+ * resolution fA to fB.  Instance spike times are cropped and shifted in
+ * seconds by 'mTimeOps' and then mapped, as STCrop, STShift and STMap would;
+ * ticks are then changed by 'mTickOps'.  The trains are merged in tick order
+ * (keeping the order of 'stSources' for equal ticks), 'mMergedOps' is
+ * applied to the merged ticks, and the result is passed in chunks of at most
+ * 'nChunkLength' spikes to the sink 'strSink':
+ *
+ *    [hStore] = ... 'store' <, bCompress>)
+ *    [cSpikeList] = ... 'spikelist')
+ *    [cDeltaAddr] = ... 'export')
+ *    ... 'save', strFilename, tDuration, fTemporalResolution, strSpec <, bCompress>)
+ *
+ * 'store' returns a new store, 'spikelist' a cell array of [tick addr]
+ * chunks, and 'export' a cell array of [delta addr] chunks, as 'export' does
+ * for a whole store.  'save' writes a spike train file, as 'save' does,
+ * without building a store.
+ *
+ * 'destroy' frees each store in 'vhStores'.  Stores are never freed
+ * automatically, except when the MEX file is cleared; every handle is then
+ * invalid.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STSpikeStore.h"
+#include "STSpikeFile.h"
+#include "STPipeline.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string>
+
+
+/* - Table of stores, indexed by handle - 1 */
+static STSpikeStore  **apStores = NULL;
+static size_t        nNumStores = 0;
+
+
+/* --- FreeStores - Free every store, when the MEX file is cleared */
+static void FreeStores(void)
+{
+   for (size_t nStore = 0; nStore < nNumStores; nStore++) delete apStores[nStore];
+   free(apStores);
+   apStores = NULL;
+   nNumStores = 0;
+}
+
+/* --- NewHandle - Register a store, and return a UINT32 handle to it */
+static mxArray *NewHandle(STSpikeStore *pStore)
+{
+   size_t nStore;
+
+   /* - Reuse a free slot if there is one */
+   for (nStore = 0; nStore < nNumStores; nStore++) {
+      if (apStores[nStore] == NULL) break;
+   }
+
+   if (nStore == nNumStores) {
+      STSpikeStore **apGrown = (STSpikeStore **) realloc(apStores, (nNumStores + 16) * sizeof(STSpikeStore *));
+      if (apGrown == NULL) {
+         delete pStore;
+         mexErrMsgIdAndTxt("STSpikeStore:OutOfMemory", "*** STSpikeStore: Couldn't allocate a new store");
+      }
+      apStores = apGrown;
+      for (size_t nSlot = nNumStores; nSlot < nNumStores + 16; nSlot++) apStores[nSlot] = NULL;
+      nNumStores += 16;
+   }
+
+   apStores[nStore] = pStore;
+
+   mxArray *pHandle = mxCreateNumericMatrix(1, 1, mxUINT32_CLASS, mxREAL);
+   *(uint32_T *) mxGetData(pHandle) = (uint32_T) (nStore + 1);
+   return pHandle;
+}
+
+/* --- GetStore - Look up the store for one handle */
+static const STSpikeStore *GetStore(uint32_T hStore)
+{
+   if ((hStore < 1) || (hStore > nNumStores) || (apStores[hStore-1] == NULL)) {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidHandle", "*** STSpikeStore: Invalid or destroyed spike store handle");
+   }
+   return apStores[hStore-1];
+}
+
+/* --- GetHandle - Check and look up a scalar handle argument */
+static const STSpikeStore *GetHandle(const mxArray *pHandle)
+{
+   if (!mxIsUint32(pHandle) || (mxGetNumberOfElements(pHandle) != 1)) {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidHandle", "*** STSpikeStore: A spike store handle must be a UINT32 scalar");
+   }
+   return GetStore(*(uint32_T *) mxGetData(pHandle));
+}
+
+
+/* --- GetChunks - Return the chunk arrays of a spike list argument */
+static std::vector<const mxArray *> GetChunks(const mxArray *pSpikeList)
+{
+   std::vector<const mxArray *> vpChunks;
+
+   if (mxIsCell(pSpikeList)) {
+      for (size_t nChunk = 0; nChunk < mxGetNumberOfElements(pSpikeList); nChunk++) {
+         const mxArray *pChunk = mxGetCell(pSpikeList, nChunk);
+         if ((pChunk != NULL) && !mxIsEmpty(pChunk)) vpChunks.push_back(pChunk);
+      }
+   } else if (!mxIsEmpty(pSpikeList)) {
+      vpChunks.push_back(pSpikeList);
+   }
+
+   for (size_t nChunk = 0; nChunk < vpChunks.size(); nChunk++) {
+      if (!mxIsDouble(vpChunks[nChunk]) || mxIsComplex(vpChunks[nChunk])) {
+         mexErrMsgIdAndTxt("STSpikeStore:InvalidSpikeList", "*** STSpikeStore: Spike lists must be real double arrays");
+      }
+   }
+
+   return vpChunks;
+}
+
+/* --- SortChunk - Sort the columns of a chunk by tick, if they are out of order */
+static void SortChunk(std::vector<uint64_t> &vnTicks, std::vector<uint32_t> &vnAddrs)
+{
+   size_t nSpike, nCount = vnTicks.size();
+
+   for (nSpike = 1; nSpike < nCount; nSpike++) {
+      if (vnTicks[nSpike] < vnTicks[nSpike-1]) break;
+   }
+   if (nSpike >= nCount) return;
+
+   std::vector< std::pair<uint64_t, uint32_t> > vSpikes(nCount);
+   for (nSpike = 0; nSpike < nCount; nSpike++) {
+      vSpikes[nSpike] = std::make_pair(vnTicks[nSpike], vnAddrs[nSpike]);
+   }
+   std::stable_sort(vSpikes.begin(), vSpikes.end(),
+                    [](const std::pair<uint64_t, uint32_t> &a, const std::pair<uint64_t, uint32_t> &b) {
+                       return a.first < b.first;
+                    });
+   for (nSpike = 0; nSpike < nCount; nSpike++) {
+      vnTicks[nSpike] = vSpikes[nSpike].first;
+      vnAddrs[nSpike] = vSpikes[nSpike].second;
+   }
+}
+
+/* --- CheckTick - Check that a tick value can be stored */
+static bool CheckTick(double fTick)
+{
+   /* - Ticks must be exact in a double, to survive the trip back */
+   return (fTick >= 0) && (fTick <= 9007199254740992.0);
+}
+
+/* --- CheckAddr - Check that an address value can be stored */
+static bool CheckAddr(double fAddr)
+{
+   return (fAddr >= 0) && (fAddr <= 4294967295.0) && (fAddr == floor(fAddr));
+}
+
+
+/* --- GetString - Return a string argument */
+static std::string GetString(const mxArray *pString, const char *strName)
+{
+   char *strValue = mxIsChar(pString) ? mxArrayToString(pString) : NULL;
+
+   if (strValue == NULL) {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument", "*** STSpikeStore: '%s' must be a string", strName);
+   }
+
+   std::string strCopy(strValue);
+   mxFree(strValue);
+   return strCopy;
+}
+
+
+/* --- CreateStore - Build a store from mapping spike list chunks */
+static STSpikeStore *CreateStore(const mxArray *pSpikeList, bool bCompress)
+{
+   std::vector<const mxArray *> vpChunks = GetChunks(pSpikeList);
+   std::unique_ptr<STSpikeStore> pStore(new STSpikeStore(bCompress));
+   std::vector<uint64_t>         vnTicks;
+   std::vector<uint32_t>         vnAddrs;
+
+   for (size_t nChunk = 0; nChunk < vpChunks.size(); nChunk++) {
+      size_t         nCount = mxGetM(vpChunks[nChunk]);
+      const double   *adTicks = mxGetPr(vpChunks[nChunk]),
+                     *adAddrs = adTicks + nCount;
+
+      if (mxGetN(vpChunks[nChunk]) != 2) {
+         mexErrMsgIdAndTxt("STSpikeStore:InvalidSpikeList",
+                           "*** STSpikeStore: Mapping spike lists must be Nx2 [tick addr] matrices");
+      }
+
+      vnTicks.resize(nCount);
+      vnAddrs.resize(nCount);
+      for (size_t nSpike = 0; nSpike < nCount; nSpike++) {
+         if (!CheckTick(adTicks[nSpike]) || !CheckAddr(adAddrs[nSpike])) {
+            mexErrMsgIdAndTxt("STSpikeStore:InvalidSpikeList",
+                              "*** STSpikeStore: Ticks must be non-negative, and addresses must be 32-bit unsigned integers");
+         }
+         vnTicks[nSpike] = (uint64_t) floor(adTicks[nSpike]);
+         vnAddrs[nSpike] = (uint32_t) adAddrs[nSpike];
+      }
+      SortChunk(vnTicks, vnAddrs);
+      pStore->AppendChunk(vnTicks.data(), vnAddrs.data(), nCount);
+   }
+
+   return pStore.release();
+}
+
+/* --- MapStore - Build a store from instance spike list chunks */
+static STSpikeStore *MapStore(const mxArray *pSpikeList, double fTemporalResolution, double fAddr, bool bCompress)
+{
+   std::vector<const mxArray *> vpChunks = GetChunks(pSpikeList);
+   std::unique_ptr<STSpikeStore> pStore(new STSpikeStore(bCompress));
+   std::vector<uint64_t>         vnTicks;
+   std::vector<uint32_t>         vnAddrs;
+
+   if (!(fTemporalResolution > 0) || !CheckAddr(fAddr)) {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument",
+                        "*** STSpikeStore: The resolution must be positive, and the address a 32-bit unsigned integer");
+   }
+
+   for (size_t nChunk = 0; nChunk < vpChunks.size(); nChunk++) {
+      size_t         nCount = mxGetNumberOfElements(vpChunks[nChunk]);
+      const double   *adTimes = mxGetPr(vpChunks[nChunk]);
+
+      vnTicks.resize(nCount);
+      vnAddrs.assign(nCount, (uint32_t) fAddr);
+      for (size_t nSpike = 0; nSpike < nCount; nSpike++) {
+         double fTick = floor(adTimes[nSpike] / fTemporalResolution);
+         if (!CheckTick(fTick)) {
+            mexErrMsgIdAndTxt("STSpikeStore:InvalidSpikeList",
+                              "*** STSpikeStore: Spike times must be non-negative");
+         }
+         vnTicks[nSpike] = (uint64_t) fTick;
+      }
+      SortChunk(vnTicks, vnAddrs);
+      pStore->AppendChunk(vnTicks.data(), vnAddrs.data(), nCount);
+   }
+
+   return pStore.release();
+}
+
+/* --- SpikeList - Return the chunks of a store as [tick addr] matrices */
+static mxArray *SpikeList(const STSpikeStore &store)
+{
+   mxArray                 *pSpikeList = mxCreateCellMatrix(1, store.vChunks.size());
+   std::vector<uint64_t>   vnTicks;
+   std::vector<uint32_t>   vnAddrs;
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) {
+      const STSpikeChunk &chunk = store.vChunks[nChunk];
+      mxArray  *pChunk = mxCreateDoubleMatrix(chunk.nCount, 2, mxREAL);
+      double   *adTicks = mxGetPr(pChunk),
+               *adAddrs = adTicks + chunk.nCount;
+
+      vnTicks.resize(chunk.nCount);
+      vnAddrs.resize(chunk.nCount);
+      STSpikeStore::Decode(chunk, 0, chunk.nCount, vnTicks.data(), vnAddrs.data());
+      for (size_t nSpike = 0; nSpike < chunk.nCount; nSpike++) {
+         adTicks[nSpike] = (double) vnTicks[nSpike];
+         adAddrs[nSpike] = (double) vnAddrs[nSpike];
+      }
+      mxSetCell(pSpikeList, nChunk, pChunk);
+   }
+
+   return pSpikeList;
+}
+
+/* --- SpikeTimes - Return the chunks of a store as vectors of spike times */
+static mxArray *SpikeTimes(const STSpikeStore &store, double fTemporalResolution)
+{
+   mxArray                 *pSpikeTimes = mxCreateCellMatrix(1, store.vChunks.size());
+   std::vector<uint64_t>   vnTicks;
+   std::vector<uint32_t>   vnAddrs;
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) {
+      const STSpikeChunk &chunk = store.vChunks[nChunk];
+      mxArray  *pChunk = mxCreateDoubleMatrix(chunk.nCount, 1, mxREAL);
+      double   *adTimes = mxGetPr(pChunk);
+
+      vnTicks.resize(chunk.nCount);
+      vnAddrs.resize(chunk.nCount);
+      STSpikeStore::Decode(chunk, 0, chunk.nCount, vnTicks.data(), vnAddrs.data());
+      for (size_t nSpike = 0; nSpike < chunk.nCount; nSpike++) {
+         adTimes[nSpike] = (double) vnTicks[nSpike] * fTemporalResolution;
+      }
+      mxSetCell(pSpikeTimes, nChunk, pChunk);
+   }
+
+   return pSpikeTimes;
+}
+
+/* --- ChunkInfo - Return the [nCount nFirstTick nLastTick nBytes] metadata of a store */
+static mxArray *ChunkInfo(const STSpikeStore &store)
+{
+   size_t   nNumChunks = store.vChunks.size();
+   mxArray  *pInfo = mxCreateDoubleMatrix(nNumChunks, 4, mxREAL);
+   double   *adInfo = mxGetPr(pInfo);
+
+   for (size_t nChunk = 0; nChunk < nNumChunks; nChunk++) {
+      adInfo[nChunk] = (double) store.vChunks[nChunk].nCount;
+      adInfo[nChunk + nNumChunks] = (double) store.vChunks[nChunk].nFirstTick;
+      adInfo[nChunk + 2*nNumChunks] = (double) store.vChunks[nChunk].nLastTick;
+      adInfo[nChunk + 3*nNumChunks] = (double) store.vChunks[nChunk].nBytes;
+   }
+
+   return pInfo;
+}
+
+/* --- Export - Return the spikes of a store as [delta addr] rows */
+static void Export(const STSpikeStore &store, mxArray **ppDeltaAddr, mxArray **ppChunkCounts)
+{
+   size_t   nTotal = store.NumSpikes(),
+            nRow = 0;
+   uint64_t nLastTick = 0;
+   std::vector<uint64_t>   vnTicks;
+   std::vector<uint32_t>   vnAddrs;
+
+   *ppDeltaAddr = mxCreateDoubleMatrix(nTotal, 2, mxREAL);
+   *ppChunkCounts = mxCreateDoubleMatrix(store.vChunks.size(), 1, mxREAL);
+
+   double   *adDelta = mxGetPr(*ppDeltaAddr),
+            *adAddr = adDelta + nTotal,
+            *adCounts = mxGetPr(*ppChunkCounts);
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) {
+      const STSpikeChunk &chunk = store.vChunks[nChunk];
+
+      vnTicks.resize(chunk.nCount);
+      vnAddrs.resize(chunk.nCount);
+      STSpikeStore::Decode(chunk, 0, chunk.nCount, vnTicks.data(), vnAddrs.data());
+      for (size_t nSpike = 0; nSpike < chunk.nCount; nSpike++, nRow++) {
+         adDelta[nRow] = (double) (vnTicks[nSpike] - nLastTick);
+         adAddr[nRow] = (double) vnAddrs[nSpike];
+         nLastTick = vnTicks[nSpike];
+      }
+      adCounts[nChunk] = (double) chunk.nCount;
+   }
+}
+
+
+/* --- GetField - Return a field of a pipeline source structure */
+static const mxArray *GetField(const mxArray *pSources, size_t nSource, const char *strField)
+{
+   const mxArray *pField;
+
+   if (mxGetFieldNumber(pSources, strField) < 0) {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument", "*** STSpikeStore: Pipeline sources must have a '%s' field", strField);
+   }
+
+   /* - Fields left unset in a structure array have no value */
+   pField = mxGetField(pSources, nSource, strField);
+   return (pField != NULL) ? pField : mxCreateDoubleMatrix(0, 0, mxREAL);
+}
+
+/* --- GetOps - Return a matrix of pipeline operations */
+static std::vector<STPipelineOp> GetOps(const mxArray *pOps)
+{
+   std::vector<STPipelineOp> vOps;
+
+   if (mxIsEmpty(pOps)) return vOps;
+
+   if (!mxIsDouble(pOps) || (mxGetN(pOps) != 3)) {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument", "*** STSpikeStore: Pipeline operations must be Kx3 [nOp fA fB] matrices");
+   }
+
+   size_t         nNumOps = mxGetM(pOps);
+   const double   *adOps = mxGetPr(pOps);
+
+   for (size_t nOp = 0; nOp < nNumOps; nOp++) {
+      STPipelineOp op = { (int) adOps[nOp], adOps[nOp + nNumOps], adOps[nOp + 2*nNumOps] };
+
+      if ((op.nOp < ST_PIPELINE_CROP) || (op.nOp > ST_PIPELINE_RESCALE)) {
+         mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument", "*** STSpikeStore: Unknown pipeline operation [%d]", op.nOp);
+      }
+      vOps.push_back(op);
+   }
+
+   return vOps;
+}
+
+/* --- AddTickOps - Add a stage to a stream for each operation on ticks */
+static std::unique_ptr<STSpikeStream> AddTickOps(std::unique_ptr<STSpikeStream> pStream,
+                                                 const std::vector<STPipelineOp> &vOps, STSpikeBufferPool &pool)
+{
+   for (size_t nOp = 0; nOp < vOps.size(); nOp++) {
+      const STPipelineOp &op = vOps[nOp];
+
+      if (op.nOp == ST_PIPELINE_CROP) {
+         double fMinTick = ceil(op.fA), fMaxTick = floor(op.fB);
+
+         /* - Clamp the range to the representable ticks, as 'crop' does */
+         if ((fMaxTick < 0) || (fMinTick > fMaxTick)) {
+            pStream.reset(new STStreamCrop(std::move(pStream), UINT64_MAX, 0, pool));
+         } else {
+            pStream.reset(new STStreamCrop(std::move(pStream), (fMinTick > 0) ? (uint64_t) fMinTick : 0,
+                                           (fMaxTick < 18446744073709549568.0) ? (uint64_t) fMaxTick : UINT64_MAX, pool));
+         }
+
+      } else if (op.nOp == ST_PIPELINE_SHIFT) {
+         pStream.reset(new STStreamShift(std::move(pStream), (int64_t) floor(op.fA + 0.5), pool));
+
+      } else {
+         pStream.reset(new STStreamRescale(std::move(pStream), STTickRatioBetween(op.fA, op.fB), pool));
+      }
+   }
+
+   return pStream;
+}
+
+/* --- SourceStream - Build the stream for one pipeline source */
+static std::unique_ptr<STSpikeStream> SourceStream(const mxArray *pSources, size_t nSource, STSpikeBufferPool &pool)
+{
+   const mxArray                    *pStore = GetField(pSources, nSource, "hSpikeStore");
+   std::vector<STPipelineOp>        vTimeOps = GetOps(GetField(pSources, nSource, "mTimeOps")),
+                                    vTickOps = GetOps(GetField(pSources, nSource, "mTickOps"));
+   std::unique_ptr<STSpikeStream>   pStream;
+
+   if (!mxIsEmpty(pStore)) {
+      pStream.reset(new STStreamStore(*GetHandle(pStore), pool));
+
+   } else {
+      std::vector<const mxArray *>  vpChunks = GetChunks(GetField(pSources, nSource, "spikeList"));
+      std::vector<STSpikeListChunk> vChunks(vpChunks.size());
+      bool                          bInstance = (mxGetScalar(GetField(pSources, nSource, "bInstance")) != 0);
+
+      for (size_t nChunk = 0; nChunk < vpChunks.size(); nChunk++) {
+         vChunks[nChunk].adTimes = mxGetPr(vpChunks[nChunk]);
+
+         if (bInstance) {
+            vChunks[nChunk].nCount = mxGetNumberOfElements(vpChunks[nChunk]);
+            vChunks[nChunk].adAddrs = NULL;
+         } else {
+            if (mxGetN(vpChunks[nChunk]) != 2) {
+               mexErrMsgIdAndTxt("STSpikeStore:InvalidSpikeList",
+                                 "*** STSpikeStore: Mapping spike lists must be Nx2 [tick addr] matrices");
+            }
+            vChunks[nChunk].nCount = mxGetM(vpChunks[nChunk]);
+            vChunks[nChunk].adAddrs = vChunks[nChunk].adTimes + vChunks[nChunk].nCount;
+         }
+      }
+
+      if (bInstance) {
+         double fAddr = mxGetScalar(GetField(pSources, nSource, "addrSynapse"));
+         if (!CheckAddr(fAddr)) {
+            mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument", "*** STSpikeStore: Addresses must be 32-bit unsigned integers");
+         }
+         pStream.reset(new STStreamTimes(vChunks, vTimeOps, mxGetScalar(GetField(pSources, nSource, "fTemporalResolution")),
+                                         (uint32_t) fAddr, pool));
+      } else {
+         pStream.reset(new STStreamTicks(vChunks, pool));
+      }
+   }
+
+   return AddTickOps(std::move(pStream), vTickOps, pool);
+}
+
+/* --- RunPipeline - Run a pipeline into its sink, returning a new store for 'store' */
+static STSpikeStore *RunPipeline(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   STSpikeBufferPool                               pool;
+   std::vector< std::unique_ptr<STSpikeStream> >   vpSources;
+   std::unique_ptr<STSpikeStream>                  pStream;
+   std::string                                     strSink = GetString(prhs[4], "strSink");
+   size_t                                          nSource, nChunkLength;
+
+   if (!mxIsStruct(prhs[1]) || !(mxGetScalar(prhs[3]) >= 1)) {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument",
+                        "*** STSpikeStore: 'stSources' must be a structure array, and the chunk length at least one spike");
+   }
+   nChunkLength = (size_t) mxGetScalar(prhs[3]);
+
+   /* - Build the stream of each source, then merge them */
+   for (nSource = 0; nSource < mxGetNumberOfElements(prhs[1]); nSource++) {
+      vpSources.push_back(SourceStream(prhs[1], nSource, pool));
+   }
+   pStream.reset(new STStreamMerge(vpSources, pool));
+   pStream = AddTickOps(std::move(pStream), GetOps(prhs[2]), pool);
+
+   /* - Drain the stream into the sink */
+   if ((strSink == "store") && (nrhs <= 6)) {
+      std::unique_ptr<STSpikeStore> pStore(new STSpikeStore((nrhs > 5) && (mxGetScalar(prhs[5]) != 0)));
+
+      STPipelineDrain(*pStream, pool, nChunkLength, [&](const uint64_t *anTicks, const uint32_t *anAddrs, size_t nCount) {
+         pStore->AppendChunk(anTicks, anAddrs, nCount);
+      });
+      return pStore.release();
+
+   } else if (((strSink == "spikelist") || (strSink == "export")) && (nrhs == 5)) {
+      std::vector<mxArray *>  vpChunks;
+      bool                    bExport = (strSink == "export");
+      uint64_t                nLastTick = 0;
+
+      STPipelineDrain(*pStream, pool, nChunkLength, [&](const uint64_t *anTicks, const uint32_t *anAddrs, size_t nCount) {
+         mxArray  *pChunk = mxCreateDoubleMatrix(nCount, 2, mxREAL);
+         double   *adTicks = mxGetPr(pChunk),
+                  *adAddrs = adTicks + nCount;
+
+         for (size_t nSpike = 0; nSpike < nCount; nSpike++) {
+            adTicks[nSpike] = bExport ? (double) (anTicks[nSpike] - nLastTick) : (double) anTicks[nSpike];
+            adAddrs[nSpike] = (double) anAddrs[nSpike];
+            nLastTick = anTicks[nSpike];
+         }
+         vpChunks.push_back(pChunk);
+      });
+
+      plhs[0] = mxCreateCellMatrix(1, vpChunks.size());
+      for (size_t nChunk = 0; nChunk < vpChunks.size(); nChunk++) mxSetCell(plhs[0], nChunk, vpChunks[nChunk]);
+
+   } else if ((strSink == "save") && (nrhs >= 9) && (nrhs <= 10)) {
+      std::string       strFilename = GetString(prhs[5], "strFilename"),
+                        strSpec = mxIsEmpty(prhs[8]) ? std::string() : GetString(prhs[8], "strSpec");
+      bool              bCompress = (nrhs > 9) && (mxGetScalar(prhs[9]) != 0);
+      STSpikeFileStream file(strFilename.c_str(), mxGetScalar(prhs[6]), mxGetScalar(prhs[7]), strSpec, bCompress);
+
+      /* - Encode each chunk through a single-chunk store, then write it */
+      STPipelineDrain(*pStream, pool, nChunkLength, [&](const uint64_t *anTicks, const uint32_t *anAddrs, size_t nCount) {
+         STSpikeStore chunk(bCompress);
+         chunk.AppendChunk(anTicks, anAddrs, nCount);
+         file.WriteChunk(chunk.vChunks[0]);
+      });
+      file.Finish();
+
+   } else {
+      mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument",
+                        "*** STSpikeStore: Unknown pipeline sink or wrong number of arguments for [%s]", strSink.c_str());
+   }
+
+   return NULL;
+}
+
+
+/* --- NumOutputs - Return the largest number of outputs of a command, or -1
+ *   if the command is unknown */
+static int NumOutputs(const char *strCommand, int nrhs, const mxArray *prhs[])
+{
+   static const struct {
+      const char  *strCommand;
+      int         nNumOutputs;
+   } aCommands[] = {
+      { "create", 1 }, { "map", 1 }, { "spikelist", 1 }, { "times", 1 }, { "info", 1 }, { "bytes", 1 },
+      { "crop", 1 }, { "shift", 1 }, { "multiplex", 1 }, { "export", 2 }, { "extract", 1 }, { "count", 1 },
+      { "save", 0 }, { "open", 4 }, { "pipeline", 1 }, { "destroy", 0 }
+   };
+
+   /* - A pipeline which saves to a file returns nothing */
+   if (!strcmp(strCommand, "pipeline") && (nrhs > 4) && mxIsChar(prhs[4]) && (GetString(prhs[4], "strSink") == "save")) {
+      return 0;
+   }
+
+   for (size_t nCommand = 0; nCommand < sizeof(aCommands) / sizeof(aCommands[0]); nCommand++) {
+      if (!strcmp(strCommand, aCommands[nCommand].strCommand)) return aCommands[nCommand].nNumOutputs;
+   }
+
+   return -1;
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   static bool    bRegisteredExit = false;
+   char           strCommand[16], *pChar;
+   int            nNumOutputs;
+   STSpikeStore   *pResult = NULL;
+   std::string    strError;
+
+   if (!bRegisteredExit) {
+      mexAtExit(FreeStores);
+      bRegisteredExit = true;
+   }
+
+   /* - Check usage */
+   if ((nrhs < 2) || !mxIsChar(prhs[0]) || mxGetString(prhs[0], strCommand, sizeof(strCommand))) {
+      mexPrintf("*** STSpikeStore: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STSpikeStore");
+      return;
+   }
+   for (pChar = strCommand; *pChar; pChar++) *pChar = (char) tolower(*pChar);
+
+   /* - Check the number of outputs requested of the command */
+   nNumOutputs = NumOutputs(strCommand, nrhs, prhs);
+   if ((nNumOutputs >= 0) && (nlhs > nNumOutputs)) {
+      mexPrintf("*** STSpikeStore: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STSpikeStore");
+      return;
+   }
+
+   try {
+      if (!strcmp(strCommand, "create") && (nrhs >= 2) && (nrhs <= 3)) {
+         pResult = CreateStore(prhs[1], (nrhs > 2) && (mxGetScalar(prhs[2]) != 0));
+
+      } else if (!strcmp(strCommand, "map") && (nrhs >= 4) && (nrhs <= 5)) {
+         pResult = MapStore(prhs[1], mxGetScalar(prhs[2]), mxGetScalar(prhs[3]), (nrhs > 4) && (mxGetScalar(prhs[4]) != 0));
+
+      } else if (!strcmp(strCommand, "spikelist") && (nrhs == 2)) {
+         plhs[0] = SpikeList(*GetHandle(prhs[1]));
+
+      } else if (!strcmp(strCommand, "times") && (nrhs == 3)) {
+         plhs[0] = SpikeTimes(*GetHandle(prhs[1]), mxGetScalar(prhs[2]));
+
+      } else if (!strcmp(strCommand, "info") && (nrhs == 2)) {
+         plhs[0] = ChunkInfo(*GetHandle(prhs[1]));
+
+      } else if (!strcmp(strCommand, "bytes") && (nrhs == 2)) {
+         plhs[0] = mxCreateDoubleScalar((double) GetHandle(prhs[1])->NumBytes());
+
+      } else if (!strcmp(strCommand, "crop") && (nrhs == 4)) {
+         const STSpikeStore   *pStore = GetHandle(prhs[1]);
+         double               fMinTick = mxGetScalar(prhs[2]),
+                              fMaxTick = mxGetScalar(prhs[3]);
+
+         /* - Clamp the range to the representable ticks */
+         if ((fMaxTick < 0) || (fMinTick > fMaxTick)) {
+            pResult = new STSpikeStore;
+         } else {
+            pResult = STStoreCrop(*pStore, (fMinTick > 0) ? (uint64_t) ceil(fMinTick) : 0,
+                                  (fMaxTick < 18446744073709549568.0) ? (uint64_t) floor(fMaxTick) : UINT64_MAX);
+         }
+
+      } else if (!strcmp(strCommand, "shift") && (nrhs == 3)) {
+         pResult = STStoreShift(*GetHandle(prhs[1]), (int64_t) floor(mxGetScalar(prhs[2]) + 0.5));
+
+      } else if (!strcmp(strCommand, "multiplex") && (nrhs >= 5) && (nrhs <= 6)) {
+         std::vector<const STSpikeStore *>   vpStores;
+         std::vector<STTickRatio>            vRatios;
+         size_t                              nStore, nNumStores = mxGetNumberOfElements(prhs[1]);
+
+         if (!mxIsUint32(prhs[1]) || !mxIsDouble(prhs[2]) || (mxGetNumberOfElements(prhs[2]) != nNumStores)) {
+            mexErrMsgIdAndTxt("STSpikeStore:InvalidArgument",
+                              "*** STSpikeStore: 'vhStores' must be UINT32 handles, with one resolution in 'vfTemporalResolution' for each");
+         }
+
+         for (nStore = 0; nStore < nNumStores; nStore++) {
+            vpStores.push_back(GetStore(((uint32_T *) mxGetData(prhs[1]))[nStore]));
+            vRatios.push_back(STTickRatioBetween(mxGetPr(prhs[2])[nStore], mxGetScalar(prhs[3])));
+         }
+
+         pResult = STStoreMultiplex(vpStores, vRatios, (size_t) mxGetScalar(prhs[4]),
+                                    (nrhs > 5) && (mxGetScalar(prhs[5]) != 0));
+
+      } else if (!strcmp(strCommand, "export") && (nrhs == 2)) {
+         mxArray *pChunkCounts;
+         Export(*GetHandle(prhs[1]), &plhs[0], &pChunkCounts);
+         if (nlhs > 1) {
+            plhs[1] = pChunkCounts;
+         } else {
+            mxDestroyArray(pChunkCounts);
+         }
+
+      } else if (!strcmp(strCommand, "extract") && (nrhs == 4)) {
+         const STSpikeStore   *pStore = GetHandle(prhs[1]);
+         double               fMinAddr = ceil(mxGetScalar(prhs[2])),
+                              fMaxAddr = floor(mxGetScalar(prhs[3]));
+
+         /* - Clamp the range to the representable addresses */
+         if ((fMaxAddr < 0) || (fMinAddr > fMaxAddr) || (fMinAddr > 4294967295.0)) {
+            pResult = new STSpikeStore;
+         } else {
+            pResult = STStoreExtract(*pStore, (fMinAddr > 0) ? (uint32_t) fMinAddr : 0,
+                                     (fMaxAddr < 4294967295.0) ? (uint32_t) fMaxAddr : UINT32_MAX);
+         }
+
+      } else if (!strcmp(strCommand, "count") && (nrhs == 5)) {
+         const STSpikeStore   *pStore = GetHandle(prhs[1]);
+         double               fNumWindows = mxGetScalar(prhs[4]);
+         std::vector<double>  vfCounts((fNumWindows > 0) ? (size_t) fNumWindows : 0, 0.0);
+
+         STStoreCount(*pStore, mxGetScalar(prhs[2]), mxGetScalar(prhs[3]), vfCounts);
+         plhs[0] = mxCreateDoubleMatrix(vfCounts.size(), 1, mxREAL);
+         if (!vfCounts.empty()) memcpy(mxGetPr(plhs[0]), vfCounts.data(), vfCounts.size() * sizeof(double));
+
+      } else if (!strcmp(strCommand, "save") && (nrhs == 6)) {
+         const STSpikeStore   *pStore = GetHandle(prhs[1]);
+         std::string          strFilename = GetString(prhs[2], "strFilename"),
+                              strSpec = mxIsEmpty(prhs[5]) ? std::string() : GetString(prhs[5], "strSpec");
+
+         STSpikeFileWrite(*pStore, strFilename.c_str(), mxGetScalar(prhs[3]), mxGetScalar(prhs[4]), strSpec);
+
+      } else if (!strcmp(strCommand, "open") && (nrhs == 2)) {
+         std::string    strFilename = GetString(prhs[1], "strFilename"),
+                        strSpec;
+         double         tDuration, fTemporalResolution;
+
+         pResult = STSpikeFileOpen(strFilename.c_str(), &tDuration, &fTemporalResolution, &strSpec);
+         if (nlhs > 1) plhs[1] = mxCreateDoubleScalar(tDuration);
+         if (nlhs > 2) plhs[2] = mxCreateDoubleScalar(fTemporalResolution);
+         if (nlhs > 3) plhs[3] = mxCreateString(strSpec.c_str());
+
+      } else if (!strcmp(strCommand, "pipeline") && (nrhs >= 5)) {
+         pResult = RunPipeline(plhs, nrhs, prhs);
+
+      } else if (!strcmp(strCommand, "destroy") && (nrhs == 2)) {
+         if (!mxIsUint32(prhs[1])) {
+            mexErrMsgIdAndTxt("STSpikeStore:InvalidHandle", "*** STSpikeStore: Spike store handles must be UINT32");
+         }
+         const uint32_T *ahStores = (const uint32_T *) mxGetData(prhs[1]);
+         for (size_t nHandle = 0; nHandle < mxGetNumberOfElements(prhs[1]); nHandle++) {
+            if ((ahStores[nHandle] >= 1) && (ahStores[nHandle] <= nNumStores)) {
+               delete apStores[ahStores[nHandle]-1];
+               apStores[ahStores[nHandle]-1] = NULL;
+            }
+         }
+
+      } else {
+         mexPrintf("*** STSpikeStore: Unknown command or wrong number of arguments for [%s]\n", strCommand);
+         mexEvalString("help private/STSpikeStore");
+         return;
+      }
+
+   } catch (std::bad_alloc &) {
+      strError = "*** STSpikeStore: Out of memory";
+   } catch (std::exception &e) {
+      strError = std::string("*** STSpikeStore: ") + e.what();
+   }
+
+   if (!strError.empty()) {
+      delete pResult;
+      mexErrMsgIdAndTxt("STSpikeStore:Failed", "%s", strError.c_str());
+   }
+
+   /* - Return a handle to a new store */
+   if (pResult != NULL) plhs[0] = NewHandle(pResult);
+}
+
+/* --- END of STSpikeStore.cpp --- */
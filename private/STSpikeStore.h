@@ -0,0 +1,489 @@
+/* STSpikeStore.h - Native columnar spike list container for toolbox MEX functions
+ * $Id: STSpikeStore.h $
+ *
+ * NOT for command-line use
+ *
+ * An STSpikeStore holds a mapped spike list natively, in place of the [tick
+ * addr] double matrices of a mapping node.  Each chunk holds its spikes in two
+ * columns: a uint64 column of time ticks and a uint32 column of logical
+ * addresses.  Every chunk is sorted by tick, and records its spike count and
+ * its first and last ticks, so that operations can skip or select whole
+ * chunks without touching their spikes.  Empty chunks are never stored.
+ *
+ * A store may instead be compressed, in which case the columns of each chunk
+ * are encoded with STSpikeCodec.h: ticks as bit-packed differences in blocks
+ * with an index, and addresses as runs where that is smaller.  Spikes are
+ * read from either kind of chunk with STSpikeStore::Decode, and located by
+ * tick with STSpikeStore::Seek, which decodes a single block of a compressed
+ * chunk.
+ *
+ * The columns of every chunk are carved out of a per-store arena, so
+ * building a store with many chunks costs a few allocations, and the whole
+ * store is freed at once.  Arena blocks start small and double in size, so
+ * that small stores stay small.  Stores are never modified once built: each
+ * operation below builds a new store from one or more source stores.
+ *
+ *    STStoreCrop       - Keep the spikes in a range of ticks
+ *    STStoreShift      - Offset every tick
+ *    STStoreMultiplex  - Rescale and interleave several stores
+ *    STStoreExtract    - Keep the spikes in a range of addresses
+ *    STStoreCount      - Count spikes in consecutive time windows
+ *
+ * These functions throw std::bad_alloc if memory runs out, and
+ * std::invalid_argument for arguments they cannot handle.  MATLAB API
+ * functions are not used here; see STSpikeStore.cpp for the MEX interface.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_SPIKE_STORE_H
+#define ST_SPIKE_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "STSpikeCodec.h"
+#include "STMergeHeap.h"
+#include "STTicks.h"
+
+
+/* - Sizes of the first and largest arena blocks, in bytes */
+#define ST_STORE_ARENA_FIRST     4096
+#define ST_STORE_ARENA_BLOCK     (4 * 1024 * 1024)
+
+/* - Alignment of each column in an arena block, in bytes */
+#define ST_STORE_ALIGN           64
+
+
+/* --- STSpikeArena - Block allocator for the columns of a store */
+class STSpikeArena {
+public:
+   STSpikeArena() : nBlockUsed(0), nBlockSize(0), nBytes(0) {}
+
+   /* - Return 'nRequest' bytes of storage, aligned to ST_STORE_ALIGN */
+   void *Allocate(size_t nRequest)
+   {
+      nRequest = (nRequest + ST_STORE_ALIGN - 1) & ~((size_t) ST_STORE_ALIGN - 1);
+
+      if (vBlocks.empty() || (nBlockUsed + nRequest > nBlockSize)) {
+         size_t nNextSize = vBlocks.empty() ? ST_STORE_ARENA_FIRST
+                                            : std::min(2 * nBlockSize, (size_t) ST_STORE_ARENA_BLOCK);
+         nBlockSize = std::max(nRequest, nNextSize);
+         vBlocks.push_back(std::unique_ptr<char[]>(new char[nBlockSize + ST_STORE_ALIGN]));
+         nBlockUsed = 0;
+         nBytes += nBlockSize + ST_STORE_ALIGN;
+      }
+
+      /* - Align the start of the block, then the columns stay aligned */
+      char *pBlock = vBlocks.back().get();
+      pBlock += (ST_STORE_ALIGN - ((uintptr_t) pBlock % ST_STORE_ALIGN)) % ST_STORE_ALIGN;
+
+      void *pColumn = pBlock + nBlockUsed;
+      nBlockUsed += nRequest;
+      return pColumn;
+   }
+
+   /* - Return the total size of the arena, in bytes */
+   size_t NumBytes(void) const { return nBytes; }
+
+private:
+   std::vector< std::unique_ptr<char[]> > vBlocks;
+   size_t   nBlockUsed, nBlockSize, nBytes;
+};
+
+
+/* - One chunk of a store: a pair of columns and their metadata.  'anTicks' is
+ *   NULL for a compressed chunk, and 'anAddrs' is NULL for run-length
+ *   encoded addresses */
+struct STSpikeChunk {
+   size_t         nCount;
+   uint64_t       nFirstTick, nLastTick;
+   size_t         nBytes;                 /* Size of the encoded columns */
+
+   uint64_t       *anTicks;               /* Plain columns */
+   uint32_t       *anAddrs;
+
+   STCodecBlock   *aBlocks;               /* Compressed ticks */
+   uint32_t       *anPacked;
+
+   size_t         nNumRuns;               /* Run-length encoded addresses */
+   uint32_t       *anRunAddrs;
+   uint64_t       *anRunEnds;
+};
+
+
+/* --- STSpikeStore - A chunked, columnar spike list */
+class STSpikeStore {
+public:
+   std::vector<STSpikeChunk>  vChunks;
+   const bool                 bCompressed;
+   std::shared_ptr<void>      pBacking;      /* Owner of adopted columns, if any */
+
+   explicit STSpikeStore(bool bCompress = false) : bCompressed(bCompress) {}
+
+   /* - Append a chunk of 'nCount' spikes, sorted by tick, encoding the
+    *   columns if the store is compressed.  Empty chunks are ignored */
+   void AppendChunk(const uint64_t *anTicks, const uint32_t *anAddrs, size_t nCount)
+   {
+      STSpikeChunk chunk;
+
+      if (nCount == 0) return;
+
+      memset(&chunk, 0, sizeof(chunk));
+      chunk.nCount = nCount;
+      chunk.nFirstTick = anTicks[0];
+      chunk.nLastTick = anTicks[nCount-1];
+
+      if (!bCompressed) {
+         chunk.anTicks = (uint64_t *) arena.Allocate(nCount * sizeof(uint64_t));
+         chunk.anAddrs = (uint32_t *) arena.Allocate(nCount * sizeof(uint32_t));
+         memcpy(chunk.anTicks, anTicks, nCount * sizeof(uint64_t));
+         memcpy(chunk.anAddrs, anAddrs, nCount * sizeof(uint32_t));
+         chunk.nBytes = nCount * (sizeof(uint64_t) + sizeof(uint32_t));
+         vChunks.push_back(chunk);
+         return;
+      }
+
+      /* - Encode the ticks, then copy the encoding into the arena */
+      std::vector<STCodecBlock>  vBlocks;
+      std::vector<uint32_t>      vnPacked;
+      STCodecEncode(anTicks, nCount, vBlocks, vnPacked);
+
+      chunk.aBlocks = (STCodecBlock *) arena.Allocate(vBlocks.size() * sizeof(STCodecBlock));
+      chunk.anPacked = (uint32_t *) arena.Allocate(vnPacked.size() * sizeof(uint32_t));
+      memcpy(chunk.aBlocks, vBlocks.data(), vBlocks.size() * sizeof(STCodecBlock));
+      if (!vnPacked.empty()) memcpy(chunk.anPacked, vnPacked.data(), vnPacked.size() * sizeof(uint32_t));
+      chunk.nBytes = vBlocks.size() * sizeof(STCodecBlock) + vnPacked.size() * sizeof(uint32_t);
+
+      /* - Encode the addresses as runs, if that is smaller */
+      if (STCodecUseRuns(anAddrs, nCount, &chunk.nNumRuns)) {
+         chunk.anRunAddrs = (uint32_t *) arena.Allocate(chunk.nNumRuns * sizeof(uint32_t));
+         chunk.anRunEnds = (uint64_t *) arena.Allocate(chunk.nNumRuns * sizeof(uint64_t));
+         STCodecEncodeRuns(anAddrs, nCount, chunk.anRunAddrs, chunk.anRunEnds);
+         chunk.nBytes += chunk.nNumRuns * (sizeof(uint32_t) + sizeof(uint64_t));
+      } else {
+         chunk.nNumRuns = 0;
+         chunk.anAddrs = (uint32_t *) arena.Allocate(nCount * sizeof(uint32_t));
+         memcpy(chunk.anAddrs, anAddrs, nCount * sizeof(uint32_t));
+         chunk.nBytes += nCount * sizeof(uint32_t);
+      }
+
+      vChunks.push_back(chunk);
+   }
+
+   /* - Append a chunk whose columns are held elsewhere, such as in a mapped
+    *   file (see STSpikeFile.h).  'pBacking' must keep them alive */
+   void AdoptChunk(const STSpikeChunk &chunk) { vChunks.push_back(chunk); }
+
+   /* - Decode spikes [nFirst, nFirst + nCount) of a chunk.  Either output
+    *   may be NULL, to skip that column */
+   static void Decode(const STSpikeChunk &chunk, size_t nFirst, size_t nCount, uint64_t *anTicks, uint32_t *anAddrs)
+   {
+      if (anTicks != NULL) {
+         if (chunk.anTicks != NULL) {
+            memcpy(anTicks, chunk.anTicks + nFirst, nCount * sizeof(uint64_t));
+         } else {
+            STCodecDecode(chunk.aBlocks, chunk.anPacked, chunk.nCount, nFirst, nCount, anTicks);
+         }
+      }
+
+      if (anAddrs != NULL) {
+         if (chunk.anAddrs != NULL) {
+            memcpy(anAddrs, chunk.anAddrs + nFirst, nCount * sizeof(uint32_t));
+         } else {
+            STCodecDecodeRuns(chunk.anRunAddrs, chunk.anRunEnds, chunk.nNumRuns, nFirst, nCount, anAddrs);
+         }
+      }
+   }
+
+   /* - Return the index of the first spike in a chunk with a tick >= 'nTick' */
+   static size_t Seek(const STSpikeChunk &chunk, uint64_t nTick)
+   {
+      if (nTick <= chunk.nFirstTick) return 0;
+      if (nTick > chunk.nLastTick) return chunk.nCount;
+
+      if (chunk.anTicks != NULL) {
+         return std::lower_bound(chunk.anTicks, chunk.anTicks + chunk.nCount, nTick) - chunk.anTicks;
+      } else {
+         return STCodecSeek(chunk.aBlocks, chunk.anPacked, chunk.nCount, nTick);
+      }
+   }
+
+   /* - Return the total number of spikes in the store */
+   size_t NumSpikes(void) const
+   {
+      size_t nTotal = 0;
+      for (size_t nChunk = 0; nChunk < vChunks.size(); nChunk++) nTotal += vChunks[nChunk].nCount;
+      return nTotal;
+   }
+
+   /* - Return the memory used by the store, in bytes */
+   size_t NumBytes(void) const
+   {
+      return sizeof(*this) + vChunks.capacity() * sizeof(STSpikeChunk) + arena.NumBytes();
+   }
+
+private:
+   STSpikeArena   arena;
+};
+
+
+/* --- STStoreCrop - Return the spikes of 'store' with ticks in [nMinTick, nMaxTick]
+ *
+ * Chunks wholly inside the range are copied whole, and chunks wholly outside
+ * it are skipped, using only their metadata.  Chunks which straddle an end
+ * of the range are cut with STSpikeStore::Seek.
+ */
+static inline STSpikeStore *STStoreCrop(const STSpikeStore &store, uint64_t nMinTick, uint64_t nMaxTick)
+{
+   std::unique_ptr<STSpikeStore> pCropped(new STSpikeStore(store.bCompressed));
+   std::vector<uint64_t>         vnTicks;
+   std::vector<uint32_t>         vnAddrs;
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) {
+      const STSpikeChunk &chunk = store.vChunks[nChunk];
+      if ((chunk.nLastTick < nMinTick) || (chunk.nFirstTick > nMaxTick)) continue;
+
+      size_t nFirst = STSpikeStore::Seek(chunk, nMinTick),
+             nEnd = (nMaxTick < chunk.nLastTick) ? STSpikeStore::Seek(chunk, nMaxTick + 1) : chunk.nCount;
+
+      vnTicks.resize(nEnd - nFirst);
+      vnAddrs.resize(nEnd - nFirst);
+      STSpikeStore::Decode(chunk, nFirst, nEnd - nFirst, vnTicks.data(), vnAddrs.data());
+      pCropped->AppendChunk(vnTicks.data(), vnAddrs.data(), nEnd - nFirst);
+   }
+
+   return pCropped.release();
+}
+
+
+/* --- STStoreShift - Return the spikes of 'store' with 'nOffset' added to every tick
+ *
+ * Ticks are unsigned, so a negative offset must not move any spike before
+ * tick zero.
+ */
+static inline STSpikeStore *STStoreShift(const STSpikeStore &store, int64_t nOffset)
+{
+   if (!store.vChunks.empty() && (nOffset < 0) && (store.vChunks[0].nFirstTick < (uint64_t) -nOffset)) {
+      throw std::invalid_argument("Shifting would move spikes before time zero");
+   }
+
+   std::unique_ptr<STSpikeStore> pShifted(new STSpikeStore(store.bCompressed));
+   std::vector<uint64_t>         vnTicks;
+   std::vector<uint32_t>         vnAddrs;
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) {
+      const STSpikeChunk &chunk = store.vChunks[nChunk];
+
+      vnTicks.resize(chunk.nCount);
+      vnAddrs.resize(chunk.nCount);
+      STSpikeStore::Decode(chunk, 0, chunk.nCount, vnTicks.data(), vnAddrs.data());
+
+      /* - Unsigned wrap-around gives the right answer for negative offsets */
+      for (size_t nSpike = 0; nSpike < chunk.nCount; nSpike++) vnTicks[nSpike] += (uint64_t) nOffset;
+      pShifted->AppendChunk(vnTicks.data(), vnAddrs.data(), chunk.nCount);
+   }
+
+   return pShifted.release();
+}
+
+
+/* - A cursor over one chunk of a store being multiplexed, holding the next
+ *   block of decoded and rescaled spikes */
+struct STMuxCursor {
+   const STSpikeChunk   *pChunk;
+   STTickRatio          ratio;
+   size_t               nNext;                  /* Next spike of the chunk to decode */
+   size_t               nPos, nCount;           /* Position in, and size of, the buffer */
+   uint64_t             anTicks[ST_CODEC_BLOCK];
+   uint32_t             anAddrs[ST_CODEC_BLOCK];
+
+   /* - Decode the next block of the chunk, returning false at its end */
+   bool Fill(void)
+   {
+      nPos = 0;
+      nCount = std::min((size_t) ST_CODEC_BLOCK, pChunk->nCount - nNext);
+      if (nCount == 0) return false;
+
+      STSpikeStore::Decode(*pChunk, nNext, nCount, anTicks, anAddrs);
+      STRescaleTicks(anTicks, nCount, ratio);
+      nNext += nCount;
+      return true;
+   }
+};
+
+/* --- STStoreMultiplex - Interleave the spikes of several stores
+ *
+ * The ticks of store 'i' are first rescaled exactly by vRatios[i] (see
+ * STTicks.h), to bring every store to a common temporal resolution.  The spikes of all
+ * stores are then merged in tick order, keeping spikes with equal ticks in
+ * the order of the stores (as sortrows would), and returned in chunks of at
+ * most 'nChunkLength' spikes, in a compressed store if 'bCompress' is true.
+ *
+ * Every chunk is already sorted, so the chunks are merged with a heap rather
+ * than sorted.  Each chunk is read through a cursor which decodes a single
+ * block at a time, so the memory used beyond the new store is one output
+ * chunk plus one block per source chunk.
+ */
+static inline STSpikeStore *STStoreMultiplex(const std::vector<const STSpikeStore *> &vpStores,
+                                             const std::vector<STTickRatio> &vRatios, size_t nChunkLength,
+                                             bool bCompress)
+{
+   std::vector<STMuxCursor>   vCursors;
+   STMergeHeap<uint64_t>      heap;
+   size_t                     nTotal = 0, nStore, nChunk, nCursor;
+
+   if (nChunkLength < 1) throw std::invalid_argument("The chunk length must be at least one spike");
+
+   /* - Open a cursor on every chunk, in order of store then chunk */
+   for (nStore = 0; nStore < vpStores.size(); nStore++) {
+      for (nChunk = 0; nChunk < vpStores[nStore]->vChunks.size(); nChunk++) {
+         STMuxCursor cursor;
+         cursor.pChunk = &vpStores[nStore]->vChunks[nChunk];
+         cursor.ratio = vRatios[nStore];
+         cursor.nNext = 0;
+         vCursors.push_back(cursor);
+         nTotal += cursor.pChunk->nCount;
+      }
+   }
+
+   heap.Reserve(vCursors.size());
+   for (nCursor = 0; nCursor < vCursors.size(); nCursor++) {
+      if (vCursors[nCursor].Fill()) heap.Push(vCursors[nCursor].anTicks[0], nCursor);
+   }
+
+   /* - Merge into output chunks */
+   std::unique_ptr<STSpikeStore> pMux(new STSpikeStore(bCompress));
+   std::vector<uint64_t>         vnTicks(std::min(nChunkLength, nTotal));
+   std::vector<uint32_t>         vnAddrs(vnTicks.size());
+   size_t                        nOut = 0;
+
+   while (!heap.Empty()) {
+      STMuxCursor &cursor = vCursors[heap.TopSource()];
+
+      vnTicks[nOut] = cursor.anTicks[cursor.nPos];
+      vnAddrs[nOut] = cursor.anAddrs[cursor.nPos];
+      cursor.nPos++;
+
+      if ((cursor.nPos < cursor.nCount) || cursor.Fill()) {
+         heap.Replace(cursor.anTicks[cursor.nPos]);
+      } else {
+         heap.Pop();
+      }
+
+      if (++nOut == nChunkLength) {
+         pMux->AppendChunk(vnTicks.data(), vnAddrs.data(), nOut);
+         nOut = 0;
+      }
+   }
+
+   pMux->AppendChunk(vnTicks.data(), vnAddrs.data(), nOut);
+   return pMux.release();
+}
+
+
+/* --- STStoreExtract - Return the spikes of 'store' with addresses in [nMinAddr, nMaxAddr]
+ *
+ * Addresses are decoded first, and ticks only for chunks which contain a
+ * matching spike.  A chunk of run-length encoded addresses is kept or skipped
+ * whole if it holds a single run.
+ */
+static inline STSpikeStore *STStoreExtract(const STSpikeStore &store, uint32_t nMinAddr, uint32_t nMaxAddr)
+{
+   std::unique_ptr<STSpikeStore> pExtracted(new STSpikeStore(store.bCompressed));
+   std::vector<uint64_t>         vnTicks;
+   std::vector<uint32_t>         vnAddrs;
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) {
+      const STSpikeChunk &chunk = store.vChunks[nChunk];
+
+      if (chunk.nNumRuns == 1) {
+         uint32_t nAddr = chunk.anRunAddrs[0];
+         if ((nAddr < nMinAddr) || (nAddr > nMaxAddr)) continue;
+      }
+
+      vnAddrs.resize(chunk.nCount);
+      STSpikeStore::Decode(chunk, 0, chunk.nCount, NULL, vnAddrs.data());
+
+      size_t nSpike, nKept = 0;
+      for (nSpike = 0; nSpike < chunk.nCount; nSpike++) {
+         nKept += (vnAddrs[nSpike] >= nMinAddr) && (vnAddrs[nSpike] <= nMaxAddr);
+      }
+      if (nKept == 0) continue;
+
+      vnTicks.resize(chunk.nCount);
+      STSpikeStore::Decode(chunk, 0, chunk.nCount, vnTicks.data(), NULL);
+
+      /* - Compact the matching spikes in place */
+      if (nKept < chunk.nCount) {
+         size_t nOut = 0;
+         for (nSpike = 0; nSpike < chunk.nCount; nSpike++) {
+            if ((vnAddrs[nSpike] >= nMinAddr) && (vnAddrs[nSpike] <= nMaxAddr)) {
+               vnTicks[nOut] = vnTicks[nSpike];
+               vnAddrs[nOut] = vnAddrs[nSpike];
+               nOut++;
+            }
+         }
+      }
+
+      pExtracted->AppendChunk(vnTicks.data(), vnAddrs.data(), nKept);
+   }
+
+   return pExtracted.release();
+}
+
+
+/* --- STStoreCount - Count the spikes of 'store' in consecutive time windows
+ *
+ * A spike at tick 't' falls at time t * 'fTemporalResolution' seconds.  Window
+ * 'n' (zero-based) spans [n, n+1] * 'tTimeWindow' seconds, including both
+ * ends, so a spike falling exactly on the boundary between two windows is
+ * counted in both, as STProfileCount does.  Counts are added to 'vfCounts',
+ * whose size sets the number of windows.  Chunks after the last window are
+ * skipped using their metadata.
+ */
+static inline void STStoreCount(const STSpikeStore &store, double fTemporalResolution, double tTimeWindow,
+                                std::vector<double> &vfCounts)
+{
+   std::vector<uint64_t>   vnTicks;
+   const ptrdiff_t         nNumWindows = (ptrdiff_t) vfCounts.size();
+
+   if (!(tTimeWindow > 0)) throw std::invalid_argument("The time window must be positive");
+
+   for (size_t nChunk = 0; nChunk < store.vChunks.size(); nChunk++) {
+      const STSpikeChunk &chunk = store.vChunks[nChunk];
+      if ((double) chunk.nFirstTick * fTemporalResolution > (double) nNumWindows * tTimeWindow) break;
+
+      vnTicks.resize(chunk.nCount);
+      STSpikeStore::Decode(chunk, 0, chunk.nCount, vnTicks.data(), NULL);
+
+      for (size_t nSpike = 0; nSpike < chunk.nCount; nSpike++) {
+         double      tSpike = (double) vnTicks[nSpike] * fTemporalResolution;
+         double      fWindow = floor(tSpike / tTimeWindow);
+         ptrdiff_t   nWindow = (fWindow < (double) nNumWindows) ? (ptrdiff_t) fWindow : nNumWindows;
+
+         /* - Test the neighbouring windows too, to match the boundary test exactly */
+         for (ptrdiff_t nTest = std::max((ptrdiff_t) 0, nWindow - 1);
+              nTest <= std::min(nNumWindows - 1, nWindow + 1); nTest++) {
+            if (((double) nTest * tTimeWindow <= tSpike) && (tSpike <= (double) (nTest + 1) * tTimeWindow)) {
+               vfCounts[nTest]++;
+            }
+         }
+      }
+   }
+}
+
+#endif  /* ST_SPIKE_STORE_H */
+
+/* --- END of STSpikeStore.h --- */
@@ -0,0 +1,46 @@
+function [varargout] = STSpikeStore(strCommand, varargin)
+
+% STSpikeStore - FUNCTION (Internal) Native columnar storage for mapped spike lists
+% $Id: STSpikeStore.m $
+%
+% NOT for command-line use
+
+% Usage: [hStore] = STSpikeStore('create', spikeList <, bCompress>)
+%        [hStore] = STSpikeStore('map', spikeList, fTemporalResolution, addrSynapse <, bCompress>)
+%        [cSpikeList] = STSpikeStore('spikelist', hStore)
+%        [cSpikeTimes] = STSpikeStore('times', hStore, fTemporalResolution)
+%        [mChunkInfo] = STSpikeStore('info', hStore)
+%        [nBytes] = STSpikeStore('bytes', hStore)
+%        [hCropped] = STSpikeStore('crop', hStore, nMinTick, nMaxTick)
+%        [hShifted] = STSpikeStore('shift', hStore, nTickOffset)
+%        [hMux] = STSpikeStore('multiplex', vhStores, vfTemporalResolution, fTemporalResolution, nChunkLength <, bCompress>)
+%        [mDeltaAddr, vnChunkCounts] = STSpikeStore('export', hStore)
+%        [hExtracted] = STSpikeStore('extract', hStore, nMinAddr, nMaxAddr)
+%        [vnCounts] = STSpikeStore('count', hStore, fTemporalResolution, tTimeWindow, nNumWindows)
+%        STSpikeStore('save', hStore, strFilename, tDuration, fTemporalResolution, strSpec)
+%        [result] = STSpikeStore('pipeline', stSources, mMergedOps, nChunkLength, strSink <, ...>)
+%        [hStore, tDuration, fTemporalResolution, strSpec] = STSpikeStore('open', strFilename)
+%        STSpikeStore('destroy', vhStores)
+%
+% STSpikeStore keeps mapped spike lists in native memory, as chunks of
+% [uint64 tick, uint32 address] columns, and returns a UINT32 handle to each
+% store.  A mapping node holds this handle in the 'hSpikeStore' field, in
+% place of a 'spikeList'.  Stores may be compressed, with bit-packed tick
+% differences and run-length encoded addresses, and may be mapped into memory
+% from spike train files written by STTrainSave.  See STSpikeStore.cpp for a
+% description of each command.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STSpikeStore.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STSpikeStore: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STSpikeStore.m ---
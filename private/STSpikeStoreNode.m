@@ -0,0 +1,58 @@
+function [node] = STSpikeStoreNode(node, hStore)
+
+% STSpikeStoreNode - FUNCTION (Internal) Attach a native spike store to a mapping node
+% $Id: STSpikeStoreNode.m $
+%
+% NOT for command-line use
+
+% Usage: [node] = STSpikeStoreNode(node, hStore)
+%
+% STSpikeStoreNode replaces the spike list of the mapping 'node' with the
+% native spike store 'hStore' (see STSpikeStore), and sets the chunking
+% fields of 'node' to match the chunks of the store.  A store with no spikes
+% is destroyed, and 'node' is given an empty spike list instead.
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Remove the old spike list
+
+if (isfield(node, 'spikeList'))
+   node = rmfield(node, 'spikeList');
+end
+
+if (isfield(node, 'nNumChunks'))
+   node = rmfield(node, 'nNumChunks');
+end
+
+if (isfield(node, 'stAddrIndex'))
+   node = rmfield(node, 'stAddrIndex');
+end
+
+
+% -- Attach the store
+
+mChunkInfo = STSpikeStore('info', hStore);
+
+if (isempty(mChunkInfo))
+   % - Keep empty mappings as plain spike lists
+   STSpikeStore('destroy', hStore);
+
+   if (isfield(node, 'hSpikeStore'))
+      node = rmfield(node, 'hSpikeStore');
+   end
+
+   node.bChunkedMode = false;
+   node.spikeList = [];
+   return;
+end
+
+node.hSpikeStore = hStore;
+node.bChunkedMode = (size(mChunkInfo, 1) > 1);
+
+if (node.bChunkedMode)
+   node.nNumChunks = size(mChunkInfo, 1);
+end
+
+% --- END of STSpikeStoreNode.m ---
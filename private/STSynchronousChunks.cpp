@@ -0,0 +1,173 @@
+/* STSynchronousChunks - FUNCTION (Internal) Find spikes with a synchronous partner in another train
+ * $Id: STSynchronousChunks.cpp $
+ *
+ * NOT for command-line use
+ *
+ * Usage: [cMatches] = STSynchronousChunks(cTimes1, cTimes2, tWindowSize <, nNumThreads>)
+ *
+ * 'cTimes1' and 'cTimes2' are cell arrays of chunks of spike times in
+ * seconds, from two spike trains.  For each chunk of 'cTimes1', the spikes
+ * which have a spike of 'cTimes2' within the window
+ *
+ *    [t - tWindowSize/2, t + tWindowSize/2]
+ *
+ * are returned in the corresponding cell of 'cMatches', sorted and without
+ * repeated times (as 'unique' would return them).  Chunks with no matches
+ * are empty.
+ *
+ * Each chunk of 'cTimes1' is compared only with the chunks of 'cTimes2'
+ * whose time range, widened by the window, overlaps its own.  Each such pair
+ * of sorted chunks is swept once with two pointers, since the start of the
+ * window only ever moves forward.  This costs O(N + M) for chunks of N and M
+ * spikes, instead of comparing every pair of spikes.  Chunks which are not
+ * sorted are sorted first.  The chunks of 'cTimes1' are spread over
+ * 'nNumThreads' threads, by default one per hardware thread.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#include "mex.h"
+#include "STThreadPool.h"
+#include <algorithm>
+#include <vector>
+
+
+/* - One chunk of spike times, sorted, and its time range */
+struct SynchChunk {
+   std::vector<double>  vfSorted;
+   const double         *afTimes;
+   size_t               nCount;
+   double               fMin, fMax;
+};
+
+
+/* --- ReadChunks - Collect the non-empty chunks of a cell array of spike times
+ *
+ * Sorted chunks are used in place; others are copied and sorted.  Empty
+ * chunks are kept, so that chunk indices match the cell array.
+ */
+static void ReadChunks(const mxArray *pCell, std::vector<SynchChunk> &vChunks)
+{
+   vChunks.resize(mxGetNumberOfElements(pCell));
+
+   for (size_t nChunk = 0; nChunk < vChunks.size(); nChunk++) {
+      const mxArray  *pChunk = mxGetCell(pCell, nChunk);
+      SynchChunk     &chunk = vChunks[nChunk];
+
+      chunk.nCount = 0;
+      chunk.afTimes = NULL;
+      if ((pChunk == NULL) || mxIsEmpty(pChunk)) continue;
+
+      if (!mxIsDouble(pChunk) || mxIsComplex(pChunk)) {
+         mexErrMsgIdAndTxt("STSynchronousChunks:InvalidSpikeList",
+                           "*** STSynchronousChunks: Spike time chunks must be real double vectors");
+      }
+
+      chunk.nCount = mxGetNumberOfElements(pChunk);
+      chunk.afTimes = mxGetPr(pChunk);
+
+      if (!std::is_sorted(chunk.afTimes, chunk.afTimes + chunk.nCount)) {
+         chunk.vfSorted.assign(chunk.afTimes, chunk.afTimes + chunk.nCount);
+         std::sort(chunk.vfSorted.begin(), chunk.vfSorted.end());
+         chunk.afTimes = chunk.vfSorted.data();
+      }
+
+      chunk.fMin = chunk.afTimes[0];
+      chunk.fMax = chunk.afTimes[chunk.nCount - 1];
+   }
+}
+
+/* --- MarkMatches - Mark the spikes of 'chunk1' with a partner in 'chunk2'
+ *
+ * The comparison is the one used by STFindSynchronousPairs,
+ * t1 - tHalf <= t2 <= t1 + tHalf, so the result is the same to the bit.
+ */
+static void MarkMatches(const SynchChunk &chunk1, const SynchChunk &chunk2, double tHalfWindow, std::vector<char> &vbMatched)
+{
+   size_t nSpike2 = 0;
+
+   for (size_t nSpike1 = 0; nSpike1 < chunk1.nCount; nSpike1++) {
+      double tMin = chunk1.afTimes[nSpike1] - tHalfWindow,
+             tMax = chunk1.afTimes[nSpike1] + tHalfWindow;
+
+      /* - The window start never moves back, so neither does this pointer */
+      while ((nSpike2 < chunk2.nCount) && (chunk2.afTimes[nSpike2] < tMin)) nSpike2++;
+      if (nSpike2 == chunk2.nCount) return;
+
+      if (chunk2.afTimes[nSpike2] <= tMax) vbMatched[nSpike1] = 1;
+   }
+}
+
+
+/* --- Gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+   std::vector<SynchChunk>             vChunks1, vChunks2;
+   std::vector< std::vector<double> >  vvfMatches;
+   unsigned                            nNumThreads = STDefaultNumThreads();
+   double                              tHalfWindow;
+
+   /* - Check usage */
+   if ((nlhs > 1) || (nrhs < 3) || (nrhs > 4) || !mxIsCell(prhs[0]) || !mxIsCell(prhs[1])) {
+      mexPrintf("*** STSynchronousChunks: Incorrect usage\n");
+      mexPrintf("  .MEX file: %s\n  [MEX BUILD - %s %s]\n", "$Id", __TIME__, __DATE__);
+      mexEvalString("help private/STSynchronousChunks");
+      return;
+   }
+
+   if (!(mxGetScalar(prhs[2]) >= 0)) {
+      mexErrMsgIdAndTxt("STSynchronousChunks:InvalidArgument",
+                        "*** STSynchronousChunks: The window size must not be negative");
+   }
+   tHalfWindow = mxGetScalar(prhs[2]) / 2;
+
+   if ((nrhs > 3) && !mxIsEmpty(prhs[3]) && (mxGetScalar(prhs[3]) >= 1)) {
+      nNumThreads = (unsigned) mxGetScalar(prhs[3]);
+   }
+
+   ReadChunks(prhs[0], vChunks1);
+   ReadChunks(prhs[1], vChunks2);
+   vvfMatches.resize(vChunks1.size());
+
+   /* - Match each chunk of train 1 against the overlapping chunks of train 2 */
+   STParallelFor(vChunks1.size(), nNumThreads, [&](size_t nChunk1, unsigned) {
+      const SynchChunk  &chunk1 = vChunks1[nChunk1];
+      std::vector<char> vbMatched(chunk1.nCount, 0);
+
+      if (chunk1.nCount == 0) return;
+
+      for (size_t nChunk2 = 0; nChunk2 < vChunks2.size(); nChunk2++) {
+         const SynchChunk &chunk2 = vChunks2[nChunk2];
+
+         if ((chunk2.nCount == 0) || (chunk2.fMax < chunk1.fMin - tHalfWindow) ||
+             (chunk2.fMin > chunk1.fMax + tHalfWindow)) continue;
+
+         MarkMatches(chunk1, chunk2, tHalfWindow, vbMatched);
+      }
+
+      /* - Keep each matched time once */
+      std::vector<double> &vfMatches = vvfMatches[nChunk1];
+      for (size_t nSpike = 0; nSpike < chunk1.nCount; nSpike++) {
+         if (vbMatched[nSpike] && (vfMatches.empty() || (vfMatches.back() != chunk1.afTimes[nSpike]))) {
+            vfMatches.push_back(chunk1.afTimes[nSpike]);
+         }
+      }
+   });
+
+   /* - Return the matches of each chunk */
+   plhs[0] = mxCreateCellMatrix(1, vChunks1.size());
+
+   for (size_t nChunk1 = 0; nChunk1 < vChunks1.size(); nChunk1++) {
+      const std::vector<double>  &vfMatches = vvfMatches[nChunk1];
+      mxArray                    *pMatches = vfMatches.empty() ? mxCreateDoubleMatrix(0, 0, mxREAL)
+                                                               : mxCreateDoubleMatrix(vfMatches.size(), 1, mxREAL);
+
+      std::copy(vfMatches.begin(), vfMatches.end(), mxGetPr(pMatches));
+      mxSetCell(plhs[0], nChunk1, pMatches);
+   }
+}
+
+/* --- END of STSynchronousChunks.cpp --- */
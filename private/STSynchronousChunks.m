@@ -0,0 +1,31 @@
+function [cMatches] = STSynchronousChunks(cTimes1, cTimes2, tWindowSize, nNumThreads)
+
+% STSynchronousChunks - FUNCTION (Internal) Find spikes with a synchronous partner in another train
+% $Id: STSynchronousChunks.m $
+%
+% NOT for command-line use
+
+% Usage: [cMatches] = STSynchronousChunks(cTimes1, cTimes2, tWindowSize <, nNumThreads>)
+%
+% 'cTimes1' and 'cTimes2' are cell arrays of chunks of spike times in seconds.
+% For each chunk of 'cTimes1', the spikes which have a spike of 'cTimes2'
+% within +/- tWindowSize/2 are returned in the corresponding cell of
+% 'cMatches', sorted and without repeated times.  Only chunks whose time
+% ranges overlap are compared, each pair with a single sweep, and the chunks
+% of 'cTimes1' are spread over 'nNumThreads' threads, by default one per
+% hardware thread.
+
+% NOTE: THIS IS A DUMMY FUNCTION, AND WILL ONLY BE EXECUTED IF
+% STSynchronousChunks.mex___ HAS NOT BEEN COMPILED
+
+% Author: agent <agent@local>
+% Created: 16th October, 2026
+% Copyright (c) 2026 agent
+
+% -- Display some help
+
+disp('*** STSynchronousChunks: MEX function has not been compiled');
+disp('    This low-level toolbox function is not yet available to the');
+disp('    MATLAB workspace.  Please run STWelcome.');
+
+% --- END of STSynchronousChunks.m ---
@@ -1,11 +1,11 @@
-function [nSpikeIndices] = STTestSpikePoisson(tTimeTrace, fInstFreq, fRandList, fMemTau)
+function [nSpikeIndices, vfFilterState] = STTestSpikePoisson(tTimeTrace, fInstFreq, fRandList, fMemTau, vfFilterState)
 
 % STTestSpikePoisson - FUNCTION Internal spike creation test function
 % $Id: STTestSpikePoisson.m 7737 2007-10-05 13:54:24Z dylan $
 %
 % NOT for command-line use
 
-% Usage: [nSpikeIndices] = STTestSpikePoisson(tTimeTrace, fInstFreq <,fRandList, fMemTau>)
+% Usage: [nSpikeIndices <, vfFilterState>] = STTestSpikePoisson(tTimeTrace, fInstFreq <,fRandList, fMemTau, vfFilterState>)
 %
 % 'tTimeTrace' is a vector of time stamps in seconds.  'fInstFreq' is a vector
 % of desired instantaneous frequencies in Hz, with an element corresponding to
@@ -15,6 +15,9 @@ function [nSpikeIndices] = STTestSpikePoisson(tTimeTrace, fInstFreq, fRandList,
 % 'fMemTau' is an optional argument to use in creating a non-ergodic spike
 % train.  It will be used as the time constant for an exponential filtering of
 % the random sequence.  If 'fMemTau' is an empty matrix, it will not be used.
+% 'vfFilterState' is the state of the filter returned for the previous chunk
+% of the same train, so that its memory continues across chunk boundaries
+% (see MakeNonErgodic).
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 26th March, 2004
@@ -29,7 +32,7 @@ RandomGenerator = stOptions.RandomGenerator;
 
 % -- Check arguments
 
-if (nargin > 4)
+if (nargin > 5)
    disp('--- STTestSpikePoisson: Extra arguments ignored');
 end
 
@@ -47,10 +50,14 @@ if (~exist('fRandList', 'var') || isempty(fRandList))
 end
 
 % - Should we perform an exponential filtering?
+if (~exist('vfFilterState', 'var'))
+   vfFilterState = [];
+end
+
 if (exist('fMemTau', 'var') && ~isempty(fMemTau));
    % - Determine temporal resolution
    fTemporalRes = tTimeTrace(2) - tTimeTrace(1);
-   fRandList = MakeNonErgodic(fRandList, fMemTau, fTemporalRes);
+   [fRandList, vfFilterState] = MakeNonErgodic(fRandList, fMemTau, fTemporalRes, vfFilterState);
 end
 
 % -- Poisson process
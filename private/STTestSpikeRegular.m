@@ -1,11 +1,11 @@
-function [nSpikeIndices] = STTestSpikeRegular(tTimeTrace, fInstFreq, fRandList, fMemTau)
+function [nSpikeIndices, vfPhaseState] = STTestSpikeRegular(tTimeTrace, fInstFreq, fRandList, fMemTau, vfPhaseState)
 
 % STTestSpikeRegular - FUNCTION Internal spike creation test function
 % $Id: STTestSpikeRegular.m 2411 2005-11-07 16:48:24Z dylan $
 %
 % NOT for command-line use
 
-% Usage: [nSpikeIndices] = STTestSpikeRegular(tTimeTrace, fInstFreq <,fRandList, fMemTau>)
+% Usage: [nSpikeIndices, vfPhaseState] = STTestSpikeRegular(tTimeTrace, fInstFreq <,fRandList, fMemTau, vfPhaseState>)
 %
 % 'tTimeTrace' is a vector of time stamps in seconds.  'fInstFreq' is a vector
 % of desired instantaneous frequencies in Hz, with an element corresponding to
@@ -18,6 +18,17 @@ function [nSpikeIndices] = STTestSpikeRegular(tTimeTrace, fInstFreq, fRandList,
 %
 % Note that a regular spike train does not use any random sequence for train
 % generation, and so will ignore these optional arguments.
+%
+% The instantaneous frequency is integrated over the time trace to give the
+% phase of the train, and a spike is placed in each bin in which the phase
+% passes a whole number.  Changing frequencies are therefore followed
+% correctly.  No more than one spike is placed in each bin.
+%
+% 'vfPhaseState' (output) holds the phase at the end of the time trace, and
+% the time at which the next trace would start.  Passing it back in for the
+% following chunk of a train continues the phase from one chunk to the next.
+% If 'vfPhaseState' is not supplied, the phase is zero at the start of
+% 'tTimeTrace', so the first bin always holds a spike.
 
 % Author: Dylan Muir <dylan@ini.phys.ethz.ch>
 % Created: 26th March, 2004
@@ -28,10 +39,13 @@ function [nSpikeIndices] = STTestSpikeRegular(tTimeTrace, fInstFreq, fRandList,
 stOptions = STOptions;
 InstanceTemporalResolution = stOptions.InstanceTemporalResolution;
 
+% - Tolerance in phase when rounding to whole spikes
+PHASE_TOLERANCE = 1e-9;
+
 
 % -- Check arguments
 
-if (nargin > 4)
+if (nargin > 5)
    disp('--- STTestSpikeRegular: Extra arguments ignored');
 end
 
@@ -43,8 +57,37 @@ if (nargin < 2)
    return;
 end
 
+if (isempty(tTimeTrace))
+   nSpikeIndices = [];
+   if (nargin < 5)
+      vfPhaseState = [];
+   end
+   return;
+end
+
+
+% -- Integrate the instantaneous frequency
+
+fInstFreq = reshape(fInstFreq .* ones(size(tTimeTrace)), 1, []);
+
+% - Find the phase at the start of the trace, continuing the previous trace
+%   up to the start of this one
+if ((nargin < 5) || isempty(vfPhaseState))
+   fPhaseStart = 0;
+else
+   fPhaseStart = vfPhaseState(1) + fInstFreq(1) * (tTimeTrace(1) - vfPhaseState(2));
+end
+
+% - Phase at the start and end of each bin
+vfBinPhase = fPhaseStart + [0 cumsum(fInstFreq(1:end-1))] .* InstanceTemporalResolution;
+vfBinEndPhase = vfBinPhase + fInstFreq .* InstanceTemporalResolution;
+
+
 % -- Determine the spike indices
 
-nSpikeIndices = find(rem(tTimeTrace, 1 ./ fInstFreq) < InstanceTemporalResolution);    % Test for spikes
+% - A spike occurs in each bin in which the phase passes a whole number
+nSpikeIndices = find(ceil(vfBinPhase - PHASE_TOLERANCE) < (vfBinEndPhase - PHASE_TOLERANCE));
+
+vfPhaseState = [vfBinEndPhase(end) tTimeTrace(end)+InstanceTemporalResolution];
 
 % --- END of STTestSpikeRegular.m ---
@@ -0,0 +1,144 @@
+/* STThreadPool.h - Work-stealing parallel loop for toolbox MEX functions
+ * $Id: STThreadPool.h $
+ *
+ * NOT for command-line use
+ *
+ * Usage: STParallelFor(nNumItems, nNumThreads, fnItem);
+ *
+ * STParallelFor calls fnItem(nItem, nWorker) once for each 'nItem' in
+ * [0, nNumItems), spread over 'nNumThreads' worker threads.  'nWorker' is the
+ * index of the calling worker, in [0, nNumThreads), and may be used to select
+ * per-thread scratch space.  STParallelFor returns when every item is done.
+ *
+ * Items are dealt round-robin onto one queue per worker.  Each worker takes
+ * items from the front of its own queue; when that is empty it steals from
+ * the back of the other queues.  Items of very different cost are therefore
+ * balanced without any central queue.  No new items can be added while the
+ * loop runs, so a worker finishes when every queue is empty.
+ *
+ * The order in which items are run, and the worker which runs each one, are
+ * not deterministic.  Any result that must be reproducible must therefore
+ * depend only on 'nItem'.
+ *
+ * If an item throws an exception, the remaining items are abandoned and the
+ * first exception is re-thrown from STParallelFor in the calling thread.
+ * MATLAB API functions (mx*, mex*) are not thread-safe, and must not be
+ * called from 'fnItem'.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_THREAD_POOL_H
+#define ST_THREAD_POOL_H
+
+#include <stddef.h>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/* --- STDefaultNumThreads - Return the number of hardware threads, at least 1 */
+static inline unsigned STDefaultNumThreads(void)
+{
+   unsigned nNumThreads = std::thread::hardware_concurrency();
+   return (nNumThreads > 0) ? nNumThreads : 1;
+}
+
+
+/* - One worker's queue of item indices */
+struct STWorkQueue {
+   std::mutex           mutex;
+   std::deque<size_t>   items;
+};
+
+
+/* --- STParallelFor - Run fnItem(nItem, nWorker) for every item, over a pool of workers */
+template <typename F>
+void STParallelFor(size_t nNumItems, unsigned nNumThreads, F fnItem)
+{
+   if (nNumItems == 0) return;
+   if (nNumThreads < 1) nNumThreads = 1;
+   if (nNumThreads > nNumItems) nNumThreads = (unsigned) nNumItems;
+
+   /* - Run small loops on the calling thread */
+   if (nNumThreads == 1) {
+      for (size_t nItem = 0; nItem < nNumItems; nItem++) fnItem(nItem, 0u);
+      return;
+   }
+
+   /* - Deal items round-robin onto the worker queues */
+   std::vector<STWorkQueue>   vQueues(nNumThreads);
+   for (size_t nItem = 0; nItem < nNumItems; nItem++) {
+      vQueues[nItem % nNumThreads].items.push_back(nItem);
+   }
+
+   std::atomic<bool>    bAbort(false);
+   std::exception_ptr   pException;
+   std::mutex           mutexException;
+
+   auto fnWorker = [&](unsigned nWorker) {
+      for (;;) {
+         size_t   nItem = 0;
+         bool     bFound = false;
+
+         if (bAbort.load()) return;
+
+         /* - Take from the front of our own queue */
+         {
+            std::lock_guard<std::mutex> lock(vQueues[nWorker].mutex);
+            if (!vQueues[nWorker].items.empty()) {
+               nItem = vQueues[nWorker].items.front();
+               vQueues[nWorker].items.pop_front();
+               bFound = true;
+            }
+         }
+
+         /* - Otherwise steal from the back of another queue */
+         for (unsigned nOffset = 1; !bFound && (nOffset < nNumThreads); nOffset++) {
+            STWorkQueue &victim = vQueues[(nWorker + nOffset) % nNumThreads];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.items.empty()) {
+               nItem = victim.items.back();
+               victim.items.pop_back();
+               bFound = true;
+            }
+         }
+
+         /* - Every queue is empty, so we're finished */
+         if (!bFound) return;
+
+         try {
+            fnItem(nItem, nWorker);
+
+         } catch (...) {
+            std::lock_guard<std::mutex> lock(mutexException);
+            if (!pException) pException = std::current_exception();
+            bAbort.store(true);
+            return;
+         }
+      }
+   };
+
+   /* - The calling thread acts as worker 0 */
+   std::vector<std::thread>   vThreads;
+   for (unsigned nWorker = 1; nWorker < nNumThreads; nWorker++) {
+      vThreads.push_back(std::thread(fnWorker, nWorker));
+   }
+   fnWorker(0u);
+
+   for (size_t nThread = 0; nThread < vThreads.size(); nThread++) {
+      vThreads[nThread].join();
+   }
+
+   if (pException) std::rethrow_exception(pException);
+}
+
+#endif
+
+/* --- END of STThreadPool.h --- */
@@ -0,0 +1,250 @@
+/* STTicks.h - Exact conversion of spike ticks between temporal resolutions
+ * $Id: STTicks.h $
+ *
+ * NOT for command-line use
+ *
+ * Mapped spike trains count time in integer ticks of 'fTemporalResolution'
+ * seconds.  Converting a tick to another resolution by multiplying it by the
+ * floating-point ratio of the resolutions loses precision, so that a spike
+ * can land one tick away from where it should, depending on the order of the
+ * conversions.  Toolbox resolutions are decimal numbers of seconds (such as
+ * 1e-6 or 0.99e-6), so here each resolution is read as an exact decimal
+ * fraction, and ticks are converted with the exact rational ratio between two
+ * resolutions:
+ *
+ *    tick_to = floor(tick_from * nNum / nDen)
+ *
+ * This is computed without overflow as
+ *
+ *    (tick / nDen) * nNum + ((tick % nDen) * nNum) / nDen
+ *
+ * which is exact whenever (nDen - 1) * nNum fits in the arithmetic used.
+ *
+ *    STTickRatioFromResolution  - Read a resolution as a decimal fraction
+ *    STTickRatioBetween         - Ratio for converting ticks between resolutions
+ *    STRescaleTick              - Convert one uint64 tick
+ *    STRescaleTicks             - Convert a column of uint64 ticks
+ *    STRescaleDoubleTicks       - Convert a column of ticks held in doubles
+ *
+ * STRescaleDoubleTicks works on MATLAB [tick addr] spike lists directly.  It
+ * uses SSE2 where available, processing two ticks per instruction, and is
+ * exact for integer ticks below 2^52.  Ticks which are not integers are
+ * rescaled in floating point.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ * Copyright (c) 2026 agent
+ */
+
+#ifndef ST_TICKS_H
+#define ST_TICKS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+   #include <emmintrin.h>
+   #define ST_TICKS_SSE2
+#endif
+
+
+/* - Largest denominator used when reading a resolution, 10^15 */
+#define ST_TICKS_MAX_DECIMAL     1000000000000000ull
+
+/* - Ticks are exact in a double below 2^53; the SSE2 kernel needs 2^52 */
+#define ST_TICKS_DOUBLE_EXACT    4503599627370496.0
+
+
+/* - An exact rational ratio between two tick lengths */
+struct STTickRatio {
+   uint64_t    nNum, nDen;
+};
+
+
+/* --- STTickGCD - Greatest common divisor */
+static inline uint64_t STTickGCD(uint64_t nA, uint64_t nB)
+{
+   while (nB != 0) {
+      uint64_t nR = nA % nB;
+      nA = nB;
+      nB = nR;
+   }
+   return nA;
+}
+
+/* --- STTickRatioFromResolution - Return a resolution in seconds as a reduced decimal fraction
+ *
+ * The smallest power of ten 'nDen' is found for which fResolution * nDen is
+ * an integer, to within the precision of a double.
+ */
+static inline STTickRatio STTickRatioFromResolution(double fResolution)
+{
+   if (!(fResolution > 0) || !(fResolution < 1e6)) {
+      throw std::invalid_argument("Temporal resolutions must be positive and finite");
+   }
+
+   for (uint64_t nDen = 1; nDen <= ST_TICKS_MAX_DECIMAL; nDen *= 10) {
+      double fNum = fResolution * (double) nDen,
+             fRounded = floor(fNum + 0.5);
+
+      if ((fRounded >= 1) && (fabs(fNum - fRounded) <= fRounded * 1e-12)) {
+         STTickRatio ratio = { (uint64_t) fRounded, nDen };
+         uint64_t nGCD = STTickGCD(ratio.nNum, ratio.nDen);
+         ratio.nNum /= nGCD;
+         ratio.nDen /= nGCD;
+         return ratio;
+      }
+   }
+
+   throw std::invalid_argument("Temporal resolutions must be decimal numbers of seconds, no finer than 1e-15");
+}
+
+/* --- STTickRatioBetween - Return the ratio converting ticks of 'fFromResolution' to 'fToResolution'
+ *
+ * The ratio is reduced, and checked so that STRescaleTick cannot overflow.
+ */
+static inline STTickRatio STTickRatioBetween(double fFromResolution, double fToResolution)
+{
+   STTickRatio from = STTickRatioFromResolution(fFromResolution),
+               to = STTickRatioFromResolution(fToResolution),
+               ratio;
+
+   /* - (from.nNum / from.nDen) / (to.nNum / to.nDen), reduced crosswise first */
+   uint64_t nGCD1 = STTickGCD(from.nNum, to.nNum),
+            nGCD2 = STTickGCD(to.nDen, from.nDen);
+   uint64_t nNumA = from.nNum / nGCD1, nNumB = to.nDen / nGCD2,
+            nDenA = from.nDen / nGCD2, nDenB = to.nNum / nGCD1;
+
+   if (((nNumB != 0) && (nNumA > UINT64_MAX / nNumB)) || ((nDenB != 0) && (nDenA > UINT64_MAX / nDenB))) {
+      throw std::invalid_argument("The ratio between these temporal resolutions can't be represented exactly");
+   }
+   ratio.nNum = nNumA * nNumB;
+   ratio.nDen = nDenA * nDenB;
+
+   if ((ratio.nDen > 1) && (ratio.nNum > UINT64_MAX / (ratio.nDen - 1))) {
+      throw std::invalid_argument("The ratio between these temporal resolutions can't be represented exactly");
+   }
+
+   return ratio;
+}
+
+/* --- STTickRatioIsUnit - Is a ratio exactly one? */
+static inline bool STTickRatioIsUnit(const STTickRatio &ratio)
+{
+   return ratio.nNum == ratio.nDen;
+}
+
+
+/* --- STRescaleTick - Return floor(nTick * nNum / nDen), exactly */
+static inline uint64_t STRescaleTick(uint64_t nTick, const STTickRatio &ratio)
+{
+   return (nTick / ratio.nDen) * ratio.nNum + ((nTick % ratio.nDen) * ratio.nNum) / ratio.nDen;
+}
+
+/* --- STRescaleTicks - Rescale 'nCount' ticks in place */
+static inline void STRescaleTicks(uint64_t *anTicks, size_t nCount, const STTickRatio &ratio)
+{
+   size_t nSpike;
+
+   if (STTickRatioIsUnit(ratio)) return;
+
+   if (ratio.nDen == 1) {
+      for (nSpike = 0; nSpike < nCount; nSpike++) anTicks[nSpike] *= ratio.nNum;
+   } else {
+      for (nSpike = 0; nSpike < nCount; nSpike++) anTicks[nSpike] = STRescaleTick(anTicks[nSpike], ratio);
+   }
+}
+
+
+/* --- STRescaleDoubleTick - Rescale one tick held in a double */
+static inline double STRescaleDoubleTick(double fTick, const STTickRatio &ratio)
+{
+   if (!(fTick >= 0) || (fTick >= ST_TICKS_DOUBLE_EXACT * 2) || (fTick != floor(fTick))) {
+      /* - Not an integer tick in the exact range, so rescale in floating point */
+      return floor(fTick * ((double) ratio.nNum / (double) ratio.nDen));
+   }
+   return (double) STRescaleTick((uint64_t) fTick, ratio);
+}
+
+#if defined(ST_TICKS_SSE2)
+/* --- STFloorSSE2 - floor() of two non-negative doubles below 2^52 */
+static inline __m128d STFloorSSE2(__m128d vfX)
+{
+   const __m128d vfMagic = _mm_set1_pd(ST_TICKS_DOUBLE_EXACT),
+                 vfOne = _mm_set1_pd(1.0);
+
+   /* - Adding and subtracting 2^52 rounds to the nearest integer */
+   __m128d vfRounded = _mm_sub_pd(_mm_add_pd(vfX, vfMagic), vfMagic);
+   return _mm_sub_pd(vfRounded, _mm_and_pd(_mm_cmpgt_pd(vfRounded, vfX), vfOne));
+}
+
+/* --- STDivModSSE2 - Exact floor(vfA / fDen) and remainder, for integers below 2^52 */
+static inline __m128d STDivModSSE2(__m128d vfA, __m128d vfDen, __m128d *pvfRem)
+{
+   const __m128d vfZero = _mm_setzero_pd(),
+                 vfOne = _mm_set1_pd(1.0);
+
+   /* - The rounded quotient may be one out either way; fix it with the remainder */
+   __m128d vfQuot = STFloorSSE2(_mm_div_pd(vfA, vfDen)),
+           vfRem = _mm_sub_pd(vfA, _mm_mul_pd(vfQuot, vfDen)),
+           vbLow = _mm_cmplt_pd(vfRem, vfZero),
+           vbHigh = _mm_cmpge_pd(vfRem, vfDen);
+
+   vfQuot = _mm_add_pd(_mm_sub_pd(vfQuot, _mm_and_pd(vbLow, vfOne)), _mm_and_pd(vbHigh, vfOne));
+   vfRem = _mm_add_pd(_mm_sub_pd(vfRem, _mm_and_pd(vbHigh, vfDen)), _mm_and_pd(vbLow, vfDen));
+   *pvfRem = vfRem;
+   return vfQuot;
+}
+#endif
+
+/* --- STRescaleDoubleTicks - Rescale 'nCount' ticks held in doubles, from 'afIn' to 'afOut'
+ *
+ * 'afIn' and 'afOut' may be the same.  Negative or very large ticks are
+ * rescaled in floating point.
+ */
+static inline void STRescaleDoubleTicks(const double *afIn, size_t nCount, const STTickRatio &ratio, double *afOut)
+{
+   size_t nSpike = 0;
+
+   if (STTickRatioIsUnit(ratio)) {
+      if (afOut != afIn) for (nSpike = 0; nSpike < nCount; nSpike++) afOut[nSpike] = afIn[nSpike];
+      return;
+   }
+
+#if defined(ST_TICKS_SSE2)
+   /* - Products below 2^52 are exact in doubles */
+   if ((double) ratio.nNum * (double) ratio.nDen < ST_TICKS_DOUBLE_EXACT) {
+      const __m128d vfNum = _mm_set1_pd((double) ratio.nNum),
+                    vfDen = _mm_set1_pd((double) ratio.nDen),
+                    vfLimit = _mm_set1_pd((ratio.nNum > ratio.nDen) ? ST_TICKS_DOUBLE_EXACT * ratio.nDen / ratio.nNum
+                                                                    : ST_TICKS_DOUBLE_EXACT),
+                    vfZero = _mm_setzero_pd();
+
+      for (; nSpike + 2 <= nCount; nSpike += 2) {
+         __m128d vfTick = _mm_loadu_pd(afIn + nSpike);
+
+         /* - Fall back to the scalar path outside the exact range */
+         if (_mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(vfTick, vfZero), _mm_cmplt_pd(vfTick, vfLimit))) != 3) {
+            afOut[nSpike] = STRescaleDoubleTick(afIn[nSpike], ratio);
+            afOut[nSpike+1] = STRescaleDoubleTick(afIn[nSpike+1], ratio);
+            continue;
+         }
+
+         __m128d vfRem, vfRemScaled,
+                 vfQuot = STDivModSSE2(vfTick, vfDen, &vfRem),
+                 vfFrac = STDivModSSE2(_mm_mul_pd(vfRem, vfNum), vfDen, &vfRemScaled);
+
+         _mm_storeu_pd(afOut + nSpike, _mm_add_pd(_mm_mul_pd(vfQuot, vfNum), vfFrac));
+      }
+   }
+#endif
+
+   for (; nSpike < nCount; nSpike++) afOut[nSpike] = STRescaleDoubleTick(afIn[nSpike], ratio);
+}
+
+#endif  /* ST_TICKS_H */
+
+/* --- END of STTicks.h --- */
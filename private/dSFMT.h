@@ -0,0 +1,350 @@
+/* dSFMT.h - Double precision SIMD-oriented Fast Mersenne Twister (dSFMT-19937)
+ * $Id: dSFMT.h $
+ *
+ * NOT for command-line use
+ *
+ * This header implements the dSFMT-19937 generator of Saito and Matsumoto,
+ * which produces double precision values directly from a 128-bit recurrence
+ * (one recurrence step gives two doubles), instead of combining two tempered
+ * 32-bit MT19937 outputs per double as genrand_res53() does.  It is used as
+ * the bulk-generation backend of twister.cpp.
+ *
+ * The recurrence is computed with SSE2 instructions when the compiler
+ * targets SSE2, and with 64-bit integer arithmetic otherwise.  Conversion
+ * from the native [1,2) range to [0,1) uses AVX2 or SSE2 where available.
+ * All code paths produce identical sequences.
+ *
+ * The state is held in a 'dsfmt_state' structure, so any number of
+ * generators may be used at once.
+ *
+ * Reference: M. Saito and M. Matsumoto, "SIMD-oriented Fast Mersenne Twister:
+ * a 128-bit Pseudorandom Number Generator", Monte Carlo and Quasi-Monte Carlo
+ * Methods 2006, Springer, 2008, pp 607--622.
+ */
+
+/* Author: agent <agent@local>
+ * Created: 16th October, 2026
+ */
+
+/*
+   Copyright (c) 2007, 2008, 2009 Mutsuo Saito, Makoto Matsumoto
+   and Hiroshima University.
+   All rights reserved.
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are
+   met:
+
+       * Redistributions of source code must retain the above copyright
+         notice, this list of conditions and the following disclaimer.
+       * Redistributions in binary form must reproduce the above
+         copyright notice, this list of conditions and the following
+         disclaimer in the documentation and/or other materials provided
+         with the distribution.
+       * Neither the name of the Hiroshima University nor the names of
+         its contributors may be used to endorse or promote products
+         derived from this software without specific prior written
+         permission.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef DSFMT_H
+#define DSFMT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define DSFMT_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define DSFMT_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+
+/* Parameters for dSFMT-19937 */
+#define DSFMT_MEXP 19937
+#define DSFMT_N ((DSFMT_MEXP - 128) / 104 + 1)
+#define DSFMT_N64 (DSFMT_N * 2)
+#define DSFMT_LOW_MASK  0x000FFFFFFFFFFFFFULL
+#define DSFMT_HIGH_CONST 0x3FF0000000000000ULL
+#define DSFMT_SR 12
+#define DSFMT_POS1 117
+#define DSFMT_SL1 19
+#define DSFMT_MSK1 0x000ffafffffffb3fULL
+#define DSFMT_MSK2 0x000ffdfffc90fffdULL
+#define DSFMT_FIX1 0x90014964b32f4329ULL
+#define DSFMT_FIX2 0x3b8d12ac548a7c7aULL
+#define DSFMT_PCV1 0x3d84e1ac0dc82880ULL
+#define DSFMT_PCV2 0x0000000000000001ULL
+
+/* Number of 32-bit words in a saved state:  the status array (including the
+ * "lung" word) followed by the read index */
+#define DSFMT_STATE_WORDS ((DSFMT_N + 1) * 4 + 1)
+
+typedef union {
+#ifdef DSFMT_HAVE_SSE2
+    __m128i si;
+    __m128d sd;
+#endif
+    uint64_t u[2];
+    uint32_t u32[4];
+    double d[2];
+} dsfmt_w128;
+
+typedef struct {
+    dsfmt_w128 status[DSFMT_N + 1];  /* status[DSFMT_N] is the "lung" */
+    int idx;                         /* Read index into the status array, as doubles */
+} dsfmt_state;
+
+
+/* - One step of the recurrence, using 64-bit integer arithmetic */
+static inline void dsfmt_do_recursion_scalar(dsfmt_w128 *r, const dsfmt_w128 *a,
+                                             const dsfmt_w128 *b, dsfmt_w128 *lung)
+{
+    uint64_t t0 = a->u[0], t1 = a->u[1];
+    uint64_t L0 = lung->u[0], L1 = lung->u[1];
+
+    lung->u[0] = (t0 << DSFMT_SL1) ^ (L1 >> 32) ^ (L1 << 32) ^ b->u[0];
+    lung->u[1] = (t1 << DSFMT_SL1) ^ (L0 >> 32) ^ (L0 << 32) ^ b->u[1];
+    r->u[0] = (lung->u[0] >> DSFMT_SR) ^ (lung->u[0] & DSFMT_MSK1) ^ t0;
+    r->u[1] = (lung->u[1] >> DSFMT_SR) ^ (lung->u[1] & DSFMT_MSK2) ^ t1;
+}
+
+/* - Regenerate the whole status array, using 64-bit integer arithmetic */
+static inline void dsfmt_gen_rand_all_scalar(dsfmt_state *state)
+{
+    dsfmt_w128 *s = state->status, lung = s[DSFMT_N];
+    int i;
+
+    for (i = 0; i < DSFMT_N - DSFMT_POS1; i++) {
+        dsfmt_do_recursion_scalar(&s[i], &s[i], &s[i + DSFMT_POS1], &lung);
+    }
+    for (; i < DSFMT_N; i++) {
+        dsfmt_do_recursion_scalar(&s[i], &s[i], &s[i + DSFMT_POS1 - DSFMT_N], &lung);
+    }
+    s[DSFMT_N] = lung;
+}
+
+#ifdef DSFMT_HAVE_SSE2
+/* - Regenerate the whole status array, using SSE2 */
+static inline void dsfmt_gen_rand_all_sse2(dsfmt_state *state)
+{
+    dsfmt_w128 *s = state->status;
+    const __m128i mask = _mm_set_epi64x((long long) DSFMT_MSK2, (long long) DSFMT_MSK1);
+    __m128i lung = s[DSFMT_N].si;
+    int i;
+
+    for (i = 0; i < DSFMT_N; i++) {
+        const __m128i x = s[i].si;
+        const __m128i b = s[(i < DSFMT_N - DSFMT_POS1) ? (i + DSFMT_POS1) : (i + DSFMT_POS1 - DSFMT_N)].si;
+        __m128i y, z, v, w;
+
+        z = _mm_slli_epi64(x, DSFMT_SL1);
+        y = _mm_shuffle_epi32(lung, 0x1b);
+        z = _mm_xor_si128(z, b);
+        y = _mm_xor_si128(y, z);
+        v = _mm_srli_epi64(y, DSFMT_SR);
+        w = _mm_and_si128(y, mask);
+        v = _mm_xor_si128(v, x);
+        s[i].si = _mm_xor_si128(v, w);
+        lung = y;
+    }
+    s[DSFMT_N].si = lung;
+}
+#endif
+
+/* - Regenerate the whole status array, with the fastest available code */
+static inline void dsfmt_gen_rand_all(dsfmt_state *state)
+{
+#ifdef DSFMT_HAVE_SSE2
+    dsfmt_gen_rand_all_sse2(state);
+#else
+    dsfmt_gen_rand_all_scalar(state);
+#endif
+}
+
+/* - Force the status array into the [1,2) double format */
+static inline void dsfmt_initial_mask(dsfmt_state *state)
+{
+    int i;
+    for (i = 0; i < DSFMT_N; i++) {
+        state->status[i].u[0] = (state->status[i].u[0] & DSFMT_LOW_MASK) | DSFMT_HIGH_CONST;
+        state->status[i].u[1] = (state->status[i].u[1] & DSFMT_LOW_MASK) | DSFMT_HIGH_CONST;
+    }
+}
+
+/* - Ensure the generator has the full period */
+static inline void dsfmt_period_certification(dsfmt_state *state)
+{
+    uint64_t tmp0 = state->status[DSFMT_N].u[0] ^ DSFMT_FIX1;
+    uint64_t tmp1 = state->status[DSFMT_N].u[1] ^ DSFMT_FIX2;
+    uint64_t inner = (tmp0 & DSFMT_PCV1) ^ (tmp1 & DSFMT_PCV2);
+    int i;
+
+    for (i = 32; i > 0; i >>= 1) {
+        inner ^= inner >> i;
+    }
+    if ((inner & 1) == 0) {
+        /* - PCV2 has its lowest bit set, so flipping that bit fixes the period */
+        state->status[DSFMT_N].u[1] ^= 1;
+    }
+}
+
+/* - Initialise the generator with a 32-bit seed */
+static inline void dsfmt_init_gen_rand(dsfmt_state *state, uint32_t seed)
+{
+    uint32_t *psfmt = &state->status[0].u32[0];
+    int i;
+
+    psfmt[0] = seed;
+    for (i = 1; i < (DSFMT_N + 1) * 4; i++) {
+        psfmt[i] = 1812433253UL * (psfmt[i - 1] ^ (psfmt[i - 1] >> 30)) + i;
+    }
+    dsfmt_initial_mask(state);
+    dsfmt_period_certification(state);
+    state->idx = DSFMT_N64;
+}
+
+static inline uint32_t dsfmt_ini_func1(uint32_t x) { return (x ^ (x >> 27)) * (uint32_t) 1664525UL; }
+static inline uint32_t dsfmt_ini_func2(uint32_t x) { return (x ^ (x >> 27)) * (uint32_t) 1566083941UL; }
+
+/* - Initialise the generator with an array of 32-bit seeds */
+static inline void dsfmt_init_by_array(dsfmt_state *state, const uint32_t init_key[], int key_length)
+{
+    uint32_t *psfmt32 = &state->status[0].u32[0], r;
+    const int size = (DSFMT_N + 1) * 4;
+    const int lag = (size >= 623) ? 11 : ((size >= 68) ? 7 : ((size >= 39) ? 5 : 3));
+    const int mid = (size - lag) / 2;
+    int i, j, count;
+
+    memset(state->status, 0x8b, sizeof(state->status));
+    count = (key_length + 1 > size) ? (key_length + 1) : size;
+
+    r = dsfmt_ini_func1(psfmt32[0] ^ psfmt32[mid % size] ^ psfmt32[(size - 1) % size]);
+    psfmt32[mid % size] += r;
+    r += key_length;
+    psfmt32[(mid + lag) % size] += r;
+    psfmt32[0] = r;
+    count--;
+    for (i = 1, j = 0; (j < count) && (j < key_length); j++) {
+        r = dsfmt_ini_func1(psfmt32[i] ^ psfmt32[(i + mid) % size] ^ psfmt32[(i + size - 1) % size]);
+        psfmt32[(i + mid) % size] += r;
+        r += init_key[j] + i;
+        psfmt32[(i + mid + lag) % size] += r;
+        psfmt32[i] = r;
+        i = (i + 1) % size;
+    }
+    for (; j < count; j++) {
+        r = dsfmt_ini_func1(psfmt32[i] ^ psfmt32[(i + mid) % size] ^ psfmt32[(i + size - 1) % size]);
+        psfmt32[(i + mid) % size] += r;
+        r += i;
+        psfmt32[(i + mid + lag) % size] += r;
+        psfmt32[i] = r;
+        i = (i + 1) % size;
+    }
+    for (j = 0; j < size; j++) {
+        r = dsfmt_ini_func2(psfmt32[i] + psfmt32[(i + mid) % size] + psfmt32[(i + size - 1) % size]);
+        psfmt32[(i + mid) % size] ^= r;
+        r -= i;
+        psfmt32[(i + mid + lag) % size] ^= r;
+        psfmt32[i] = r;
+        i = (i + 1) % size;
+    }
+    dsfmt_initial_mask(state);
+    dsfmt_period_certification(state);
+    state->idx = DSFMT_N64;
+}
+
+/* - Return a single value on [0,1) */
+static inline double dsfmt_genrand_close_open(dsfmt_state *state)
+{
+    if (state->idx >= DSFMT_N64) {
+        dsfmt_gen_rand_all(state);
+        state->idx = 0;
+    }
+    return (&state->status[0].d[0])[state->idx++] - 1.0;
+}
+
+/* - Copy 'nCount' values on [1,2) to [0,1) */
+static inline void dsfmt_convert_close_open(double *dst, const double *src, long nCount)
+{
+    long i = 0;
+#if defined(DSFMT_HAVE_AVX2)
+    const __m256d one4 = _mm256_set1_pd(1.0);
+    for (; i + 4 <= nCount; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_sub_pd(_mm256_loadu_pd(src + i), one4));
+    }
+#elif defined(DSFMT_HAVE_SSE2)
+    const __m128d one2 = _mm_set1_pd(1.0);
+    for (; i + 2 <= nCount; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_sub_pd(_mm_loadu_pd(src + i), one2));
+    }
+#endif
+    for (; i < nCount; i++) {
+        dst[i] = src[i] - 1.0;
+    }
+}
+
+/* - Fill an array with values on [0,1).  The values are exactly those that
+ *   'nCount' calls to dsfmt_genrand_close_open() would return */
+static inline void dsfmt_fill_close_open(dsfmt_state *state, double *adArray, long nCount)
+{
+    while (nCount > 0) {
+        long nAvailable;
+
+        if (state->idx >= DSFMT_N64) {
+            dsfmt_gen_rand_all(state);
+            state->idx = 0;
+        }
+
+        nAvailable = DSFMT_N64 - state->idx;
+        if (nAvailable > nCount) nAvailable = nCount;
+
+        dsfmt_convert_close_open(adArray, &state->status[0].d[0] + state->idx, nAvailable);
+        state->idx += (int) nAvailable;
+        adArray += nAvailable;
+        nCount -= nAvailable;
+    }
+}
+
+/* - Fill an array with values on [0,1), using only scalar code */
+static inline void dsfmt_fill_close_open_scalar(dsfmt_state *state, double *adArray, long nCount)
+{
+    while (nCount > 0) {
+        long nAvailable, i;
+        const double *adSource;
+
+        if (state->idx >= DSFMT_N64) {
+            dsfmt_gen_rand_all_scalar(state);
+            state->idx = 0;
+        }
+
+        nAvailable = DSFMT_N64 - state->idx;
+        if (nAvailable > nCount) nAvailable = nCount;
+
+        adSource = &state->status[0].d[0] + state->idx;
+        for (i = 0; i < nAvailable; i++) adArray[i] = adSource[i] - 1.0;
+        state->idx += (int) nAvailable;
+        adArray += nAvailable;
+        nCount -= nAvailable;
+    }
+}
+
+#endif
+
+/* --- END of dSFMT.h --- */
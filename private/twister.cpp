@@ -1,411 +1,592 @@
-/*
- * twister.cpp  Mex wrapper for the Mersenne Twister RNG.
-
-%TWISTER   Uniformly distributed pseudo-random numbers.
-%   R = TWISTER(N) returns an N-by-N matrix containing pseudo-random values
-%   drawn from a uniform distribution on the unit interval.  TWISTER(M,N) or
-%   TWISTER([M,N]) returns an M-by-N matrix.  TWISTER(M,N,P,...) or
-%   TWISTER([M,N,P,...]) generates an M-by-N-by-P-by-... array.  TWISTER with
-%   no arguments returns a scalar.  TWISTER(SIZE(A)) returns an array the same
-%   size as A.
-%
-%   TWISTER produces pseudo-random numbers using the Mersenne Twister
-%   algorithm by Nishimura and Matsumoto, and is an alternative to the
-%   built-in function RAND in MATLAB.  It creates double precision values in
-%   the closed interval [0, 1-2^(-53)], and can generate 2^19937 - 1 values
-%   before repeating itself.
-%
-%   The sequence of numbers generated is determined by the internal state of
-%   the generator.  Since MATLAB resets the state at start-up, the sequence of
-%   numbers generated will be the same in each session unless the state is
-%   changed.  Setting the generator to different states leads to unique
-%   computations, but does not improve any statistical properties.  Setting
-%   the generator to the same fixed state allows computations to be repeated.
-%
-%   TWISTER('state',J), where J is a scalar integer, initializes the state of
-%   the generator.  There is no simple connection between the sequence of
-%   random numbers generated from TWISTER('state',J) and TWISTER('state',J+1).
-%   TWISTER('state',0) resets the generator to its initial state.  J may also
-%   be an array of integers with length less than 625.
-%
-%   S = TWISTER('state') returns a 625-element vector of UINT32 values
-%   containing the current state of the uniform generator.
-%
-%   TWISTER('state',S), where S is the output of TWISTER('state'), sets the
-%   state of the generator to S.
-%
-%    Examples:
-%
-%       Three ways to initialize TWISTER differently each time:
-%          twister('state',sum(100*clock))
-%          twister('state',100*clock)
-%          twister('state',2^32*rand(n,1)) % where n < 625.
-%
-%       Generate 100 values, reset the state, and repeat the sequence:
-%          s = twister('state');
-%          u1 = twister(100,1);
-%          twister('state',s);
-%          u2 = twister(100,1); % contains exactly the same values as u1
-%
-%       Generate uniform values from the interval [a, b]:
-%          r = a + (b-a).*twister(100,1);
-%
-%       Generate integers uniform on the set 1:n:
-%          r = 1 + floor(n.*twister(100,1));
-%
-%       Generate standard normal random values using the inversion method:
-%          z = -sqrt(2).*erfcinv(2*twister(100,1));
-%
-%   Mex file derived from a copyrighted C program by Takuji Nishimura and
-%   Makoto Matsumoto.
-%
-%   Reference: M. Matsumoto and T. Nishimura, "Mersenne Twister: A
-%   623-Dimensionally Equidistributed Uniform Pseudo-Random Number Generator",
-%   ACM Transactions on Modeling and Computer Simulation, Vol. 8, No. 1,
-%   January 1998, pp 3--30.
-%
-%   See also RAND, RANDN.
-
-%   Note:  Initializing TWISTER to the scalar integer state 0 actually
-%   corresponds to the C call init_genrand(5489).
-
-%   Written by Peter Perkins, The MathWorks, Inc.
-%   Revision: 1.0  Date: 2004/12/23
-%   This function is not supported by The MathWorks, Inc.
-%
-%   Requires MATLAB R13.
-
- */
-
-
-#include "mex.h"
-#include "matrix.h"
-#include <math.h>
-#include <string.h>
-#include <ctype.h>
-
-
-/****************************************************************************
- *
- * Mersenne Twister code:
- */
-
-
-/*
-   A C-program for MT19937, with initialization improved 2002/1/26.
-   Coded by Takuji Nishimura and Makoto Matsumoto.
-
-   Before using, initialize the state by using init_genrand(seed)
-   or init_by_array(init_key, key_length).
-
-   Copyright (C) 1997 - 2002, Makoto Matsumoto and Takuji Nishimura,
-   All rights reserved.
-
-   Redistribution and use in source and binary forms, with or without
-   modification, are permitted provided that the following conditions
-   are met:
-
-     1. Redistributions of source code must retain the above copyright
-        notice, this list of conditions and the following disclaimer.
-
-     2. Redistributions in binary form must reproduce the above copyright
-        notice, this list of conditions and the following disclaimer in the
-        documentation and/or other materials provided with the distribution.
-
-     3. The names of its contributors may not be used to endorse or promote
-        products derived from this software without specific prior written
-        permission.
-
-   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
-   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
-   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
-   A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
-   CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
-   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
-   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
-   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
-   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-
-
-   Any feedback is very welcome.
-   http://www.math.keio.ac.jp/matumoto/emt.html
-   email: matumoto@math.keio.ac.jp
-*/
-
-/* Period parameters */
-#define N 624
-#define M 397
-#define MATRIX_A 0x9908b0dfUL   /* constant vector a */
-#define UPPER_MASK 0x80000000UL /* most significant w-r bits */
-#define LOWER_MASK 0x7fffffffUL /* least significant r bits */
-
-static unsigned long mt[N]; /* the array for the state vector  */
-static int mti=N+1; /* mti==N+1 means mt[N] is not initialized */
-
-/* initializes mt[N] with a seed */
-void init_genrand(unsigned long s)
-{
-    mt[0]= s & 0xffffffffUL;
-    for (mti=1; mti<N; mti++) {
-        mt[mti] =
-	    (1812433253UL * (mt[mti-1] ^ (mt[mti-1] >> 30)) + mti);
-        /* See Knuth TAOCP Vol2. 3rd Ed. P.106 for multiplier. */
-        /* In the previous versions, MSBs of the seed affect   */
-        /* only MSBs of the array mt[].                        */
-        /* 2002/01/09 modified by Makoto Matsumoto             */
-        mt[mti] &= 0xffffffffUL;
-        /* for >32 bit machines */
-    }
-}
-
-/* initialize by an array with array-length */
-/* init_key is the array for initializing keys */
-/* key_length is its length */
-void init_by_array(unsigned long init_key[], unsigned long key_length)
-{
-    int i, j, k;
-    init_genrand(19650218UL);
-    i=1; j=0;
-    k = (N>key_length ? N : key_length);
-    for (; k; k--) {
-        mt[i] = (mt[i] ^ ((mt[i-1] ^ (mt[i-1] >> 30)) * 1664525UL))
-          + init_key[j] + j; /* non linear */
-        mt[i] &= 0xffffffffUL; /* for WORDSIZE > 32 machines */
-        i++; j++;
-        if (i>=N) { mt[0] = mt[N-1]; i=1; }
-        if (j>=key_length) j=0;
-    }
-    for (k=N-1; k; k--) {
-        mt[i] = (mt[i] ^ ((mt[i-1] ^ (mt[i-1] >> 30)) * 1566083941UL))
-          - i; /* non linear */
-        mt[i] &= 0xffffffffUL; /* for WORDSIZE > 32 machines */
-        i++;
-        if (i>=N) { mt[0] = mt[N-1]; i=1; }
-    }
-
-    mt[0] = 0x80000000UL; /* MSB is 1; assuring non-zero initial array */
-}
-
-/* generates a random number on [0,0xffffffff]-interval */
-unsigned long genrand_int32(void)
-{
-    unsigned long y;
-    static unsigned long mag01[2]={0x0UL, MATRIX_A};
-    /* mag01[x] = x * MATRIX_A  for x=0,1 */
-
-    if (mti >= N) { /* generate N words at one time */
-        int kk;
-
-        if (mti == N+1)   /* if init_genrand() has not been called, */
-            init_genrand(5489UL); /* a default initial seed is used */
-
-        for (kk=0;kk<N-M;kk++) {
-            y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-            mt[kk] = mt[kk+M] ^ (y >> 1) ^ mag01[y & 0x1UL];
-        }
-        for (;kk<N-1;kk++) {
-            y = (mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK);
-            mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & 0x1UL];
-        }
-        y = (mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK);
-        mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & 0x1UL];
-
-        mti = 0;
-    }
-
-    y = mt[mti++];
-
-    /* Tempering */
-    y ^= (y >> 11);
-    y ^= (y << 7) & 0x9d2c5680UL;
-    y ^= (y << 15) & 0xefc60000UL;
-    y ^= (y >> 18);
-
-    return y;
-}
-
-/* generates a random number on [0,0x7fffffff]-interval */
-long genrand_int31(void)
-{
-    return (long)(genrand_int32()>>1);
-}
-
-/* generates a random number on [0,1]-real-interval */
-double genrand_real1(void)
-{
-    return genrand_int32()*(1.0/4294967295.0);
-    /* divided by 2^32-1 */
-}
-
-/* generates a random number on [0,1)-real-interval */
-double genrand_real2(void)
-{
-    return genrand_int32()*(1.0/4294967296.0);
-    /* divided by 2^32 */
-}
-
-/* generates a random number on (0,1)-real-interval */
-double genrand_real3(void)
-{
-    return (((double)genrand_int32()) + 0.5)*(1.0/4294967296.0);
-    /* divided by 2^32 */
-}
-
-/* generates a random number on [0,1) with 53-bit resolution*/
-double genrand_res53(void)
-{
-    unsigned long a=genrand_int32()>>5, b=genrand_int32()>>6;
-    return(a*67108864.0+b)*(1.0/9007199254740992.0);
-}
-/* These real versions are due to Isaku Wada, 2002/01/09 added */
-
-
-/****************************************************************************
- *
- * MATLAB code:
- */
-
-/* the gateway function */
-void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
-{
-    int errMsgNum = 0;
-
-    /* First time through.
-     */
-    if (mti == N+1) init_genrand(5489UL);
-
-    if (nlhs > 1) {
-        mexErrMsgIdAndTxt("twister:TooManyOutputs", "Too many output arguments.");
-    }
-
-    /* No args given, return a scalar.
-     */
-    if (nrhs == 0) {
-        plhs[0] = mxCreateDoubleScalar(genrand_res53());
-
-    } else if ((nrhs > 0) && (mxIsChar(prhs[0]))) {
-        char theString[10], *p = theString;
-        if (mxGetString(prhs[0],theString,sizeof(theString))) {
-            mexErrMsgIdAndTxt("twister:BadStringArg", "Invalid string arg.");
-        }
-        for (;*p;p++) *p = tolower(*p); /* need strncasecmp */
-        if (strncmp(theString,"state",sizeof(theString))) {
-            mexErrMsgIdAndTxt("twister:BadStringArg", "Invalid string arg.");
-        } else if (nrhs > 2) {
-            mexErrMsgIdAndTxt("twister:TooManyInputs", "Too many input arguments.");
-        }
-
-        /* Return the old state when setting the state only if asked for, but
-         * always return current state when reading the state.
-         */
-        if ((nlhs > 0) || (nrhs == 1)) {
-            plhs[0] = mxCreateNumericMatrix(1,N+1,mxUINT32_CLASS,mxREAL);
-            unsigned long *q = mt, *p = (unsigned long*)mxGetData(plhs[0]);
-            for (int i=N; i; i--) *p++ = *q++;
-            *p++ = mti;
-        }
-
-        /* Init or set the state.
-         */
-        if (nrhs == 2) {
-            unsigned long initLen = (unsigned long)mxGetNumberOfElements(prhs[1]);
-            if (initLen == 1) {
-                /* M&N's default initializer (see genrand_int32) is
-                 * 5489UL, make zero do the same thing as that.
-                 */
-                unsigned long initVal = (unsigned long)mxGetScalar(prhs[1]);
-                if (initVal == 0) initVal = 5489UL;
-                init_genrand(initVal);
-            } else if (mxIsDouble(prhs[1])) {
-                if (initLen <= N) {
-                    double *q = (double*)mxGetData(prhs[1]);
-                    unsigned long init[N], *p = init;
-                    for (int i=initLen; i; i--) *p++ = (unsigned long) *q++;
-                    init_by_array(init, initLen);
-                } else {
-                    mexErrMsgIdAndTxt("twister:InvalidInitLen", "Initializer J must have fewer than 625 elements.");
-                }
-            } else if (mxIsUint32(prhs[1])) {
-                unsigned long stateLen = (unsigned long)mxGetNumberOfElements(prhs[1]);
-                unsigned long *state = (unsigned long*)mxGetData(prhs[1]);
-                if ((stateLen == N+1) && (state[N] <= N)) {
-                    unsigned long *q = state, *p = mt;
-                    for (int i=N; i; i--) *p++ = *q++;
-                    mti = (int) *q++;
-                } else {
-                    mexErrMsgIdAndTxt("twister:InvalidStateLen", "Invalid state vector S.");
-                }
-            } else {
-                mexErrMsgIdAndTxt("twister:InvalidInitOrState", "Second input must be an initializer or a state vector.");
-            }
-        }
-
-    } else {
-        int nelem, localDims[10];
-        int *dims = localDims;
-        int ndim = (nrhs == 1) ? mxGetNumberOfElements(prhs[0]) : nrhs;
-
-        if (ndim > 10) {
-            dims = (int *)mxCalloc(ndim, sizeof(int));
-        }
-
-        /* Individual size args given.
-         */
-        if (nrhs > 1) {
-            int *p = dims;
-            nelem = 1;
-            for (int i=0; i<ndim; i++) {
-                if ((!mxIsDouble(prhs[i])) || (mxGetNumberOfElements(prhs[i])!=1) || mxIsComplex(prhs[i])) {
-                    errMsgNum = 101; goto cleanup;
-                }
-                nelem *= *p++ = (int)mxGetScalar(prhs[i]);
-            }
-
-        /* Size vector given.
-         */
-        } else { /* nrhs == 1, nrhs==0 has already been weeded out */
-            if ((!mxIsDouble(prhs[0])) || (mxGetNumberOfElements(prhs[0])<1) ||  mxIsComplex(prhs[0])) {
-                errMsgNum = 102; goto cleanup;
-
-            /* Single size given, we'll return a square matrix.
-             */
-            } else if (ndim == 1) {
-                ndim = 2;
-                int n = (int)mxGetScalar(prhs[0]);
-                dims[0] = n; dims[1] = n;
-                nelem = n*n;
-
-            /* Size vector.
-             */
-            } else {
-                int *p = dims;
-                double *q = (double*)mxGetData(prhs[0]);
-                nelem = 1;
-                for (int i=ndim; i; i--) nelem *= *p++ = (int)*q++;
-            }
-        }
-
-        for (int i=0; i<ndim; i++) {
-            if ((dims[i] < 0) || dims[i] > INT_MAX) {
-                errMsgNum = 103; goto cleanup;
-            }
-        }
-
-        /* Create the output matrix, get a pointer to its data, and fill it
-         * in with random values.
-         */
-        {
-        plhs[0] = mxCreateNumericArray(ndim,dims,mxDOUBLE_CLASS,mxREAL);
-        double *r = (double*) mxGetData(plhs[0]);
-        for (int i=nelem; i; i--,r++) *r = genrand_res53();
-        }
-
-cleanup:
-        if (dims != localDims) mxFree((void *)dims);
-        if (errMsgNum) {
-            mexErrMsgIdAndTxt("twister:InvalidSize", "Invalid output size.");
-        }
-    }
-}
+/*
+ * twister.cpp  Mex wrapper for the Mersenne Twister RNG.
+
+%TWISTER   Uniformly distributed pseudo-random numbers.
+%   R = TWISTER(N) returns an N-by-N matrix containing pseudo-random values
+%   drawn from a uniform distribution on the unit interval.  TWISTER(M,N) or
+%   TWISTER([M,N]) returns an M-by-N matrix.  TWISTER(M,N,P,...) or
+%   TWISTER([M,N,P,...]) generates an M-by-N-by-P-by-... array.  TWISTER with
+%   no arguments returns a scalar.  TWISTER(SIZE(A)) returns an array the same
+%   size as A.
+%
+%   TWISTER produces pseudo-random numbers using the Mersenne Twister
+%   algorithm by Nishimura and Matsumoto, and is an alternative to the
+%   built-in function RAND in MATLAB.  It creates double precision values in
+%   the closed interval [0, 1-2^(-53)], and can generate 2^19937 - 1 values
+%   before repeating itself.
+%
+%   The sequence of numbers generated is determined by the internal state of
+%   the generator.  Since MATLAB resets the state at start-up, the sequence of
+%   numbers generated will be the same in each session unless the state is
+%   changed.  Setting the generator to different states leads to unique
+%   computations, but does not improve any statistical properties.  Setting
+%   the generator to the same fixed state allows computations to be repeated.
+%
+%   TWISTER('state',J), where J is a scalar integer, initializes the state of
+%   the generator.  There is no simple connection between the sequence of
+%   random numbers generated from TWISTER('state',J) and TWISTER('state',J+1).
+%   TWISTER('state',0) resets the generator to its initial state.  J may also
+%   be an array of integers with length less than 625.
+%
+%   S = TWISTER('state') returns a 625-element vector of UINT32 values
+%   containing the current state of the uniform generator.
+%
+%   TWISTER('state',S), where S is the output of TWISTER('state'), sets the
+%   state of the generator to S.
+%
+%   H = TWISTER('create') creates a new generator and returns a UINT32 handle
+%   to it.  The new generator is independent of the default generator used
+%   by TWISTER(N), and of every other generator.  TWISTER('create',J) seeds the
+%   new generator as TWISTER('state',J) would.
+%
+%   TWISTER('seed',H,J) or TWISTER('seed',H,S) reseeds or sets the state of
+%   generator H.  S = TWISTER('getstate',H) returns its state, in the same
+%   format as TWISTER('state').
+%
+%   R = TWISTER('rand',H,M,N,...) returns values from generator H, with the
+%   size arguments interpreted as for TWISTER(M,N,...).
+%
+%   TWISTER('jump',H,K) advances generator H by 2^K 32-bit outputs, without
+%   generating them.  Each double value consumes two outputs.  K defaults to
+%   128.
+%
+%   HS = TWISTER('substreams',NS,J,K) creates NS generators from the single
+%   seed J.  The first is seeded as by TWISTER('create',J), and each subsequent
+%   generator starts 2^K outputs further along the same sequence, so the
+%   substreams never overlap in practice.  K defaults to 128.  The substreams
+%   depend only on J and K, so work shared out over them gives the same
+%   results regardless of the number of threads or the order of the work.
+%
+%   TWISTER('destroy',H) frees generator H.  H may be a vector of handles.
+%
+%   TWISTER('generator','dsfmt') switches the default generator to dSFMT, the
+%   double precision SIMD-oriented Fast Mersenne Twister by Saito and
+%   Matsumoto.  dSFMT produces double values directly, two per step of its
+%   recurrence, and fills large arrays several times faster than the original
+%   algorithm.  Its values lie in the interval [0, 1-2^(-52)], and it has the
+%   same period of 2^19937 - 1.  While dSFMT is selected, TWISTER('state',...)
+%   initializes, returns and sets the dSFMT state, which is a 769-element
+%   UINT32 vector.  TWISTER('generator','mt19937') switches back to the
+%   original algorithm.  Each algorithm keeps its own state while the other is
+%   selected.  G = TWISTER('generator') returns the name of the selected
+%   algorithm.  Generators created with TWISTER('create') always use the
+%   original algorithm.
+%
+%    Examples:
+%
+%       Three ways to initialize TWISTER differently each time:
+%          twister('state',sum(100*clock))
+%          twister('state',100*clock)
+%          twister('state',2^32*rand(n,1)) % where n < 625.
+%
+%       Generate 100 values, reset the state, and repeat the sequence:
+%          s = twister('state');
+%          u1 = twister(100,1);
+%          twister('state',s);
+%          u2 = twister(100,1); % contains exactly the same values as u1
+%
+%       Generate uniform values from the interval [a, b]:
+%          r = a + (b-a).*twister(100,1);
+%
+%       Generate integers uniform on the set 1:n:
+%          r = 1 + floor(n.*twister(100,1));
+%
+%       Generate reproducible values in four independent substreams:
+%          hs = twister('substreams',4,5489);
+%          u = twister('rand',hs(3),100,1);
+%          twister('destroy',hs);
+%
+%       Fill a large array quickly, reproducibly:
+%          twister('generator','dsfmt');
+%          twister('state',5489);
+%          u = twister(4*1024*1024,1);
+%
+%       Generate standard normal random values using the inversion method:
+%          z = -sqrt(2).*erfcinv(2*twister(100,1));
+%
+%   Mex file derived from a copyrighted C program by Takuji Nishimura and
+%   Makoto Matsumoto.
+%
+%   Reference: M. Matsumoto and T. Nishimura, "Mersenne Twister: A
+%   623-Dimensionally Equidistributed Uniform Pseudo-Random Number Generator",
+%   ACM Transactions on Modeling and Computer Simulation, Vol. 8, No. 1,
+%   January 1998, pp 3--30.
+%
+%   Jump-ahead: H. Haramoto, M. Matsumoto, T. Nishimura, F. Panneton and
+%   P. L'Ecuyer, "Efficient Jump Ahead for F2-Linear Random Number
+%   Generators", INFORMS Journal on Computing, Vol. 20, No. 3, 2008.
+%
+%   dSFMT: M. Saito and M. Matsumoto, "SIMD-oriented Fast Mersenne Twister: a
+%   128-bit Pseudorandom Number Generator", Monte Carlo and Quasi-Monte Carlo
+%   Methods 2006, Springer, 2008, pp 607--622.
+%
+%   See also RAND, RANDN.
+
+%   Note:  Initializing TWISTER to the scalar integer state 0 actually
+%   corresponds to the C call init_genrand(5489).
+
+%   Written by Peter Perkins, The MathWorks, Inc.
+%   Revision: 1.0  Date: 2004/12/23
+%   This function is not supported by The MathWorks, Inc.
+%
+%   Requires MATLAB R13.
+
+ */
+
+
+#include "mex.h"
+#include "matrix.h"
+#include <math.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+#include "MersenneTwister.h"
+#include "dSFMT.h"
+
+
+/****************************************************************************
+ *
+ * Generator handles:
+ */
+
+/* The default generator, used by TWISTER(N) and TWISTER('state',...) */
+static mt_state defaultState = { {0}, MT_N+1 };
+
+/* The dSFMT default generator, used in place of 'defaultState' when selected
+ * with TWISTER('generator','dsfmt')
+ */
+static dsfmt_state defaultDsfmt;
+static bool dsfmtSeeded = false;
+static bool useDsfmt = false;
+
+/* Table of generators created with TWISTER('create') */
+static mt_state **generators = NULL;
+static unsigned int numGenerators = 0;
+
+/* Jump polynomials, kept between calls to TWISTER('jump',...) and
+ * TWISTER('substreams',...)
+ */
+static mt_jump_cache jumpCache;
+
+/* Free all generators when the MEX file is cleared */
+static void freeGenerators(void)
+{
+    for (unsigned int i=0; i<numGenerators; i++) free(generators[i]);
+    free(generators);
+    generators = NULL;
+    numGenerators = 0;
+}
+
+/* Allocate a new generator, and return its handle */
+static uint32_T newGenerator(void)
+{
+    unsigned int i;
+
+    /* Reuse a free slot if there is one */
+    for (i=0; i<numGenerators; i++) {
+        if (generators[i] == NULL) break;
+    }
+
+    if (i == numGenerators) {
+        mt_state **grown = (mt_state **)realloc(generators, (numGenerators+16)*sizeof(mt_state *));
+        if (grown == NULL) {
+            mexErrMsgIdAndTxt("twister:OutOfMemory", "Could not allocate a new generator.");
+        }
+        generators = grown;
+        for (unsigned int j=numGenerators; j<numGenerators+16; j++) generators[j] = NULL;
+        numGenerators += 16;
+    }
+
+    generators[i] = (mt_state *)malloc(sizeof(mt_state));
+    if (generators[i] == NULL) {
+        mexErrMsgIdAndTxt("twister:OutOfMemory", "Could not allocate a new generator.");
+    }
+    generators[i]->mti = MT_N+1;
+
+    return (uint32_T)(i+1);
+}
+
+/* Look up the generator for a handle argument */
+static mt_state *getGenerator(const mxArray *handle)
+{
+    if (!mxIsUint32(handle) || (mxGetNumberOfElements(handle) != 1)) {
+        mexErrMsgIdAndTxt("twister:InvalidHandle", "Generator handle H must be a UINT32 scalar.");
+    }
+
+    uint32_T h = *(uint32_T *)mxGetData(handle);
+    if ((h < 1) || (h > numGenerators) || (generators[h-1] == NULL)) {
+        mexErrMsgIdAndTxt("twister:InvalidHandle", "Invalid or destroyed generator handle H.");
+    }
+
+    return generators[h-1];
+}
+
+/* Return a generator's state as a UINT32 vector */
+static mxArray *getState(const mt_state *state)
+{
+    mxArray *s = mxCreateNumericMatrix(1,MT_N+1,mxUINT32_CLASS,mxREAL);
+    uint32_T *p = (uint32_T*)mxGetData(s);
+    for (int i=0; i<MT_N; i++) *p++ = state->mt[i];
+    *p++ = state->mti;
+    return s;
+}
+
+/* Seed a generator from an initializer J, or set it from a state vector S */
+static void setState(mt_state *state, const mxArray *init)
+{
+    mwSize initLen = mxGetNumberOfElements(init);
+    if (initLen == 1) {
+        /* M&N's default initializer (see genrand_int32) is
+         * 5489UL, make zero do the same thing as that.
+         */
+        uint32_t initVal = (uint32_t)mxGetScalar(init);
+        if (initVal == 0) initVal = 5489UL;
+        init_genrand(state, initVal);
+    } else if (mxIsDouble(init)) {
+        if ((initLen >= 1) && (initLen <= MT_N)) {
+            double *q = (double*)mxGetData(init);
+            uint32_t key[MT_N], *p = key;
+            for (mwSize i=initLen; i; i--) *p++ = (uint32_t) *q++;
+            init_by_array(state, key, (int)initLen);
+        } else {
+            mexErrMsgIdAndTxt("twister:InvalidInitLen", "Initializer J must have fewer than 625 elements.");
+        }
+    } else if (mxIsUint32(init)) {
+        uint32_T *s = (uint32_T*)mxGetData(init);
+        if ((initLen == MT_N+1) && (s[MT_N] <= MT_N)) {
+            for (int i=0; i<MT_N; i++) state->mt[i] = s[i];
+            state->mti = (int) s[MT_N];
+        } else {
+            mexErrMsgIdAndTxt("twister:InvalidStateLen", "Invalid state vector S.");
+        }
+    } else {
+        mexErrMsgIdAndTxt("twister:InvalidInitOrState", "Second input must be an initializer or a state vector.");
+    }
+}
+
+/* Return the dSFMT state as a UINT32 vector */
+static mxArray *getDsfmtState(const dsfmt_state *state)
+{
+    mxArray *s = mxCreateNumericMatrix(1,DSFMT_STATE_WORDS,mxUINT32_CLASS,mxREAL);
+    uint32_T *p = (uint32_T*)mxGetData(s);
+    memcpy(p, state->status, (DSFMT_STATE_WORDS-1)*sizeof(uint32_T));
+    p[DSFMT_STATE_WORDS-1] = state->idx;
+    return s;
+}
+
+/* Seed the dSFMT generator from an initializer J, or set it from a state
+ * vector S
+ */
+static void setDsfmtState(dsfmt_state *state, const mxArray *init)
+{
+    mwSize initLen = mxGetNumberOfElements(init);
+    if (initLen == 1) {
+        /* As for MT19937, zero gives the default initializer */
+        uint32_t initVal = (uint32_t)mxGetScalar(init);
+        if (initVal == 0) initVal = 5489UL;
+        dsfmt_init_gen_rand(state, initVal);
+    } else if (mxIsDouble(init)) {
+        if ((initLen >= 1) && (initLen < DSFMT_STATE_WORDS)) {
+            double *q = (double*)mxGetData(init);
+            uint32_t key[DSFMT_STATE_WORDS], *p = key;
+            for (mwSize i=initLen; i; i--) *p++ = (uint32_t) *q++;
+            dsfmt_init_by_array(state, key, (int)initLen);
+        } else {
+            mexErrMsgIdAndTxt("twister:InvalidInitLen", "Initializer J must have fewer than 769 elements.");
+        }
+    } else if (mxIsUint32(init)) {
+        uint32_T *s = (uint32_T*)mxGetData(init);
+        if ((initLen == DSFMT_STATE_WORDS) && (s[DSFMT_STATE_WORDS-1] <= DSFMT_N64)) {
+            memcpy(state->status, s, (DSFMT_STATE_WORDS-1)*sizeof(uint32_T));
+            state->idx = (int) s[DSFMT_STATE_WORDS-1];
+        } else {
+            mexErrMsgIdAndTxt("twister:InvalidStateLen", "Invalid state vector S.");
+        }
+    } else {
+        mexErrMsgIdAndTxt("twister:InvalidInitOrState", "Second input must be an initializer or a state vector.");
+    }
+}
+
+/* Read an optional jump size argument */
+static int getLog2Steps(int nrhs, const mxArray *prhs[], int argIndex)
+{
+    if ((nrhs <= argIndex) || mxIsEmpty(prhs[argIndex])) return MT_DEFAULT_LOG2_JUMP;
+
+    double k = mxGetScalar(prhs[argIndex]);
+    if ((k < 0) || (k > 1024) || (k != floor(k))) {
+        mexErrMsgIdAndTxt("twister:InvalidJump", "Jump size K must be an integer between 0 and 1024.");
+    }
+    return (int)k;
+}
+
+/* Create an array of random values from a generator, with the size given by
+ * the arguments prhs[0..nrhs-1].  If 'dsState' is not NULL, the values are
+ * filled in bulk from that dSFMT generator instead of from 'state'.
+ */
+static mxArray *randomArray(mt_state *state, dsfmt_state *dsState, int nrhs, const mxArray *prhs[])
+{
+    int errMsgNum = 0;
+    mwSize nelem, localDims[10];
+    mwSize *dims = localDims;
+    mwSize ndim = (nrhs == 1) ? mxGetNumberOfElements(prhs[0]) : nrhs;
+    mxArray *r = NULL;
+
+    /* No size given, return a scalar.
+     */
+    if (nrhs == 0) {
+        return mxCreateDoubleScalar(dsState ? dsfmt_genrand_close_open(dsState) : genrand_res53(state));
+    }
+
+    if (ndim > 10) {
+        dims = (mwSize *)mxCalloc(ndim, sizeof(mwSize));
+    }
+
+    /* Individual size args given.
+     */
+    if (nrhs > 1) {
+        mwSize *p = dims;
+        nelem = 1;
+        for (mwSize i=0; i<ndim; i++) {
+            if ((!mxIsDouble(prhs[i])) || (mxGetNumberOfElements(prhs[i])!=1) || mxIsComplex(prhs[i])) {
+                errMsgNum = 101; goto cleanup;
+            }
+            double d = mxGetScalar(prhs[i]);
+            if ((d < 0) || (d > INT_MAX)) {
+                errMsgNum = 103; goto cleanup;
+            }
+            nelem *= *p++ = (mwSize)d;
+        }
+
+    /* Size vector given.
+     */
+    } else { /* nrhs == 1 */
+        if ((!mxIsDouble(prhs[0])) || (mxGetNumberOfElements(prhs[0])<1) ||  mxIsComplex(prhs[0])) {
+            errMsgNum = 102; goto cleanup;
+
+        /* Single size given, we'll return a square matrix.
+         */
+        } else if (ndim == 1) {
+            ndim = 2;
+            double d = mxGetScalar(prhs[0]);
+            if ((d < 0) || (d > INT_MAX)) {
+                errMsgNum = 103; goto cleanup;
+            }
+            dims[0] = (mwSize)d; dims[1] = (mwSize)d;
+            nelem = dims[0]*dims[1];
+
+        /* Size vector.
+         */
+        } else {
+            mwSize *p = dims;
+            double *q = (double*)mxGetData(prhs[0]);
+            nelem = 1;
+            for (mwSize i=ndim; i; i--, q++) {
+                if ((*q < 0) || (*q > INT_MAX)) {
+                    errMsgNum = 103; goto cleanup;
+                }
+                nelem *= *p++ = (mwSize)*q;
+            }
+        }
+    }
+
+    /* Create the output matrix, get a pointer to its data, and fill it
+     * in with random values.
+     */
+    {
+    r = mxCreateNumericArray(ndim,dims,mxDOUBLE_CLASS,mxREAL);
+    double *p = (double*) mxGetData(r);
+    if (dsState) {
+        dsfmt_fill_close_open(dsState, p, (long)nelem);
+    } else {
+        for (mwSize i=nelem; i; i--,p++) *p = genrand_res53(state);
+    }
+    }
+
+cleanup:
+    if (dims != localDims) mxFree((void *)dims);
+    if (errMsgNum) {
+        mexErrMsgIdAndTxt("twister:InvalidSize", "Invalid output size.");
+    }
+    return r;
+}
+
+
+/****************************************************************************
+ *
+ * MATLAB code:
+ */
+
+/* the gateway function */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    static bool registeredExit = false;
+
+    if (!registeredExit) {
+        mexAtExit(freeGenerators);
+        registeredExit = true;
+    }
+
+    /* First time through.
+     */
+    if (defaultState.mti == MT_N+1) init_genrand(&defaultState, 5489UL);
+
+    if (nlhs > 1) {
+        mexErrMsgIdAndTxt("twister:TooManyOutputs", "Too many output arguments.");
+    }
+
+    /* No args given, return a scalar.
+     */
+    if (nrhs == 0) {
+        plhs[0] = mxCreateDoubleScalar(useDsfmt ? dsfmt_genrand_close_open(&defaultDsfmt) : genrand_res53(&defaultState));
+
+    } else if ((nrhs > 0) && (mxIsChar(prhs[0]))) {
+        char theString[16], *p = theString;
+        if (mxGetString(prhs[0],theString,sizeof(theString))) {
+            mexErrMsgIdAndTxt("twister:BadStringArg", "Invalid string arg.");
+        }
+        for (;*p;p++) *p = tolower(*p); /* need strncasecmp */
+
+        if (!strcmp(theString,"state")) {
+            if (nrhs > 2) {
+                mexErrMsgIdAndTxt("twister:TooManyInputs", "Too many input arguments.");
+            }
+
+            /* Return the old state when setting the state only if asked for, but
+             * always return current state when reading the state.
+             */
+            if ((nlhs > 0) || (nrhs == 1)) {
+                plhs[0] = useDsfmt ? getDsfmtState(&defaultDsfmt) : getState(&defaultState);
+            }
+
+            /* Init or set the state.
+             */
+            if (nrhs == 2) {
+                if (useDsfmt) {
+                    setDsfmtState(&defaultDsfmt, prhs[1]);
+                } else {
+                    setState(&defaultState, prhs[1]);
+                }
+            }
+
+        } else if (!strcmp(theString,"generator")) {
+            if (nrhs > 2) {
+                mexErrMsgIdAndTxt("twister:TooManyInputs", "Too many input arguments.");
+            }
+
+            /* Return the selected algorithm, as for 'state'.
+             */
+            if ((nlhs > 0) || (nrhs == 1)) {
+                plhs[0] = mxCreateString(useDsfmt ? "dsfmt" : "mt19937");
+            }
+
+            if (nrhs == 2) {
+                char genString[16], *q = genString;
+                if (!mxIsChar(prhs[1]) || mxGetString(prhs[1],genString,sizeof(genString))) {
+                    mexErrMsgIdAndTxt("twister:BadGenerator", "Generator must be 'mt19937' or 'dsfmt'.");
+                }
+                for (;*q;q++) *q = tolower(*q);
+
+                if (!strcmp(genString,"dsfmt")) {
+                    useDsfmt = true;
+                    if (!dsfmtSeeded) {
+                        dsfmt_init_gen_rand(&defaultDsfmt, 5489UL);
+                        dsfmtSeeded = true;
+                    }
+                } else if (!strcmp(genString,"mt19937")) {
+                    useDsfmt = false;
+                } else {
+                    mexErrMsgIdAndTxt("twister:BadGenerator", "Generator must be 'mt19937' or 'dsfmt'.");
+                }
+            }
+
+        } else if (!strcmp(theString,"create")) {
+            if (nrhs > 2) {
+                mexErrMsgIdAndTxt("twister:TooManyInputs", "Too many input arguments.");
+            }
+            uint32_T h = newGenerator();
+            if (nrhs == 2) {
+                setState(generators[h-1], prhs[1]);
+            } else {
+                init_genrand(generators[h-1], 5489UL);
+            }
+            plhs[0] = mxCreateNumericMatrix(1,1,mxUINT32_CLASS,mxREAL);
+            *(uint32_T *)mxGetData(plhs[0]) = h;
+
+        } else if (!strcmp(theString,"destroy")) {
+            if (nrhs != 2) {
+                mexErrMsgIdAndTxt("twister:WrongNumInputs", "Usage: twister('destroy',H).");
+            }
+            if (!mxIsUint32(prhs[1])) {
+                mexErrMsgIdAndTxt("twister:InvalidHandle", "Generator handle H must be UINT32.");
+            }
+            uint32_T *h = (uint32_T *)mxGetData(prhs[1]);
+            for (mwSize i=mxGetNumberOfElements(prhs[1]); i; i--, h++) {
+                if ((*h >= 1) && (*h <= numGenerators)) {
+                    free(generators[*h-1]);
+                    generators[*h-1] = NULL;
+                }
+            }
+
+        } else if (!strcmp(theString,"seed")) {
+            if (nrhs != 3) {
+                mexErrMsgIdAndTxt("twister:WrongNumInputs", "Usage: twister('seed',H,J).");
+            }
+            setState(getGenerator(prhs[1]), prhs[2]);
+
+        } else if (!strcmp(theString,"getstate")) {
+            if (nrhs != 2) {
+                mexErrMsgIdAndTxt("twister:WrongNumInputs", "Usage: S = twister('getstate',H).");
+            }
+            plhs[0] = getState(getGenerator(prhs[1]));
+
+        } else if (!strcmp(theString,"rand")) {
+            if (nrhs < 2) {
+                mexErrMsgIdAndTxt("twister:WrongNumInputs", "Usage: R = twister('rand',H,M,N,...).");
+            }
+            plhs[0] = randomArray(getGenerator(prhs[1]), NULL, nrhs-2, prhs+2);
+
+        } else if (!strcmp(theString,"jump")) {
+            if ((nrhs < 2) || (nrhs > 3)) {
+                mexErrMsgIdAndTxt("twister:WrongNumInputs", "Usage: twister('jump',H,K).");
+            }
+            if (mt_jump(getGenerator(prhs[1]), &jumpCache, getLog2Steps(nrhs, prhs, 2))) {
+                mexErrMsgIdAndTxt("twister:OutOfMemory", "Could not compute the jump polynomial.");
+            }
+
+        } else if (!strcmp(theString,"substreams")) {
+            if ((nrhs < 3) || (nrhs > 4)) {
+                mexErrMsgIdAndTxt("twister:WrongNumInputs", "Usage: HS = twister('substreams',NS,J,K).");
+            }
+            double numStreams = mxGetScalar(prhs[1]);
+            if ((numStreams < 1) || (numStreams > 65536) || (numStreams != floor(numStreams))) {
+                mexErrMsgIdAndTxt("twister:InvalidNumStreams", "Number of substreams NS must be an integer between 1 and 65536.");
+            }
+            int log2Steps = getLog2Steps(nrhs, prhs, 3);
+
+            mt_state master;
+            setState(&master, prhs[2]);
+
+            const uint64_t *jump = mt_get_jump_poly(&jumpCache, log2Steps);
+            if (jump == NULL) {
+                mexErrMsgIdAndTxt("twister:OutOfMemory", "Could not compute the jump polynomial.");
+            }
+
+            plhs[0] = mxCreateNumericMatrix(1,(mwSize)numStreams,mxUINT32_CLASS,mxREAL);
+            uint32_T *h = (uint32_T *)mxGetData(plhs[0]);
+            mt_state *previous = &master;
+            for (int i=0; i<(int)numStreams; i++) {
+                h[i] = newGenerator();
+                *generators[h[i]-1] = *previous;
+                if (i > 0) mt_apply_jump_poly(generators[h[i]-1], jump);
+                previous = generators[h[i]-1];
+            }
+
+        } else {
+            mexErrMsgIdAndTxt("twister:BadStringArg", "Invalid string arg.");
+        }
+
+    } else {
+        plhs[0] = randomArray(&defaultState, useDsfmt ? &defaultDsfmt : NULL, nrhs, prhs);
+    }
+}